@@ -0,0 +1,474 @@
+/**
+ \file
+ Microbenchmarks of the hot paths of the reader
+
+ Usage: bench_corsika [options] particle_file
+
+   --json FILE      also write the results as JSON (for comparing runs)
+   --ehistory FILE  a file written with EHISTORY, for the history cases
+   --filter TEXT    only run the cases whose name contains TEXT
+   --min-time S     run each case for at least S seconds (default 0.5)
+   --repeat N       best of N measurements (default 3)
+   --tmp DIR        where to write the copies of the file (default /tmp)
+
+ The particle file is copied (plain, .gz and .bz2) so that every
+ backend reads the same data. Throughput is given in items (particles,
+ blocks, lookups, profiles) per second and in GB/s of uncompressed data.
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/FileStream.h>
+#include <corsika/RawStream.h>
+#include <corsika/FileIndex.h>
+#include <corsika/RawParticleStream.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/ShowerParticleStream.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/LongFile.h>
+#include <corsika/Index.h>
+#include <corsika/Units.h>
+#include <corsika/particle/ParticleList.h>
+#include <corsika/particle/VParticleProperties.h>
+#include <boost/scoped_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace corsika;
+
+namespace
+{
+    /// What one run of a case did
+    struct Work
+    {
+        Work(double items = 0, double bytes = 0): fItems(items), fBytes(bytes) {}
+        double fItems;
+        double fBytes;  // uncompressed
+    };
+
+    struct Result
+    {
+        std::string fName;
+        std::string fUnit;
+        size_t fIterations;
+        double fSeconds;    // per iteration, best of the repetitions
+        Work fWork;         // per iteration
+    };
+
+    struct Options
+    {
+        Options(): fMinTime(0.5), fRepeat(3), fTmp("/tmp") {}
+        std::string fInput;
+        std::string fEHistory;
+        std::string fJson;
+        std::string fFilter;
+        double fMinTime;
+        size_t fRepeat;
+        std::string fTmp;
+    };
+
+    // keeps the results of the cases alive
+    volatile double gSink = 0;
+
+    double now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct Bench
+    {
+        explicit Bench(const Options& options): fOptions(options) {}
+
+        /// Run \a f until fMinTime has passed, fRepeat times, and keep the fastest
+        void Run(const std::string& name, const std::string& unit, const std::function<Work()>& f)
+        {
+            if (!fOptions.fFilter.empty() && name.find(fOptions.fFilter) == std::string::npos)
+                return;
+            Result result;
+            result.fName = name;
+            result.fUnit = unit;
+            result.fIterations = 0;
+            result.fSeconds = 0;
+            f(); // warm up (page cache, lazy initialization)
+            for (size_t r = 0; r != fOptions.fRepeat; ++r)
+            {
+                size_t iterations = 0;
+                Work work;
+                const double start = now();
+                double elapsed = 0;
+                do
+                {
+                    work = f();
+                    ++iterations;
+                    elapsed = now() - start;
+                } while (elapsed < fOptions.fMinTime);
+                const double seconds = elapsed/iterations;
+                if (!result.fIterations || seconds < result.fSeconds)
+                {
+                    result.fSeconds = seconds;
+                    result.fWork = work;
+                }
+                result.fIterations += iterations;
+            }
+            Print(result);
+            fResults.push_back(result);
+        }
+
+        void Skip(const std::string& name, const std::string& reason)
+        {
+            if (fOptions.fFilter.empty() || name.find(fOptions.fFilter) != std::string::npos)
+                printf("%-36s skipped: %s\n", name.c_str(), reason.c_str());
+        }
+
+        void Print(const Result& r) const
+        {
+            printf("%-36s %12.3f ms %14.4g %s/s", r.fName.c_str(), r.fSeconds*1e3,
+                   r.fWork.fItems/r.fSeconds, r.fUnit.c_str());
+            if (r.fWork.fBytes > 0)
+                printf(" %9.3f GB/s", r.fWork.fBytes/r.fSeconds*1e-9);
+            printf("\n");
+            fflush(stdout);
+        }
+
+        void WriteJson(const std::string& filename) const
+        {
+            FILE* f = fopen(filename.c_str(), "w");
+            if (!f)
+                throw IOException("Error opening '" + filename + "' for writing.\n");
+            char host[256] = "";
+            gethostname(host, sizeof(host) - 1);
+            fprintf(f, "{\n  \"context\": {\"input\": \"%s\", \"host\": \"%s\", \"min_time\": %g, \"repeat\": %zu},\n",
+                    fOptions.fInput.c_str(), host, fOptions.fMinTime, fOptions.fRepeat);
+            fprintf(f, "  \"benchmarks\": [");
+            for (size_t i = 0; i != fResults.size(); ++i)
+            {
+                const Result& r = fResults[i];
+                fprintf(f, "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %zu, \"seconds\": %.9g, "
+                        "\"items\": %.17g, \"bytes\": %.17g, \"items_per_second\": %.9g, \"bytes_per_second\": %.9g}",
+                        (i ? "," : ""), r.fName.c_str(), r.fUnit.c_str(), r.fIterations, r.fSeconds,
+                        r.fWork.fItems, r.fWork.fBytes, r.fWork.fItems/r.fSeconds, r.fWork.fBytes/r.fSeconds);
+            }
+            fprintf(f, "\n  ]\n}\n");
+            if (fclose(f))
+                throw IOException("Error writing '" + filename + "'.\n");
+        }
+
+        const Options& fOptions;
+        std::vector<Result> fResults;
+    };
+
+    std::vector<char> read_file(const std::string& filename)
+    {
+        boost::scoped_ptr<FileStream> in(FileStream::open(filename.c_str()));
+        if (!in)
+            throw IOException("Error opening '" + filename + "'.\n");
+        std::vector<char> data;
+        std::vector<char> buffer(1 << 20);
+        long n;
+        while ((n = in->read(buffer.size(), buffer.data())) > 0)
+            data.insert(data.end(), buffer.begin(), buffer.begin() + n);
+        return data;
+    }
+
+    void write_file(const std::string& filename, const std::vector<char>& data)
+    {
+        boost::scoped_ptr<OutputFileStream> out(OutputFileStream::open(filename.c_str()));
+        if (!out || !out->write(data.size(), data.data()) || !out->close())
+            throw IOException("Error writing '" + filename + "'.\n");
+    }
+
+    /// A .long file with \a n showers, as CORSIKA writes them
+    void write_long(const std::string& filename, int n, int bins)
+    {
+        FILE* f = fopen(filename.c_str(), "w");
+        if (!f)
+            throw IOException("Error opening '" + filename + "' for writing.\n");
+        for (int shower = 1; shower <= n; ++shower)
+        {
+            fprintf(f, " LONGITUDINAL DISTRIBUTION IN %5d VERTICAL STEPS OF    10. G/CM**2 FOR SHOWER %6d\n", bins, shower);
+            fprintf(f, " DEPTH     GAMMAS   POSITRONS   ELECTRONS         MU+         MU-     HADRONS     CHARGED      NUCLEI   CERENKOV\n");
+            for (int b = 0; b != bins; ++b)
+                fprintf(f, "%7.1f %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E\n",
+                        10.*b + 5., 1e5 + b, 2e4, 3e4 + b, 4.5e2, 5.25e2, 6., 7e4, 0., 9.87654e7);
+            fprintf(f, " LONGITUDINAL ENERGY DEPOSIT IN %5d VERTICAL STEPS OF    10. G/CM**2 FOR SHOWER %6d\n", bins, shower);
+            fprintf(f, " DEPTH       GAMMA    EM IONIZ     EM CUT    MU IONIZ     MU CUT  HADR IONIZ   HADR CUT   NEUTRINO    SUM\n");
+            for (int b = 0; b != bins; ++b)
+                fprintf(f, "%7.1f %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E\n",
+                        10.*b + 5., 1., 2., 3., 4., 5., 6., 7., 8., 100.);
+            fprintf(f, "\n FIT OF THE HILLAS CURVE   N(T) = P1 * ((T-P2)/(P3-P2))**((P3-P2)/(P4+P5*T+P6*T**2)) * EXP((P3-T)/(P4+P5*T+P6*T**2))\n");
+            fprintf(f, " TO LONGITUDINAL DISTRIBUTION OF     ALL CHARGED  PARTICLES\n");
+            fprintf(f, " PARAMETERS         =   %11.4E %11.4E %11.4E %11.4E %11.4E %11.4E\n",
+                    1.5e5, -12., 750., 40., -1.5e-2, 2e-5);
+            fprintf(f, " CHI**2/DOF         =   %11.4E\n AV. DEVIATION IN %% =   1.0000E+00\n\n", 2.5);
+        }
+        fclose(f);
+    }
+
+    /// A square detector, for PositionIndex
+    struct Station
+    {
+        Station(double x, double y, double size): fX(x), fY(y), fSize(size) {}
+        double x() const { return fX; }
+        double y() const { return fY; }
+        double dx() const { return fSize; }
+        double dy() const { return fSize; }
+        double fX, fY, fSize;
+    };
+
+    template <class Thinning>
+    size_t block_loop(RawStream& stream)
+    {
+        Block<Thinning> block;
+        size_t n = 0;
+        while (stream.GetNextBlock(block))
+            ++n;
+        return n;
+    }
+
+    size_t count_blocks(RawStream& stream)
+    {
+        return stream.IsThinned() ? block_loop<Thinned>(stream) : block_loop<NotThinned>(stream);
+    }
+
+    size_t block_size(RawStream& stream)
+    {
+        return stream.IsThinned() ? sizeof(Block<Thinned>) : sizeof(Block<NotThinned>);
+    }
+
+    /// Every particle of every shower, in batches
+    size_t read_showers(const std::string& filename)
+    {
+        ShowerFile file(filename);
+        const std::vector<unsigned int> ids = file.GetEventIds();
+        ParticleBatch batch;
+        size_t n = 0;
+        for (size_t i = 0; i != ids.size(); ++i)
+        {
+            file.FindEvent(ids[i]);
+            ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+            while (stream.NextBatch(batch))
+            {
+                n += batch.size();
+                gSink = gSink + batch.fKineticEnergy[0];
+            }
+        }
+        return n;
+    }
+
+    /// Every particle record of the first shower, unfiltered
+    size_t read_records(const std::string& filename)
+    {
+        RawStreamPtr raw = RawStream::Create(filename);
+        FileIndex index;
+        index.Scan(*raw, true);
+        if (index.eventHeaders.empty())
+            return 0;
+        RawParticleStreamPtr stream = VRawParticleStream::Create(raw, index.eventHeaders[0] + 1);
+        size_t n = 0;
+        while (boost::optional<Particle> p = stream->NextParticle())
+        {
+            ++n;
+            gSink = gSink + p->fX;
+        }
+        return n;
+    }
+
+    void usage()
+    {
+        printf("Usage: bench_corsika [--json FILE] [--ehistory FILE] [--filter TEXT] [--min-time S] [--repeat N] [--tmp DIR] particle_file\n");
+    }
+
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--json" && hasValue) options.fJson = argv[++i];
+            else if (arg == "--ehistory" && hasValue) options.fEHistory = argv[++i];
+            else if (arg == "--filter" && hasValue) options.fFilter = argv[++i];
+            else if (arg == "--min-time" && hasValue) options.fMinTime = atof(argv[++i]);
+            else if (arg == "--repeat" && hasValue) options.fRepeat = std::max(1, atoi(argv[++i]));
+            else if (arg == "--tmp" && hasValue) options.fTmp = argv[++i];
+            else if (arg[0] == '-' || !options.fInput.empty()) return false;
+            else options.fInput = arg;
+        }
+        return !options.fInput.empty();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        usage();
+        return 1;
+    }
+
+    try
+    {
+        Bench bench(options);
+
+        // the same data through every backend
+        const std::vector<char> data = read_file(options.fInput);
+        const double bytes = data.size();
+        const std::string base = options.fTmp + "/bench_corsika_" + std::to_string(getpid());
+        const std::string raw = base + ".dat";
+        const char* extensions[] = {"", ".gz", ".bz2"};
+        const char* backends[] = {"raw", "gz", "bz2"};
+        for (int b = 0; b != 3; ++b)
+            write_file(raw + extensions[b], data);
+        printf("%s: %.1f MB\n", options.fInput.c_str(), bytes*1e-6);
+
+        for (int b = 0; b != 3; ++b)
+        {
+            const std::string name = raw + extensions[b];
+            bench.Run(std::string("FileStream::read/") + backends[b], "B", [&name]()
+                {
+                    boost::scoped_ptr<FileStream> in(FileStream::open(name.c_str()));
+                    std::vector<char> buffer(1 << 20);
+                    double n = 0;
+                    long r;
+                    while ((r = in->read(buffer.size(), buffer.data())) > 0)
+                        n += r;
+                    return Work(n, n);
+                });
+        }
+
+        bench.Run("RawStream::GetNextBlock", "block", [&raw]()
+            {
+                RawStreamPtr stream = RawStream::Create(raw);
+                const size_t n = count_blocks(*stream);
+                return Work(n, double(n)*block_size(*stream));
+            });
+
+        for (int b = 0; b != 3; ++b)
+        {
+            const std::string name = raw + extensions[b];
+            bench.Run(std::string("FileIndex::Scan/") + backends[b], "block", [&name, bytes]()
+                {
+                    // reads the whole file (and seeks back to where it started)
+                    RawStreamPtr stream = RawStream::Create(name);
+                    FileIndex index;
+                    index.Scan(*stream, true);
+                    return Work(bytes/block_size(*stream), bytes);
+                });
+        }
+
+        bench.Run("RawParticleStream::NextParticle", "particle", [&raw]()
+            {
+                return Work(read_records(raw));
+            });
+        bench.Run("ShowerParticleStream::NextBatch", "particle", [&raw, bytes]()
+            {
+                return Work(read_showers(raw), bytes);
+            });
+        bench.Run("ShowerParticleStream::NextBatch/gz", "particle", [&raw, bytes]()
+            {
+                return Work(read_showers(raw + ".gz"), bytes);
+            });
+        if (options.fEHistory.empty())
+        {
+            bench.Skip("RawParticleStream::NextParticle/ehistory", "no --ehistory file");
+            bench.Skip("ShowerParticleStream::NextBatch/ehistory", "no --ehistory file");
+        }
+        else
+        {
+            const std::string& ehistory = options.fEHistory;
+            bench.Run("RawParticleStream::NextParticle/ehistory", "particle", [&ehistory]()
+                {
+                    return Work(read_records(ehistory));
+                });
+            bench.Run("ShowerParticleStream::NextBatch/ehistory", "particle", [&ehistory]()
+                {
+                    return Work(read_showers(ehistory));
+                });
+        }
+
+        // the particle codes of the file, in file order
+        std::vector<int> codes;
+        {
+            ShowerFile file(raw);
+            file.FindEvent(file.GetEventIds().at(0));
+            ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+            while (boost::optional<Particle> p = stream.NextParticle())
+                codes.push_back(int(p->fDescription/1000));
+        }
+        bench.Run("ParticleList::CorsikaToPDG", "lookup", [&codes]()
+            {
+                long sum = 0;
+                for (size_t i = 0; i != codes.size(); ++i)
+                    sum += ParticleList::CorsikaToPDG(codes[i]);
+                gSink = gSink + sum;
+                return Work(codes.size());
+            });
+        bench.Run("ParticleList::Get", "lookup", [&codes]()
+            {
+                double sum = 0;
+                for (size_t i = 0; i != codes.size(); ++i)
+                    sum += ParticleList::Get(ParticleList::CorsikaToPDG(codes[i])).GetMass();
+                gSink = gSink + sum;
+                return Work(codes.size());
+            });
+
+        // a 1.5 km grid of 10 m^2 stations, queried at uniformly random positions
+        {
+            PositionIndex<Station> index(50*km, 100*m);
+            for (double x = -24*km; x < 24*km; x += 1.5*km)
+                for (double y = -24*km; y < 24*km; y += 1.5*km)
+                    index.Add(Station(x, y, sqrt(10.)*m));
+            std::vector<double> xs(1 << 20);
+            std::vector<double> ys(xs.size());
+            srand(42);
+            for (size_t i = 0; i != xs.size(); ++i)
+            {
+                xs[i] = (double(rand())/RAND_MAX - 0.5)*50*km;
+                ys[i] = (double(rand())/RAND_MAX - 0.5)*50*km;
+            }
+            bench.Run("PositionIndex::Get", "lookup", [&index, &xs, &ys]()
+                {
+                    size_t hits = 0;
+                    for (size_t i = 0; i != xs.size(); ++i)
+                        hits += index.Get(xs[i], ys[i]).size();
+                    gSink = gSink + hits;
+                    return Work(xs.size());
+                });
+        }
+
+        const std::string longName = base + ".long";
+        const int nShowers = 100;
+        write_long(longName, nShowers, 200);
+        const double longBytes = read_file(longName).size();
+        bench.Run("LongFile::GetProfile", "profile", [&longName, longBytes]()
+            {
+                LongFile file(longName, 0.5);
+                double sum = 0;
+                for (size_t i = 0; i != file.size(); ++i)
+                    sum += file.GetProfile(i).fCalorimetricEnergy;
+                gSink = gSink + sum;
+                return Work(file.size(), longBytes);
+            });
+
+        for (int b = 0; b != 3; ++b)
+            remove((raw + extensions[b]).c_str());
+        remove(longName.c_str());
+
+        if (!options.fJson.empty())
+            bench.WriteJson(options.fJson);
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "bench_corsika: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
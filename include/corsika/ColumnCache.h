@@ -0,0 +1,137 @@
+/**
+ \file
+ Memory-mapped cache of decoded particle columns
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/Block.h>
+#include <corsika/ColumnSpan.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/RawParticleStream.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    struct ShowerFile;
+
+    /**
+     \class ColumnCache ColumnCache.h "corsika/ColumnCache.h"
+
+     \brief Decoded particles of every event, memory-mapped from an uncompressed columnar file.
+
+     Decoding a CORSIKA file is the slow part of most analyses. The
+     cache is written once (with Convert, usually next to the
+     particle file) and then mapped into memory: the columns are
+     returned as views of the mapped file, without copying or
+     decoding anything, so reading runs at the speed of memory (or of
+     the page cache).
+
+     Columns hold the particles read by ShowerParticleStream (the
+     observation level and time shift of ShowerFile), with the same
+     units and types as ParticleBatch, plus the PDG codes of the
+     parent and grandparent (zero if the file has no history
+     records). Every column starts at a multiple of kAlignment bytes.
+
+     The file has the native byte order and is not meant to be moved
+     across architectures. Errors throw IOException.
+
+     A cache can also live in POSIX shared memory (see ShowerServer),
+     so that many processes map the same decoded events.
+
+     \ingroup corsika
+     */
+    struct ColumnCache: boost::noncopyable
+    {
+        enum Column
+        {
+            eX,
+            eY,
+            eT,
+            ePx,
+            ePy,
+            ePz,
+            eKineticEnergy,
+            eWeight,
+            ePDG,
+            eCorsikaCode,
+            eLevel,
+            eGeneration,
+            eParentPDG,
+            eGrandParentPDG,
+            eNColumns
+        };
+
+        /// Where the cache is
+        enum Source
+        {
+            eFile,
+            eSharedMemory   // name of a POSIX shared memory object
+        };
+
+        static const size_t kAlignment = 64;
+
+        /// Name of a column, like "x" or "parent_pdg"
+        static std::string ColumnName(Column c);
+        /// Column for a name, eNColumns if unknown
+        static Column ColumnFromName(const std::string& name);
+        /// Type of the elements of a column, as a numpy type string ("<f4", "<i4" or "<i2")
+        static const char* ColumnType(Column c);
+        static size_t ColumnItemSize(Column c);
+
+        /// Decode all events of a CORSIKA file into a cache. Returns the number of particles.
+        static size_t Convert(const std::string& corsikaFile, const std::string& cacheFile);
+        /// Decode some events into an open, seekable, file (\a name is only for messages). Returns the number of particles.
+        static size_t Write(ShowerFile& file, const std::vector<unsigned int>& eventIds, FILE* out, const std::string& name);
+
+        explicit ColumnCache(const std::string& name, Source source = eFile);
+        ~ColumnCache();
+
+        /**
+         Particle records of an event, for a ShowerParticleStream. They
+         are rebuilt from the columns, at the observation level they
+         were read from (GetObservationLevel) and with no time offset,
+         and without parents (only their codes are cached).
+         */
+        static RawParticleStreamPtr CreateParticleStream(boost::shared_ptr<const ColumnCache> cache, size_t event);
+
+        const std::string& GetFilename() const { return fFilename; }
+        const RunHeader& GetRunHeader() const;
+
+        size_t GetNEvents() const;
+        /// Position of the event with this event number, GetNEvents() if there is none
+        size_t FindEvent(unsigned int eventId) const;
+        const EventHeader& GetEventHeader(size_t event) const;
+        const EventTrailer& GetEventTrailer(size_t event) const;
+        size_t GetNParticles(size_t event) const;
+        /// Observation level (starting at 1) of the particles of an event, 1 if there are none
+        unsigned int GetObservationLevel(size_t event) const;
+
+        /// Address of the first element of a column
+        const void* GetData(size_t event, Column c) const;
+
+        ColumnSpan<float> GetFloats(size_t event, Column c) const;     // x to weight
+        ColumnSpan<int> GetInts(size_t event, Column c) const;         // pdg codes
+        ColumnSpan<short> GetShorts(size_t event, Column c) const;     // corsika code, level and generation
+
+        /// Copy an event into a batch, for code that works on batches.
+        void GetBatch(size_t event, ParticleBatch& batch) const;
+
+    private:
+        struct EventEntry;
+        const EventEntry& GetEntry(size_t event) const;
+        template <class T> ColumnSpan<T> GetSpan(size_t event, Column c, const char* type) const;
+
+        std::string fFilename;
+        const char* fData;
+        size_t fSize;
+        size_t fNEvents;
+    };
+}
@@ -0,0 +1,35 @@
+/**
+ \file
+ Read-only view of a contiguous array
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <cstddef>
+
+namespace corsika
+{
+    /**
+     \class ColumnSpan ColumnSpan.h "corsika/ColumnSpan.h"
+
+     \brief Read-only view of a contiguous array (a column of a ColumnCache or a ProfileTable).
+     */
+    template <class T> struct ColumnSpan
+    {
+        ColumnSpan(): fData(0), fSize(0) {}
+        ColumnSpan(const T* data, size_t size): fData(data), fSize(size) {}
+
+        const T* data() const { return fData; }
+        size_t size() const { return fSize; }
+        bool empty() const { return !fSize; }
+        const T* begin() const { return fData; }
+        const T* end() const { return fData + fSize; }
+        const T& operator[](size_t i) const { return fData[i]; }
+
+    private:
+        const T* fData;
+        size_t fSize;
+    };
+}
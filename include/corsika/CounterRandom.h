@@ -0,0 +1,37 @@
+/**
+ \file
+ Counter-based random numbers
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace corsika
+{
+    /**
+     \class CounterRandom CounterRandom.h "corsika/CounterRandom.h"
+
+     \brief Counter-based random numbers: the n-th number of stream (seed, key1, key2) is a hash of the four.
+
+     There is no state besides the counter, so the numbers for one
+     particle do not depend on which thread handles it or on what was
+     drawn for other particles.
+     */
+    struct CounterRandom
+    {
+        CounterRandom(uint64_t seed, uint64_t key1, uint64_t key2 = 0);
+        /// Uniform in [0, 1)
+        double Uniform();
+        /// Standard normal
+        double Gaussian();
+
+        static uint64_t Mix(uint64_t x);
+
+    private:
+        uint64_t fKey;
+        uint64_t fCounter;
+    };
+}
@@ -0,0 +1,188 @@
+/**
+ \file
+ Sampling of ground particles with a layout of detectors
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/Index.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/ParticleSelection.h>
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace corsika
+{
+    struct Shower;
+    struct ShowerParticleStream;
+
+    /**
+     \class Detector DetectorSampler.h "corsika/DetectorSampler.h"
+
+     \brief Horizontal footprint of a detector: a circle or a (possibly rotated) rectangle.
+
+     Coordinates are in the frame of the detector layout (see
+     DetectorSampler::SetCore). The angle of a rectangle is the
+     rotation of its dx side with respect to the x axis.
+     */
+    struct Detector
+    {
+        enum Shape
+        {
+            eCircle,
+            eRectangle
+        };
+
+        static Detector Circle(double x, double y, double radius);
+        static Detector Rectangle(double x, double y, double dx, double dy, double angle = 0);
+
+        double GetArea() const;
+
+        // for the collision policies
+        double x() const { return fX; }
+        double y() const { return fY; }
+        double radius() const { return fRadius; }
+        double dx() const { return fDx; }
+        double dy() const { return fDy; }
+        double angle() const { return fAngle; }
+
+        Shape fShape;
+        double fX;
+        double fY;
+        double fRadius;
+        double fDx;
+        double fDy;
+        double fAngle;
+    };
+
+    /// Collision policy for Detector, CircleCollision or RotatedSquareCollision depending on the shape.
+    struct DetectorCollision
+    {
+        /// Footprint of a detector with the geometry computed once, for the exact tests
+        struct Shape
+        {
+            bool Contains(double x, double y) const
+            { return fCircle ? fDisk.Contains(x, y) : fRectangle.Contains(x, y); }
+            bool fCircle;
+            detail::Circle fDisk;
+            detail::RotatedRectangle fRectangle;
+        };
+        typedef Shape shape_type;
+
+        static Shape Prepare(const Detector& d);
+        std::vector<std::pair<unsigned int,unsigned int> > operator()(const std::vector<double>& x, const std::vector<double>& y, const Detector& d) const;
+        std::vector<detail::CellCoverage> Coverage(const std::vector<double>& x, const std::vector<double>& y, const Detector& d) const;
+        bool Contains(const Detector& d, double x, double y) const;
+    };
+
+    /// What a detector has seen.
+    struct DetectorHits
+    {
+        DetectorHits(): fEntries(0), fWeight(0), fSumW2(0), fEnergy(0), fFirstTime(HUGE_VAL) {}
+        void Add(const DetectorHits& other);
+
+        size_t fEntries;    ///< number of particles
+        double fWeight;     ///< sum of weights (number of particles if weights are not used)
+        double fSumW2;      ///< sum of squared weights
+        double fEnergy;     ///< weighted sum of kinetic energies
+        double fFirstTime;  ///< earliest arrival time, HUGE_VAL if there are no hits
+    };
+
+    /**
+     \class DetectorSampler DetectorSampler.h "corsika/DetectorSampler.h"
+
+     \brief Finds the particles that hit each detector of a layout and accumulates them.
+
+     The detectors are put in a FlatPositionIndex once. Particles are
+     then decoded in batches, the index is queried for the whole batch
+     and each (particle, detector) pair where the particle is inside
+     the detector footprint is added to the DetectorHits of that
+     detector and, if set, passed to a callback.
+
+     Particle coordinates are in the CORSIKA array frame with the core
+     at the origin. The shower core is placed at (x, y) of the layout
+     with SetCore, so that a particle at (px, py) is at (px + x, py + y)
+     in the layout.
+     \code
+     std::vector<Detector> layout;
+     layout.push_back(Detector::Circle(0, 750*m, 1.8*m));
+     ...
+     DetectorSampler sampler(layout);
+     sampler.SetSelection(ParticleSelection("pdg in (13, -13)"));
+     sampler.Sample(file.GetCurrentShower(), 4);
+     double muons = sampler.GetHits(0).fWeight;
+     \endcode
+     */
+    struct DetectorSampler
+    {
+        /**
+         Called for every hit with the batch, the particle in the batch,
+         the detector and the thread. With several threads it is called
+         concurrently from all of them (use the thread argument to keep
+         per-thread state).
+         */
+        typedef std::function<void(const ParticleBatch& batch, size_t particle, size_t detector, size_t thread)> HitCallback;
+
+        /**
+         cellSize is the size of the index cells. Zero means it is
+         chosen from the detector density. The index covers the
+         bounding box of the layout.
+         */
+        DetectorSampler(const std::vector<Detector>& detectors, double cellSize = 0);
+
+        size_t GetNDetectors() const { return fDetectors.size(); }
+        const Detector& GetDetector(size_t d) const { return fDetectors.at(d); }
+        const std::vector<Detector>& GetDetectors() const { return fDetectors; }
+
+        void SetCore(double x, double y) { fCoreX = x; fCoreY = y; }
+        double GetCoreX() const { return fCoreX; }
+        double GetCoreY() const { return fCoreY; }
+
+        void SetSelection(const ParticleSelection& selection);
+        void ClearSelection() { fSelection.reset(); }
+        bool HasSelection() const { return bool(fSelection); }
+
+        void SetUseWeights(bool use) { fUseWeights = use; }
+        bool GetUseWeights() const { return fUseWeights; }
+
+        void SetCallback(const HitCallback& callback) { fCallback = callback; }
+        void ClearCallback() { fCallback = HitCallback(); }
+
+        /// Sample the particles of a batch (in the calling thread).
+        void Sample(const ParticleBatch& batch);
+        /// Sample the remaining particles in a stream, nThreads == 0 means one per hardware thread.
+        void Sample(ShowerParticleStream& stream, size_t nThreads = 1);
+        /// Sample all particles of a shower.
+        void Sample(const Shower& shower, size_t nThreads = 1);
+
+        const DetectorHits& GetHits(size_t d) const { return fHits.at(d); }
+        const std::vector<DetectorHits>& GetAllHits() const { return fHits; }
+        /// Number of (particle, detector) hits so far
+        size_t GetNHits() const;
+
+        /// Clear the hits (layout, core, selection and callback are kept).
+        void Reset();
+
+        typedef FlatPositionIndex<Detector, DetectorCollision> index_type;
+        const index_type& GetIndex() const { return *fIndex; }
+
+        /// The index used by the sampler: covers the bounding box of the detectors, built and ready for lookups.
+        static boost::shared_ptr<index_type> MakeIndex(const std::vector<Detector>& detectors, double cellSize = 0);
+
+    private:
+        void Sample(const ParticleBatch& batch, std::vector<DetectorHits>& hits, size_t thread) const;
+
+        std::vector<Detector> fDetectors;
+        boost::shared_ptr<index_type> fIndex;
+        double fCoreX;
+        double fCoreY;
+        boost::shared_ptr<const ParticleSelection> fSelection;
+        bool fUseWeights;
+        HitCallback fCallback;
+        std::vector<DetectorHits> fHits;
+    };
+}
@@ -0,0 +1,135 @@
+/**
+ \file
+ Resampling of thinned particles near detectors
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/CounterRandom.h>
+#include <corsika/DetectorSampler.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/ParticleSelection.h>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace corsika
+{
+    struct Shower;
+    struct ShowerParticleStream;
+
+    /**
+     \class DethinningKernel Dethinning.h "corsika/Dethinning.h"
+
+     \brief How one weighted particle is spread into unweighted ones (Billoir-style cone back-projection).
+
+     The particle track is followed back from the ground to a vertex
+     at a distance L, drawn from a normal distribution of mean
+     fVertexDistance and relative width fVertexSpread (truncated at
+     five sigma and at zero). Each new particle leaves the vertex in a
+     direction drawn uniformly in the cone of half-angle fConeAngle
+     around the original direction, keeps the energy and type, and
+     reaches the ground later by the difference in path length
+     (moving at the speed of light). New particles going up are lost.
+
+     Particles more inclined than fMaxZenith are not resampled.
+     */
+    struct DethinningKernel
+    {
+        DethinningKernel();
+
+        /// Largest vertex distance that can be drawn
+        double GetMaxVertexDistance() const;
+        /// Largest horizontal distance between the original particle and a new one, for a particle with this zenith angle
+        double GetReach(double zenith) const;
+
+        double fVertexDistance;
+        double fVertexSpread;
+        double fConeAngle;
+        double fMaxZenith;
+    };
+
+    /**
+     \class Dethinner Dethinning.h "corsika/Dethinning.h"
+
+     \brief Replaces thinned particles by unweighted ones, only where there are detectors.
+
+     A particle of weight w is replaced by floor(w) or floor(w) + 1
+     particles of weight one (the mean is w), spread with a
+     DethinningKernel. Particles with weight one or less are kept as
+     they are. The new particles are generated only for particles
+     whose kernel reaches a detector, and only the ones that land in
+     a detector are kept, so memory and time go with the area of the
+     detectors and not with the total weight of the shower.
+
+     The random numbers for particle i of the shower (counting from
+     the first particle sampled after construction or Reset) come from
+     the streams (seed, i, j), j being the new particle, so the result
+     is the same for any number of threads. The particles in each
+     detector are in the order of the original particles.
+
+     Like for DetectorSampler, particles are in the array frame with
+     the core at the origin and the core is placed in the layout with
+     SetCore.
+     */
+    struct Dethinner
+    {
+        Dethinner(const std::vector<Detector>& detectors, const DethinningKernel& kernel = DethinningKernel(),
+                  uint64_t seed = 0);
+
+        size_t GetNDetectors() const { return fDetectors.size(); }
+        const Detector& GetDetector(size_t d) const { return fDetectors.at(d); }
+        const DethinningKernel& GetKernel() const { return fKernel; }
+        uint64_t GetSeed() const { return fSeed; }
+
+        void SetCore(double x, double y) { fCoreX = x; fCoreY = y; }
+
+        /// Only resample particles passing a selection (others are ignored).
+        void SetSelection(const ParticleSelection& selection);
+        void ClearSelection() { fSelection.reset(); }
+
+        /// Resample the particles of a batch. Batches must be given in order.
+        void Sample(const ParticleBatch& batch);
+        /// Resample the remaining particles in a stream, nThreads == 0 means one per hardware thread.
+        void Sample(ShowerParticleStream& stream, size_t nThreads = 1);
+        void Sample(const Shower& shower, size_t nThreads = 1);
+
+        /// Particles in detector d
+        const ParticleBatch& GetParticles(size_t d) const { return fParticles.at(d); }
+
+        /// Number of particles read so far
+        size_t GetNRead() const { return fNRead; }
+        /// Number of new particles generated (before checking if they hit a detector)
+        size_t GetNGenerated() const { return fNGenerated; }
+
+        /// Clear the particles in the detectors and restart the particle count.
+        void Reset();
+
+    private:
+        struct Output
+        {
+            Output(size_t n): fParticles(n), fNGenerated(0) {}
+            std::vector<ParticleBatch> fParticles;
+            size_t fNGenerated;
+        };
+
+        void Sample(const ParticleBatch& batch, size_t first, Output& out) const;
+        void Merge(Output& out);
+
+        std::vector<Detector> fDetectors;
+        std::vector<DetectorCollision::Shape> fShapes;  // fDetectors, prepared for the exact tests
+        DethinningKernel fKernel;
+        uint64_t fSeed;
+        double fMaxReach;
+        boost::shared_ptr<DetectorSampler::index_type> fIndex;  // detectors enlarged by fMaxReach
+        double fCoreX;
+        double fCoreY;
+        boost::shared_ptr<const ParticleSelection> fSelection;
+
+        std::vector<ParticleBatch> fParticles;
+        size_t fNRead;
+        size_t fNGenerated;
+    };
+}
@@ -9,3 +9,11 @@ struct FileStream
     virtual bool seek(size_t absolute_position) = 0; // Returns false on failure
     static FileStream* open(const char* filename); // Returns null on failure
 };
+
+struct OutputFileStream
+{
+    virtual ~OutputFileStream(){}
+    virtual bool write(size_t num, const void* bytes) = 0; // Returns false on failure
+    virtual bool close() = 0; // Flushes and closes, returns false on failure
+    static OutputFileStream* open(const char* filename); // Compressed if the name ends in .gz or .bz2. Returns null on failure
+};
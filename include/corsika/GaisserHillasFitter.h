@@ -0,0 +1,103 @@
+/**
+ \file
+ Least-squares fits of Gaisser-Hillas functions to longitudinal profiles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/GaisserHillasParameter.h>
+#include <corsika/LongCache.h>
+#include <corsika/LongProfile.h>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class GaisserHillasFitter GaisserHillasFitter.h "corsika/GaisserHillasFitter.h"
+
+     \brief Fit Gaisser-Hillas functions to profiles, one or many at a time.
+
+     The function is
+       N(X) = NMax ((X - X0)/(XMax - X0))^((XMax - X0)/L) exp((XMax - X)/L)
+     with L = a + b X + c X^2. eFourParameters fits NMax, XMax, X0 and
+     a (b = c = 0), eSixParameters fits all of them, like CORSIKA.
+
+     The fit is a Levenberg-Marquardt minimization of chi^2 with
+     analytic derivatives. Starting values come from the profile: XMax
+     and NMax from a parabola through the maximum, L and X0 from the
+     mean and width of the profile around it. The six-parameter fit
+     starts from the four-parameter one.
+
+     Depths are the numbers in the profiles (g/cm2, like LongProfile
+     and LongFile). The results are in the units of
+     GaisserHillasParameter (Units.h), like the CORSIKA fit read by
+     LongFile, with errors from the covariance at the minimum and
+     GetChiSquare/GetNdof set. A fit that is not possible (fewer points
+     than parameters plus one, or no positive value) returns a
+     parameter with NMax and Ndof zero.
+
+     Cuts select the points used: a depth range and a minimum value
+     relative to the profile maximum. A profile ends at the first
+     depth that does not increase (LongFile leaves unused bins at
+     zero).
+
+     \ingroup corsika
+     */
+    struct GaisserHillasFitter
+    {
+        enum Form
+        {
+            eFourParameters,
+            eSixParameters
+        };
+
+        /// Errors of the values in chi^2
+        enum Errors
+        {
+            ePoisson,   // sigma^2 = value (at least 1)
+            eUniform    // sigma = 1
+        };
+
+        explicit GaisserHillasFitter(Form form = eFourParameters, Errors errors = ePoisson);
+
+        Form GetForm() const { return fForm; }
+        Errors GetErrors() const { return fErrors; }
+
+        /// Use only points with minDepth <= depth <= maxDepth
+        void SetDepthRange(double minDepth, double maxDepth) { fMinDepth = minDepth; fMaxDepth = maxDepth; }
+        double GetMinDepth() const { return fMinDepth; }
+        double GetMaxDepth() const { return fMaxDepth; }
+        /// Use only points with value >= fraction*maximum
+        void SetMinFraction(double fraction) { fMinFraction = fraction; }
+        double GetMinFraction() const { return fMinFraction; }
+        void SetMaxIterations(size_t n) { fMaxIterations = n; }
+        size_t GetMaxIterations() const { return fMaxIterations; }
+
+        /// One profile with n bins
+        GaisserHillasParameter Fit(const double* depth, const double* values, size_t n) const;
+        GaisserHillasParameter Fit(const std::vector<double>& depth, const std::vector<double>& values) const;
+        /// A column of a profile (dE/dX goes with the energy deposit depths)
+        GaisserHillasParameter Fit(const LongProfile& profile, ProfileTable::Column c = ProfileTable::eCharge) const;
+
+        /// A column of many profiles, nThreads == 0 means one per hardware thread.
+        std::vector<GaisserHillasParameter> Fit(const std::vector<LongProfile>& profiles,
+                                                ProfileTable::Column c = ProfileTable::eCharge,
+                                                size_t nThreads = 1) const;
+        /// A column of every profile in a cache
+        std::vector<GaisserHillasParameter> Fit(const LongCache& cache,
+                                                ProfileTable::Column c = ProfileTable::eCharge,
+                                                size_t nThreads = 1) const;
+
+    private:
+        GaisserHillasParameter FitColumn(const double* depth, const double* values, size_t n, bool isEnergyDeposit) const;
+
+        Form fForm;
+        Errors fErrors;
+        double fMinDepth;
+        double fMaxDepth;
+        double fMinFraction;
+        size_t fMaxIterations;
+    };
+}
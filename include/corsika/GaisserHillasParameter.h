@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <vector>
 
 namespace corsika
 {
@@ -66,8 +67,22 @@ namespace corsika
         { fC = c; fCError = error; }
         
         double Eval(const double depth) const;
+        /**
+         The function at n depths. Same as Eval(depth) for each of them
+         (up to rounding), and zero where lambda is not positive or the
+         function is below 1e-300 NMax. The loop vectorizes.
+         */
+        void Eval(const double* depths, double* out, size_t n) const;
+        /**
+         Many showers at the same depths: out[i*n + j] is shower i at
+         depths[j]. nThreads == 0 means one per hardware thread.
+         */
+        static void Eval(const std::vector<GaisserHillasParameter>& showers,
+                         const double* depths, size_t n, double* out, size_t nThreads = 1);
         void Dump(std::ostream& os = std::cout) const;
+        /// Integral over depth from X0: closed form if b = c = 0, numerical otherwise
         double GetIntegral() const;
+        /// Propagated from the parameter errors and the NMax-XMax correlation
         double GetIntegralError() const;
         
     private:
@@ -0,0 +1,156 @@
+/**
+ \file
+ Fixed-bin histograms of particle fields
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ParticleBatch.h>
+#include <corsika/ParticleSelection.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    struct ShowerParticleStream;
+
+    /**
+     \class HistogramAxis Histogram.h "corsika/Histogram.h"
+
+     \brief Binning of one ParticleBatch column.
+
+     Bins can be uniform in the value (eLinear), uniform in log10 of
+     the value (eLog), given by explicit edges (eEdges) or one bin per
+     listed value (eCategories, meant for pdg or corsika_code).
+     Values outside the axis range do not belong to any bin.
+     */
+    struct HistogramAxis
+    {
+        enum Scale
+        {
+            eLinear,
+            eLog,
+            eEdges,
+            eCategories
+        };
+
+        HistogramAxis();
+        /// nBins uniform bins between min and max. For eLog, min and max must be positive.
+        HistogramAxis(ParticleBatch::Column column, size_t nBins, double min, double max, Scale scale = eLinear);
+        /// Either the bin edges (eEdges, increasing) or the accepted values (eCategories)
+        HistogramAxis(ParticleBatch::Column column, const std::vector<double>& values, Scale scale = eEdges);
+
+        ParticleBatch::Column GetColumn() const { return fColumn; }
+        Scale GetScale() const { return fScale; }
+        size_t GetNBins() const { return fNBins; }
+        /// Bin edges (nBins + 1 values). For eCategories these are the category values.
+        const std::vector<double>& GetEdges() const { return fEdges; }
+
+        /// Bin for a value, or -1 if it is outside the axis.
+        int FindBin(double value) const;
+        /// bins[i] = FindBin(values[i]) for i in [0, n)
+        void FindBins(const double* values, size_t n, int* bins) const;
+
+        bool operator==(const HistogramAxis& other) const;
+        bool operator!=(const HistogramAxis& other) const { return !(*this == other); }
+
+    private:
+        ParticleBatch::Column fColumn;
+        Scale fScale;
+        size_t fNBins;
+        double fMin;
+        double fMax;
+        double fScaleFactor; // bins per unit of (log of) the value, for uniform bins
+        std::vector<double> fEdges;
+    };
+
+    /**
+     \class Histogram Histogram.h "corsika/Histogram.h"
+
+     \brief Weighted 1D, 2D or 3D histogram filled from particle batches.
+
+     Each particle adds its weight (the thinning weight, one in
+     unthinned files) to one bin, unless SetUseWeights(false) is
+     called. An optional ParticleSelection restricts the particles
+     that are counted. Contents are stored in row-major order: the
+     bin (i, j, k) is at (i*ny + j)*nz + k, like a C/numpy array of
+     shape (nx, ny, nz).
+
+     Filling in parallel uses one accumulator per thread. The calling
+     thread decodes batches while the others fill them (see
+     ParallelPipeline). Batches are assigned to threads in a fixed
+     order and the accumulators are added in thread order, so a given
+     number of threads always gives the same result.
+     \code
+     Histogram h(HistogramAxis(ParticleBatch::eX, 100, -6*km, 6*km),
+                 HistogramAxis(ParticleBatch::eY, 100, -6*km, 6*km));
+     h.SetSelection(ParticleSelection("pdg in (13, -13)"));
+     h.Fill(shower.ParticleStream(), 4);
+     \endcode
+     */
+    struct Histogram
+    {
+        Histogram(const HistogramAxis& x);
+        Histogram(const HistogramAxis& x, const HistogramAxis& y);
+        Histogram(const HistogramAxis& x, const HistogramAxis& y, const HistogramAxis& z);
+
+        size_t GetNDimensions() const { return fAxes.size(); }
+        const HistogramAxis& GetAxis(size_t i) const { return fAxes.at(i); }
+
+        void SetSelection(const ParticleSelection& selection);
+        void ClearSelection() { fSelection.reset(); }
+        bool HasSelection() const { return bool(fSelection); }
+        const ParticleSelection& GetSelection() const { return *fSelection; }
+
+        void SetUseWeights(bool use) { fUseWeights = use; }
+        bool GetUseWeights() const { return fUseWeights; }
+
+        /// Fill with all (selected) particles in a batch.
+        void Fill(const ParticleBatch& batch);
+
+        /// Fill with the remaining particles in a stream, nThreads == 0 means one per hardware thread.
+        void Fill(ShowerParticleStream& stream, size_t nThreads = 1);
+
+        /**
+         Fill with the particles of all showers in a file. The file is
+         scanned once, then each thread reads its own copy of it
+         (ShowerFile::OpenCopy) and takes every nThreads-th shower. This
+         pays off for uncompressed files with many showers. A shower
+         that cannot be read is an IOException.
+         */
+        void FillFile(const std::string& filename, size_t nThreads = 0);
+
+        /// Add the contents of another histogram with the same binning. Throws std::invalid_argument otherwise.
+        void Add(const Histogram& other);
+        Histogram& operator+=(const Histogram& other) { Add(other); return *this; }
+
+        /// Set all bins to zero (binning and selection are kept).
+        void Reset();
+
+        const std::vector<double>& GetContents() const { return fContents; }
+        /// Sum of squared weights in each bin, for the statistical uncertainty.
+        const std::vector<double>& GetSumW2() const { return fSumW2; }
+        double GetBinContent(size_t i, size_t j = 0, size_t k = 0) const;
+
+        /// Number of particles that went into a bin
+        size_t GetEntries() const { return fEntries; }
+        /// Sum of the weights of the selected particles that did not go into any bin
+        double GetOutside() const { return fOutside; }
+
+    private:
+        void Init();
+
+        std::vector<HistogramAxis> fAxes;
+        std::vector<size_t> fStrides;
+        boost::shared_ptr<const ParticleSelection> fSelection;
+        bool fUseWeights;
+
+        std::vector<double> fContents;
+        std::vector<double> fSumW2;
+        size_t fEntries;
+        double fOutside;
+    };
+}
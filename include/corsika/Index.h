@@ -15,6 +15,8 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <unordered_map>
 
 
 namespace corsika
@@ -26,6 +28,228 @@ namespace corsika
         bool less_equal(double i, double j);
         bool greater(double i, double j);
         bool greater_equal(double i, double j);
+        
+        /// A grid cell touched by a pointee, and whether the pointee covers all of it.
+        struct CellCoverage
+        {
+            unsigned int i, j;
+            bool full;
+        };
+        
+        /// Closed bounds of bin k of an axis with the given edges (infinite for the over-/under-flow bins).
+        inline void cell_bounds(const std::vector<double>& edges, size_t k, double& low, double& high)
+        {
+            low = (k == 0 ? -HUGE_VAL : edges[k-1]);
+            high = (k == edges.size() ? HUGE_VAL : edges[k]);
+        }
+        
+        /**
+         Cells of the grid overlapping a shape within a bounding box. The
+         shape provides Intersects(x0, x1, y0, y1) and Covers(x0, x1, y0, y1)
+         for closed boxes. Cells that only touch the shape along an edge can
+         be included, so the result is a superset of the cells with points inside.
+         */
+        template <class Shape>
+        std::vector<CellCoverage> cover(const std::vector<double>& x, const std::vector<double>& y,
+                                        double xmin, double xmax, double ymin, double ymax, const Shape& shape)
+        {
+            const size_t i_min = digitize(x, xmin);
+            const size_t i_max = digitize(x, xmax);
+            const size_t j_min = digitize(y, ymin);
+            const size_t j_max = digitize(y, ymax);
+            std::vector<CellCoverage> cells;
+            for (size_t i = i_min; i <= i_max; ++i) {
+                double x0, x1;
+                cell_bounds(x, i, x0, x1);
+                for (size_t j = j_min; j <= j_max; ++j) {
+                    double y0, y1;
+                    cell_bounds(y, j, y0, y1);
+                    if (!shape.Intersects(x0, x1, y0, y1))
+                        continue;
+                    CellCoverage c = { (unsigned int)i, (unsigned int)j, shape.Covers(x0, x1, y0, y1) };
+                    cells.push_back(c);
+                }
+            }
+            return cells;
+        }
+        
+        inline std::vector<std::pair<unsigned int,unsigned int> > to_bins(const std::vector<CellCoverage>& cells)
+        {
+            std::vector<std::pair<unsigned int,unsigned int> > bins(cells.size());
+            for (size_t k = 0; k != cells.size(); ++k) {
+                bins[k] = std::make_pair(cells[k].i, cells[k].j);
+            }
+            return bins;
+        }
+        
+        struct Circle
+        {
+            double x, y, r;
+            bool Contains(double px, double py) const
+            { return (px-x)*(px-x) + (py-y)*(py-y) <= r*r; }
+            bool Intersects(double x0, double x1, double y0, double y1) const
+            {
+                const double dx = std::max(std::max(x0 - x, x - x1), 0.);
+                const double dy = std::max(std::max(y0 - y, y - y1), 0.);
+                return dx*dx + dy*dy <= r*r;
+            }
+            bool Covers(double x0, double x1, double y0, double y1) const
+            {
+                const double dx = std::max(std::fabs(x0 - x), std::fabs(x1 - x));
+                const double dy = std::max(std::fabs(y0 - y), std::fabs(y1 - y));
+                return dx*dx + dy*dy <= r*r;
+            }
+        };
+        
+        /// Convex polygon. The vertices can be in either orientation.
+        struct ConvexPolygon
+        {
+            ConvexPolygon(const std::vector<std::pair<double,double> >& vertices):
+            v(vertices), xmin(HUGE_VAL), xmax(-HUGE_VAL), ymin(HUGE_VAL), ymax(-HUGE_VAL)
+            {
+                double area = 0;
+                for (size_t k = 0; k != v.size(); ++k) {
+                    const std::pair<double,double>& a = v[k];
+                    const std::pair<double,double>& b = v[(k+1)%v.size()];
+                    area += a.first*b.second - b.first*a.second;
+                    xmin = std::min(xmin, a.first);
+                    xmax = std::max(xmax, a.first);
+                    ymin = std::min(ymin, a.second);
+                    ymax = std::max(ymax, a.second);
+                }
+                if (area < 0)
+                    std::reverse(v.begin(), v.end()); // counter-clockwise from now on
+            }
+            bool Contains(double px, double py) const
+            {
+                for (size_t k = 0; k != v.size(); ++k) {
+                    if (Side(k, px, py) < 0)
+                        return false;
+                }
+                return !v.empty();
+            }
+            bool Intersects(double x0, double x1, double y0, double y1) const
+            {
+                // separating axes: the box axes first, then the polygon edges
+                x0 = std::max(x0, xmin);
+                x1 = std::min(x1, xmax);
+                y0 = std::max(y0, ymin);
+                y1 = std::min(y1, ymax);
+                if (x0 > x1 || y0 > y1)
+                    return false;
+                for (size_t k = 0; k != v.size(); ++k) {
+                    if (Side(k, x0, y0) < 0 && Side(k, x1, y0) < 0 && Side(k, x0, y1) < 0 && Side(k, x1, y1) < 0)
+                        return false;
+                }
+                return true;
+            }
+            bool Covers(double x0, double x1, double y0, double y1) const
+            { return Contains(x0, y0) && Contains(x1, y0) && Contains(x0, y1) && Contains(x1, y1); }
+            
+            // positive if (px, py) is on the inner side of edge k
+            double Side(size_t k, double px, double py) const
+            {
+                const std::pair<double,double>& a = v[k];
+                const std::pair<double,double>& b = v[(k+1)%v.size()];
+                return (b.first - a.first)*(py - a.second) - (b.second - a.second)*(px - a.first);
+            }
+            
+            std::vector<std::pair<double,double> > v;
+            double xmin, xmax, ymin, ymax;
+        };
+        
+        /// Rectangle with sides 2*hx and 2*hy rotated by an angle (cosine c, sine s) around its center (x, y).
+        struct RotatedRectangle
+        {
+            double x, y, c, s, hx, hy;
+            bool Contains(double px, double py) const
+            {
+                // rotate the point into the frame of the rectangle
+                const double u = (px - x)*c + (py - y)*s;
+                const double v = -(px - x)*s + (py - y)*c;
+                return std::fabs(u) <= hx && std::fabs(v) <= hy;
+            }
+            ConvexPolygon Polygon() const
+            {
+                const double u[4] = { -hx, hx, hx, -hx };
+                const double v[4] = { -hy, -hy, hy, hy };
+                std::vector<std::pair<double,double> > corners(4);
+                for (int k = 0; k != 4; ++k) {
+                    corners[k] = std::make_pair(x + u[k]*c - v[k]*s, y + u[k]*s + v[k]*c);
+                }
+                return ConvexPolygon(corners);
+            }
+        };
+        
+        inline RotatedRectangle rotated_rectangle(double x, double y, double dx, double dy, double angle)
+        {
+            RotatedRectangle r = { x, y, std::cos(angle), std::sin(angle), dx/2, dy/2 };
+            return r;
+        }
+        
+        /// True if Policy has a Coverage member, used by FlatPositionIndex to keep the full/partial flag
+        template <class Policy>
+        struct has_coverage
+        {
+            template <class P> static char test(decltype(&P::Coverage));
+            template <class P> static long test(...);
+            static const bool value = sizeof(test<Policy>(0)) == 1;
+        };
+        
+        template <class Policy, class Pointee, bool = has_coverage<Policy>::value>
+        struct coverage_of
+        {
+            static std::vector<CellCoverage> get(const Policy& policy, const std::vector<double>& x, const std::vector<double>& y, const Pointee& p)
+            { return policy.Coverage(x, y, p); }
+        };
+        
+        /// Policies without Coverage: all cells are partially covered
+        template <class Policy, class Pointee>
+        struct coverage_of<Policy, Pointee, false>
+        {
+            static std::vector<CellCoverage> get(const Policy& policy, const std::vector<double>& x, const std::vector<double>& y, const Pointee& p)
+            {
+                std::vector<std::pair<unsigned int,unsigned int> > bins = policy(x, y, p);
+                std::vector<CellCoverage> cells(bins.size());
+                for (size_t k = 0; k != bins.size(); ++k) {
+                    CellCoverage c = { bins[k].first, bins[k].second, false };
+                    cells[k] = c;
+                }
+                return cells;
+            }
+        };
+        
+        /// True if Policy has a Prepare member, used by FlatPositionIndex to cache the shapes of the pointees
+        template <class Policy>
+        struct has_prepare
+        {
+            template <class P> static char test(decltype(&P::Prepare));
+            template <class P> static long test(...);
+            static const bool value = sizeof(test<Policy>(0)) == 1;
+        };
+        
+        /// The prepared shape of each pointee, so the exact test does not redo the geometry for every point
+        template <class Policy, class Pointee, bool = has_prepare<Policy>::value>
+        struct prepared_shapes
+        {
+            void Add(const Policy& policy, const Pointee& p)
+            { fShapes.push_back(policy.Prepare(p)); }
+            bool Contains(const Policy&, const Pointee&, unsigned int id, double x, double y) const
+            { return fShapes[id].Contains(x, y); }
+            void Clear()
+            { fShapes.clear(); }
+            std::vector<typename Policy::shape_type> fShapes;
+        };
+        
+        /// Policies without Prepare: the policy's Contains is called on the pointee
+        template <class Policy, class Pointee>
+        struct prepared_shapes<Policy, Pointee, false>
+        {
+            void Add(const Policy&, const Pointee&) {}
+            bool Contains(const Policy& policy, const Pointee& p, unsigned int, double x, double y) const
+            { return policy.Contains(p, x, y); }
+            void Clear() {}
+        };
     }
     
     /**
@@ -54,6 +278,28 @@ namespace corsika
             }
             return bins;
         }
+        
+        /// The cells of operator(), flagged if the square covers them completely.
+        std::vector<detail::CellCoverage> Coverage(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        {
+            std::vector<std::pair<unsigned int,unsigned int> > bins = (*this)(x, y, p);
+            std::vector<detail::CellCoverage> cells(bins.size());
+            for (size_t k = 0; k != bins.size(); ++k) {
+                double x0, x1, y0, y1;
+                detail::cell_bounds(x, bins[k].first, x0, x1);
+                detail::cell_bounds(y, bins[k].second, y0, y1);
+                cells[k].i = bins[k].first;
+                cells[k].j = bins[k].second;
+                cells[k].full = (x0 >= p.x() - p.dx()/2 && x1 <= p.x() + p.dx()/2 &&
+                                 y0 >= p.y() - p.dy()/2 && y1 <= p.y() + p.dy()/2);
+            }
+            return cells;
+        }
+        
+        /// Exact test: the point is inside the (closed) square.
+        bool Contains(const Pointee& p, double x, double y) const
+        { return std::fabs(x - p.x()) <= p.dx()/2 && std::fabs(y - p.y()) <= p.dy()/2; }
+        
     private:
         size_t GetIndex(const std::vector<double>& arr, double x) const
         {
@@ -63,6 +309,101 @@ namespace corsika
         }
     };
     
+    /**
+     \class CircleCollision
+     
+     \brief Collision policy for circular pointees, like water tanks. Pointee objects must provide x, y and radius member functions.
+     
+     Besides the cells touched by the circle (the call operator), the
+     policy can tell which cells are completely inside it (Coverage) and
+     whether a point is inside (Contains). Prepare returns the shape
+     with its geometry computed, FlatPositionIndex keeps one per pointee
+     for the exact tests.
+     */
+    template<class Pointee> struct CircleCollision
+    {
+        typedef detail::Circle shape_type;
+        
+        std::vector<std::pair<unsigned int,unsigned int> > operator()(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        { return detail::to_bins(Coverage(x, y, p)); }
+        
+        std::vector<detail::CellCoverage> Coverage(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        {
+            const detail::Circle c = Prepare(p);
+            return detail::cover(x, y, c.x - c.r, c.x + c.r, c.y - c.r, c.y + c.r, c);
+        }
+        
+        bool Contains(const Pointee& p, double x, double y) const
+        { return Prepare(p).Contains(x, y); }
+        
+        static shape_type Prepare(const Pointee& p)
+        {
+            detail::Circle c = { p.x(), p.y(), p.radius() };
+            return c;
+        }
+    };
+    
+    /**
+     \class ConvexPolygonCollision
+     
+     \brief Collision policy for convex polygons. Pointee objects must provide a vertices member function returning a std::vector<std::pair<double,double> >.
+     
+     The vertices can be given clockwise or counter-clockwise. See CircleCollision for the members.
+     */
+    template<class Pointee> struct ConvexPolygonCollision
+    {
+        typedef detail::ConvexPolygon shape_type;
+        
+        std::vector<std::pair<unsigned int,unsigned int> > operator()(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        { return detail::to_bins(Coverage(x, y, p)); }
+        
+        std::vector<detail::CellCoverage> Coverage(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        {
+            const detail::ConvexPolygon polygon = Prepare(p);
+            return detail::cover(x, y, polygon.xmin, polygon.xmax, polygon.ymin, polygon.ymax, polygon);
+        }
+        
+        /// Builds the polygon on every call, FlatPositionIndex::Contains uses the cached one.
+        bool Contains(const Pointee& p, double x, double y) const
+        { return Prepare(p).Contains(x, y); }
+        
+        static shape_type Prepare(const Pointee& p)
+        { return detail::ConvexPolygon(p.vertices()); }
+    };
+    
+    /**
+     \class RotatedSquareCollision
+     
+     \brief Collision policy for rectangles that are not aligned with the grid axes.
+     
+     This is the case for detector stations laid out in the array frame
+     when the index is in a frame rotated with respect to it (for
+     instance, when the array rotation of the CORSIKA file differs from
+     the one of the detector layout). Pointee objects must provide x, y,
+     dx, dy and angle member functions, where angle is the rotation of
+     the rectangle sides dx and dy with respect to the grid x and y axes.
+     See CircleCollision for the members.
+     */
+    template<class Pointee> struct RotatedSquareCollision
+    {
+        typedef detail::RotatedRectangle shape_type;
+        
+        std::vector<std::pair<unsigned int,unsigned int> > operator()(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        { return detail::to_bins(Coverage(x, y, p)); }
+        
+        std::vector<detail::CellCoverage> Coverage(const std::vector<double>& x, const std::vector<double>& y, const Pointee& p) const
+        {
+            const detail::ConvexPolygon polygon = Prepare(p).Polygon();
+            return detail::cover(x, y, polygon.xmin, polygon.xmax, polygon.ymin, polygon.ymax, polygon);
+        }
+        
+        bool Contains(const Pointee& p, double x, double y) const
+        { return Prepare(p).Contains(x, y); }
+        
+        static shape_type Prepare(const Pointee& p)
+        { return detail::rotated_rectangle(p.x(), p.y(), p.dx(), p.dy(), p.angle()); }
+    };
+    
     /**
      \class PositionIndex Index.h "Index.h"
      
@@ -219,4 +560,317 @@ namespace corsika
         std::vector<boost::shared_ptr<Pointee> > fAll;
     };
     
+
+    /**
+     \class FlatPositionIndex Index.h "Index.h"
+     
+     \brief Compact version of PositionIndex for large numbers of particles and pointees.
+     
+     The grid, the over-/under-flow bins and the collision policy are the
+     same as in PositionIndex, and a position falls in the same bin in
+     both. The differences are in how things are stored and looked up:
+     - pointees are numbered in the order they are added, and the
+       numbers in each cell are stored in one contiguous array (CSR),
+     - the bin is computed arithmetically from the uniform spacing and
+       then checked against the bin edges, instead of a binary search,
+     - duplicate pointers are detected with a hash map,
+     - Query looks up whole arrays of positions at once.
+     
+     If the collision policy provides Coverage and Contains (like
+     CircleCollision), each pointee in a cell is flagged when it covers
+     the whole cell. QueryContained then returns only the pairs where
+     the position is really inside the pointee, and the exact test is
+     skipped for the flagged cells.
+     
+     Adding pointees only records them. Build() must be called after the
+     last Add and before any lookup (lookups on a stale index throw
+     std::logic_error). After Build(), lookups do not modify the index
+     and can be done from several threads.
+     */
+    template<class Pointee, class CollisionPolicy=SquareCollision<Pointee> >
+    struct FlatPositionIndex
+    {
+        typedef Pointee value_type;
+        typedef boost::shared_ptr<Pointee> pointer_type;
+        typedef std::vector<boost::shared_ptr<Pointee> > pointer_list_type;
+        
+        /// Pointee numbers in one cell
+        struct Range
+        {
+            Range(const unsigned int* b = 0, const unsigned int* e = 0, const char* f = 0): fBegin(b), fEnd(e), fFull(f) {}
+            const unsigned int* begin() const { return fBegin; }
+            const unsigned int* end() const { return fEnd; }
+            size_t size() const { return fEnd - fBegin; }
+            bool empty() const { return fBegin == fEnd; }
+            unsigned int operator[](size_t i) const { return fBegin[i]; }
+            /// True if pointee i covers the whole cell
+            bool full(size_t i) const { return fFull[i]; }
+            const unsigned int* fBegin;
+            const unsigned int* fEnd;
+            const char* fFull;
+        };
+        
+        /// Same as the PositionIndex constructor: a square grid centered at zero.
+        FlatPositionIndex(double x=50*km, double dx = 100*m):
+        fBuilt(true)
+        {
+            const unsigned int s(std::floor(x/dx)+2); // includes over/under-flow
+            for (unsigned int i = 0; i != 2; ++i) {
+                fSize[i] = x;
+                fBins[i] = s - 2;
+                fSpacing[i] = fSize[i]/fBins[i];
+                fBinEdges[i].resize(s-1);
+                for (unsigned int j=0; j!=s-1; ++j) {
+                    fBinEdges[i][j] = j*fSpacing[i] - fSize[i]/2;
+                }
+            }
+            Init();
+        }
+        
+        /// Same as the PositionIndex constructor: (min, max, n_bins) for each axis.
+        FlatPositionIndex(double xmin, double xmax, unsigned int xbins, double ymin, double ymax, unsigned int ybins):
+        fBuilt(true)
+        {
+            const double min[2] = {xmin, ymin};
+            const double max[2] = {xmax, ymax};
+            const unsigned int shape[2] = {xbins, ybins};
+            for (unsigned int i = 0; i != 2; ++i) {
+                fSize[i] = max[i] - min[i];
+                fBins[i] = shape[i];
+                fSpacing[i] = fSize[i]/shape[i];
+                fBinEdges[i].resize(shape[i]+1);
+                for (unsigned int j=0; j!=fBinEdges[i].size(); ++j) {
+                    fBinEdges[i][j] = min[i] + j*fSpacing[i];
+                }
+            }
+            Init();
+        }
+        
+        double GetSize(size_t i) const
+        { return fSize[i]; }
+        double GetSpacing(size_t i) const
+        { return fSpacing[i]; }
+        int GetBins(size_t i) const
+        { return fBins[i]; }
+        /// Number of cells, including over-/under-flow
+        size_t GetNCells() const
+        { return fOffsets.size() - 1; }
+        
+        /// Add a pointee (ignored if this pointer was already added). Returns its number.
+        unsigned int Add(boost::shared_ptr<Pointee> p)
+        {
+            const unsigned int id = fAll.size();
+            std::pair<typename std::unordered_map<const Pointee*, unsigned int>::iterator, bool> seen =
+                fIds.insert(std::make_pair(p.get(), id));
+            if (!seen.second) {
+                return seen.first->second;
+            }
+            std::vector<detail::CellCoverage> cells =
+                detail::coverage_of<CollisionPolicy, Pointee>::get(fCollisionPolicy, fBinEdges[0], fBinEdges[1], *p);
+            fAll.push_back(p);
+            fShapes.Add(fCollisionPolicy, *p);
+            for (size_t k = 0; k != cells.size(); ++k) {
+                fPending.push_back(std::make_pair(std::make_pair(Cell(cells[k].i, cells[k].j), id), char(cells[k].full)));
+            }
+            fBuilt = false;
+            return id;
+        }
+        
+        unsigned int Add(const Pointee& v)
+        {
+            return Add(boost::shared_ptr<Pointee>(new Pointee(v)));
+        }
+        void Add(const std::vector<boost::shared_ptr<Pointee> >& v)
+        {
+            for (size_t i = 0; i != v.size(); ++i) {
+                Add(v[i]);
+            }
+        }
+        
+        /// Build the cell lists. Must be called after adding pointees and before any lookup.
+        void Build()
+        {
+            if (fBuilt)
+                return;
+            // sort the (cell, id) pairs and count the pointees in each cell
+            std::sort(fPending.begin(), fPending.end());
+            fPending.erase(std::unique(fPending.begin(), fPending.end(), SameCell), fPending.end());
+            std::fill(fOffsets.begin(), fOffsets.end(), 0);
+            for (size_t k = 0; k != fPending.size(); ++k) {
+                ++fOffsets[fPending[k].first.first + 1];
+            }
+            for (size_t c = 1; c != fOffsets.size(); ++c) {
+                fOffsets[c] += fOffsets[c-1];
+            }
+            fIndices.resize(fPending.size());
+            fFull.resize(fPending.size());
+            for (size_t k = 0; k != fPending.size(); ++k) {
+                fIndices[k] = fPending[k].first.second;
+                fFull[k] = fPending[k].second;
+            }
+            fBuilt = true;
+        }
+        
+        bool IsBuilt() const
+        { return fBuilt; }
+        
+        /// Cell (flat bin number) of a position
+        size_t GetCell(double x, double y) const
+        { return Cell(GetIndex(0, x), GetIndex(1, y)); }
+        
+        /// Pointee numbers in a cell
+        Range GetRange(size_t cell) const
+        {
+            CheckBuilt();
+            return Range(fIndices.data() + fOffsets[cell], fIndices.data() + fOffsets[cell+1], fFull.data() + fOffsets[cell]);
+        }
+        
+        /// Pointee numbers at a position
+        Range Get(double x, double y) const
+        { return GetRange(GetCell(x, y)); }
+        
+        bool IsEmpty(double x, double y) const
+        { return Get(x, y).empty(); }
+        
+        const boost::shared_ptr<Pointee>& GetPointee(unsigned int id) const
+        { return fAll[id]; }
+        
+        const std::vector<boost::shared_ptr<Pointee> >& GetAll() const
+        { return fAll; }
+        
+        /// cells[i] = GetCell(xs[i], ys[i]) for i in [0, n)
+        template <class T>
+        void Query(const T* xs, const T* ys, size_t n, unsigned int* cells) const
+        {
+            CheckBuilt();
+            const size_t ny = fBins[1] + 2;
+            for (size_t i = 0; i != n; ++i) {
+                cells[i] = GetIndex(0, xs[i])*ny + GetIndex(1, ys[i]);
+            }
+        }
+        
+        /**
+         All (particle, pointee) pairs for n positions: particle i and
+         pointee pointees[k] share a cell if particles[k] == i. The
+         pairs are in particle order. Returns the number of pairs.
+         */
+        template <class T>
+        size_t Query(const T* xs, const T* ys, size_t n,
+                     std::vector<unsigned int>& particles, std::vector<unsigned int>& pointees) const
+        {
+            std::vector<unsigned int> cells(n);
+            Query(xs, ys, n, cells.data());
+            particles.clear();
+            pointees.clear();
+            for (size_t i = 0; i != n; ++i) {
+                const unsigned int* b = fIndices.data() + fOffsets[cells[i]];
+                const unsigned int* e = fIndices.data() + fOffsets[cells[i]+1];
+                for (; b != e; ++b) {
+                    particles.push_back(i);
+                    pointees.push_back(*b);
+                }
+            }
+            return particles.size();
+        }
+        
+        /**
+         Exact test: position (x, y) is inside pointee id (needs a policy
+         with Contains). If the policy has Prepare, the shape prepared
+         when the pointee was added is used.
+         */
+        bool Contains(unsigned int id, double x, double y) const
+        { return fShapes.Contains(fCollisionPolicy, *fAll[id], id, x, y); }
+        
+        /**
+         Same as Query, but only the pairs where the position is inside
+         the pointee according to the policy's Contains. The exact test
+         is not done when the pointee covers the whole cell.
+         */
+        template <class T>
+        size_t QueryContained(const T* xs, const T* ys, size_t n,
+                              std::vector<unsigned int>& particles, std::vector<unsigned int>& pointees) const
+        {
+            std::vector<unsigned int> cells(n);
+            Query(xs, ys, n, cells.data());
+            particles.clear();
+            pointees.clear();
+            for (size_t i = 0; i != n; ++i) {
+                for (size_t k = fOffsets[cells[i]]; k != fOffsets[cells[i]+1]; ++k) {
+                    if (fFull[k] || Contains(fIndices[k], xs[i], ys[i])) {
+                        particles.push_back(i);
+                        pointees.push_back(fIndices[k]);
+                    }
+                }
+            }
+            return particles.size();
+        }
+        
+        void Clear()
+        {
+            fAll.clear();
+            fShapes.Clear();
+            fIds.clear();
+            fPending.clear();
+            fIndices.clear();
+            fFull.clear();
+            std::fill(fOffsets.begin(), fOffsets.end(), 0);
+            fBuilt = true;
+        }
+        
+    private:
+        void Init()
+        {
+            fOffsets.assign((fBins[0] + 2)*(fBins[1] + 2) + 1, 0);
+        }
+        
+        size_t Cell(size_t i, size_t j) const
+        { return i*(fBins[1] + 2) + j; }
+        
+        typedef std::pair<std::pair<size_t, unsigned int>, char> PendingCell; // ((cell, pointee), full)
+        
+        static bool SameCell(const PendingCell& a, const PendingCell& b)
+        { return a.first == b.first; }
+        
+        void CheckBuilt() const
+        {
+            if (!fBuilt)
+                throw std::logic_error("FlatPositionIndex: Build() must be called after adding pointees");
+        }
+        
+        /// Same as detail::digitize(fBinEdges[a], x), the number of edges <= x
+        size_t GetIndex(size_t a, double x) const
+        {
+            const std::vector<double>& edges = fBinEdges[a];
+            const size_t last = fBins[a] + 1;
+            if (!(x >= edges[0]))
+                return (x < edges[0]) ? 0 : last; // NaN goes to overflow, like digitize
+            if (x >= edges[last-1])
+                return last;
+            size_t k = size_t((x - edges[0])/fSpacing[a]) + 1;
+            // rounding can put us one bin off near an edge
+            if (k > last - 1)
+                k = last - 1;
+            if (edges[k-1] > x)
+                --k;
+            else if (edges[k] <= x)
+                ++k;
+            return k;
+        }
+        
+        CollisionPolicy fCollisionPolicy;
+        double fSize[2];
+        double fSpacing[2];
+        unsigned int fBins[2];
+        std::vector<double> fBinEdges[2];
+        
+        std::vector<boost::shared_ptr<Pointee> > fAll;
+        detail::prepared_shapes<CollisionPolicy, Pointee> fShapes;  // one per pointee, next to fAll
+        std::unordered_map<const Pointee*, unsigned int> fIds;
+        std::vector<PendingCell> fPending;  // all added pointees, until Build()
+        std::vector<size_t> fOffsets;       // fOffsets[c] is the start of cell c in fIndices
+        std::vector<unsigned int> fIndices;
+        std::vector<char> fFull;            // fFull[k] is true if pointee fIndices[k] covers the whole cell
+        bool fBuilt;
+    };
+    
 }
@@ -0,0 +1,119 @@
+/**
+ \file
+ Counters and timers of the hot paths of the reader
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace corsika
+{
+    /**
+     \class Instrumentation Instrumentation.h "corsika/Instrumentation.h"
+
+     \brief What the reader did (bytes, seeks, blocks, particles) and where the time went.
+
+     The file streams, RawStream, FileIndex::Scan, the particle streams
+     and LongFile count what they do. Each thread adds to its own
+     counters, without locks or contention, and Get adds up the
+     counters of all threads (also the ones that finished). Counts are
+     made per read, per block or per batch of particles, never per
+     particle, and timers only time reads, seeks, scans and profile
+     parsing, so the cost is lost in the work itself.
+
+     Reset only moves the zero: the counters of the threads are never
+     written by another thread.
+
+     Configuring with -DCORSIKA_INSTRUMENTATION=OFF defines
+     CORSIKA_NO_INSTRUMENTATION and compiles the counting out of the
+     library. The functions below are still there, IsEnabled is false
+     and everything reads zero.
+
+     \ingroup corsika
+     */
+    struct Instrumentation
+    {
+        enum Counter
+        {
+            eBytesRead,             // bytes returned by the file streams (uncompressed)
+            eBytesDecompressed,     // the part of them that came from .gz and .bz2 files
+            eReads,                 // calls to FileStream::read
+            eSeeks,                 // calls to FileStream::seek, and reopenings of streams that can not seek
+            eDiskBlocks,            // disk blocks read by RawStream
+            eScannedBlocks,         // blocks read by FileIndex::Scan
+            eParticleBlocks,        // particle blocks decoded by RawParticleStream
+            eSkippedBlocks,         // particle blocks skipped without decoding them
+            eParticleRecords,       // records of the decoded particle blocks (particles and history)
+            eParticlesEmitted,      // particles returned by ShowerParticleStream
+            eParticlesFiltered,     // particles dropped by ShowerParticleStream (level, type or subsampling)
+            eLongProfiles,          // profiles parsed by LongFile
+            eNCounters
+        };
+
+        enum Timer
+        {
+            eReadTime,              // reading uncompressed files
+            eDecompressTime,        // reading and decompressing .gz and .bz2 files
+            eSeekTime,
+            eScanTime,              // FileIndex::Scan (includes its reads)
+            eLongParseTime,         // LongFile profiles
+            eNTimers
+        };
+
+        /// Name of a counter, like "bytes_read"
+        static std::string CounterName(Counter c);
+        /// Name of a timer, like "decompress"
+        static std::string TimerName(Timer t);
+
+        /// Counting was compiled in
+        static bool IsEnabled();
+        /// Total of all threads since the last Reset
+        static uint64_t Get(Counter c);
+        /// Seconds, total of all threads since the last Reset
+        static double Get(Timer t);
+        static void Reset();
+        /// Every counter and timer, one per line
+        static void Dump(std::ostream& os = std::cout);
+
+        /// Add to a counter of the calling thread (use CORSIKA_COUNT)
+        static void Add(Counter c, uint64_t n);
+        /// Add nanoseconds to a timer of the calling thread (use CORSIKA_TIME)
+        static void AddTime(Timer t, uint64_t ns);
+
+        /// Adds the time from construction to destruction to a timer
+        struct ScopedTimer
+        {
+            explicit ScopedTimer(Timer t): fTimer(t), fStart(std::chrono::steady_clock::now()) {}
+            ~ScopedTimer()
+            {
+                AddTime(fTimer, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - fStart).count());
+            }
+
+        private:
+            Timer fTimer;
+            std::chrono::steady_clock::time_point fStart;
+        };
+    };
+}
+
+#define CORSIKA_INSTRUMENTATION_CAT2(a, b) a##b
+#define CORSIKA_INSTRUMENTATION_CAT(a, b) CORSIKA_INSTRUMENTATION_CAT2(a, b)
+
+#ifdef CORSIKA_NO_INSTRUMENTATION
+#define CORSIKA_COUNT(counter, n) ((void)0)
+#define CORSIKA_TIME(timer) ((void)0)
+#else
+/// Add n to Instrumentation::counter
+#define CORSIKA_COUNT(counter, n) \
+    corsika::Instrumentation::Add(corsika::Instrumentation::counter, n)
+/// Time the rest of the scope with Instrumentation::timer
+#define CORSIKA_TIME(timer) \
+    corsika::Instrumentation::ScopedTimer CORSIKA_INSTRUMENTATION_CAT(corsika_timer_, __LINE__)(corsika::Instrumentation::timer)
+#endif
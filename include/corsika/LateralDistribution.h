@@ -0,0 +1,145 @@
+/**
+ \file
+ Lateral distribution and arrival-time profiles of ground particles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/Histogram.h>
+#include <corsika/ParticleSelection.h>
+#include <corsika/QuantileSketch.h>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    struct Shower;
+
+    /**
+     \class LateralDistribution LateralDistribution.h "corsika/LateralDistribution.h"
+
+     \brief Weighted particle density and arrival-time quantiles as a function of core distance.
+
+     Particles are grouped in classes (each one a ParticleSelection,
+     a particle can be in several classes) and in bins of distance to
+     the shower core. For each class and bin we keep the sum of
+     weights, the sum of squared weights and a QuantileSketch of the
+     arrival times, so the memory does not depend on the number of
+     particles.
+
+     The distance is measured either on the ground or in the shower
+     plane (perpendicular to the shower axis). In the shower plane,
+     the arrival time is taken relative to a plane front moving with
+     the primary (see ShowerFrame). The shower direction is taken from
+     Shower::GetZenith and Shower::GetAzimuth. CORSIKA writes particle
+     coordinates in the array frame, rotated by
+     EventHeader::fArrayRotation with respect to magnetic north, so
+     the azimuth in that frame is the difference of the two.
+
+     Densities are weights per unit area of the annulus (on the ground
+     or in the shower plane) and are meant to be fed to an LDF fit
+     together with GetDensityError.
+     \code
+     LateralDistribution ldf(HistogramAxis(ParticleBatch::eR, 30, 10*m, 3*km, HistogramAxis::eLog));
+     ldf.AddDefaultClasses();
+     ldf.Fill(file.GetCurrentShower());
+     double rho_mu = ldf.GetDensity(ldf.FindClass("muon"), 12);
+     \endcode
+     */
+    struct LateralDistribution
+    {
+        enum Plane
+        {
+            eGround,
+            eShowerPlane
+        };
+
+        /**
+         The radius axis is any uniform, logarithmic or explicit-edge
+         HistogramAxis (its column is ignored). timeAccuracy is the
+         relative accuracy of the time quantiles.
+         */
+        LateralDistribution(const HistogramAxis& radius, Plane plane = eShowerPlane, double timeAccuracy = 0.01);
+
+        /// Add a particle class. Returns its index.
+        size_t AddClass(const std::string& name, const ParticleSelection& selection);
+        /// Add the classes "photon", "electron" (e+ and e-), "muon" (mu+ and mu-) and "hadron" (everything else).
+        void AddDefaultClasses();
+
+        size_t GetNClasses() const { return fClasses.size(); }
+        const std::string& GetClassName(size_t c) const { return fClasses.at(c).fName; }
+        /// Index of a class by name, or GetNClasses() if there is no such class.
+        size_t FindClass(const std::string& name) const;
+
+        Plane GetPlane() const { return fPlane; }
+        const HistogramAxis& GetRadiusAxis() const { return fRadius; }
+        size_t GetNBins() const { return fRadius.GetNBins(); }
+
+        /// Shower direction, with the azimuth in the frame of the particle coordinates.
+        void SetGeometry(double zenith, double azimuth);
+        /// Geometry from the shower header (zenith, azimuth and array rotation).
+        void SetGeometry(const Shower& shower);
+        double GetZenith() const { return fZenith; }
+        double GetAzimuth() const { return fAzimuth; }
+
+        /// Accumulate the particles in a batch (geometry must be set).
+        void Fill(const ParticleBatch& batch);
+        /// Set the geometry and accumulate all particles of a shower.
+        void Fill(const Shower& shower);
+
+        /**
+         One distribution per shower in a file, in file order, with
+         the same binning and classes as the prototype. Showers are
+         spread over nThreads threads (zero means one per hardware
+         thread), each thread with its own copy of the file sharing
+         one scan (ShowerFile::OpenCopy). A shower that cannot be read
+         is an IOException.
+         */
+        static std::vector<LateralDistribution> FillFile(const LateralDistribution& prototype,
+                                                         const std::string& filename, size_t nThreads = 0);
+
+        /// Add another distribution with the same binning and classes (for stacking showers).
+        void Add(const LateralDistribution& other);
+        void Reset();
+
+        /// Shower number of the last shower filled, zero if filled from batches only.
+        int GetShowerNumber() const { return fShowerNumber; }
+
+        double GetArea(size_t bin) const;
+        double GetWeight(size_t c, size_t bin) const { return fBins.at(c*GetNBins() + bin).fWeight; }
+        double GetSumW2(size_t c, size_t bin) const { return fBins.at(c*GetNBins() + bin).fSumW2; }
+        size_t GetEntries(size_t c, size_t bin) const { return fBins.at(c*GetNBins() + bin).fTimes.GetCount(); }
+        double GetDensity(size_t c, size_t bin) const { return GetWeight(c, bin)/GetArea(bin); }
+        double GetDensityError(size_t c, size_t bin) const;
+        /// Estimate of the q-quantile of the arrival times. NaN if the bin is empty.
+        double GetTimeQuantile(size_t c, size_t bin, double q) const;
+        const QuantileSketch& GetTimes(size_t c, size_t bin) const { return fBins.at(c*GetNBins() + bin).fTimes; }
+
+    private:
+        struct Class
+        {
+            std::string fName;
+            ParticleSelection fSelection;
+        };
+
+        struct Bin
+        {
+            Bin(double accuracy): fWeight(0), fSumW2(0), fTimes(accuracy) {}
+            double fWeight;
+            double fSumW2;
+            QuantileSketch fTimes;
+        };
+
+        HistogramAxis fRadius;
+        Plane fPlane;
+        double fTimeAccuracy;
+        std::vector<Class> fClasses;
+        std::vector<Bin> fBins; // class-major
+
+        double fZenith;
+        double fAzimuth;
+        int fShowerNumber;
+    };
+}
@@ -0,0 +1,95 @@
+/**
+ \file
+ Memory-mapped binary cache of the profiles in a .long file
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ColumnCache.h>
+#include <corsika/LongProfile.h>
+#include <corsika/ProfileTable.h>
+#include <boost/noncopyable.hpp>
+#include <string>
+
+namespace corsika
+{
+    /**
+     \class LongCache LongCache.h "corsika/LongCache.h"
+
+     \brief The profiles of a .long file, memory-mapped from a binary sidecar.
+
+     LongFile parses text every time a profile is requested. The
+     cache is written once with Convert and then mapped: profiles are
+     returned as views of the file (GetColumn), and the Gaisser-Hillas
+     parameters and calorimetric energies of all showers are
+     contiguous arrays (GetScalars), so an Xmax distribution over
+     millions of showers is a single read.
+
+     The reader has the interface of LongFile (size, Dx, GetProfile...).
+     Depths are the ones given by LongFile for the zenith angle passed
+     to Convert. The file has the native byte order. Errors throw
+     IOException.
+
+     \ingroup corsika
+     */
+    struct LongCache: ProfileColumns, boost::noncopyable
+    {
+        /// One value per shower
+        enum Scalar
+        {
+            eXMax,
+            eNMax,
+            eXZero,
+            eA,
+            eB,
+            eC,
+            eChiSquare,
+            eNdof,
+            eCalorimetricEnergy,
+            eNScalars
+        };
+
+        /// Name of a scalar, like "xmax"
+        static std::string ScalarName(Scalar s);
+        /// Scalar for a name, eNScalars if unknown
+        static Scalar ScalarFromName(const std::string& name);
+
+        /// Write all profiles of a .long file into a cache. Returns the number of showers.
+        static size_t Convert(const std::string& longFile, const std::string& cacheFile, double zenith = 0);
+
+        explicit LongCache(const std::string& filename);
+        ~LongCache();
+
+        const std::string& GetFilename() const { return fFilename; }
+
+        // same as LongFile
+        size_t size() const { return fNEvents; }
+        float Dx() const;
+        bool HasParticleProfile() const;
+        bool HasEnergyDeposit() const;
+        bool IsSlantDepth() const;
+        /// Copy of a profile
+        LongProfile GetProfile(size_t event) const;
+
+        /// Zenith angle given to Convert
+        double GetZenith() const;
+        /// Number of depth bins of a column in a shower
+        size_t GetNBins(size_t event, Column c) const;
+        /// A profile column of a shower (no copy)
+        ColumnSpan<double> GetColumn(size_t event, Column c) const;
+        /// A quantity of every shower (no copy)
+        ColumnSpan<double> GetScalars(Scalar s) const;
+        GaisserHillasParameter GetGaisserHillas(size_t event) const;
+
+    private:
+        struct EventEntry;
+        const EventEntry& GetEntry(size_t event) const;
+
+        std::string fFilename;
+        const char* fData;
+        size_t fSize;
+        size_t fNEvents;
+    };
+}
@@ -12,7 +12,6 @@
 #include <memory>
 #include <map>
 #include <vector>
-#include <fstream>
 #include <boost/shared_ptr.hpp>
 #include <corsika/LongProfile.h>
 
@@ -25,6 +24,10 @@ namespace corsika
      
      \brief Read data from .long files generated by CORSIKA
      
+     The file is memory-mapped and parsed in place (no locale, no
+     allocations per line), so profiles can be fetched from many
+     threads and copies of a LongFile share the mapping.
+     
      \author Javier Gonzalez
      \date 14 Jul 2016
      \ingroup corsika
@@ -39,33 +42,57 @@ namespace corsika
         
         void Close()
         {
-            if (fLongDataFile->is_open()) {fLongDataFile->close();}
+            fData.reset();
+            fSize = 0;
         }
         
-        LongProfile GetProfile(size_t event);
+        LongProfile GetProfile(size_t event) const;
+        /// Profile with the depths of another zenith angle than the one of the file
+        LongProfile GetProfile(size_t event, double zenith) const;
+        
+        /**
+         A profile as it is written in the file: depths along the
+         vertical (unless IsSlantDepth), the energy deposit of each
+         bin (not per depth) and the Gaisser-Hillas fit as read. It
+         does not depend on the zenith angle, ToProfile applies it.
+         */
+        struct RawProfile
+        {
+            FloatProfileTable fProfiles;
+            float fGaisserHillas[6];    // nmax, x0, xmax, a, b, c
+            float fChiSquare;           // per degree of freedom, zero without a fit
+            double fCalorimetricEnergy;
+        };
+        RawProfile GetRawProfile(size_t event) const;
+        /// The profile of a shower with a zenith angle, same as GetProfile
+        LongProfile ToProfile(const RawProfile& raw, double zenith) const;
         
         size_t size() const { return event_count; }
-        float Dx() const { return fDx; }
+        float Dx() const { return DxAt(fCosZenith); }
         bool HasParticleProfile() const { return fPartProfiles.size(); }
         bool HasEnergyDeposit() const { return fdEdXProfiles.size(); }
         bool IsSlantDepth() const { return fIsSlantDepthProfile; }
         
     private:
         void Scan();
-        LongProfile FetchProfile(size_t i);
+        RawProfile FetchProfile(size_t i) const;
+        LongProfile ToProfile(const RawProfile& raw, float cosZenith) const;
+        float DxAt(float cosZenith) const
+        { return (fIsSlantDepthProfile ? fVerticalDx : fVerticalDx/cosZenith); }
         
         std::string fFilename;
         
         float fCosZenith;
         bool fIsSlantDepthProfile;
         size_t event_count;
-        float fDx;
+        float fVerticalDx;
         size_t fNBinsParticles;
         size_t fNBinsEnergyDeposit;
         
-        boost::shared_ptr<std::ifstream> fLongDataFile;
-        std::vector<std::streampos> fPartProfiles;
-        std::vector<std::streampos> fdEdXProfiles;
+        boost::shared_ptr<const char> fData;   // the mapped file
+        size_t fSize;
+        std::vector<size_t> fPartProfiles;      // offsets of the line after each section header
+        std::vector<size_t> fdEdXProfiles;
         
     };    
 }
@@ -0,0 +1,66 @@
+/**
+ \file
+ Longitudinal profiles of a .long file, parsed once for all zenith angles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/LongFile.h>
+#include <corsika/LongProfile.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class LongLoader LongLoader.h "corsika/LongLoader.h"
+
+     \brief The profiles of a .long file, with the depths of each shower.
+
+     A LongFile applies the zenith angle it was opened with to every
+     profile, so showers with different zenith angles need a file (and
+     a parse) each. The loader parses each profile once, keeps it as
+     written in the file (LongFile::RawProfile, floats) and applies
+     the zenith angle of the shower that asks for it. The results are
+     the ones of a LongFile opened with that angle, to the last bit.
+
+     Profiles are cached when they are first requested, and can be
+     requested from many threads. ShowerFile keeps one loader per file.
+
+     \ingroup corsika
+     */
+    struct LongLoader: boost::noncopyable
+    {
+        explicit LongLoader(const std::string& filename);
+
+        const std::string& GetFilename() const { return fFilename; }
+
+        size_t size() const { return fFile.size(); }
+        bool HasParticleProfile() const { return fFile.HasParticleProfile(); }
+        bool HasEnergyDeposit() const { return fFile.HasEnergyDeposit(); }
+        bool IsSlantDepth() const { return fFile.IsSlantDepth(); }
+        /// Step of the energy deposit profile for a zenith angle
+        float Dx(double zenith = 0) const;
+
+        /// Profile of a shower with a zenith angle (IOException if there is no such shower)
+        LongProfile GetProfile(size_t event, double zenith = 0) const;
+
+        /// Number of profiles parsed so far
+        size_t GetNCached() const;
+        /// Forget the parsed profiles
+        void ClearCache();
+
+    private:
+        boost::shared_ptr<const LongFile::RawProfile> GetRawProfile(size_t event) const;
+
+        std::string fFilename;
+        LongFile fFile;     // vertical
+        mutable std::mutex fMutex;
+        mutable std::vector<boost::shared_ptr<const LongFile::RawProfile> > fCache;
+    };
+}
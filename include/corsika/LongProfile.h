@@ -8,25 +8,14 @@
  */
 
 #pragma once
-#include <vector>
 #include <corsika/GaisserHillasParameter.h>
+#include <corsika/ProfileTable.h>
 
 namespace corsika
 {
     struct LongProfile
     {
-        std::vector<double> fChargeProfile;
-        std::vector<double> fGammaProfile;
-        std::vector<double> fElectronProfile;
-        std::vector<double> fPositronProfile;
-        std::vector<double> fMuonProfile;
-        std::vector<double> fAntiMuonProfile;
-        std::vector<double> fHadronProfile;
-        std::vector<double> fNucleiProfile;
-        std::vector<double> fCherenkovProfile;
-        std::vector<double> fDepth;
-        std::vector<double> fdEdX;
-        std::vector<double> fDepth_dE;
+        ProfileTable fProfiles;
         
         double fCalorimetricEnergy;
         GaisserHillasParameter fGaisserHillas;
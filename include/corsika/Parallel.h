@@ -0,0 +1,316 @@
+/**
+ \file
+ Minimal helpers to spread independent work over threads
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace corsika
+{
+    /// Number of threads to use when the caller does not say (one per hardware thread).
+    inline size_t DefaultThreadCount()
+    {
+        const size_t n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    /**
+     \brief Call f(i, thread) for i in [0, n) using up to nThreads threads.
+
+     Work is assigned statically: item i always goes to thread
+     i % nThreads. Together with one accumulator per thread, merged in
+     thread order, this gives results that do not depend on timing.
+     nThreads == 0 means DefaultThreadCount(). With one thread
+     everything runs in the calling thread.
+
+     If f throws, the remaining items of that thread are skipped and
+     the first exception (in thread order) is rethrown after all
+     threads finished.
+     */
+    template <class Function>
+    void ParallelFor(size_t n, size_t nThreads, Function f)
+    {
+        if (!nThreads)
+            nThreads = DefaultThreadCount();
+        if (nThreads > n)
+            nThreads = n;
+        if (nThreads <= 1)
+        {
+            for (size_t i = 0; i != n; ++i)
+                f(i, size_t(0));
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(nThreads);
+        std::vector<std::thread> threads;
+        threads.reserve(nThreads);
+        for (size_t t = 0; t != nThreads; ++t)
+        {
+            threads.push_back(std::thread([&, t]()
+                {
+                    try
+                    {
+                        for (size_t i = t; i < n; i += nThreads)
+                            f(i, t);
+                    }
+                    catch (...)
+                    {
+                        errors[t] = std::current_exception();
+                    }
+                }));
+        }
+        for (size_t t = 0; t != nThreads; ++t)
+            threads[t].join();
+        for (size_t t = 0; t != nThreads; ++t)
+        {
+            if (errors[t])
+                std::rethrow_exception(errors[t]);
+        }
+    }
+
+    /**
+     \brief Fixed set of threads running submitted tasks in submission order.
+
+     Meant for work that waits (I/O), where ParallelFor's static split
+     does not fit. Tasks should not throw (wrap them in a
+     std::packaged_task to get their result or exception). The
+     destructor runs the tasks still queued and joins the threads.
+     */
+    struct ThreadPool: boost::noncopyable
+    {
+        explicit ThreadPool(size_t nThreads = 0): fStop(false)
+        {
+            if (!nThreads)
+                nThreads = DefaultThreadCount();
+            for (size_t t = 0; t != nThreads; ++t)
+                fThreads.push_back(std::thread([this]() { Run(); }));
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fStop = true;
+            }
+            fCondition.notify_all();
+            for (size_t t = 0; t != fThreads.size(); ++t)
+                fThreads[t].join();
+        }
+
+        void Submit(const std::function<void()>& task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fTasks.push_back(task);
+            }
+            fCondition.notify_one();
+        }
+
+        size_t GetNThreads() const { return fThreads.size(); }
+
+    private:
+        void Run()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(fMutex);
+                    fCondition.wait(lock, [this]() { return fStop || !fTasks.empty(); });
+                    if (fTasks.empty())
+                        return;
+                    task = fTasks.front();
+                    fTasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex fMutex;
+        std::condition_variable fCondition;
+        std::deque<std::function<void()> > fTasks;
+        std::vector<std::thread> fThreads;
+        bool fStop;
+    };
+
+    namespace detail
+    {
+        /// State shared by the calling thread and the workers of ParallelPipeline
+        template <class Item>
+        struct Pipeline
+        {
+            Pipeline(size_t nWorkers, size_t depth):
+                fDepth(depth), fItems(nWorkers*depth), fProduced(nWorkers, 0), fConsumed(nWorkers, 0),
+                fFinished(nWorkers, 0), fErrors(nWorkers + 1), fDone(false), fFailed(false), fExited(0)
+            {}
+
+            /// Item k goes to worker k % nWorkers, at place k / nWorkers of its queue
+            Item& Get(size_t worker, size_t place)
+            { return fItems[worker*fDepth + place % fDepth]; }
+
+            size_t fDepth;
+            std::vector<Item> fItems;
+            std::vector<size_t> fProduced;  // per worker, under fMutex
+            std::vector<size_t> fConsumed;
+            std::vector<size_t> fFinished;
+            std::vector<std::exception_ptr> fErrors;  // one per worker, the last one for the calling thread
+            bool fDone;
+            bool fFailed;
+            size_t fExited;
+            std::mutex fMutex;
+            std::condition_variable fReady;  // workers wait for items
+            std::condition_variable fFree;   // the calling thread waits for consumed items
+        };
+    }
+
+    /**
+     \brief Produce items in the calling thread and consume them in nThreads worker threads at the same time.
+
+     This is the pattern of reading a shower: the particle stream can
+     only be decoded in one thread, but processing the batches can be
+     spread. produce(item) fills the next item (reusing its buffers)
+     and returns false when there are no more; it always runs in the
+     calling thread. Item k goes to worker k % nThreads, which calls
+     consume(item, worker). Each worker gets its items in order, so
+     one accumulator per worker, merged in worker order, gives results
+     that do not depend on timing (as with ParallelFor). Once consumed,
+     finish(item) is called in the calling thread, in item order.
+
+     At most \a depth items per worker are being produced, waiting or
+     consumed, so the memory is bounded while decoding runs ahead of
+     the workers. The workers run in a ThreadPool started once per
+     call. With nThreads == 1 everything runs in the calling thread,
+     and nThreads == 0 means DefaultThreadCount().
+
+     If any of the functions throws, production stops and the first
+     exception (workers in order, then the calling thread) is rethrown
+     after all threads finished.
+     */
+    template <class Item, class Produce, class Consume, class Finish>
+    void ParallelPipeline(size_t nThreads, Produce produce, Consume consume, Finish finish, size_t depth = 2)
+    {
+        if (!nThreads)
+            nThreads = DefaultThreadCount();
+        if (!depth)
+            depth = 1;
+        if (nThreads == 1)
+        {
+            Item item;
+            while (produce(item))
+            {
+                consume(item, size_t(0));
+                finish(item);
+            }
+            return;
+        }
+
+        detail::Pipeline<Item> s(nThreads, depth);
+        {
+            ThreadPool pool(nThreads);
+            for (size_t t = 0; t != nThreads; ++t)
+            {
+                pool.Submit([&s, &consume, t]()
+                    {
+                        std::unique_lock<std::mutex> lock(s.fMutex);
+                        for (;;)
+                        {
+                            s.fReady.wait(lock, [&]() { return s.fFailed || s.fDone || s.fConsumed[t] != s.fProduced[t]; });
+                            if (s.fFailed || s.fConsumed[t] == s.fProduced[t])
+                                break;
+                            Item& item = s.Get(t, s.fConsumed[t]);
+                            lock.unlock();
+                            try
+                            {
+                                consume(item, t);
+                            }
+                            catch (...)
+                            {
+                                lock.lock();
+                                s.fErrors[t] = std::current_exception();
+                                s.fFailed = true;
+                                s.fReady.notify_all();
+                                break;
+                            }
+                            lock.lock();
+                            ++s.fConsumed[t];
+                            s.fFree.notify_one();
+                        }
+                        ++s.fExited;
+                        s.fFree.notify_one();
+                    });
+            }
+
+            std::unique_lock<std::mutex> lock(s.fMutex);
+            try
+            {
+                size_t k = 0;  // items produced
+                size_t f = 0;  // items finished
+                bool more = true;
+                while (!s.fFailed && (more || f != k))
+                {
+                    // finish in order what the workers are done with
+                    if (f != k && s.fConsumed[f % nThreads] > f / nThreads)
+                    {
+                        Item& item = s.Get(f % nThreads, f / nThreads);
+                        lock.unlock();
+                        finish(item);
+                        lock.lock();
+                        ++s.fFinished[f % nThreads];
+                        ++f;
+                        continue;
+                    }
+                    const size_t t = k % nThreads;
+                    if (more && s.fProduced[t] - s.fFinished[t] < depth)
+                    {
+                        Item& item = s.Get(t, k / nThreads);
+                        lock.unlock();
+                        more = produce(item);
+                        lock.lock();
+                        if (more)
+                        {
+                            ++s.fProduced[t];
+                            ++k;
+                            s.fReady.notify_all();
+                        }
+                        continue;
+                    }
+                    s.fFree.wait(lock);
+                }
+            }
+            catch (...)
+            {
+                if (!lock.owns_lock())
+                    lock.lock();
+                s.fErrors[nThreads] = std::current_exception();
+                s.fFailed = true;
+            }
+            s.fDone = true;
+            s.fReady.notify_all();
+            s.fFree.wait(lock, [&]() { return s.fExited == nThreads; });
+        }
+        for (size_t t = 0; t != s.fErrors.size(); ++t)
+        {
+            if (s.fErrors[t])
+                std::rethrow_exception(s.fErrors[t]);
+        }
+    }
+
+    /// ParallelPipeline without anything to do after the items are consumed
+    template <class Item, class Produce, class Consume>
+    void ParallelPipeline(size_t nThreads, Produce produce, Consume consume)
+    {
+        ParallelPipeline<Item>(nThreads, produce, consume, [](Item&) {});
+    }
+}
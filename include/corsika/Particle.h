@@ -106,6 +106,7 @@ namespace corsika
         void SetParent(const Particle& p) { fParent.reset(new Particle(p)); }
         Particle& GetParent() { return *fParent; }
         
+        bool HasGrandParent() const { return bool(fGrandParent); }
         void SetGrandParent(const Particle& p) { fGrandParent.reset(new Particle(p));  }
         Particle& GetGrandParent() { return *fGrandParent; }
         
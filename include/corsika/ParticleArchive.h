@@ -0,0 +1,167 @@
+/**
+ \file
+ Compact quantized archive of CORSIKA particle files
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/Block.h>
+#include <corsika/IOException.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerFile.h>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class ArchiveOptions ParticleArchive.h "corsika/ParticleArchive.h"
+
+     \brief Precision and chunking of a particle archive.
+
+     Positions and times are rounded to multiples of fPosition and
+     fTime, the natural logarithm of the momentum to a multiple of
+     fLogMomentum (so this is the relative precision of the
+     momentum) and the direction cosines to multiples of fDirection.
+     */
+    struct ArchiveOptions
+    {
+        ArchiveOptions();
+
+        double fPosition;       // cm
+        double fTime;           // ns
+        double fLogMomentum;
+        double fDirection;
+        unsigned int fChunkSize;        // particle records per compressed chunk
+        int fCompressionLevel;          // zlib, 1 (fast) to 9 (small)
+    };
+
+    /**
+     \class ParticleArchiveWriter ParticleArchive.h "corsika/ParticleArchive.h"
+
+     \brief Write the particles of a CORSIKA file into a compact columnar archive.
+
+     The particle records of each event are stored in chunks of
+     ArchiveOptions::fChunkSize records. Within a chunk every field
+     is a column:
+     - the particle code and the rest of the description (hadronic
+       generation and observation level) as 16-bit integers,
+     - positions and times quantized to integers (times relative to
+       the earliest particle in the chunk),
+     - the momentum as its logarithm and two direction cosines, also
+       quantized (the largest cosine is left out and computed from the
+       other two),
+     - the weight as a float, only for thinned files.
+     The bytes of each column are shuffled (all first bytes, then all
+     second bytes...) before compressing the chunk with zlib, so the
+     mostly constant high bytes cost almost nothing.
+
+     Records that can not be quantized (muon-production and history
+     records, Cherenkov bunches, particles at rest or values out of
+     range) are stored as they are, in the same position, so reading
+     the archive with ShowerParticleStream gives the same particles
+     with the same parents.
+
+     Run and event headers and trailers are stored verbatim.
+     Longitudinal blocks are not archived (use the .long file).
+
+     Blocks are given in file order, as read from a RawStream. Errors
+     throw IOException.
+
+     \ingroup corsika
+     */
+    struct ParticleArchiveWriter
+    {
+        ParticleArchiveWriter(const std::string& filename, bool thinned, const ArchiveOptions& options = ArchiveOptions());
+        ~ParticleArchiveWriter();
+
+        void Write(const Block<Thinned>& block);
+        void Write(const Block<NotThinned>& block);
+
+        /// Write the pending chunk and close the file.
+        void Close();
+
+        /// Number of particle records written so far
+        size_t GetNRecords() const { return fNRecords; }
+        /// Number of records stored without quantization
+        size_t GetNRawRecords() const { return fNRawRecords; }
+
+        /// Archive a whole CORSIKA file. Returns the number of particle records.
+        static size_t Convert(const std::string& corsikaFile, const std::string& archive,
+                              const ArchiveOptions& options = ArchiveOptions());
+
+    private:
+        template <class Thinning> void WriteBlock(const Block<Thinning>& block);
+        void Add(const ParticleData<Thinned>& record);
+        void WriteChunk();
+        void WriteBytes(const void* data, size_t size);
+
+        std::string fFilename;
+        FILE* fFile;
+        bool fThinned;
+        ArchiveOptions fOptions;
+        bool fInEvent;
+        std::vector<ParticleData<Thinned> > fChunk;
+        size_t fNRecords;
+        size_t fNRawRecords;
+    };
+
+    /**
+     \class ParticleArchive ParticleArchive.h "corsika/ParticleArchive.h"
+
+     \brief Read an archive written by ParticleArchiveWriter, like a ShowerFile.
+
+     The particle stream of the current shower is a
+     ShowerParticleStream, so everything that reads showers (batches,
+     selections, histograms, detector sampling) works on archives.
+     Each chunk is a block for block subsampling, and skipped chunks
+     are not decompressed.
+
+     \ingroup corsika
+     */
+    struct ParticleArchive
+    {
+        ParticleArchive();
+        ParticleArchive(const std::string& filename);
+
+        void Open(const std::string& filename);
+        void Close();
+        bool IsOpen() const { return bool(fFile); }
+
+        /// Find an event and position to read it
+        Status FindEvent(unsigned int eventId);
+        size_t GetNEvents() const { return fEvents.size(); }
+
+        const Shower& GetCurrentShower() const { return fCurrentShower; }
+        Shower& GetCurrentShower() { return fCurrentShower; }
+
+        const RunHeader& GetRunHeader() const { return fRunHeader; }
+        bool IsThinned() const { return fThinned; }
+        const ArchiveOptions& GetOptions() const { return fOptions; }
+
+        /// The file is a particle archive
+        static bool IsValid(const std::string& filename);
+
+    private:
+        struct Event
+        {
+            EventHeader fHeader;
+            EventTrailer fTrailer;
+            long fFirstChunk;   // file offset
+        };
+
+        std::string fFilename;
+        boost::shared_ptr<FILE> fFile;
+        bool fThinned;
+        ArchiveOptions fOptions;
+        RunHeader fRunHeader;
+        std::vector<Event> fEvents;
+        Shower fCurrentShower;
+        boost::shared_ptr<ShowerParticleStream> fParticleStream;
+    };
+}
@@ -0,0 +1,92 @@
+/**
+ \file
+ Columnar batch of decoded particles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/Particle.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace corsika
+{
+    /**
+     \class ParticleBatch ParticleBatch.h "corsika/ParticleBatch.h"
+
+     \brief Particles decoded into one contiguous array per field.
+
+     A batch is filled by ShowerParticleStream::NextBatch and is the
+     unit of work for everything that processes particles in bulk
+     (selections, histograms, detector sampling...). Columns are in
+     CORSIKA units (cm, ns, GeV). History and muon-production
+     records are not part of a batch.
+
+     \ingroup corsika
+     */
+    struct ParticleBatch
+    {
+        /// Number of particles decoded per batch unless told otherwise.
+        static const size_t kDefaultSize = 4096;
+
+        /// Fields that can be requested by name with GetColumn.
+        enum Column
+        {
+            eX,
+            eY,
+            eR,                 // sqrt(x*x + y*y)
+            eT,
+            ePx,
+            ePy,
+            ePz,
+            eMomentum,
+            eKineticEnergy,
+            ePDG,
+            eCorsikaCode,
+            eLevel,             // observation level, starting at zero like Particle::ObservingLevel
+            eGeneration,        // hadronic generation
+            eWeight,
+            eNColumns
+        };
+
+        /// Column for a name like "x", "ekin" or "pdg". Returns eNColumns if unknown.
+        static Column ColumnFromName(const std::string& name);
+        static std::string ColumnName(Column c);
+
+        size_t size() const { return fX.size(); }
+        bool empty() const { return fX.empty(); }
+        void clear();
+        void reserve(size_t n);
+
+        /// Append one particle.
+        void push_back(const Particle& p);
+
+        /// Append particle i of another batch.
+        void push_back(const ParticleBatch& other, size_t i);
+
+        /// Append all particles in another batch.
+        void Append(const ParticleBatch& other);
+
+        /// Keep only the particles with mask[i] != 0, preserving order. Returns the new size.
+        size_t Compact(const std::vector<char>& mask);
+
+        /// Value of a column for particle i (derived columns are computed on the fly).
+        double Get(Column c, size_t i) const;
+
+        /// Fill out[0..size()) with the values of a column.
+        void GetColumn(Column c, double* out) const;
+
+        std::vector<float> fX, fY;          // cm
+        std::vector<float> fT;              // ns
+        std::vector<float> fPx, fPy, fPz;   // GeV
+        std::vector<float> fKineticEnergy;  // GeV
+        std::vector<float> fWeight;
+        std::vector<int> fPDG;
+        std::vector<short> fCorsikaCode;
+        std::vector<short> fLevel;
+        std::vector<short> fGeneration;
+    };
+}
@@ -0,0 +1,79 @@
+/**
+ \file
+ Particle selection expressions
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ParticleBatch.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    struct Particle;
+
+    /**
+     \class ParticleSelection ParticleSelection.h "corsika/ParticleSelection.h"
+
+     \brief Boolean expression over particle fields, parsed once and evaluated over whole batches.
+
+     The expression is written in terms of the columns of a
+     ParticleBatch (x, y, r, t, px, py, pz, p, ekin, pdg,
+     corsika_code, level, generation, weight), numbers, the units
+     in Units.h (m, km, ns, GeV...) and the functions abs, sqrt, exp,
+     log and log10. Supported operators, from lowest to highest precedence:
+     - or, ||
+     - and, &&
+     - not, !
+     - comparisons <, <=, >, >=, ==, !=, and set membership "in (a, b, ...)" / "not in (...)"
+     - +, -
+     - *, /
+     - unary minus
+
+     For example:
+     \code
+     ParticleSelection muons("pdg in (13, -13) and r < 800*m and ekin > 1*GeV");
+     \endcode
+
+     Parts of the expression that do not depend on particle fields
+     (like 800*m) are evaluated once when parsing. The rest is
+     evaluated one operation at a time over the whole batch, so the
+     cost per particle is a handful of tight loops.
+
+     Syntax errors throw std::invalid_argument.
+
+     \ingroup corsika
+     */
+    struct ParticleSelection
+    {
+        struct Node;
+
+        ParticleSelection(const std::string& expression);
+
+        const std::string& GetExpression() const { return fExpression; }
+
+        /// Evaluate over a batch. After the call, mask.size() == batch.size() and mask[i] != 0 if particle i is selected.
+        void Evaluate(const ParticleBatch& batch, std::vector<char>& mask) const;
+
+        /// Number of selected particles in a batch
+        size_t Count(const ParticleBatch& batch) const;
+
+        /// Remove the particles that are not selected from a batch. Returns the new size.
+        size_t Select(ParticleBatch& batch) const;
+
+        /// Evaluate for a single particle. This is the slow path, prefer the batch methods.
+        bool operator()(const Particle& p) const;
+
+    private:
+        struct ScratchPool;
+
+        std::string fExpression;
+        boost::shared_ptr<const Node> fRoot;
+        size_t fNTemporaries;
+        boost::shared_ptr<ScratchPool> fScratch;
+    };
+}
@@ -0,0 +1,77 @@
+/**
+ \file
+ Resampling of longitudinal profiles onto a common depth grid
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/LongCache.h>
+#include <corsika/LongProfile.h>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class ProfileResampler ProfileResampler.h "corsika/ProfileResampler.h"
+
+     \brief Interpolate many profiles onto the same depth grid.
+
+     Profiles come with their own depth bins (which depend on the
+     zenith angle for vertical-depth profiles, and differ between
+     particle numbers and energy deposit). This gives them all the
+     same bins, for example to feed a fluorescence simulation or to
+     average showers.
+
+     Depths of the grid are in the units of the profile depths and
+     must increase. Grid points outside a profile are zero (there is
+     no extrapolation). A profile ends at the first depth that does
+     not increase (LongFile leaves unused bins at zero).
+
+     eLog interpolates the logarithm of the values, which follows
+     the exponential rise and fall of a shower better; where one of
+     the neighbouring values is not positive it is linear.
+
+     The positions of the grid in the bins are computed once for
+     consecutive profiles with the same depths. The values around each
+     grid point are gathered first, and the interpolation runs over
+     the gathered values without branches (eLog with the fast exp and
+     log of the Gaisser-Hillas batch evaluation, accurate to a few
+     units in the last place), so it vectorizes. Results are rows of a
+     row-major matrix, one row per profile.
+
+     \ingroup corsika
+     */
+    struct ProfileResampler
+    {
+        enum Interpolation
+        {
+            eLinear,
+            eLog
+        };
+
+        explicit ProfileResampler(const std::vector<double>& grid, Interpolation mode = eLinear);
+
+        const std::vector<double>& GetGrid() const { return fGrid; }
+        Interpolation GetInterpolation() const { return fMode; }
+
+        /// One profile with n bins, GetGrid().size() values are written to out
+        void Resample(const double* depth, const double* values, size_t n, double* out) const;
+        std::vector<double> Resample(const std::vector<double>& depth, const std::vector<double>& values) const;
+
+        /// A column of many profiles (dE/dX goes with the energy deposit depths), nThreads == 0 means one per hardware thread.
+        std::vector<double> Resample(const std::vector<LongProfile>& profiles, LongCache::Column c, size_t nThreads = 1) const;
+        /// A column of every profile in a cache
+        std::vector<double> Resample(const LongCache& cache, LongCache::Column c, size_t nThreads = 1) const;
+
+        struct Workspace;
+
+    private:
+        template <class Get>
+        std::vector<double> ResampleAll(size_t n, Get get, size_t nThreads) const;
+
+        std::vector<double> fGrid;
+        Interpolation fMode;
+    };
+}
@@ -0,0 +1,181 @@
+/**
+ \file
+ All longitudinal profiles of a shower in one buffer
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ColumnSpan.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class ProfileColumns ProfileTable.h "corsika/ProfileTable.h"
+
+     \brief The columns of a longitudinal profile, and their names.
+
+     \ingroup corsika
+     */
+    struct ProfileColumns
+    {
+        /// Profile columns (one value per depth bin)
+        enum Column
+        {
+            eDepth,
+            eGamma,
+            ePositron,
+            eElectron,
+            eAntiMuon,
+            eMuon,
+            eHadron,
+            eCharge,
+            eNuclei,
+            eCherenkov,
+            eDepth_dE,      // energy deposit bins from here on
+            edEdX,
+            eNColumns
+        };
+
+        /// Name of a column, like "depth" or "anti_muon"
+        static std::string ColumnName(Column c);
+        /// Column for a name, eNColumns if unknown
+        static Column ColumnFromName(const std::string& name);
+        /// Column with the depths of a column (eDepth or eDepth_dE)
+        static Column DepthColumn(Column c) { return (c < eDepth_dE ? eDepth : eDepth_dE); }
+    };
+
+    /**
+     \class BasicProfileTable ProfileTable.h "corsika/ProfileTable.h"
+
+     \brief The profiles of a shower, every column in a single buffer.
+
+     The particle columns (eDepth to eCherenkov) have GetNBins()
+     values and the energy deposit ones (eDepth_dE and edEdX)
+     GetNBinsEnergyDeposit(). Each column is contiguous and they
+     follow each other in the order of the enum, which is also the
+     layout of a shower in a LongCache.
+
+     Readers size the table once and write the columns in place
+     (Get), so a profile costs one allocation. Tables are meant to be
+     moved: copying one copies the whole buffer.
+
+     ProfileTable stores doubles and FloatProfileTable floats, which
+     is all the precision CORSIKA writes.
+
+     \ingroup corsika
+     */
+    template <class T>
+    struct BasicProfileTable: ProfileColumns
+    {
+        typedef T value_type;
+
+        BasicProfileTable(): fNBins(0), fNBinsEnergyDeposit(0) {}
+        /// All values zero
+        BasicProfileTable(size_t nBins, size_t nBinsEnergyDeposit):
+            fData(kParticleColumns*nBins + kEnergyDepositColumns*nBinsEnergyDeposit),
+            fNBins(nBins), fNBinsEnergyDeposit(nBinsEnergyDeposit)
+        {}
+        /// Copy with another precision
+        template <class U>
+        explicit BasicProfileTable(const BasicProfileTable<U>& other):
+            fData(other.data(), other.data() + other.size()),
+            fNBins(other.GetNBins()), fNBinsEnergyDeposit(other.GetNBinsEnergyDeposit())
+        {}
+
+        size_t GetNBins() const { return fNBins; }
+        size_t GetNBinsEnergyDeposit() const { return fNBinsEnergyDeposit; }
+        /// Number of values in a column
+        size_t GetNBins(Column c) const
+        { return (c < eDepth_dE ? fNBins : fNBinsEnergyDeposit); }
+        bool empty() const { return fData.empty(); }
+
+        /**
+         Change the number of bins, keeping the values of the bins that
+         remain and setting new ones to zero. Only a table that grows
+         is reallocated.
+         */
+        void Resize(size_t nBins, size_t nBinsEnergyDeposit)
+        {
+            if (nBins <= fNBins && nBinsEnergyDeposit <= fNBinsEnergyDeposit)
+            {
+                // every column but the first (which stays) moves towards the front
+                T* const out = fData.data();
+                for (int c = 1; c != eNColumns; ++c)
+                {
+                    const Column column = Column(c);
+                    std::copy(Get(column), Get(column) + (c < eDepth_dE ? nBins : nBinsEnergyDeposit),
+                              out + Offset(column, nBins, nBinsEnergyDeposit));
+                }
+                fData.resize(kParticleColumns*nBins + kEnergyDepositColumns*nBinsEnergyDeposit);
+            }
+            else
+            {
+                BasicProfileTable resized(nBins, nBinsEnergyDeposit);
+                for (int c = 0; c != eNColumns; ++c)
+                {
+                    const Column column = Column(c);
+                    std::copy(Get(column), Get(column) + std::min(GetNBins(column), resized.GetNBins(column)),
+                              resized.Get(column));
+                }
+                fData.swap(resized.fData);
+            }
+            fNBins = nBins;
+            fNBinsEnergyDeposit = nBinsEnergyDeposit;
+        }
+
+        /// No bins (the buffer is kept for the next profile)
+        void clear()
+        {
+            fData.clear();
+            fNBins = fNBinsEnergyDeposit = 0;
+        }
+
+        /// First value of a column, to write it in place
+        T* Get(Column c)
+        { return fData.data() + Offset(Check(c), fNBins, fNBinsEnergyDeposit); }
+        const T* Get(Column c) const
+        { return fData.data() + Offset(Check(c), fNBins, fNBinsEnergyDeposit); }
+
+        /// A column (no copy)
+        ColumnSpan<T> GetColumn(Column c) const
+        { return ColumnSpan<T>(Get(c), GetNBins(c)); }
+        /// Copy of a column
+        std::vector<T> GetVector(Column c) const
+        { return std::vector<T>(Get(c), Get(c) + GetNBins(c)); }
+
+        /// The whole buffer, with the columns in order
+        const T* data() const { return fData.data(); }
+        size_t size() const { return fData.size(); }
+
+    private:
+        static const size_t kParticleColumns = eDepth_dE;
+        static const size_t kEnergyDepositColumns = eNColumns - eDepth_dE;
+
+        static Column Check(Column c)
+        {
+            if (c < 0 || c >= eNColumns)
+                throw std::out_of_range("ProfileTable: column out of range");
+            return c;
+        }
+
+        static size_t Offset(Column c, size_t nBins, size_t nBinsEnergyDeposit)
+        {
+            return (c < eDepth_dE ?
+                    c*nBins :
+                    kParticleColumns*nBins + (c - eDepth_dE)*nBinsEnergyDeposit);
+        }
+
+        std::vector<T> fData;
+        size_t fNBins;
+        size_t fNBinsEnergyDeposit;
+    };
+
+    typedef BasicProfileTable<double> ProfileTable;
+    typedef BasicProfileTable<float> FloatProfileTable;
+}
@@ -0,0 +1,76 @@
+/**
+ \file
+ Mergeable streaming quantile estimator
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class QuantileSketch QuantileSketch.h "corsika/QuantileSketch.h"
+
+     \brief Weighted quantiles of a stream of values in bounded memory.
+
+     Values are counted in logarithmically spaced buckets (the
+     DDSketch scheme), so any quantile is estimated with a relative
+     error below the accuracy given in the constructor. Positive and
+     negative values are kept separately. If the values span more than
+     maxBuckets buckets of one sign, the buckets closest to zero are
+     merged, which only degrades the accuracy of the smallest values.
+
+     Two sketches with the same accuracy can be merged, and merging in
+     a fixed order gives a reproducible result.
+     */
+    struct QuantileSketch
+    {
+        QuantileSketch(double relativeAccuracy = 0.01, size_t maxBuckets = 2048);
+
+        void Add(double value, double weight = 1);
+        /// Add all values of another sketch. Throws std::invalid_argument if the accuracy differs.
+        void Merge(const QuantileSketch& other);
+        void Clear();
+
+        /// Estimate of the q-quantile (0 <= q <= 1). Returns NaN if the sketch is empty.
+        double GetQuantile(double q) const;
+
+        double GetRelativeAccuracy() const { return fAccuracy; }
+        size_t GetCount() const { return fCount; }
+        double GetTotalWeight() const { return fTotal; }
+        double GetMin() const { return fMin; }
+        double GetMax() const { return fMax; }
+        /// Number of buckets in use, a measure of the memory taken
+        size_t GetNBuckets() const { return fPositive.fWeights.size() + fNegative.fWeights.size(); }
+
+    private:
+        // weights of consecutive bucket indices, starting at fOffset
+        struct Store
+        {
+            Store(): fOffset(0) {}
+            void Add(int index, double weight, size_t maxBuckets);
+            int fOffset;
+            std::vector<double> fWeights;
+        };
+
+        int Index(double absValue) const;
+        double Value(int index) const;
+
+        double fAccuracy;
+        double fGamma;
+        double fLogGamma;
+        size_t fMaxBuckets;
+
+        Store fPositive;
+        Store fNegative;
+        double fZero;
+        size_t fCount;
+        double fTotal;
+        double fMin;
+        double fMax;
+    };
+}
@@ -12,6 +12,12 @@ namespace corsika
         virtual boost::optional<Particle> NextParticle() = 0;
         virtual void Rewind() = 0;
         virtual bool IsValid() const = 0;
+        /// The next particle is the first one of a particle block
+        virtual bool AtBlockStart() const = 0;
+        /// Skip the next particle block without decoding it. Returns false at the end of the particle records.
+        virtual bool SkipBlock() = 0;
+        /// Position of the first block after the particle records (the first LONG block or the event trailer), zero if unknown. Lets SkipBlock seek instead of read.
+        virtual void SetEnd(size_t end) = 0;
         virtual ~VRawParticleStream(){}
         static RawParticleStreamPtr Create(RawStreamPtr stream, size_t start=0);
     };
@@ -22,10 +28,14 @@ namespace corsika
         const ParticleData<Thinning>* GetOneParticle();
         void Rewind();
         bool IsValid() const { return valid; }
+        bool AtBlockStart() const { return valid && current_particle == kParticlesInBlock; }
+        bool SkipBlock();
+        void SetEnd(size_t end) { this->end = end; }
 
     private:
         RawStreamPtr stream;
         size_t start;
+        size_t end;
         size_t current_particle;
         Block<Thinning> block;
         bool valid;
@@ -46,6 +46,8 @@ namespace corsika
         
         /// This is a stream of a thinned corsika file
         virtual bool IsThinned() const = 0;
+        /// The disk blocks are delimited by 64-bit (instead of 32-bit) record markers
+        virtual bool Is64Bit() const = 0;
         
         static RawStreamPtr Create(const std::string& theName);
     };
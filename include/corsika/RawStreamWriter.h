@@ -0,0 +1,58 @@
+/**
+ \file
+ Writing raw CORSIKA files
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <boost/shared_ptr.hpp>
+#include <corsika/Block.h>
+#include <corsika/IOException.h>
+#include <string>
+
+namespace corsika
+{
+    typedef boost::shared_ptr<struct RawStreamWriter> RawStreamWriterPtr;
+
+    /**
+     \class RawStreamWriter RawStreamWriter.h "corsika/RawStreamWriter.h"
+
+     \brief Block-wise write access to a Corsika ground particles file.
+
+     This is the counterpart of RawStream. Blocks are grouped into
+     disk blocks of kSubBlocksPerBlock sub-blocks, with the Fortran
+     record markers (32 or 64 bits) around each disk block, so the
+     output can be read by RawStream and by CORSIKA's own tools.
+     Whole disk blocks are written at once. The file is compressed
+     if its name ends in .gz or .bz2.
+
+     Close (or the destructor) completes the last disk block with
+     empty sub-blocks. Errors throw IOException, and so does writing
+     a block of the wrong type (thinned or not).
+
+     \ingroup corsika
+     */
+    struct RawStreamWriter
+    {
+        virtual ~RawStreamWriter() {}
+
+        /// Append one block
+        virtual void Write(const Block<Thinned>& theBlock) = 0;
+        virtual void Write(const Block<NotThinned>& theBlock) = 0;
+
+        /// Number of the block written by the next call to Write
+        virtual size_t GetNextPosition() const = 0;
+
+        /// This is a stream of a thinned corsika file
+        virtual bool IsThinned() const = 0;
+        /// The disk blocks are delimited by 64-bit (instead of 32-bit) record markers
+        virtual bool Is64Bit() const = 0;
+
+        /// Write the last disk block and close the file. Nothing can be written afterwards.
+        virtual void Close() = 0;
+
+        static RawStreamWriterPtr Create(const std::string& theName, bool thinned, bool is64Bit = false);
+    };
+}
@@ -9,9 +9,10 @@
 
 #pragma once
 #include <corsika/Block.h>
+#include <corsika/IOException.h>
 #include <corsika/ShowerParticleStream.h>
 #include <corsika/GaisserHillasParameter.h>
-#include <vector>
+#include <corsika/ProfileTable.h>
 
 namespace corsika
 {
@@ -19,7 +20,6 @@ namespace corsika
     {
         Shower(): particle_stream(0) {}
         Shower(const EventHeader& header, const EventTrailer& trailer, ShowerParticleStream* particle_stream);
-        ~Shower(){}
         
         int GetPrimary() const            {return fPrimaryParticle;   }
         float GetEnergy() const           {return fEnergy;         }
@@ -33,8 +33,15 @@ namespace corsika
         float GetMuonEnergyCutoff() const {return fMuonEnergyCutoff;}
         
         
+        /// False for showers without particles, like those from ShowerFile::LoadLongitudinal
+        bool HasParticleStream() const
+        { return particle_stream; }
+        
+        /// The particles of the shower, rewound. Throws IOException if HasParticleStream() is false.
         ShowerParticleStream& ParticleStream() const
         {
+            if (!particle_stream)
+                throw IOException("This shower has no particle stream (it was loaded without its particles)");
             particle_stream->Rewind();
             //++(*fParticleIterator);
             return *particle_stream;
@@ -67,18 +74,7 @@ namespace corsika
         const EventTrailer& GetEventTrailer() const
         { return fEventTrailer; }
         
-        std::vector<double> fdEdX;
-        std::vector<double> fChargeProfile;
-        std::vector<double> fGammaProfile;
-        std::vector<double> fElectronProfile;
-        std::vector<double> fPositronProfile;
-        std::vector<double> fMuonProfile;
-        std::vector<double> fAntiMuonProfile;
-        std::vector<double> fHadronProfile;
-        std::vector<double> fNucleiProfile;
-        std::vector<double> fCherenkovProfile;
-        std::vector<double> fDepth;
-        std::vector<double> fDepth_dE;
+        ProfileTable fProfiles;
         
     private:
         EventHeader fEventHeader;
@@ -11,14 +11,17 @@
 #include <corsika/RawStream.h>
 #include <corsika/IOException.h>
 #include <corsika/Shower.h>
-#include <corsika/LongFile.h>
+#include <corsika/LongLoader.h>
 #include <corsika/FileIndex.h>
+#include <boost/shared_ptr.hpp>
+#include <future>
 #include <string>
 #include <map>
 #include <vector>
 
 namespace corsika
 {
+    struct ThreadPool;
     
     enum Status
     {
@@ -27,11 +30,24 @@ namespace corsika
         eEOF
     };
     
+    typedef boost::shared_ptr<Shower> ShowerPtr;
+    
     /**
      \class ShowerFile ShowerFile.h "corsika/ShowerFile.h"
      
      \brief Read data from the output of CORSIKA
      
+     Events can also be loaded in advance with LoadAsync, so that the
+     seeks and reads of the next events overlap with the processing of
+     the current one (useful on network file systems):
+     \code
+     std::deque<std::shared_future<ShowerPtr> > inFlight;
+     for (size_t i = 0; i != ids.size(); ++i) {
+         inFlight.push_back(file.LoadAsync(ids[i]));
+         if (inFlight.size() == K) { Process(*inFlight.front().get()); inFlight.pop_front(); }
+     }
+     \endcode
+     
      \ingroup corsika
      */
     struct ShowerFile
@@ -44,6 +60,16 @@ namespace corsika
         /// Open file
         virtual void Open(const std::string& theFileName, bool scan = true);
         
+        /**
+         Open the file of \a other again, with a stream of its own but
+         the index, run header and .long file of \a other, so the file
+         is not scanned again (\a other is scanned first if it was not).
+         This is how one file is read from several threads: one copy
+         per thread, all opened from the same ShowerFile before the
+         threads start.
+         */
+        void OpenCopy(ShowerFile& other);
+        
         /// Close file
         virtual void Close();
         
@@ -53,6 +79,34 @@ namespace corsika
         /// Get number of showers in file
         virtual size_t GetNEvents();
         
+        /// Event numbers of the showers in file, in file order
+        std::vector<unsigned int> GetEventIds();
+        
+        /**
+         Read an event (headers and longitudinal profiles, like
+         FindEvent) in one of the I/O threads of this file. The
+         returned shower has its own stream and does not change the
+         current shower, so any number of events can be in flight. An
+         unknown event or a read error is an IOException thrown by
+         get(). Pending loads finish before the file is closed.
+         */
+        std::shared_future<ShowerPtr> LoadAsync(unsigned int eventId);
+        
+        /**
+         The headers and longitudinal profiles of every shower, in file
+         order, in one pass that skips the particle blocks (the showers
+         have no particle stream). Profiles are the ones FindEvent
+         gives: from the LONG blocks when the file has them, with the
+         energy deposit of the .long file, or else from the .long
+         file. With energyDeposit false and LONG blocks, the .long file
+         is not read at all.
+         */
+        std::vector<ShowerPtr> LoadLongitudinal(bool energyDeposit = true);
+        
+        /// Number of threads used by LoadAsync (default 4), takes effect on the next load after Close.
+        void SetNIOThreads(size_t n) { fNIOThreads = n; }
+        size_t GetNIOThreads() const { return fNIOThreads; }
+        
         
         /// File is open
         bool IsOpen()
@@ -79,14 +133,21 @@ namespace corsika
         Status ReadRunHeader();
         template <class Thinning>
         Status Read();
-        Status ReadLongFile();
+        Status ReadLongFile(bool energyDepositOnly = false);
         template <class Thinning>
         Status ReadLongBlocks();
+        template <class Thinning>
+        std::vector<ShowerPtr> LoadLongitudinal(bool energyDeposit);
+        /// Profiles of the .long file, null if there is none
+        boost::shared_ptr<LongLoader> GetLongLoader();
+        
+        struct AsyncState;
         
         Shower fCurrentShower;
         corsika::RunHeader fRunHeader;
         
         RawStreamPtr fRawStream;
+        std::string fFilename;
         std::string fLongFile;
         FileIndex fIndex;
         unsigned int fCurrentPosition;
@@ -94,6 +155,10 @@ namespace corsika
         bool fIsThinned;
         bool fFileScanned;
         
-        boost::shared_ptr<LongFile> fCorsikaLongFile;
+        boost::shared_ptr<LongLoader> fLongLoader;  // the .long file, shared with the I/O threads
+        
+        size_t fNIOThreads;
+        boost::shared_ptr<AsyncState> fAsyncState;  // long file of the I/O threads
+        boost::shared_ptr<ThreadPool> fIOThreads;
     };
 }
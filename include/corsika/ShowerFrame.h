@@ -0,0 +1,90 @@
+/**
+ \file
+ Transformation of ground particle coordinates into the shower frame
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace corsika
+{
+    struct EventHeader;
+    struct Shower;
+    struct ParticleBatch;
+
+    /**
+     \class ShowerFrame ShowerFrame.h "corsika/ShowerFrame.h"
+
+     \brief Shower axis and core, and the transformation of ground positions and times to that frame.
+
+     With the primary moving along
+     p = (sin(zenith) cos(azimuth), sin(zenith) sin(azimuth), -cos(zenith)),
+     a ground position d = (x, y, 0) relative to the core has shower-frame coordinates
+     - x' = d.(cos(zenith) cos(azimuth), cos(zenith) sin(azimuth), sin(zenith)), in the vertical plane containing the axis,
+     - y' = d.(-sin(azimuth), cos(azimuth), 0), horizontal,
+     - r = sqrt(x'^2 + y'^2), the distance to the axis,
+     - residual = t - timeOffset - d.p/c, the time relative to a plane front moving with the primary.
+
+     Times from ShowerParticleStream already have the time of flight
+     to the core (CoreTimeShift) subtracted, so the frame of a Shower
+     uses timeOffset = 0. For times read with RawParticleStream, pass
+     rawTimes = true to subtract it here.
+
+     The azimuth is in the frame of the particle coordinates, which
+     CORSIKA rotates by EventHeader::fArrayRotation from magnetic north.
+     */
+    struct ShowerFrame
+    {
+        ShowerFrame(double zenith = 0, double azimuth = 0, double coreX = 0, double coreY = 0, double timeOffset = 0);
+        /// Frame of a shower, for times from its ShowerParticleStream.
+        ShowerFrame(const Shower& shower);
+        /// Frame from an event header. Set rawTimes for times that still include CoreTimeShift(header).
+        ShowerFrame(const EventHeader& header, bool rawTimes = false);
+
+        /**
+         Time CORSIKA's clock runs until the primary, moving at the
+         speed of light, reaches the core at the lowest observation
+         level. The clock starts at the first interaction or, for the
+         SLANT and CURVED options, at the top of the atmosphere. The
+         CURVED option takes the Earth's curvature into account.
+         */
+        static double CoreTimeShift(const EventHeader& header);
+
+        double GetZenith() const { return fZenith; }
+        double GetAzimuth() const { return fAzimuth; }
+        double GetCoreX() const { return fCoreX; }
+        double GetCoreY() const { return fCoreY; }
+        double GetTimeOffset() const { return fTimeOffset; }
+
+        /**
+         Transform n particles. Any of the output arrays can be null if
+         not needed. The time residual needs t.
+         */
+        void Transform(const float* x, const float* y, const float* t, size_t n,
+                       double* xOut, double* yOut, double* r, double* residual) const;
+
+        /// Transform the particles of a batch into the given vectors (resized to batch.size()).
+        void Transform(const ParticleBatch& batch,
+                       std::vector<double>& x, std::vector<double>& y,
+                       std::vector<double>& r, std::vector<double>& residual) const;
+
+    private:
+        void Init();
+
+        double fZenith;
+        double fAzimuth;
+        double fCoreX;
+        double fCoreY;
+        double fTimeOffset;
+
+        // derived
+        double fCosZenith;
+        double fSinZenith;
+        double fCosAzimuth;
+        double fSinAzimuth;
+    };
+}
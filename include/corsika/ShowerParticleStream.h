@@ -1,6 +1,8 @@
 #pragma once
 #include <corsika/RawParticleStream.h>
+#include <corsika/ParticleBatch.h>
 #include <boost/optional.hpp>
+#include <cstdint>
 
 namespace corsika
 {
@@ -9,16 +11,83 @@ namespace corsika
     //
     struct ShowerParticleStream
     {
-        ShowerParticleStream(){}
-        ShowerParticleStream(RawStreamPtr stream, size_t start, double timeOffset, int observationLevel, bool keepMuProd);
-        virtual void Rewind() { stream->Rewind(); }
+        /// How particles are subsampled, see SetSubsampling
+        enum Subsampling
+        {
+            eAllParticles,
+            eParticleSubsampling,   // keep each particle with a given probability
+            eBlockSubsampling       // keep each particle block with a given probability, skip the others undecoded
+        };
+        
+        ShowerParticleStream():
+        fAtEnd(true), fSubsampling(eAllParticles), fFraction(1), fSeed(0),
+        fNParticles(0), fNBlocks(0), fSkippedBlocks(0), fBlockSkipped(false),
+        fNEmitted(0), fNFiltered(0) {}
+        /// \a end is the position of the first block after the particles, the first LONG block or the event trailer (zero if unknown). It allows skipping blocks by seeking.
+        ShowerParticleStream(RawStreamPtr stream, size_t start, double timeOffset, int observationLevel, bool keepMuProd,
+                             size_t end = 0);
+        /// Particles from any source of particle records (like a ParticleArchive).
+        ShowerParticleStream(RawParticleStreamPtr stream, double timeOffset, int observationLevel, bool keepMuProd);
+        virtual ~ShowerParticleStream();
+        virtual void Rewind();
         boost::optional<Particle> NextParticle();
         
+        /// Decode up to \a maxParticles particles into \a batch (cleared first). Returns the number of particles decoded.
+        size_t NextBatch(ParticleBatch& batch, size_t maxParticles = ParticleBatch::kDefaultSize);
+        
+        /**
+         Return only a random fraction of the particles, with fWeight
+         divided by the fraction so that weighted sums are unbiased.
+         With eParticleSubsampling every particle is kept with
+         probability \a fraction. With eBlockSubsampling the choice is
+         made for each block of 39 particle records, and the blocks that
+         are dropped are not decoded at all. If the stream was given the
+         end of the particle records (ShowerFile does) they are skipped
+         by seeking, which saves reading them only if the file is not
+         compressed (seeking in a compressed file decompresses); without
+         the end they are always read. Particles whose history records
+         were in a dropped block lose their parent information.
+         
+         The random numbers come from CounterRandom with \a seed and the
+         particle (or block) number, so the same particles are chosen on
+         every pass. Takes effect from the next particle read; Rewind to
+         apply it to the whole shower.
+         */
+        void SetSubsampling(Subsampling mode, double fraction = 1, uint64_t seed = 0);
+        Subsampling GetSubsampling() const { return fSubsampling; }
+        double GetSubsamplingFraction() const { return fFraction; }
+        /// Number of particle blocks dropped since the last Rewind
+        size_t GetNSkippedBlocks() const { return fSkippedBlocks; }
+        
+        /**
+         Reservoir sampling: read all remaining particles and keep a
+         uniform random sample of at most \a size of them in \a batch,
+         with fWeight multiplied by (particles read)/(particles kept).
+         Returns the number of particles read.
+         */
+        size_t NextReservoir(ParticleBatch& batch, size_t size, uint64_t seed = 0);
+        
     private:
+        boost::optional<Particle> NextRecord();
+        /// Add the particles counted since the last call to Instrumentation
+        void FlushCounts();
+        
+
         boost::optional<Particle> value_;
         RawParticleStreamPtr stream;
         double fTimeOffset;
         int fObservationLevel;
         bool fKeepMuProd;
+        bool fAtEnd; // set once NextBatch reached the end of the particle records
+        
+        Subsampling fSubsampling;
+        double fFraction;
+        uint64_t fSeed;
+        size_t fNParticles;     // particles returned or dropped since Rewind
+        size_t fNBlocks;        // block decisions since Rewind
+        size_t fSkippedBlocks;
+        bool fBlockSkipped;     // a block was dropped while reading the current particle
+        size_t fNEmitted;       // not yet added to Instrumentation (done once per block)
+        size_t fNFiltered;
     };
 }
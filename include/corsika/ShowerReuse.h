@@ -0,0 +1,85 @@
+/**
+ \file
+ Sampling one shower at many core positions in a single pass
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/DetectorSampler.h>
+#include <utility>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class ShowerReuse ShowerReuse.h "corsika/ShowerReuse.h"
+
+     \brief DetectorSampler for the same shower at N core positions, reading the particles once.
+
+     A particle at p (core at the origin) hits detector d for core
+     position c if p + c is inside d, that is, if p is inside d
+     shifted by -c. The N copies of the layout, each shifted by one
+     core position, are put in a single index, so each particle is
+     looked up once and the hits for all cores come out of the same
+     query. The result is N independent sets of DetectorHits, one per
+     core position, the same as sampling the shower N times with
+     DetectorSampler::SetCore.
+     \code
+     std::vector<std::pair<double,double> > cores = ...; // N positions in the layout
+     ShowerReuse reuse(layout, cores);
+     reuse.Sample(file.GetCurrentShower(), 4);
+     double signal = reuse.GetHits(k, d).fWeight;
+     \endcode
+     */
+    struct ShowerReuse
+    {
+        /// Called for every hit. See DetectorSampler::HitCallback.
+        typedef std::function<void(const ParticleBatch& batch, size_t particle, size_t core, size_t detector, size_t thread)> HitCallback;
+
+        ShowerReuse(const std::vector<Detector>& detectors, const std::vector<std::pair<double,double> >& cores,
+                    double cellSize = 0);
+
+        size_t GetNCores() const { return fCores.size(); }
+        size_t GetNDetectors() const { return fNDetectors; }
+        const std::pair<double,double>& GetCore(size_t k) const { return fCores.at(k); }
+        const std::vector<std::pair<double,double> >& GetCores() const { return fCores; }
+        const Detector& GetDetector(size_t d) const { return fDetectors.at(d); }
+
+        void SetSelection(const ParticleSelection& selection) { fSampler.SetSelection(selection); }
+        void ClearSelection() { fSampler.ClearSelection(); }
+        void SetUseWeights(bool use) { fSampler.SetUseWeights(use); }
+        bool GetUseWeights() const { return fSampler.GetUseWeights(); }
+
+        void SetCallback(const HitCallback& callback);
+        void ClearCallback() { fSampler.ClearCallback(); }
+
+        void Sample(const ParticleBatch& batch) { fSampler.Sample(batch); }
+        void Sample(ShowerParticleStream& stream, size_t nThreads = 1) { fSampler.Sample(stream, nThreads); }
+        void Sample(const Shower& shower, size_t nThreads = 1) { fSampler.Sample(shower, nThreads); }
+
+        /// Hits in detector d with the core at position k
+        const DetectorHits& GetHits(size_t k, size_t d) const { return fSampler.GetHits(Id(k, d)); }
+        /// Number of (particle, detector) hits with the core at position k
+        size_t GetNHits(size_t k) const;
+        /// Number of (particle, core, detector) hits
+        size_t GetNHits() const { return fSampler.GetNHits(); }
+
+        void Reset() { fSampler.Reset(); }
+
+        /// The sampler of the shifted layouts, detector k*GetNDetectors() + d is detector d for core k
+        const DetectorSampler& GetSampler() const { return fSampler; }
+
+    private:
+        size_t Id(size_t k, size_t d) const;
+
+        static std::vector<Detector> Shift(const std::vector<Detector>& detectors,
+                                           const std::vector<std::pair<double,double> >& cores);
+
+        std::vector<std::pair<double,double> > fCores;
+        std::vector<Detector> fDetectors;
+        size_t fNDetectors;
+        DetectorSampler fSampler;
+    };
+}
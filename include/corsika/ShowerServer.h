@@ -0,0 +1,196 @@
+/**
+ \file
+ Local server of decoded showers in shared memory
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ColumnCache.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/ShowerParticleStream.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace corsika
+{
+    /**
+     \class ShowerServer ShowerServer.h "corsika/ShowerServer.h"
+
+     \brief Decode each requested event once and share it with local processes.
+
+     When many jobs on a node read the same showers, each of them
+     decompresses and decodes the same files. The server does it once
+     per event: it writes the decoded columns (in the ColumnCache
+     layout) to a POSIX shared memory segment, and clients map the
+     segment read-only, so the particles are in memory only once.
+
+     Clients talk to the server through a Unix socket, with one text
+     line per request and per reply:
+     - "EVENTS <file>" replies "OK <id> <id>..."
+     - "LOAD <id> <file>" replies "OK <segment name>"
+     - "STOP" replies "OK" and stops the server.
+     Errors reply "ERROR <message>". File names are the rest of the
+     line, so they may contain spaces, and must be absolute paths
+     (ShowerClient resolves relative ones in its own directory).
+
+     Segments are kept while their total size is below a memory
+     limit. Beyond it, the least recently requested ones are removed
+     (a client that mapped a segment keeps it until it unmaps it, and
+     ShowerClient asks again if a segment went away before it could
+     map it). The destructor removes the remaining segments and the
+     socket. Segments left behind by servers that did not exit
+     cleanly are removed when a server starts.
+
+     Serve waits for requests in the calling thread and answers them
+     in a pool of worker threads, so events are decoded in parallel
+     and a long decoding does not hold up the other clients. Each
+     event is decoded once even if several clients ask for it at the
+     same time, and the requests of one connection are answered in
+     order. Errors setting up the socket throw IOException.
+
+     \ingroup corsika
+     */
+    struct ShowerServer: boost::noncopyable
+    {
+        static const size_t kDefaultMemoryLimit = size_t(4) << 30;
+
+        /// Serve on a socket, keeping up to \a memoryLimit bytes of segments
+        explicit ShowerServer(const std::string& socketPath, size_t memoryLimit = kDefaultMemoryLimit);
+        ~ShowerServer();
+
+        /// Remove the segments of servers that are no longer running. Returns how many were removed.
+        static size_t RemoveStaleSegments();
+
+        /// Handle requests, in nThreads workers (0 for DefaultThreadCount), until a STOP request or a call to Stop.
+        void Serve(size_t nThreads = 0);
+        void Stop() { fStop = true; }
+
+        const std::string& GetSocketPath() const { return fSocketPath; }
+        /// Number of shared memory segments (decoded events)
+        size_t GetNSegments() const;
+        /// Total size of the segments, in bytes
+        size_t GetSegmentBytes() const;
+        size_t GetMemoryLimit() const { return fMemoryLimit; }
+
+    private:
+        typedef std::pair<std::string, unsigned int> SegmentKey;
+        struct Segment
+        {
+            std::string fName;
+            size_t fSize;
+            size_t fLastUse;
+        };
+
+        struct Connection;
+        /// Answer the complete requests of a connection (in a worker)
+        void Answer(Connection& connection);
+        std::string Handle(const std::string& request);
+        /**
+         The file with its index (it is never read from: LOAD reads a
+         copy). Called with \a lock held on fMutex; a file seen for the
+         first time is scanned with the lock released.
+         */
+        boost::shared_ptr<ShowerFile> GetFile(const std::string& path, std::unique_lock<std::mutex>& lock);
+        std::string Load(const std::string& filename, unsigned int eventId);
+        /// Remove least recently used segments, except \a keep, until they fit in the limit. Needs fMutex.
+        void Evict(const SegmentKey& keep);
+
+        std::string fSocketPath;
+        int fSocket;
+        std::atomic<bool> fStop;
+        int fWake[2];           // pipe through which workers wake up Serve
+
+        mutable std::mutex fMutex;      // for the members below
+        std::condition_variable fDecoded;
+        std::set<SegmentKey> fDecoding;
+        std::condition_variable fOpened;
+        std::set<std::string> fOpening;
+        size_t fMemoryLimit;
+        size_t fSegmentBytes;
+        size_t fNRequests;      // clock for the least recently used segment
+        std::map<std::string, boost::shared_ptr<ShowerFile> > fFiles;
+        std::map<SegmentKey, Segment> fSegments;
+    };
+
+    /**
+     \class ShowerClient ShowerServer.h "corsika/ShowerServer.h"
+
+     \brief Connection to a ShowerServer.
+
+     Errors, including the ones reported by the server, throw IOException.
+
+     \ingroup corsika
+     */
+    struct ShowerClient: boost::noncopyable
+    {
+        explicit ShowerClient(const std::string& socketPath);
+        ~ShowerClient();
+
+        /// Event numbers of the showers in a file, in file order
+        std::vector<unsigned int> GetEventIds(const std::string& filename);
+        /// Columns of an event, mapped from shared memory (the cache has only this event)
+        boost::shared_ptr<ColumnCache> Load(const std::string& filename, unsigned int eventId);
+        /// Ask the server to stop
+        void StopServer();
+
+    private:
+        std::string Request(const std::string& request);
+
+        std::string fSocketPath;
+        int fSocket;
+        std::string fBuffer;
+    };
+
+    /**
+     \class SharedShowerFile ShowerServer.h "corsika/ShowerServer.h"
+
+     \brief Particles of the showers of a file, read through a ShowerServer.
+
+     This is a particle-only view, not a replacement for ShowerFile.
+     The particle stream of the current shower is a
+     ShowerParticleStream over the shared columns, so batches,
+     selections and histograms work as usual, with the particles of
+     the observation level the server read. What the columns do not
+     hold is missing: showers have no longitudinal profiles, and
+     particles have no parent records (use the parent_pdg columns of
+     GetColumns).
+
+     \ingroup corsika
+     */
+    struct SharedShowerFile
+    {
+        SharedShowerFile(const std::string& socketPath, const std::string& filename);
+
+        /// Find an event and position to read it
+        Status FindEvent(unsigned int eventId);
+        size_t GetNEvents() const { return fEventIds.size(); }
+        const std::vector<unsigned int>& GetEventIds() const { return fEventIds; }
+
+        const Shower& GetCurrentShower() const { return fCurrentShower; }
+        Shower& GetCurrentShower() { return fCurrentShower; }
+
+        /// Run header, available once an event was found
+        const RunHeader& GetRunHeader() const;
+        /// Columns of the current event
+        boost::shared_ptr<ColumnCache> GetColumns() const { return fColumns; }
+
+    private:
+        boost::shared_ptr<ShowerClient> fClient;
+        std::string fFilename;
+        std::vector<unsigned int> fEventIds;
+        boost::shared_ptr<ColumnCache> fColumns;
+        boost::shared_ptr<ShowerParticleStream> fParticleStream;
+        Shower fCurrentShower;
+    };
+}
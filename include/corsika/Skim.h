@@ -0,0 +1,58 @@
+/**
+ \file
+ Writing a subset of the particles of a CORSIKA file
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <corsika/ParticleSelection.h>
+#include <corsika/RawStream.h>
+#include <corsika/RawStreamWriter.h>
+#include <cstdint>
+#include <string>
+
+namespace corsika
+{
+    /**
+     \brief Copy a CORSIKA file keeping only the particles passing a selection (a muon-only or footprint-only skim).
+
+     Run and event headers and trailers and longitudinal blocks are
+     copied as they are, so the output is a valid CORSIKA file that
+     can be read with ShowerFile. Particle records are repacked,
+     kParticlesInBlock per sub-block, and the muon-production and
+     history records are kept together with the particle they
+     precede. The counts in the event trailers still refer to the
+     original shower.
+
+     The selection sees the same particles as Shower::select and
+     ShowerParticleStream: times are relative to the core
+     (ShowerFrame::CoreTimeShift), and only particles of a known type
+     at the given observation level are selected. Particles at other
+     levels are dropped. Records that are not particles (Cherenkov
+     bunches) are copied without being selected. The remaining
+     differences: the level is not switched to 1 when the file has
+     fewer levels (ShowerFile does), and history records are matched
+     to the particle that follows them even when ShowerParticleStream
+     would not use them (more than two, or a second muon-production
+     record).
+
+     If fraction < 1, each selected particle is also kept with that
+     probability and its weight is divided by fraction. This needs a
+     thinned file (there is no weight otherwise) and throws
+     std::invalid_argument if it is not. The random numbers come from
+     CounterRandom(seed, i), i being the position of the particle in
+     the input.
+
+     Returns the number of particles written.
+
+     \ingroup corsika
+     */
+    size_t Skim(RawStream& input, RawStreamWriter& output, const ParticleSelection& selection,
+                double fraction = 1, uint64_t seed = 0, unsigned int observationLevel = 1);
+
+    /// Skim a file into a new one with the same layout (thinning and record markers). The output is compressed if its name ends in .gz or .bz2.
+    size_t Skim(const std::string& input, const std::string& output, const ParticleSelection& selection,
+                double fraction = 1, uint64_t seed = 0, unsigned int observationLevel = 1);
+}
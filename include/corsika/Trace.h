@@ -0,0 +1,107 @@
+/**
+ \file
+ Timeline of the reader stages, written as Chrome trace events
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace corsika
+{
+    /**
+     \class Trace Trace.h "corsika/Trace.h"
+
+     \brief Spans of what each thread was doing, for a trace viewer.
+
+     Instrumentation adds up where the time went, a trace shows when:
+     whether decompression and decoding overlap, whether the threads
+     of ShowerFile::LoadAsync keep ahead of the consumer, where a
+     thread waits. While recording, the reader adds a span for each
+     of these stages (the category of the span):
+
+      - open: RawStream::Create, ShowerFile::Open, LongFile
+      - scan: FileIndex::Scan
+      - seek: seeks of the file streams
+      - io and decompress: reads of plain and compressed files
+      - decode: particle batches (ShowerParticleStream::NextBatch),
+        profiles and the showers loaded by LoadAsync
+      - filter: ParticleSelection
+      - callback: the hit callbacks of DetectorSampler
+      - user: spans of the caller (Span, or corsika.trace.Span in python)
+
+     Each thread is a track of its own. Write saves the spans in the
+     Chrome trace event format (JSON), which chrome://tracing and
+     https://ui.perfetto.dev read.
+
+     When not recording, a span costs a call that reads a flag. The spans of
+     the reader are compiled out with CORSIKA_NO_INSTRUMENTATION
+     (see Instrumentation), the ones of the caller are not.
+
+     \ingroup corsika
+     */
+    struct Trace
+    {
+        /// Start recording (discarding the spans of earlier recordings). Spans after the first \a maxSpans are dropped.
+        static void Start(size_t maxSpans = 1 << 22);
+        /// Stop recording, keep the spans. Returns the number of spans.
+        static size_t Stop();
+        static bool IsRecording();
+        /// Spans recorded since Start
+        static size_t GetNSpans();
+        /// Spans dropped because there were more than maxSpans
+        static size_t GetNDropped();
+        /// Forget the spans
+        static void Clear();
+
+        /// Name of the track of the calling thread
+        static void SetThreadName(const std::string& name);
+
+        /// Write the spans in the Chrome trace event format (IOException if the file can not be written)
+        static void Write(const std::string& filename);
+
+        /// Nanoseconds of the clock of the spans
+        static uint64_t Now();
+        /**
+         Add a span of the calling thread. \a name and \a stage must
+         outlive the trace (string literals, or strings from Intern).
+         */
+        static void Record(const char* name, const char* stage, uint64_t start, uint64_t end);
+        /// A copy of \a s that is never freed, for names that are not literals
+        static const char* Intern(const std::string& s);
+
+        /// Records a span from construction to destruction, if recording
+        struct Span
+        {
+            Span(const char* name, const char* stage):
+                fName(IsRecording() ? name : 0), fStage(stage), fStart(fName ? Now() : 0) {}
+            ~Span()
+            {
+                if (fName)
+                    Record(fName, fStage, fStart, Now());
+            }
+
+        private:
+            Span(const Span&);
+            Span& operator=(const Span&);
+
+            const char* fName;
+            const char* fStage;
+            uint64_t fStart;
+        };
+    };
+}
+
+#define CORSIKA_TRACE_CAT2(a, b) a##b
+#define CORSIKA_TRACE_CAT(a, b) CORSIKA_TRACE_CAT2(a, b)
+
+#ifdef CORSIKA_NO_INSTRUMENTATION
+#define CORSIKA_TRACE(name, stage) ((void)0)
+#else
+/// Trace the rest of the scope as a span \a name of \a stage (string literals)
+#define CORSIKA_TRACE(name, stage) \
+    corsika::Trace::Span CORSIKA_TRACE_CAT(corsika_span_, __LINE__)(name, stage)
+#endif
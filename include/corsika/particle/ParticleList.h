@@ -41,6 +41,7 @@ namespace corsika
         static void InitCorsikaToPDGMap();
         
         static void SetList();
+        static void FillList();
         
         static std::map<int, int> corsikaToPDGMap_;
         static std::map<int, ParticleProperties> particles_;
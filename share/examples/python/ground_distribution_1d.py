@@ -22,18 +22,19 @@ f = corsika.ShowerFile(filename)
 
 print("File has %d showers"%f.n_events)
 
-h = ROOT.TH1F()
-h.SetBins(100, -6000, 6000)
-
+# the histogram is filled in C++, from batches of particles
 # corsika distance unit is cm
-i = 0
+m = corsika.units.m
+x = corsika.Histogram(corsika.HistogramAxis('x', 100, -6000*m, 6000*m))
+# count particles, as a TH1 filled one particle at a time does (thinned files are weighted by default)
+x.use_weights = False
 f.find_event(1)
-shower = f.current_shower
-for p in shower.particles:
-    h.Fill(p.x/100)
-    i += 1
-    if i > 1e4:
-        break
+x.fill(f.current_shower)
+
+h = ROOT.TH1F()
+h.SetBins(100, -6000, 6000)
+for i, c in enumerate(x.contents):
+    h.SetBinContent(i+1, c)
 
 h.SetTitle('Air-shower 1d Particle Distribution')
 h.GetXaxis().SetTitle('x/m')
@@ -22,19 +22,22 @@ f = corsika.ShowerFile(filename)
 
 print("File has %d showers"%f.n_events)
 
-h = ROOT.TH1F()
 n_bins = 50
-bins = numpy.logspace(0, 3, n_bins+1)
-h.SetBins(n_bins, bins)
 
+# logarithmic bins from 1 m to 1 km, filled by all showers in the file
+# (one thread per CPU, each reading its own showers)
 # corsika distance unit is cm
-i = 0
-for shower in f.events():
-    for p in shower.particles:
-        h.Fill(p.x/100)
-        i += 1
-        if i > 1e4:
-            break
+m = corsika.units.m
+x = corsika.Histogram(corsika.HistogramAxis('x', n_bins, 1*m, 1000*m, corsika.HistogramAxis.Scale.eLog))
+# count particles (thinned files are weighted by default)
+x.use_weights = False
+x.fill_file(filename)
+
+h = ROOT.TH1F()
+bins = numpy.array(x.edges[0])/m
+h.SetBins(n_bins, bins)
+for i, c in enumerate(x.contents):
+    h.SetBinContent(i+1, c)
 
 h.SetTitle('Air-shower 1d Particle Distribution')
 h.GetXaxis().SetTitle('x/m')
@@ -21,17 +21,20 @@ f = corsika.ShowerFile(filename)
 
 print("File has %d showers"%f.n_events)
 
+# corsika distance unit is cm
+m = corsika.units.m
+xy = corsika.Histogram(corsika.HistogramAxis('x', 100, -6000*m, 6000*m),
+                       corsika.HistogramAxis('y', 100, -6000*m, 6000*m))
+# count particles (thinned files are weighted by default)
+xy.use_weights = False
+xy.fill_file(filename)
+
 h = ROOT.TH2F()
 h.SetBins(100, -6000, 6000, 100, -6000, 6000)
-
-# corsika distance unit is cm
-i = 0
-for shower in f.events():
-    for p in shower.particles:
-        h.Fill(p.x/100, p.y/100)
-        i += 1
-        if i > 1e4:
-            break
+contents = xy.contents
+for i in range(100):
+    for j in range(100):
+        h.SetBinContent(i+1, j+1, contents[i,j])
 
 h.SetTitle('Air-shower 2d Particle Distribution')
 h.GetXaxis().SetTitle('x/m')
@@ -14,7 +14,6 @@ import ROOT
 # this is a ROOT option, you can try uncommenting it to see what happens
 ROOT.gStyle.SetOptStat(0)
 
-max_n = None
 if len(sys.argv)>1:
     filename = sys.argv[1]
 else:
@@ -28,24 +27,44 @@ print("File has %d showers"%f.n_events)
 side = 2000.
 nbins = 100
 
-distributions = {}
-distributions[corsika.Particle.Type.eElectron] = ROOT.TH2F("electrons","Electrons", nbins, -side/2, side/2, nbins, -side/2, side/2)
-distributions[corsika.Particle.Type.eMuon] = ROOT.TH2F("muons","Muons", nbins, -side/2, side/2, nbins, -side/2, side/2)
-distributions[corsika.Particle.Type.ePhoton] = ROOT.TH2F("photons","Photons", nbins, -side/2, side/2, nbins, -side/2, side/2)
-distributions[corsika.Particle.Type.eUndefined] = ROOT.TH2F("other","Other", nbins, -side/2, side/2, nbins, -side/2, side/2)
-
+# one histogram per particle type, each with its own selection
 # corsika distance unit is cm
-i = 0
+m = corsika.units.m
+E = corsika.Particle.Type
+selections = {
+    E.eElectron: 'pdg in (11, -11)',
+    E.eMuon: 'pdg in (13, -13)',
+    E.ePhoton: 'pdg == 22',
+    E.eUndefined: 'pdg not in (11, -11, 13, -13, 22)',
+}
+names = {E.eElectron: ('electrons', 'Electrons'), E.eMuon: ('muons', 'Muons'),
+         E.ePhoton: ('photons', 'Photons'), E.eUndefined: ('other', 'Other')}
+
+histograms = {}
+for p_type, selection in selections.items():
+    xy = corsika.Histogram(corsika.HistogramAxis('x', nbins, -side/2*m, side/2*m),
+                           corsika.HistogramAxis('y', nbins, -side/2*m, side/2*m))
+    xy.selection = selection
+    # count particles (thinned files are weighted by default)
+    xy.use_weights = False
+    histograms[p_type] = xy
+
+# the file is read once, each batch of particles fills all histograms
+batch = corsika.ParticleBatch()
 for shower in f.events():
-    for p in shower.particles:
-        p_type = p.pdg_code
-        if p_type in distributions.keys():
-            distributions[p_type].Fill(p.x/nbins, p.y/nbins)
-        else:
-            distributions[corsika.Particle.Type.eUndefined].Fill(p.x/nbins, p.y/nbins)
-        i += 1
-        if not max_n is None and i > max_n:
-            break
+    particles = shower.particles
+    while particles.next_batch(batch):
+        for xy in histograms.values():
+            xy.fill(batch)
+
+distributions = {}
+for p_type, xy in histograms.items():
+    contents = xy.contents
+    h = ROOT.TH2F(names[p_type][0], names[p_type][1], nbins, -side/2, side/2, nbins, -side/2, side/2)
+    for i in range(nbins):
+        for j in range(nbins):
+            h.SetBinContent(i+1, j+1, contents[i,j])
+    distributions[p_type] = h
 
 c = ROOT.TCanvas()
 c.Divide(2,2)
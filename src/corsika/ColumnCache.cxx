@@ -0,0 +1,403 @@
+/**
+ \file
+ Implementation of the memory-mapped column cache
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ColumnCache.h>
+#include <corsika/IOException.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/ShowerParticleStream.h>
+#include <corsika/particle/ParticleList.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace corsika;
+
+namespace
+{
+    const char kMagic[8] = {'C', 'O', 'R', 'S', 'C', 'O', 'L', 'S'};
+    const uint32_t kVersion = 1;
+
+    struct FileHeader
+    {
+        char fMagic[8];
+        uint32_t fVersion;
+        uint32_t fNColumns;
+        uint64_t fNEvents;
+        uint64_t fEventTable;   // offset of the EventEntry array
+    };
+    // the run header follows the file header
+
+    const char* kColumnNames[] =
+    {
+        "x", "y", "t", "px", "py", "pz", "ekin", "weight",
+        "pdg", "corsika_code", "level", "generation", "parent_pdg", "grandparent_pdg"
+    };
+
+    void write(FILE* f, const void* data, size_t size, const std::string& filename)
+    {
+        if (size && fwrite(data, 1, size, f) != size)
+            throw IOException("Error writing column cache '" + filename + "'.\n");
+    }
+
+    /// Pad the file with zeros to a multiple of the alignment. Returns the new position.
+    uint64_t align(FILE* f, size_t alignment, const std::string& filename)
+    {
+        static const char zeros[ColumnCache::kAlignment] = {0};
+        const long position = ftell(f);
+        const size_t pad = (alignment - position % alignment) % alignment;
+        write(f, zeros, pad, filename);
+        return position + pad;
+    }
+
+    int pdg_of(const Particle& p)
+    {
+        return ParticleList::CorsikaToPDG(p.CorsikaCode());
+    }
+}
+
+struct ColumnCache::EventEntry
+{
+    EventHeader fHeader;
+    EventTrailer fTrailer;
+    uint64_t fNParticles;
+    uint64_t fOffset[eNColumns];
+};
+
+std::string ColumnCache::ColumnName(Column c)
+{
+    if (c < 0 || c >= eNColumns)
+        return "";
+    return kColumnNames[c];
+}
+
+ColumnCache::Column ColumnCache::ColumnFromName(const std::string& name)
+{
+    for (int i = 0; i != eNColumns; ++i)
+    {
+        if (name == kColumnNames[i])
+            return Column(i);
+    }
+    return eNColumns;
+}
+
+const char* ColumnCache::ColumnType(Column c)
+{
+    if (c <= eWeight)
+        return "<f4";
+    if (c == eCorsikaCode || c == eLevel || c == eGeneration)
+        return "<i2";
+    return "<i4";
+}
+
+size_t ColumnCache::ColumnItemSize(Column c)
+{
+    return ColumnType(c)[2] - '0';
+}
+
+size_t ColumnCache::Convert(const std::string& corsikaFile, const std::string& cacheFile)
+{
+    ShowerFile file(corsikaFile);
+    FILE* f = fopen(cacheFile.c_str(), "wb");
+    if (!f)
+        throw IOException("Error opening column cache '" + cacheFile + "' for writing.\n");
+    boost::shared_ptr<FILE> closer(f, fclose);
+    const size_t n = Write(file, file.GetEventIds(), f, cacheFile);
+    closer.reset();
+    return n;
+}
+
+size_t ColumnCache::Write(ShowerFile& file, const std::vector<unsigned int>& ids, FILE* f, const std::string& cacheFile)
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    write(f, &header, sizeof(header), cacheFile);
+    write(f, &file.GetRunHeader(), sizeof(RunHeader), cacheFile);
+
+    std::vector<EventEntry> entries;
+    size_t total = 0;
+    ParticleBatch batch;
+    std::vector<int> parent;
+    std::vector<int> grandparent;
+    for (size_t e = 0; e != ids.size(); ++e)
+    {
+        if (file.FindEvent(ids[e]) != eSuccess)
+            throw IOException("Error reading event for '" + cacheFile + "'.\n");
+        ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+        batch.clear();
+        parent.clear();
+        grandparent.clear();
+        while (boost::optional<Particle> p = stream.NextParticle())
+        {
+            batch.push_back(*p);
+            parent.push_back(p->HasParent() ? pdg_of(p->GetParent()) : 0);
+            grandparent.push_back(p->HasGrandParent() ? pdg_of(p->GetGrandParent()) : 0);
+        }
+
+        EventEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.fHeader = file.GetCurrentShower().GetEventHeader();
+        entry.fTrailer = file.GetCurrentShower().GetEventTrailer();
+        entry.fNParticles = batch.size();
+        const void* columns[eNColumns] =
+        {
+            batch.fX.data(), batch.fY.data(), batch.fT.data(),
+            batch.fPx.data(), batch.fPy.data(), batch.fPz.data(),
+            batch.fKineticEnergy.data(), batch.fWeight.data(),
+            batch.fPDG.data(), batch.fCorsikaCode.data(), batch.fLevel.data(), batch.fGeneration.data(),
+            parent.data(), grandparent.data()
+        };
+        for (int c = 0; c != eNColumns; ++c)
+        {
+            entry.fOffset[c] = align(f, kAlignment, cacheFile);
+            write(f, columns[c], batch.size()*ColumnItemSize(Column(c)), cacheFile);
+        }
+        entries.push_back(entry);
+        total += batch.size();
+    }
+
+    std::memcpy(header.fMagic, kMagic, sizeof(kMagic));
+    header.fVersion = kVersion;
+    header.fNColumns = eNColumns;
+    header.fNEvents = entries.size();
+    header.fEventTable = align(f, kAlignment, cacheFile);
+    write(f, entries.data(), entries.size()*sizeof(EventEntry), cacheFile);
+    if (fseek(f, 0, SEEK_SET))
+        throw IOException("Error writing column cache '" + cacheFile + "'.\n");
+    write(f, &header, sizeof(header), cacheFile);
+    if (fflush(f))
+        throw IOException("Error writing column cache '" + cacheFile + "'.\n");
+    return total;
+}
+
+ColumnCache::ColumnCache(const std::string& filename, Source source):
+    fFilename(filename), fData(0), fSize(0), fNEvents(0)
+{
+    const int fd = (source == eSharedMemory ? shm_open(filename.c_str(), O_RDONLY, 0) : open(filename.c_str(), O_RDONLY));
+    if (fd < 0)
+        throw IOException("Error opening column cache '" + filename + "'.\n");
+    struct stat s;
+    if (fstat(fd, &s) || size_t(s.st_size) < sizeof(FileHeader) + sizeof(RunHeader))
+    {
+        close(fd);
+        throw IOException("Not a column cache: '" + filename + "'.\n");
+    }
+    void* data = mmap(0, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw IOException("Error mapping column cache '" + filename + "'.\n");
+    fData = static_cast<const char*>(data);
+    fSize = s.st_size;
+
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(fData);
+    std::string error;
+    if (std::memcmp(header.fMagic, kMagic, sizeof(kMagic)))
+        error = "Not a column cache: '";
+    else if (header.fVersion != kVersion || header.fNColumns != eNColumns)
+        error = "Unsupported column cache version in '";
+    else if (header.fEventTable > fSize || header.fNEvents > (fSize - header.fEventTable)/sizeof(EventEntry))
+        error = "Truncated column cache '";
+    if (error.empty())
+    {
+        fNEvents = header.fNEvents;
+        for (size_t e = 0; e != fNEvents && error.empty(); ++e)
+        {
+            const EventEntry& entry = GetEntry(e);
+            for (int c = 0; c != eNColumns; ++c)
+            {
+                if (entry.fOffset[c] > fSize || entry.fNParticles > (fSize - entry.fOffset[c])/ColumnItemSize(Column(c)))
+                    error = "Truncated column cache '";
+            }
+        }
+    }
+    if (!error.empty())
+    {
+        munmap(const_cast<char*>(fData), fSize);
+        throw IOException(error + filename + "'.\n");
+    }
+}
+
+ColumnCache::~ColumnCache()
+{
+    munmap(const_cast<char*>(fData), fSize);
+}
+
+const RunHeader& ColumnCache::GetRunHeader() const
+{
+    return *reinterpret_cast<const RunHeader*>(fData + sizeof(FileHeader));
+}
+
+size_t ColumnCache::GetNEvents() const
+{
+    return fNEvents;
+}
+
+const ColumnCache::EventEntry& ColumnCache::GetEntry(size_t event) const
+{
+    if (event >= fNEvents)
+        throw std::out_of_range("ColumnCache: event out of range");
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(fData);
+    return reinterpret_cast<const EventEntry*>(fData + header.fEventTable)[event];
+}
+
+size_t ColumnCache::FindEvent(unsigned int eventId) const
+{
+    for (size_t e = 0; e != fNEvents; ++e)
+    {
+        if (unsigned(GetEntry(e).fHeader.fEventNumber) == eventId)
+            return e;
+    }
+    return fNEvents;
+}
+
+const EventHeader& ColumnCache::GetEventHeader(size_t event) const
+{
+    return GetEntry(event).fHeader;
+}
+
+const EventTrailer& ColumnCache::GetEventTrailer(size_t event) const
+{
+    return GetEntry(event).fTrailer;
+}
+
+size_t ColumnCache::GetNParticles(size_t event) const
+{
+    return GetEntry(event).fNParticles;
+}
+
+unsigned int ColumnCache::GetObservationLevel(size_t event) const
+{
+    if (!GetNParticles(event))
+        return 1;
+    return GetShorts(event, eLevel)[0] + 1;
+}
+
+const void* ColumnCache::GetData(size_t event, Column c) const
+{
+    if (c < 0 || c >= eNColumns)
+        throw std::out_of_range("ColumnCache: column out of range");
+    return fData + GetEntry(event).fOffset[c];
+}
+
+template <class T>
+ColumnSpan<T> ColumnCache::GetSpan(size_t event, Column c, const char* type) const
+{
+    if (c < 0 || c >= eNColumns || std::strcmp(ColumnType(c), type))
+        throw std::invalid_argument("ColumnCache: column " + ColumnName(c) + " is not of the requested type");
+    return ColumnSpan<T>(static_cast<const T*>(GetData(event, c)), GetNParticles(event));
+}
+
+ColumnSpan<float> ColumnCache::GetFloats(size_t event, Column c) const
+{
+    return GetSpan<float>(event, c, "<f4");
+}
+
+ColumnSpan<int> ColumnCache::GetInts(size_t event, Column c) const
+{
+    return GetSpan<int>(event, c, "<i4");
+}
+
+ColumnSpan<short> ColumnCache::GetShorts(size_t event, Column c) const
+{
+    return GetSpan<short>(event, c, "<i2");
+}
+
+void ColumnCache::GetBatch(size_t event, ParticleBatch& batch) const
+{
+    batch.clear();
+    ColumnSpan<float> f;
+    f = GetFloats(event, eX); batch.fX.assign(f.begin(), f.end());
+    f = GetFloats(event, eY); batch.fY.assign(f.begin(), f.end());
+    f = GetFloats(event, eT); batch.fT.assign(f.begin(), f.end());
+    f = GetFloats(event, ePx); batch.fPx.assign(f.begin(), f.end());
+    f = GetFloats(event, ePy); batch.fPy.assign(f.begin(), f.end());
+    f = GetFloats(event, ePz); batch.fPz.assign(f.begin(), f.end());
+    f = GetFloats(event, eKineticEnergy); batch.fKineticEnergy.assign(f.begin(), f.end());
+    f = GetFloats(event, eWeight); batch.fWeight.assign(f.begin(), f.end());
+    ColumnSpan<int> pdg = GetInts(event, ePDG);
+    batch.fPDG.assign(pdg.begin(), pdg.end());
+    ColumnSpan<short> s;
+    s = GetShorts(event, eCorsikaCode); batch.fCorsikaCode.assign(s.begin(), s.end());
+    s = GetShorts(event, eLevel); batch.fLevel.assign(s.begin(), s.end());
+    s = GetShorts(event, eGeneration); batch.fGeneration.assign(s.begin(), s.end());
+}
+
+namespace
+{
+    /// Particle records rebuilt from the columns of one event
+    struct ColumnParticleStream: VRawParticleStream
+    {
+        ColumnParticleStream(boost::shared_ptr<const ColumnCache> cache, size_t event):
+            fCache(cache), fN(cache->GetNParticles(event)), fCurrent(0)
+        {
+            fX = cache->GetFloats(event, ColumnCache::eX).data();
+            fY = cache->GetFloats(event, ColumnCache::eY).data();
+            fT = cache->GetFloats(event, ColumnCache::eT).data();
+            fPx = cache->GetFloats(event, ColumnCache::ePx).data();
+            fPy = cache->GetFloats(event, ColumnCache::ePy).data();
+            fPz = cache->GetFloats(event, ColumnCache::ePz).data();
+            fWeight = cache->GetFloats(event, ColumnCache::eWeight).data();
+            fCode = cache->GetShorts(event, ColumnCache::eCorsikaCode).data();
+            fLevel = cache->GetShorts(event, ColumnCache::eLevel).data();
+            fGeneration = cache->GetShorts(event, ColumnCache::eGeneration).data();
+        }
+
+        boost::optional<Particle> NextParticle()
+        {
+            if (fCurrent == fN)
+                return boost::optional<Particle>();
+            const size_t i = fCurrent++;
+            ParticleData<Thinned> r;
+            r.fDescription = fCode[i]*1000. + fGeneration[i]*10 + fLevel[i] + 1;
+            r.fPx = fPx[i];
+            r.fPy = fPy[i];
+            r.fPz = fPz[i];
+            r.fX = fX[i];
+            r.fY = fY[i];
+            r.fTorZ = fT[i];
+            r.fWeight = fWeight[i];
+            return Particle(r);
+        }
+        void Rewind() { fCurrent = 0; }
+        bool IsValid() const { return true; }
+        bool AtBlockStart() const { return fCurrent != fN && fCurrent % kParticlesInBlock == 0; }
+        bool SkipBlock()
+        {
+            if (fCurrent == fN)
+                return false;
+            fCurrent = std::min(fN, fCurrent + kParticlesInBlock);
+            return true;
+        }
+        void SetEnd(size_t) {}
+
+    private:
+        boost::shared_ptr<const ColumnCache> fCache;
+        size_t fN;
+        size_t fCurrent;
+        const float* fX;
+        const float* fY;
+        const float* fT;
+        const float* fPx;
+        const float* fPy;
+        const float* fPz;
+        const float* fWeight;
+        const short* fCode;
+        const short* fLevel;
+        const short* fGeneration;
+    };
+}
+
+RawParticleStreamPtr ColumnCache::CreateParticleStream(boost::shared_ptr<const ColumnCache> cache, size_t event)
+{
+    return RawParticleStreamPtr(new ColumnParticleStream(cache, event));
+}
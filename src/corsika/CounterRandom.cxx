@@ -0,0 +1,39 @@
+/**
+ \file
+ Implementation of the counter-based random numbers
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/CounterRandom.h>
+#include <corsika/Constants.h>
+#include <cmath>
+
+using namespace corsika;
+
+CounterRandom::CounterRandom(uint64_t seed, uint64_t key1, uint64_t key2):
+    fKey(Mix(Mix(Mix(seed) ^ key1) ^ key2)), fCounter(0)
+{
+}
+
+uint64_t CounterRandom::Mix(uint64_t x)
+{
+    // the splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+double CounterRandom::Uniform()
+{
+    return (Mix(fKey + fCounter++) >> 11)*(1./9007199254740992.); // 53 bits
+}
+
+double CounterRandom::Gaussian()
+{
+    const double u = 1 - Uniform(); // in (0, 1]
+    const double v = Uniform();
+    return std::sqrt(-2*std::log(u))*std::cos(2*kPi*v);
+}
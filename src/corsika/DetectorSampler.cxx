@@ -0,0 +1,227 @@
+/**
+ \file
+ Implementation of the detector sampling engine
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/DetectorSampler.h>
+#include <corsika/Constants.h>
+#include <corsika/Parallel.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerParticleStream.h>
+#include <corsika/Trace.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace corsika;
+
+Detector Detector::Circle(double x, double y, double radius)
+{
+    if (!(radius > 0))
+        throw std::invalid_argument("Detector::Circle: the radius must be positive");
+    Detector d = { eCircle, x, y, radius, 2*radius, 2*radius, 0 };
+    return d;
+}
+
+Detector Detector::Rectangle(double x, double y, double dx, double dy, double angle)
+{
+    if (!(dx > 0 && dy > 0))
+        throw std::invalid_argument("Detector::Rectangle: the sides must be positive");
+    Detector d = { eRectangle, x, y, 0.5*std::sqrt(dx*dx + dy*dy), dx, dy, angle };
+    return d;
+}
+
+double Detector::GetArea() const
+{
+    if (fShape == eCircle)
+        return kPi*fRadius*fRadius;
+    return fDx*fDy;
+}
+
+std::vector<std::pair<unsigned int,unsigned int> >
+DetectorCollision::operator()(const std::vector<double>& x, const std::vector<double>& y, const Detector& d) const
+{
+    return detail::to_bins(Coverage(x, y, d));
+}
+
+std::vector<detail::CellCoverage>
+DetectorCollision::Coverage(const std::vector<double>& x, const std::vector<double>& y, const Detector& d) const
+{
+    if (d.fShape == Detector::eCircle)
+        return CircleCollision<Detector>().Coverage(x, y, d);
+    return RotatedSquareCollision<Detector>().Coverage(x, y, d);
+}
+
+bool DetectorCollision::Contains(const Detector& d, double x, double y) const
+{
+    return Prepare(d).Contains(x, y);
+}
+
+DetectorCollision::Shape DetectorCollision::Prepare(const Detector& d)
+{
+    Shape shape;
+    shape.fCircle = (d.fShape == Detector::eCircle);
+    shape.fDisk = CircleCollision<Detector>::Prepare(d);
+    shape.fRectangle = RotatedSquareCollision<Detector>::Prepare(d);
+    return shape;
+}
+
+void DetectorHits::Add(const DetectorHits& other)
+{
+    fEntries += other.fEntries;
+    fWeight += other.fWeight;
+    fSumW2 += other.fSumW2;
+    fEnergy += other.fEnergy;
+    fFirstTime = std::min(fFirstTime, other.fFirstTime);
+}
+
+DetectorSampler::DetectorSampler(const std::vector<Detector>& detectors, double cellSize):
+    fDetectors(detectors), fIndex(MakeIndex(detectors, cellSize)),
+    fCoreX(0), fCoreY(0), fUseWeights(true), fHits(detectors.size())
+{
+}
+
+boost::shared_ptr<DetectorSampler::index_type>
+DetectorSampler::MakeIndex(const std::vector<Detector>& detectors, double cellSize)
+{
+    if (detectors.empty())
+        throw std::invalid_argument("DetectorSampler: no detectors");
+
+    // bounding box of the layout, the index is one cell larger on each side
+    double xmin = HUGE_VAL, xmax = -HUGE_VAL, ymin = HUGE_VAL, ymax = -HUGE_VAL;
+    double extent = 0;
+    for (size_t d = 0; d != detectors.size(); ++d)
+    {
+        const Detector& det = detectors[d];
+        xmin = std::min(xmin, det.fX - det.fRadius);
+        xmax = std::max(xmax, det.fX + det.fRadius);
+        ymin = std::min(ymin, det.fY - det.fRadius);
+        ymax = std::max(ymax, det.fY + det.fRadius);
+        extent = std::max(extent, 2*det.fRadius);
+    }
+    if (!(cellSize > 0))
+    {
+        // about one detector per cell, but not smaller than a detector
+        const double area = (xmax - xmin)*(ymax - ymin);
+        cellSize = std::max(extent, std::sqrt(area/detectors.size()));
+    }
+    // a few thousand bins per axis is more than enough for any layout
+    const unsigned int kMaxBins = 4096;
+    const unsigned int xbins = std::min(kMaxBins, (unsigned int)(std::ceil((xmax - xmin)/cellSize)) + 2);
+    const unsigned int ybins = std::min(kMaxBins, (unsigned int)(std::ceil((ymax - ymin)/cellSize)) + 2);
+    const double xcenter = 0.5*(xmin + xmax);
+    const double ycenter = 0.5*(ymin + ymax);
+    const double xsize = std::max(xbins*cellSize, 1.01*(xmax - xmin));
+    const double ysize = std::max(ybins*cellSize, 1.01*(ymax - ymin));
+    boost::shared_ptr<index_type> index(new index_type(xcenter - xsize/2, xcenter + xsize/2, xbins,
+                                                     ycenter - ysize/2, ycenter + ysize/2, ybins));
+    for (size_t d = 0; d != detectors.size(); ++d)
+        index->Add(detectors[d]);
+    index->Build();
+    return index;
+}
+
+void DetectorSampler::SetSelection(const ParticleSelection& selection)
+{
+    fSelection.reset(new ParticleSelection(selection));
+}
+
+void DetectorSampler::Sample(const ParticleBatch& batch, std::vector<DetectorHits>& hits, size_t thread) const
+{
+    const size_t n = batch.size();
+    if (!n)
+        return;
+
+    std::vector<char> mask;
+    if (fSelection)
+        fSelection->Evaluate(batch, mask);
+
+    // particle positions in the layout frame
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    for (size_t i = 0; i != n; ++i)
+    {
+        x[i] = batch.fX[i] + fCoreX;
+        y[i] = batch.fY[i] + fCoreY;
+    }
+    std::vector<unsigned int> particles;
+    std::vector<unsigned int> detectors;
+    fIndex->QueryContained(x.data(), y.data(), n, particles, detectors);
+
+    for (size_t k = 0; k != particles.size(); ++k)
+    {
+        const size_t i = particles[k];
+        if (fSelection && !mask[i])
+            continue;
+        DetectorHits& h = hits[detectors[k]];
+        const double w = fUseWeights ? batch.fWeight[i] : 1.;
+        ++h.fEntries;
+        h.fWeight += w;
+        h.fSumW2 += w*w;
+        h.fEnergy += w*batch.fKineticEnergy[i];
+        h.fFirstTime = std::min(h.fFirstTime, double(batch.fT[i]));
+    }
+
+    if (!fCallback || particles.empty())
+        return;
+    // one span for all the callbacks of the batch, so they do not crowd the other stages out of the trace
+    CORSIKA_TRACE("DetectorSampler::HitCallback", "callback");
+    for (size_t k = 0; k != particles.size(); ++k)
+    {
+        const size_t i = particles[k];
+        if (fSelection && !mask[i])
+            continue;
+        fCallback(batch, i, detectors[k], thread);
+    }
+}
+
+void DetectorSampler::Sample(const ParticleBatch& batch)
+{
+    Sample(batch, fHits, 0);
+}
+
+void DetectorSampler::Sample(ShowerParticleStream& stream, size_t nThreads)
+{
+    if (!nThreads)
+        nThreads = DefaultThreadCount();
+
+    if (nThreads == 1)
+    {
+        ParticleBatch batch;
+        while (stream.NextBatch(batch))
+            Sample(batch, fHits, 0);
+        return;
+    }
+
+    // Same scheme as Histogram::Fill: batches are decoded here while
+    // the threads sample them, batch k goes to thread k % nThreads.
+    std::vector<std::vector<DetectorHits> > partial(nThreads, std::vector<DetectorHits>(fDetectors.size()));
+    ParallelPipeline<ParticleBatch>(nThreads,
+        [&](ParticleBatch& batch) { return stream.NextBatch(batch) != 0; },
+        [&](const ParticleBatch& batch, size_t t) { Sample(batch, partial[t], t); });
+    for (size_t t = 0; t != nThreads; ++t)
+    {
+        for (size_t d = 0; d != fHits.size(); ++d)
+            fHits[d].Add(partial[t][d]);
+    }
+}
+
+void DetectorSampler::Sample(const Shower& shower, size_t nThreads)
+{
+    Sample(shower.ParticleStream(), nThreads);
+}
+
+size_t DetectorSampler::GetNHits() const
+{
+    size_t n = 0;
+    for (size_t d = 0; d != fHits.size(); ++d)
+        n += fHits[d].fEntries;
+    return n;
+}
+
+void DetectorSampler::Reset()
+{
+    fHits.assign(fDetectors.size(), DetectorHits());
+}
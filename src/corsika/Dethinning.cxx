@@ -0,0 +1,243 @@
+/**
+ \file
+ Implementation of the de-thinning engine
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/Dethinning.h>
+#include <corsika/Constants.h>
+#include <corsika/Parallel.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerParticleStream.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace corsika;
+
+DethinningKernel::DethinningKernel():
+    fVertexDistance(500*m), fVertexSpread(0.2), fConeAngle(3*deg), fMaxZenith(75*deg)
+{
+}
+
+double DethinningKernel::GetMaxVertexDistance() const
+{
+    return fVertexDistance*(1 + 5*fVertexSpread);
+}
+
+double DethinningKernel::GetReach(double zenith) const
+{
+    if (zenith > fMaxZenith)
+        return 0;
+    // the farthest point of the cone footprint is in the plane of the track
+    const double outer = std::min(zenith + fConeAngle, 0.5*kPi);
+    if (outer >= 0.5*kPi)
+        return HUGE_VAL;
+    return GetMaxVertexDistance()*std::cos(zenith)*(std::tan(outer) - std::tan(zenith));
+}
+
+Dethinner::Dethinner(const std::vector<Detector>& detectors, const DethinningKernel& kernel, uint64_t seed):
+    fDetectors(detectors), fKernel(kernel), fSeed(seed),
+    fMaxReach(kernel.GetReach(kernel.fMaxZenith)),
+    fCoreX(0), fCoreY(0),
+    fParticles(detectors.size()), fNRead(0), fNGenerated(0)
+{
+    if (!(kernel.fVertexDistance > 0) || !(kernel.fVertexSpread >= 0) || !(kernel.fConeAngle >= 0))
+        throw std::invalid_argument("Dethinner: the vertex distance must be positive and the spread and cone angle non-negative");
+    if (!(kernel.fMaxZenith + kernel.fConeAngle < 0.5*kPi))
+        throw std::invalid_argument("Dethinner: the maximum zenith angle plus the cone angle must be below 90 degrees");
+
+    // the reach grows with the zenith angle, so this is enough for any particle
+    std::vector<Detector> enlarged;
+    for (size_t d = 0; d != detectors.size(); ++d)
+    {
+        enlarged.push_back(Detector::Circle(detectors[d].fX, detectors[d].fY, detectors[d].fRadius + fMaxReach));
+        fShapes.push_back(DetectorCollision::Prepare(detectors[d]));
+    }
+    fIndex = DetectorSampler::MakeIndex(enlarged);
+}
+
+void Dethinner::SetSelection(const ParticleSelection& selection)
+{
+    fSelection.reset(new ParticleSelection(selection));
+}
+
+void Dethinner::Sample(const ParticleBatch& batch, size_t first, Output& out) const
+{
+    const size_t n = batch.size();
+    if (!n)
+        return;
+
+    std::vector<char> mask;
+    if (fSelection)
+        fSelection->Evaluate(batch, mask);
+
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    for (size_t i = 0; i != n; ++i)
+    {
+        x[i] = batch.fX[i] + fCoreX;
+        y[i] = batch.fY[i] + fCoreY;
+    }
+    // (particle, detector) pairs, grouped by particle
+    std::vector<unsigned int> particles;
+    std::vector<unsigned int> near;
+    fIndex->QueryContained(x.data(), y.data(), n, particles, near);
+
+    const double maxDistance = fKernel.GetMaxVertexDistance();
+    const double cosCone = std::cos(fKernel.fConeAngle);
+    std::vector<unsigned int> candidates;
+    for (size_t k = 0; k != particles.size(); )
+    {
+        const size_t i = particles[k];
+        size_t end = k;
+        while (end != particles.size() && particles[end] == i)
+            ++end;
+        if (fSelection && !mask[i])
+        {
+            k = end;
+            continue;
+        }
+
+        const double px = batch.fPx[i];
+        const double py = batch.fPy[i];
+        const double pz = batch.fPz[i];
+        const double p = std::sqrt(px*px + py*py + pz*pz);
+        const double weight = batch.fWeight[i];
+        const double zenith = (p > 0 ? std::acos(std::min(1., pz/p)) : 0.);
+
+        if (weight <= 1 || p == 0 || zenith > fKernel.fMaxZenith)
+        {
+            // kept as it is
+            for (; k != end; ++k)
+            {
+                if (fShapes[near[k]].Contains(x[i], y[i]))
+                    out.fParticles[near[k]].push_back(batch, i);
+            }
+            continue;
+        }
+
+        const double reach = fKernel.GetReach(zenith);
+        candidates.clear();
+        for (; k != end; ++k)
+        {
+            const Detector& det = fDetectors[near[k]];
+            if (std::hypot(x[i] - det.fX, y[i] - det.fY) <= det.fRadius + reach)
+                candidates.push_back(near[k]);
+        }
+        if (candidates.empty())
+            continue;
+
+        // direction of motion (z up) and two vectors perpendicular to it
+        const double ux = px/p, uy = py/p, uz = -pz/p;
+        double ax = 0, ay = 0, az = 1;
+        if (std::fabs(uz) > 0.9)
+        {
+            ax = 1;
+            az = 0;
+        }
+        double e1x = ay*uz - az*uy, e1y = az*ux - ax*uz, e1z = ax*uy - ay*ux;
+        const double norm = std::sqrt(e1x*e1x + e1y*e1y + e1z*e1z);
+        e1x /= norm;
+        e1y /= norm;
+        e1z /= norm;
+        const double e2x = uy*e1z - uz*e1y, e2y = uz*e1x - ux*e1z, e2z = ux*e1y - uy*e1x;
+
+        const uint64_t id = first + i;
+        CounterRandom count(fSeed, id);
+        const size_t copies = size_t(weight) + (count.Uniform() < weight - std::floor(weight));
+        out.fNGenerated += copies;
+        for (size_t j = 0; j != copies; ++j)
+        {
+            CounterRandom random(fSeed, id, j + 1);
+            double distance = fKernel.fVertexDistance*(1 + fKernel.fVertexSpread*random.Gaussian());
+            distance = std::max(0., std::min(distance, maxDistance));
+            const double cosBeta = 1 - random.Uniform()*(1 - cosCone);
+            const double sinBeta = std::sqrt(std::max(0., 1 - cosBeta*cosBeta));
+            const double phi = 2*kPi*random.Uniform();
+            const double c = sinBeta*std::cos(phi);
+            const double s = sinBeta*std::sin(phi);
+            const double vx = cosBeta*ux + c*e1x + s*e2x;
+            const double vy = cosBeta*uy + c*e1y + s*e2y;
+            const double vz = cosBeta*uz + c*e1z + s*e2z;
+            if (vz >= 0)
+                continue;
+
+            // from the vertex (distance back along the track) down to the ground
+            const double height = -distance*uz;
+            const double path = height/(-vz);
+            const double gx = x[i] - distance*ux + path*vx;
+            const double gy = y[i] - distance*uy + path*vy;
+            for (size_t l = 0; l != candidates.size(); ++l)
+            {
+                if (!fShapes[candidates[l]].Contains(gx, gy))
+                    continue;
+                ParticleBatch& b = out.fParticles[candidates[l]];
+                b.push_back(batch, i);
+                b.fX.back() = gx - fCoreX;
+                b.fY.back() = gy - fCoreY;
+                b.fT.back() = batch.fT[i] + (path - distance)/kSpeedOfLight;
+                b.fPx.back() = p*vx;
+                b.fPy.back() = p*vy;
+                b.fPz.back() = -p*vz;
+                b.fWeight.back() = 1;
+            }
+        }
+    }
+}
+
+void Dethinner::Merge(Output& out)
+{
+    for (size_t d = 0; d != fParticles.size(); ++d)
+        fParticles[d].Append(out.fParticles[d]);
+    fNGenerated += out.fNGenerated;
+}
+
+void Dethinner::Sample(const ParticleBatch& batch)
+{
+    Output out(fDetectors.size());
+    Sample(batch, fNRead, out);
+    fNRead += batch.size();
+    Merge(out);
+}
+
+void Dethinner::Sample(ShowerParticleStream& stream, size_t nThreads)
+{
+    // batches are decoded here while the threads resample them, and
+    // the output of each batch is appended in order, so the result
+    // does not depend on the number of threads
+    struct Item
+    {
+        Item(): fFirst(0), fOutput(0) {}
+        ParticleBatch fBatch;
+        size_t fFirst;
+        Output fOutput;
+    };
+    const size_t nDetectors = fDetectors.size();
+    ParallelPipeline<Item>(nThreads,
+        [&](Item& item)
+        {
+            if (!stream.NextBatch(item.fBatch))
+                return false;
+            item.fFirst = fNRead;
+            fNRead += item.fBatch.size();
+            item.fOutput = Output(nDetectors);
+            return true;
+        },
+        [&](Item& item, size_t) { Sample(item.fBatch, item.fFirst, item.fOutput); },
+        [&](Item& item) { Merge(item.fOutput); });
+}
+
+void Dethinner::Sample(const Shower& shower, size_t nThreads)
+{
+    Sample(shower.ParticleStream(), nThreads);
+}
+
+void Dethinner::Reset()
+{
+    fParticles.assign(fDetectors.size(), ParticleBatch());
+    fNRead = 0;
+    fNGenerated = 0;
+}
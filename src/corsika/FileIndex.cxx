@@ -1,4 +1,6 @@
 #include <corsika/FileIndex.h>
+#include <corsika/Instrumentation.h>
+#include <corsika/Trace.h>
 #include <sstream>
 
 using namespace corsika;
@@ -66,6 +68,7 @@ template <class Thinning> void Scan(FileIndex& index, RawStream& stream, bool fo
         
         if (blockIndex >400 && !foundEventHeader) break;
     }
+    CORSIKA_COUNT(eScannedBlocks, blockIndex);
     
     if (!blockUnth.IsRunTrailer())
     {
@@ -94,6 +97,8 @@ template <class Thinning> void Scan(FileIndex& index, RawStream& stream, bool fo
 
 void FileIndex::Scan(RawStream& stream, bool force)
 {
+    CORSIKA_TIME(eScanTime);
+    CORSIKA_TRACE("FileIndex::Scan", "scan");
     if (stream.IsThinned()) ::Scan<Thinned>(*this, stream, force);
     else ::Scan<NotThinned>(*this, stream, force);
 }
@@ -1,10 +1,22 @@
 #include <corsika/FileStream.h>
+#include <corsika/Instrumentation.h>
+#include <corsika/Trace.h>
 #include <stdio.h>
 #include <string.h>
 #include <zlib.h>
 #include <bzlib.h>
 #include <sys/stat.h>
 
+static inline void count_decompressed(long n)
+{
+    CORSIKA_COUNT(eReads, 1);
+    if (n > 0)
+    {
+        CORSIKA_COUNT(eBytesRead, n);
+        CORSIKA_COUNT(eBytesDecompressed, n);
+    }
+}
+
 struct RawFileStream: FileStream
 {
     FILE* file;
@@ -15,10 +27,18 @@ struct RawFileStream: FileStream
     }
     long read(size_t num, void* bytes)
     {
-        return fread(bytes, 1, num, file);
+        CORSIKA_TIME(eReadTime);
+        CORSIKA_TRACE("fread", "io");
+        long n = fread(bytes, 1, num, file);
+        CORSIKA_COUNT(eReads, 1);
+        CORSIKA_COUNT(eBytesRead, n);
+        return n;
     }
     bool seek(size_t absolute_position)
     {
+        CORSIKA_TIME(eSeekTime);
+        CORSIKA_TRACE("fseek", "seek");
+        CORSIKA_COUNT(eSeeks, 1);
         return fseek(file, absolute_position, SEEK_SET) == 0;
     }
 };
@@ -32,10 +52,18 @@ struct GzFileStream: FileStream
     }
     long read(size_t num, void* bytes)
     {
-        return gzread(file, bytes, (unsigned)num);
+        CORSIKA_TIME(eDecompressTime);
+        CORSIKA_TRACE("gzread", "decompress");
+        long n = gzread(file, bytes, (unsigned)num);
+        count_decompressed(n);
+        return n;
     }
     bool seek(size_t absolute_position)
     {
+        // forward seeks decompress up to the position
+        CORSIKA_TIME(eSeekTime);
+        CORSIKA_TRACE("gzseek", "seek");
+        CORSIKA_COUNT(eSeeks, 1);
         return gzseek(file, absolute_position, SEEK_SET) != -1;
     }
 };
@@ -49,7 +77,11 @@ struct Bz2FileStream: FileStream
     }
     long read(size_t num, void* bytes)
     {
-        return BZ2_bzread(f, bytes, (int)num);
+        CORSIKA_TIME(eDecompressTime);
+        CORSIKA_TRACE("BZ2_bzread", "decompress");
+        long n = BZ2_bzread(f, bytes, (int)num);
+        count_decompressed(n);
+        return n;
     }
     bool seek(size_t absolute_position)
     {
@@ -87,3 +119,90 @@ FileStream* FileStream::open(const char* filename)
     }
     return 0;
 }
+
+struct RawOutputFileStream: OutputFileStream
+{
+    FILE* file;
+    RawOutputFileStream(FILE* file): file(file)
+    {
+        setvbuf(file, 0, _IOFBF, 1 << 20);
+    }
+    ~RawOutputFileStream()
+    {
+        close();
+    }
+    bool write(size_t num, const void* bytes)
+    {
+        return fwrite(bytes, 1, num, file) == num;
+    }
+    bool close()
+    {
+        if (!file) return true;
+        bool ok = fclose(file) == 0;
+        file = 0;
+        return ok;
+    }
+};
+struct GzOutputFileStream: OutputFileStream
+{
+    gzFile file;
+    GzOutputFileStream(gzFile file): file(file)
+    {
+        gzbuffer(file, 1 << 20);
+    }
+    ~GzOutputFileStream()
+    {
+        close();
+    }
+    bool write(size_t num, const void* bytes)
+    {
+        return gzwrite(file, bytes, (unsigned)num) == (int)num;
+    }
+    bool close()
+    {
+        if (!file) return true;
+        bool ok = gzclose(file) == Z_OK;
+        file = 0;
+        return ok;
+    }
+};
+struct Bz2OutputFileStream: OutputFileStream
+{
+    BZFILE* f;
+    Bz2OutputFileStream(BZFILE* f): f(f) {}
+    ~Bz2OutputFileStream()
+    {
+        close();
+    }
+    bool write(size_t num, const void* bytes)
+    {
+        return BZ2_bzwrite(f, const_cast<void*>(bytes), (int)num) == (int)num;
+    }
+    bool close()
+    {
+        if (!f) return true;
+        BZ2_bzclose(f);
+        f = 0;
+        return true;
+    }
+};
+
+OutputFileStream* OutputFileStream::open(const char* filename)
+{
+    if (ends_with(filename, ".gz"))
+    {
+        if (gzFile f = gzopen(filename, "wb6"))
+            return new GzOutputFileStream(f);
+    }
+    else if (ends_with(filename, ".bz2"))
+    {
+        if (BZFILE* f = BZ2_bzopen(filename, "wb"))
+            return new Bz2OutputFileStream(f);
+    }
+    else
+    {
+        if (FILE* f = fopen(filename, "wb"))
+            return new RawOutputFileStream(f);
+    }
+    return 0;
+}
@@ -0,0 +1,421 @@
+/**
+ \file
+ Implementation of the Gaisser-Hillas fitter
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/GaisserHillasFitter.h>
+#include <corsika/Parallel.h>
+#include <corsika/Units.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace corsika;
+
+namespace
+{
+    // parameter indices
+    enum
+    {
+        iNMax,
+        iXMax,
+        iXZero,
+        iA,
+        iB,
+        iC,
+        kMaxParameters
+    };
+
+    const double kInfinity = std::numeric_limits<double>::infinity();
+
+    struct Point
+    {
+        double fX;
+        double fY;
+        double fWeight;     // 1/sigma^2
+    };
+
+    /**
+     Value of the function at x and, if gradient is not null, its
+     derivatives with respect to the parameters. Returns false where
+     the parameters are not valid.
+     */
+    bool evaluate(const double* p, size_t nPar, double x, double& value, double* gradient)
+    {
+        const double lambda = p[iA] + (nPar > iB ? x*(p[iB] + x*p[iC]) : 0.);
+        const double d = p[iXMax] - p[iXZero];
+        if (!(lambda > 0) || !(d > 0) || !(p[iNMax] > 0))
+            return false;
+        const double u = x - p[iXZero];
+        if (u <= 0)
+        {
+            value = 0;
+            if (gradient)
+                std::fill(gradient, gradient + nPar, 0.);
+            return true;
+        }
+        const double logRatio = std::log(u/d);
+        const double exponent = (d*logRatio + p[iXMax] - x)/lambda;
+        value = p[iNMax]*std::exp(exponent);
+        if (gradient)
+        {
+            // d(log N)/dp times N
+            gradient[iNMax] = value/p[iNMax];
+            gradient[iXMax] = value*logRatio/lambda;
+            gradient[iXZero] = value*(1 - d/u - logRatio)/lambda;
+            const double dLambda = -value*exponent/lambda;
+            gradient[iA] = dLambda;
+            if (nPar > iB)
+            {
+                gradient[iB] = x*dLambda;
+                gradient[iC] = x*x*dLambda;
+            }
+        }
+        return true;
+    }
+
+    /// chi^2 and, if a is not null, the normal equations a.delta = g
+    double chi_square(const std::vector<Point>& points, const double* p, size_t nPar, double* a, double* g)
+    {
+        if (a)
+        {
+            std::fill(a, a + nPar*nPar, 0.);
+            std::fill(g, g + nPar, 0.);
+        }
+        double chi2 = 0;
+        double gradient[kMaxParameters];
+        for (size_t i = 0; i != points.size(); ++i)
+        {
+            const Point& point = points[i];
+            double value;
+            if (!evaluate(p, nPar, point.fX, value, a ? gradient : 0))
+                return kInfinity;
+            const double residual = point.fY - value;
+            chi2 += point.fWeight*residual*residual;
+            if (!a)
+                continue;
+            for (size_t j = 0; j != nPar; ++j)
+            {
+                const double wj = point.fWeight*gradient[j];
+                g[j] += wj*residual;
+                for (size_t k = 0; k <= j; ++k)
+                    a[j*nPar + k] += wj*gradient[k];
+            }
+        }
+        if (a)
+        {
+            for (size_t j = 0; j != nPar; ++j)
+                for (size_t k = 0; k < j; ++k)
+                    a[k*nPar + j] = a[j*nPar + k];
+        }
+        return chi2;
+    }
+
+    /// Solve m.x = b (n x n, m and b are overwritten), false if singular
+    bool solve(double* m, double* b, size_t n, double* x)
+    {
+        for (size_t col = 0; col != n; ++col)
+        {
+            size_t pivot = col;
+            for (size_t row = col + 1; row != n; ++row)
+            {
+                if (std::fabs(m[row*n + col]) > std::fabs(m[pivot*n + col]))
+                    pivot = row;
+            }
+            if (!(std::fabs(m[pivot*n + col]) > 0))
+                return false;
+            if (pivot != col)
+            {
+                for (size_t k = 0; k != n; ++k)
+                    std::swap(m[col*n + k], m[pivot*n + k]);
+                std::swap(b[col], b[pivot]);
+            }
+            for (size_t row = col + 1; row != n; ++row)
+            {
+                const double f = m[row*n + col]/m[col*n + col];
+                for (size_t k = col; k != n; ++k)
+                    m[row*n + k] -= f*m[col*n + k];
+                b[row] -= f*b[col];
+            }
+        }
+        for (size_t i = n; i-- != 0;)
+        {
+            double sum = b[i];
+            for (size_t k = i + 1; k != n; ++k)
+                sum -= m[i*n + k]*x[k];
+            x[i] = sum/m[i*n + i];
+        }
+        return true;
+    }
+
+    /// Inverse of a (n x n), false if singular
+    bool invert(const double* a, size_t n, double* inverse)
+    {
+        for (size_t col = 0; col != n; ++col)
+        {
+            double m[kMaxParameters*kMaxParameters];
+            double b[kMaxParameters] = {0};
+            double x[kMaxParameters];
+            std::copy(a, a + n*n, m);
+            b[col] = 1;
+            if (!solve(m, b, n, x))
+                return false;
+            for (size_t row = 0; row != n; ++row)
+                inverse[row*n + col] = x[row];
+        }
+        return true;
+    }
+
+    /**
+     Levenberg-Marquardt minimization of chi^2, starting at p. Returns
+     the minimum chi^2 (infinite if the start is not valid) and the
+     covariance of the parameters.
+     */
+    double minimize(const std::vector<Point>& points, double* p, size_t nPar, size_t maxIterations,
+                    double* covariance)
+    {
+        double a[kMaxParameters*kMaxParameters];
+        double g[kMaxParameters];
+        double chi2 = chi_square(points, p, nPar, a, g);
+        if (!std::isfinite(chi2))
+            return kInfinity;
+
+        double mu = 1e-3;
+        for (size_t iteration = 0; iteration != maxIterations; ++iteration)
+        {
+            // Marquardt's scaling makes the step independent of the parameter units
+            double m[kMaxParameters*kMaxParameters];
+            double b[kMaxParameters];
+            double delta[kMaxParameters];
+            std::copy(a, a + nPar*nPar, m);
+            std::copy(g, g + nPar, b);
+            for (size_t j = 0; j != nPar; ++j)
+                m[j*nPar + j] += mu*(a[j*nPar + j] > 0 ? a[j*nPar + j] : 1.);
+
+            double trial[kMaxParameters];
+            double trialChi2 = kInfinity;
+            bool small = false;
+            if (solve(m, b, nPar, delta))
+            {
+                small = true;
+                for (size_t j = 0; j != nPar; ++j)
+                {
+                    trial[j] = p[j] + delta[j];
+                    small = small && std::fabs(delta[j]) <= 1e-10*std::fabs(p[j]) + 1e-300;
+                }
+                trialChi2 = chi_square(points, trial, nPar, 0, 0);
+            }
+
+            if (trialChi2 < chi2)
+            {
+                small = small || chi2 - trialChi2 <= 1e-12*chi2;
+                std::copy(trial, trial + nPar, p);
+                chi2 = chi_square(points, p, nPar, a, g);
+                mu = std::max(mu/10, 1e-12);
+                if (small)
+                    break;
+            }
+            else
+            {
+                mu *= 10;
+                if (mu > 1e12 || small)
+                    break;
+            }
+        }
+
+        if (!invert(a, nPar, covariance))
+            std::fill(covariance, covariance + nPar*nPar, 0.);
+        return chi2;
+    }
+
+    /// Points of a profile passing the cuts
+    std::vector<Point> select(const double* depth, const double* values, size_t n, GaisserHillasFitter::Errors errors,
+                              double minDepth, double maxDepth, double minFraction)
+    {
+        // a profile ends where the depths stop increasing
+        size_t used = n ? 1 : 0;
+        while (used < n && depth[used] > depth[used - 1])
+            ++used;
+
+        double maximum = 0;
+        for (size_t i = 0; i != used; ++i)
+        {
+            if (depth[i] >= minDepth && depth[i] <= maxDepth)
+                maximum = std::max(maximum, values[i]);
+        }
+
+        std::vector<Point> points;
+        points.reserve(used);
+        for (size_t i = 0; i != used; ++i)
+        {
+            if (depth[i] < minDepth || depth[i] > maxDepth || values[i] < minFraction*maximum)
+                continue;
+            Point point;
+            point.fX = depth[i];
+            point.fY = values[i];
+            point.fWeight = (errors == GaisserHillasFitter::ePoisson ? 1/std::max(values[i], 1.) : 1.);
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    /// Starting values from the maximum of the profile and its mean and width
+    bool start(const std::vector<Point>& points, double* p)
+    {
+        size_t k = 0;
+        for (size_t i = 1; i != points.size(); ++i)
+        {
+            if (points[i].fY > points[k].fY)
+                k = i;
+        }
+        if (!(points[k].fY > 0))
+            return false;
+        p[iXMax] = points[k].fX;
+        p[iNMax] = points[k].fY;
+
+        if (k > 0 && k + 1 < points.size())
+        {
+            // parabola through the maximum and its neighbours
+            const double x0 = points[k-1].fX, x1 = points[k].fX, x2 = points[k+1].fX;
+            const double y0 = points[k-1].fY, y1 = points[k].fY, y2 = points[k+1].fY;
+            const double denominator = (x0 - x1)*(x0 - x2)*(x1 - x2);
+            const double a = (x2*(y1 - y0) + x1*(y0 - y2) + x0*(y2 - y1))/denominator;
+            const double b = (x2*x2*(y0 - y1) + x1*x1*(y2 - y0) + x0*x0*(y1 - y2))/denominator;
+            const double c = (x1*x2*(x1 - x2)*y0 + x2*x0*(x2 - x0)*y1 + x0*x1*(x0 - x1)*y2)/denominator;
+            const double vertex = -b/(2*a);
+            if (a < 0 && vertex > x0 && vertex < x2)
+            {
+                p[iXMax] = vertex;
+                p[iNMax] = std::max(c + vertex*(b + vertex*a), y1);
+            }
+        }
+
+        // with constant L the profile is a gamma distribution in (X - X0)/L:
+        // mean = XMax + L and variance = L (XMax - X0 + L)
+        double sum = 0, sumX = 0, sumX2 = 0;
+        for (size_t i = 0; i != points.size(); ++i)
+        {
+            const double lower = (i ? points[i-1].fX : points[i].fX);
+            const double upper = (i + 1 < points.size() ? points[i+1].fX : points[i].fX);
+            const double w = std::max(points[i].fY, 0.)*(upper - lower)/2;
+            sum += w;
+            sumX += w*points[i].fX;
+            sumX2 += w*points[i].fX*points[i].fX;
+        }
+        double lambda = 60;
+        double width = 0;
+        if (sum > 0)
+        {
+            const double mean = sumX/sum;
+            width = std::max(sumX2/sum - mean*mean, 0.);
+            if (mean - p[iXMax] > 10 && mean - p[iXMax] < 150)
+                lambda = mean - p[iXMax];
+        }
+        const double w = std::max(width/(lambda*lambda) - 1, 2.);
+        p[iXZero] = std::min(p[iXMax] - lambda*w, points[0].fX - 1);
+        p[iA] = lambda;
+        p[iB] = 0;
+        p[iC] = 0;
+        return true;
+    }
+}
+
+
+GaisserHillasFitter::GaisserHillasFitter(const Form form, const Errors errors):
+    fForm(form),
+    fErrors(errors),
+    fMinDepth(-std::numeric_limits<double>::max()),
+    fMaxDepth(std::numeric_limits<double>::max()),
+    fMinFraction(0),
+    fMaxIterations(200)
+{
+}
+
+GaisserHillasParameter GaisserHillasFitter::Fit(const double* depth, const double* values, size_t n) const
+{
+    return FitColumn(depth, values, n, false);
+}
+
+GaisserHillasParameter GaisserHillasFitter::Fit(const std::vector<double>& depth, const std::vector<double>& values) const
+{
+    return FitColumn(depth.data(), values.data(), std::min(depth.size(), values.size()), false);
+}
+
+GaisserHillasParameter GaisserHillasFitter::Fit(const LongProfile& profile, const ProfileTable::Column c) const
+{
+    const ProfileTable& table = profile.fProfiles;
+    return FitColumn(table.Get(ProfileTable::DepthColumn(c)), table.Get(c), table.GetNBins(c), c == ProfileTable::edEdX);
+}
+
+std::vector<GaisserHillasParameter>
+GaisserHillasFitter::Fit(const std::vector<LongProfile>& profiles, const ProfileTable::Column c, const size_t nThreads) const
+{
+    std::vector<GaisserHillasParameter> out(profiles.size());
+    ParallelFor(profiles.size(), nThreads,
+                [&](size_t i, size_t)
+                {
+                    out[i] = Fit(profiles[i], c);
+                });
+    return out;
+}
+
+std::vector<GaisserHillasParameter>
+GaisserHillasFitter::Fit(const LongCache& cache, const ProfileTable::Column c, const size_t nThreads) const
+{
+    std::vector<GaisserHillasParameter> out(cache.size());
+    ParallelFor(cache.size(), nThreads,
+                [&](size_t i, size_t)
+                {
+                    const ColumnSpan<double> values = cache.GetColumn(i, c);
+                    out[i] = FitColumn(cache.GetColumn(i, ProfileTable::DepthColumn(c)).data(), values.data(), values.size(),
+                                       c == ProfileTable::edEdX);
+                });
+    return out;
+}
+
+GaisserHillasParameter GaisserHillasFitter::FitColumn(const double* depth, const double* values, size_t n,
+                                                      bool isEnergyDeposit) const
+{
+    GaisserHillasParameter gh;
+    const std::vector<Point> points = select(depth, values, n, fErrors, fMinDepth, fMaxDepth, fMinFraction);
+    const size_t nPar = (fForm == eSixParameters ? 6 : 4);
+    double p[kMaxParameters];
+    if (points.size() <= nPar || !start(points, p))
+        return gh;
+
+    double covariance[kMaxParameters*kMaxParameters];
+    double chi2 = minimize(points, p, 4, fMaxIterations, covariance);
+    if (nPar == 6)
+    {
+        double p6[kMaxParameters];
+        std::copy(p, p + kMaxParameters, p6);
+        if (!std::isfinite(chi2))
+            start(points, p6);
+        const double chi6 = minimize(points, p6, 6, fMaxIterations, covariance);
+        if (!std::isfinite(chi6))
+            return gh;
+        chi2 = chi6;
+        std::copy(p6, p6 + kMaxParameters, p);
+    }
+    if (!std::isfinite(chi2))
+        return gh;
+
+    const double depthUnit = g/cm2;
+    const double* const cov = covariance;
+    double error[kMaxParameters] = {0};
+    for (size_t j = 0; j != nPar; ++j)
+        error[j] = std::sqrt(std::max(cov[j*nPar + j], 0.));
+    gh.SetNMax(p[iNMax], error[iNMax], isEnergyDeposit);
+    gh.SetXMax(p[iXMax]*depthUnit, error[iXMax]*depthUnit);
+    gh.SetXZero(p[iXZero]*depthUnit, error[iXZero]*depthUnit);
+    gh.SetA(p[iA]*depthUnit, error[iA]*depthUnit);
+    gh.SetB(p[iB], error[iB]);
+    gh.SetC(p[iC]/depthUnit, error[iC]/depthUnit);
+    if (error[iNMax] > 0 && error[iXMax] > 0)
+        gh.SetNMaxXMaxCorrelation(cov[iNMax*nPar + iXMax]/(error[iNMax]*error[iXMax]));
+    gh.SetChiSquare(chi2, points.size() - nPar);
+    return gh;
+}
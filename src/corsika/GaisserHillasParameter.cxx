@@ -1,16 +1,25 @@
 #include <corsika/GaisserHillasParameter.h>
+#include <corsika/Parallel.h>
+#include "fast_math.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 using namespace std;
 using namespace corsika;
 
-static void log(const std::string& mess)
-{
-    std::cout << mess << std::endl;
-}
-#define WARNING(mess) log(mess);
-
 GaisserHillasParameter::GaisserHillasParameter():
+    fXMax(0.0),
+    fXMaxError(0.0),
+    fNMax(0.0),
+    fNMaxError(0.0),
+    fRhoNMaxXMax(0.0),
+    fChiSqr(0.0),
+    fNdof(0),
+    fGammaIntegral(0.0),
+    fGammaError(0.0),
+    fIsEnergyDeposit(false),
     fXZero(0.0),
     fXZeroError(0.0),
     fA(0.0),
@@ -34,6 +43,48 @@ double GaisserHillasParameter::Eval(const double depth) const
     exp((fXMax - depth) / lambda);
 }
 
+void GaisserHillasParameter::Eval(const double* depths, double* out, size_t n) const
+{
+    // N = NMax exp((d (log u - log d) + XMax - X)/lambda) with u = X - X0 and d = XMax - X0
+    const double d = fXMax - fXZero;
+    if (!(d > 0))
+    {
+        std::fill(out, out + n, 0.);
+        return;
+    }
+    // local copies, out could alias the members
+    const double nMax = fNMax;
+    const double xMax = fXMax;
+    const double xZero = fXZero;
+    const double a = fA;
+    const double b = fB;
+    const double c = fC;
+    const double logD = log(d);
+    for (size_t i = 0; i != n; ++i)
+    {
+        const double x = depths[i];
+        const double u = x - xZero;
+        const double lambda = a + x*(b + x*c);
+        // everything is computed for every depth, with meaningless values
+        // outside the range, and then selected
+        const double exponent = ((detail::fast_log(u) - logD)*d + xMax - x)/lambda;
+        const double value = nMax*detail::fast_exp(exponent);
+        const uint64_t mask = detail::positive_mask(u) & detail::positive_mask(lambda) &
+                              detail::below_mask(std::fabs(exponent), 708.);
+        out[i] = detail::from_bits(detail::to_bits(value) & mask);
+    }
+}
+
+void GaisserHillasParameter::Eval(const std::vector<GaisserHillasParameter>& showers,
+                                  const double* depths, size_t n, double* out, size_t nThreads)
+{
+    ParallelFor(showers.size(), nThreads,
+                [&](size_t i, size_t)
+                {
+                    showers[i].Eval(depths, out + i*n, n);
+                });
+}
+
 void GaisserHillasParameter::Dump(ostream& os) const
 {
     static const double g = 1;
@@ -52,12 +103,74 @@ void GaisserHillasParameter::Dump(ostream& os) const
 
 double GaisserHillasParameter::GetIntegral() const
 {
-    WARNING("not implemented!");
-    return 0.;
+    if (fNMax <= 0 || fXMax <= fXZero || fA <= 0)
+        return 0.;
+    
+    if (!fB && !fC)
+    {
+        // constant lambda: in t = (X - X0)/lambda it is a gamma function,
+        // NMax lambda (e/w)^w Gamma(w + 1) with w = (XMax - X0)/lambda
+        const double w = (fXMax - fXZero)/fA;
+        return fNMax*fA*exp(w - w*log(w) + lgamma(w + 1));
+    }
+    
+    // Simpson's rule in steps of lambda(XMax)/50, until the tail is negligible
+    // or lambda stops being positive
+    const double lambdaMax = fA + fXMax*(fB + fXMax*fC);
+    if (lambdaMax <= 0)
+        return 0.;
+    const double step = lambdaMax/50;
+    double integral = 0;
+    double x = fXZero;
+    double previous = 0;
+    for (size_t i = 0; i != 1000000; ++i)
+    {
+        const double end = x + step;
+        if (fA + end*(fB + end*fC) <= 0)
+            break;
+        const double middle = Eval(x + step/2);
+        const double next = Eval(end);
+        integral += step/6*(previous + 4*middle + next);
+        x = end;
+        previous = next;
+        if (x > fXMax && next < 1e-12*fNMax)
+            break;
+    }
+    return integral;
 }
 
 double GaisserHillasParameter::GetIntegralError() const
 {
-    WARNING("not implemented!");
-    return 0.;
+    const double integral = GetIntegral();
+    if (integral <= 0)
+        return 0.;
+    
+    // numerical derivatives with respect to each parameter, using the
+    // NMax-XMax correlation and treating the others as independent
+    const double dNMax = integral/fNMax;
+    double dXMax = 0;
+    double variance = dNMax*dNMax*fNMaxError*fNMaxError;
+    for (int i = 0; i != 5; ++i)
+    {
+        const double errors[5] = {fXMaxError, fXZeroError, fAError, fBError, fCError};
+        if (!(errors[i] > 0))
+            continue;
+        const double h = 1e-3*errors[i];
+        GaisserHillasParameter up(*this);
+        GaisserHillasParameter down(*this);
+        switch (i)
+        {
+        case 0: up.fXMax += h; down.fXMax -= h; break;
+        case 1: up.fXZero += h; down.fXZero -= h; break;
+        case 2: up.fA += h; down.fA -= h; break;
+        case 3: up.fB += h; down.fB -= h; break;
+        default: up.fC += h; down.fC -= h; break;
+        }
+        const double derivative = (up.GetIntegral() - down.GetIntegral())/(2*h);
+        variance += derivative*derivative*errors[i]*errors[i];
+        if (!i)
+            dXMax = derivative;
+    }
+    variance += 2*fRhoNMaxXMax*dNMax*dXMax*fNMaxError*fXMaxError;
+    return sqrt(std::max(variance, 0.));
 }
@@ -0,0 +1,321 @@
+/**
+ \file
+ Implementation of the particle histograms
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/Histogram.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/ShowerParticleStream.h>
+#include <corsika/Parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace corsika;
+
+HistogramAxis::HistogramAxis():
+    fColumn(ParticleBatch::eX), fScale(eLinear), fNBins(0),
+    fMin(0), fMax(0), fScaleFactor(0)
+{}
+
+HistogramAxis::HistogramAxis(ParticleBatch::Column column, size_t nBins, double min, double max, Scale scale):
+    fColumn(column), fScale(scale), fNBins(nBins), fMin(min), fMax(max), fScaleFactor(0)
+{
+    if (column < 0 || column >= ParticleBatch::eNColumns)
+        throw std::invalid_argument("HistogramAxis: invalid column");
+    if (scale != eLinear && scale != eLog)
+        throw std::invalid_argument("HistogramAxis: uniform bins must be linear or logarithmic");
+    if (!nBins || !(min < max))
+        throw std::invalid_argument("HistogramAxis: need at least one bin and min < max");
+    if (scale == eLog)
+    {
+        if (min <= 0)
+            throw std::invalid_argument("HistogramAxis: logarithmic bins need a positive range");
+        fMin = std::log10(min);
+        fMax = std::log10(max);
+    }
+    fScaleFactor = nBins/(fMax - fMin);
+
+    fEdges.resize(nBins + 1);
+    for (size_t i = 0; i <= nBins; ++i)
+    {
+        const double e = fMin + i*(fMax - fMin)/nBins;
+        fEdges[i] = (scale == eLog ? std::pow(10., e) : e);
+    }
+    fEdges.front() = min;
+    fEdges.back() = max;
+}
+
+HistogramAxis::HistogramAxis(ParticleBatch::Column column, const std::vector<double>& values, Scale scale):
+    fColumn(column), fScale(scale), fNBins(0), fMin(0), fMax(0), fScaleFactor(0), fEdges(values)
+{
+    if (column < 0 || column >= ParticleBatch::eNColumns)
+        throw std::invalid_argument("HistogramAxis: invalid column");
+    if (scale == eEdges)
+    {
+        if (values.size() < 2)
+            throw std::invalid_argument("HistogramAxis: need at least two bin edges");
+        for (size_t i = 1; i != values.size(); ++i)
+        {
+            if (!(values[i-1] < values[i]))
+                throw std::invalid_argument("HistogramAxis: bin edges must be increasing");
+        }
+        fNBins = values.size() - 1;
+        fMin = values.front();
+        fMax = values.back();
+    }
+    else if (scale == eCategories)
+    {
+        if (values.empty())
+            throw std::invalid_argument("HistogramAxis: need at least one category");
+        fNBins = values.size();
+    }
+    else
+        throw std::invalid_argument("HistogramAxis: a list of values needs edges or categories");
+}
+
+int HistogramAxis::FindBin(double value) const
+{
+    switch (fScale)
+    {
+        case eLinear:
+        case eLog:
+        {
+            if (fScale == eLog)
+            {
+                if (!(value > 0))
+                    return -1;
+                value = std::log10(value);
+            }
+            if (!(value >= fMin && value < fMax))
+                return -1;
+            const size_t bin = size_t((value - fMin)*fScaleFactor);
+            return int(std::min(bin, fNBins - 1));
+        }
+        case eEdges:
+        {
+            if (!(value >= fMin && value < fMax))
+                return -1;
+            return int(std::upper_bound(fEdges.begin(), fEdges.end(), value) - fEdges.begin()) - 1;
+        }
+        case eCategories:
+        {
+            for (size_t i = 0; i != fNBins; ++i)
+            {
+                if (value == fEdges[i])
+                    return int(i);
+            }
+            return -1;
+        }
+    }
+    return -1;
+}
+
+void HistogramAxis::FindBins(const double* values, size_t n, int* bins) const
+{
+    if (fScale == eLinear)
+    {
+        // the common case gets its own loop without the switch
+        const int last = int(fNBins) - 1;
+        for (size_t i = 0; i != n; ++i)
+        {
+            const double v = values[i];
+            // convert only values in range: the conversion of NaN or of large values is undefined
+            bins[i] = (v >= fMin && v < fMax) ? std::min(int((v - fMin)*fScaleFactor), last) : -1;
+        }
+        return;
+    }
+    for (size_t i = 0; i != n; ++i)
+        bins[i] = FindBin(values[i]);
+}
+
+bool HistogramAxis::operator==(const HistogramAxis& other) const
+{
+    return fColumn == other.fColumn && fScale == other.fScale && fEdges == other.fEdges;
+}
+
+
+Histogram::Histogram(const HistogramAxis& x):
+    fUseWeights(true)
+{
+    fAxes.push_back(x);
+    Init();
+}
+
+Histogram::Histogram(const HistogramAxis& x, const HistogramAxis& y):
+    fUseWeights(true)
+{
+    fAxes.push_back(x);
+    fAxes.push_back(y);
+    Init();
+}
+
+Histogram::Histogram(const HistogramAxis& x, const HistogramAxis& y, const HistogramAxis& z):
+    fUseWeights(true)
+{
+    fAxes.push_back(x);
+    fAxes.push_back(y);
+    fAxes.push_back(z);
+    Init();
+}
+
+void Histogram::Init()
+{
+    fStrides.assign(fAxes.size(), 1);
+    size_t size = 1;
+    for (size_t a = fAxes.size(); a-- != 0;)
+    {
+        fStrides[a] = size;
+        size *= fAxes[a].GetNBins();
+    }
+    fContents.assign(size, 0.);
+    fSumW2.assign(size, 0.);
+    fEntries = 0;
+    fOutside = 0;
+}
+
+void Histogram::SetSelection(const ParticleSelection& selection)
+{
+    fSelection.reset(new ParticleSelection(selection));
+}
+
+void Histogram::Reset()
+{
+    std::fill(fContents.begin(), fContents.end(), 0.);
+    std::fill(fSumW2.begin(), fSumW2.end(), 0.);
+    fEntries = 0;
+    fOutside = 0;
+}
+
+double Histogram::GetBinContent(size_t i, size_t j, size_t k) const
+{
+    size_t index = i*fStrides[0];
+    if (fAxes.size() > 1)
+        index += j*fStrides[1];
+    if (fAxes.size() > 2)
+        index += k*fStrides[2];
+    return fContents.at(index);
+}
+
+void Histogram::Fill(const ParticleBatch& batch)
+{
+    const size_t n = batch.size();
+    if (!n)
+        return;
+
+    std::vector<char> mask;
+    if (fSelection)
+        fSelection->Evaluate(batch, mask);
+
+    // global bin of each particle, -1 once it falls outside one of the axes
+    std::vector<int> index(n, 0);
+    std::vector<int> bins(n);
+    std::vector<double> values(n);
+    for (size_t a = 0; a != fAxes.size(); ++a)
+    {
+        batch.GetColumn(fAxes[a].GetColumn(), values.data());
+        fAxes[a].FindBins(values.data(), n, bins.data());
+        const int stride = int(fStrides[a]);
+        for (size_t i = 0; i != n; ++i)
+            index[i] = (index[i] < 0 || bins[i] < 0) ? -1 : index[i] + bins[i]*stride;
+    }
+
+    for (size_t i = 0; i != n; ++i)
+    {
+        if (fSelection && !mask[i])
+            continue;
+        const double w = (fUseWeights ? batch.fWeight[i] : 1.);
+        if (index[i] < 0)
+        {
+            fOutside += w;
+            continue;
+        }
+        fContents[index[i]] += w;
+        fSumW2[index[i]] += w*w;
+        ++fEntries;
+    }
+}
+
+void Histogram::Fill(ShowerParticleStream& stream, size_t nThreads)
+{
+    if (!nThreads)
+        nThreads = DefaultThreadCount();
+
+    if (nThreads == 1)
+    {
+        ParticleBatch batch;
+        while (stream.NextBatch(batch))
+            Fill(batch);
+        return;
+    }
+
+    // batches are decoded here while the threads fill them, batch k
+    // always goes to partial[k % nThreads]
+    Histogram empty(*this);
+    empty.Reset();
+    std::vector<Histogram> partial(nThreads, empty);
+    ParallelPipeline<ParticleBatch>(nThreads,
+        [&](ParticleBatch& batch) { return stream.NextBatch(batch) != 0; },
+        [&](const ParticleBatch& batch, size_t t) { partial[t].Fill(batch); });
+    for (size_t t = 0; t != nThreads; ++t)
+        Add(partial[t]);
+}
+
+void Histogram::FillFile(const std::string& filename, size_t nThreads)
+{
+    // scanned once, the copies of the threads share the index
+    ShowerFile file(filename);
+    const std::vector<unsigned int> ids = file.GetEventIds();
+    if (!nThreads)
+        nThreads = DefaultThreadCount();
+    nThreads = std::max(size_t(1), std::min(nThreads, ids.size()));
+    std::vector<ShowerFile> files(nThreads);
+    for (size_t t = 0; t != nThreads; ++t)
+        files[t].OpenCopy(file);
+
+    Histogram empty(*this);
+    empty.Reset();
+    std::vector<Histogram> partial(nThreads, empty);
+    ParallelFor(nThreads, nThreads,
+        [&](size_t t, size_t)
+        {
+            for (size_t event = t; event < ids.size(); event += nThreads)
+            {
+                if (files[t].FindEvent(ids[event]) != eSuccess)
+                {
+                    std::ostringstream msg;
+                    msg << "Histogram::FillFile: cannot read event " << ids[event] << " from " << filename;
+                    throw IOException(msg.str());
+                }
+                partial[t].Fill(files[t].GetCurrentShower().ParticleStream(), 1);
+            }
+        });
+    for (size_t t = 0; t != nThreads; ++t)
+        Add(partial[t]);
+}
+
+void Histogram::Add(const Histogram& other)
+{
+    if (fAxes.size() != other.fAxes.size())
+        throw std::invalid_argument("Histogram::Add: histograms have different dimensions");
+    for (size_t a = 0; a != fAxes.size(); ++a)
+    {
+        if (fAxes[a] != other.fAxes[a])
+        {
+            std::ostringstream msg;
+            msg << "Histogram::Add: axis " << a << " has a different binning";
+            throw std::invalid_argument(msg.str());
+        }
+    }
+    for (size_t i = 0; i != fContents.size(); ++i)
+    {
+        fContents[i] += other.fContents[i];
+        fSumW2[i] += other.fSumW2[i];
+    }
+    fEntries += other.fEntries;
+    fOutside += other.fOutside;
+}
@@ -0,0 +1,186 @@
+/**
+ \file
+ Implementation of the counters of the reader
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/Instrumentation.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace corsika;
+
+namespace
+{
+    const char* kCounterNames[] =
+    {
+        "bytes_read", "bytes_decompressed", "reads", "seeks", "disk_blocks", "scanned_blocks",
+        "particle_blocks", "skipped_blocks", "particle_records", "particles_emitted",
+        "particles_filtered", "long_profiles"
+    };
+    const char* kTimerNames[] =
+    {
+        "read", "decompress", "seek", "scan", "long_parse"
+    };
+
+    const size_t kNValues = Instrumentation::eNCounters + Instrumentation::eNTimers;
+
+    /// The counters of a thread, followed by its timers (ns). Only the thread writes them.
+    struct ThreadCounters
+    {
+        ThreadCounters()
+        {
+            for (size_t i = 0; i != kNValues; ++i)
+                fValues[i].store(0, std::memory_order_relaxed);
+        }
+
+        void Add(size_t i, uint64_t n)
+        {
+            // a plain add, the atomic only makes the reads of other threads well defined
+            fValues[i].store(fValues[i].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t> fValues[kNValues];
+    };
+
+    struct Registry
+    {
+        std::mutex fMutex;
+        std::vector<ThreadCounters*> fThreads;
+        uint64_t fFinished[kNValues];   // threads that exited
+        uint64_t fZero[kNValues];       // totals at the last Reset
+
+        Registry()
+        {
+            std::fill(fFinished, fFinished + kNValues, 0);
+            std::fill(fZero, fZero + kNValues, 0);
+        }
+
+        // with the lock
+        uint64_t Total(size_t i) const
+        {
+            uint64_t total = fFinished[i];
+            for (size_t t = 0; t != fThreads.size(); ++t)
+                total += fThreads[t]->fValues[i].load(std::memory_order_relaxed);
+            return total;
+        }
+    };
+
+    Registry& registry()
+    {
+        static Registry* r = new Registry;  // never destroyed, threads can exit after main
+        return *r;
+    }
+
+    /// Moves the counts of a thread to the registry when it exits
+    struct ThreadExit
+    {
+        ThreadExit(): fCounters(0) {}
+        ~ThreadExit()
+        {
+            if (!fCounters)
+                return;
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.fMutex);
+            for (size_t i = 0; i != kNValues; ++i)
+                r.fFinished[i] += fCounters->fValues[i].load(std::memory_order_relaxed);
+            r.fThreads.erase(std::find(r.fThreads.begin(), r.fThreads.end(), fCounters));
+            delete fCounters;
+        }
+        ThreadCounters* fCounters;
+    };
+
+    thread_local ThreadCounters* tCounters = 0;
+
+    ThreadCounters& thread_counters()
+    {
+        if (!tCounters)
+        {
+            static thread_local ThreadExit exit;
+            ThreadCounters* counters = new ThreadCounters;
+            Registry& r = registry();
+            {
+                std::lock_guard<std::mutex> lock(r.fMutex);
+                r.fThreads.push_back(counters);
+            }
+            exit.fCounters = counters;
+            tCounters = counters;
+        }
+        return *tCounters;
+    }
+
+    uint64_t get(size_t i)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.fMutex);
+        return r.Total(i) - r.fZero[i];
+    }
+}
+
+std::string Instrumentation::CounterName(Counter c)
+{
+    if (c < 0 || c >= eNCounters)
+        return "";
+    return kCounterNames[c];
+}
+
+std::string Instrumentation::TimerName(Timer t)
+{
+    if (t < 0 || t >= eNTimers)
+        return "";
+    return kTimerNames[t];
+}
+
+bool Instrumentation::IsEnabled()
+{
+#ifdef CORSIKA_NO_INSTRUMENTATION
+    return false;
+#else
+    return true;
+#endif
+}
+
+uint64_t Instrumentation::Get(Counter c)
+{
+    if (c < 0 || c >= eNCounters)
+        throw std::out_of_range("Instrumentation: counter out of range");
+    return get(c);
+}
+
+double Instrumentation::Get(Timer t)
+{
+    if (t < 0 || t >= eNTimers)
+        throw std::out_of_range("Instrumentation: timer out of range");
+    return get(eNCounters + t)*1e-9;
+}
+
+void Instrumentation::Reset()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.fMutex);
+    for (size_t i = 0; i != kNValues; ++i)
+        r.fZero[i] = r.Total(i);
+}
+
+void Instrumentation::Dump(std::ostream& os)
+{
+    for (int c = 0; c != eNCounters; ++c)
+        os << CounterName(Counter(c)) << " " << Get(Counter(c)) << '\n';
+    for (int t = 0; t != eNTimers; ++t)
+        os << TimerName(Timer(t)) << " " << Get(Timer(t)) << " s\n";
+}
+
+void Instrumentation::Add(Counter c, uint64_t n)
+{
+    thread_counters().Add(c, n);
+}
+
+void Instrumentation::AddTime(Timer t, uint64_t ns)
+{
+    thread_counters().Add(eNCounters + t, ns);
+}
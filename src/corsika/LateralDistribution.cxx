@@ -0,0 +1,196 @@
+/**
+ \file
+ Implementation of the lateral distribution engine
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/LateralDistribution.h>
+#include <corsika/Constants.h>
+#include <corsika/ShowerFrame.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/Parallel.h>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace corsika;
+
+LateralDistribution::LateralDistribution(const HistogramAxis& radius, Plane plane, double timeAccuracy):
+    fRadius(radius), fPlane(plane), fTimeAccuracy(timeAccuracy),
+    fZenith(0), fAzimuth(0), fShowerNumber(0)
+{
+    if (radius.GetScale() == HistogramAxis::eCategories)
+        throw std::invalid_argument("LateralDistribution: the radius axis needs bins, not categories");
+    if (radius.GetEdges().front() < 0)
+        throw std::invalid_argument("LateralDistribution: the radius axis starts below zero");
+}
+
+size_t LateralDistribution::AddClass(const std::string& name, const ParticleSelection& selection)
+{
+    Class c = { name, selection };
+    fClasses.push_back(c);
+    fBins.resize(fClasses.size()*GetNBins(), Bin(fTimeAccuracy));
+    return fClasses.size() - 1;
+}
+
+void LateralDistribution::AddDefaultClasses()
+{
+    AddClass("photon", ParticleSelection("pdg == 22"));
+    AddClass("electron", ParticleSelection("pdg in (11, -11)"));
+    AddClass("muon", ParticleSelection("pdg in (13, -13)"));
+    AddClass("hadron", ParticleSelection("pdg not in (22, 11, -11, 13, -13)"));
+}
+
+size_t LateralDistribution::FindClass(const std::string& name) const
+{
+    for (size_t c = 0; c != fClasses.size(); ++c)
+    {
+        if (fClasses[c].fName == name)
+            return c;
+    }
+    return fClasses.size();
+}
+
+void LateralDistribution::SetGeometry(double zenith, double azimuth)
+{
+    fZenith = zenith;
+    fAzimuth = azimuth;
+}
+
+void LateralDistribution::SetGeometry(const Shower& shower)
+{
+    const ShowerFrame frame(shower);
+    SetGeometry(frame.GetZenith(), frame.GetAzimuth());
+    fShowerNumber = shower.GetShowerNumber();
+}
+
+double LateralDistribution::GetArea(size_t bin) const
+{
+    const std::vector<double>& edges = fRadius.GetEdges();
+    return kPi*(edges.at(bin + 1)*edges.at(bin + 1) - edges.at(bin)*edges.at(bin));
+}
+
+double LateralDistribution::GetDensityError(size_t c, size_t bin) const
+{
+    return std::sqrt(GetSumW2(c, bin))/GetArea(bin);
+}
+
+double LateralDistribution::GetTimeQuantile(size_t c, size_t bin, double q) const
+{
+    return GetTimes(c, bin).GetQuantile(q);
+}
+
+void LateralDistribution::Fill(const ParticleBatch& batch)
+{
+    const size_t n = batch.size();
+    if (!n)
+        return;
+
+    // distance and time in the chosen plane, computed once for all classes
+    std::vector<double> r(n);
+    std::vector<double> t(n);
+    if (fPlane == eGround)
+    {
+        for (size_t i = 0; i != n; ++i)
+        {
+            r[i] = std::sqrt(double(batch.fX[i])*batch.fX[i] + double(batch.fY[i])*batch.fY[i]);
+            t[i] = batch.fT[i];
+        }
+    }
+    else
+    {
+        ShowerFrame(fZenith, fAzimuth).Transform(batch.fX.data(), batch.fY.data(), batch.fT.data(), n,
+                                                 0, 0, r.data(), t.data());
+    }
+    std::vector<int> bins(n);
+    fRadius.FindBins(r.data(), n, bins.data());
+
+    std::vector<char> mask;
+    const size_t nBins = GetNBins();
+    for (size_t c = 0; c != fClasses.size(); ++c)
+    {
+        fClasses[c].fSelection.Evaluate(batch, mask);
+        Bin* classBins = &fBins[c*nBins];
+        for (size_t i = 0; i != n; ++i)
+        {
+            if (!mask[i] || bins[i] < 0)
+                continue;
+            Bin& b = classBins[bins[i]];
+            const double w = batch.fWeight[i];
+            b.fWeight += w;
+            b.fSumW2 += w*w;
+            b.fTimes.Add(t[i], w);
+        }
+    }
+}
+
+void LateralDistribution::Fill(const Shower& shower)
+{
+    SetGeometry(shower);
+    ShowerParticleStream& stream = shower.ParticleStream();
+    ParticleBatch batch;
+    while (stream.NextBatch(batch))
+        Fill(batch);
+}
+
+std::vector<LateralDistribution>
+LateralDistribution::FillFile(const LateralDistribution& prototype, const std::string& filename, size_t nThreads)
+{
+    // scanned once, the copies of the threads share the index
+    ShowerFile file(filename);
+    const std::vector<unsigned int> ids = file.GetEventIds();
+    LateralDistribution empty(prototype);
+    empty.Reset();
+    std::vector<LateralDistribution> result(ids.size(), empty);
+
+    if (!nThreads)
+        nThreads = DefaultThreadCount();
+    nThreads = std::max(size_t(1), std::min(nThreads, ids.size()));
+    std::vector<ShowerFile> files(nThreads);
+    for (size_t t = 0; t != nThreads; ++t)
+        files[t].OpenCopy(file);
+
+    ParallelFor(nThreads, nThreads,
+        [&](size_t thread, size_t)
+        {
+            for (size_t event = thread; event < ids.size(); event += nThreads)
+            {
+                if (files[thread].FindEvent(ids[event]) != eSuccess)
+                {
+                    std::ostringstream msg;
+                    msg << "LateralDistribution::FillFile: cannot read event " << ids[event] << " from " << filename;
+                    throw IOException(msg.str());
+                }
+                result[event].Fill(files[thread].GetCurrentShower());
+            }
+        });
+    return result;
+}
+
+void LateralDistribution::Add(const LateralDistribution& other)
+{
+    if (fRadius != other.fRadius || fPlane != other.fPlane || fClasses.size() != other.fClasses.size())
+        throw std::invalid_argument("LateralDistribution::Add: different binning or classes");
+    for (size_t i = 0; i != fBins.size(); ++i)
+    {
+        fBins[i].fWeight += other.fBins[i].fWeight;
+        fBins[i].fSumW2 += other.fBins[i].fSumW2;
+        fBins[i].fTimes.Merge(other.fBins[i].fTimes);
+    }
+}
+
+void LateralDistribution::Reset()
+{
+    for (size_t i = 0; i != fBins.size(); ++i)
+    {
+        fBins[i].fWeight = 0;
+        fBins[i].fSumW2 = 0;
+        fBins[i].fTimes.Clear();
+    }
+    fZenith = 0;
+    fAzimuth = 0;
+    fShowerNumber = 0;
+}
@@ -0,0 +1,283 @@
+/**
+ \file
+ Implementation of the memory-mapped cache of longitudinal profiles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/LongCache.h>
+#include <corsika/LongFile.h>
+#include <corsika/IOException.h>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace corsika;
+
+namespace
+{
+    const char kMagic[8] = {'C', 'O', 'R', 'S', 'L', 'O', 'N', 'G'};
+    const uint32_t kVersion = 1;
+
+    enum Flags
+    {
+        eSlant = 1,
+        eParticles = 2,
+        eEnergyDeposit = 4
+    };
+
+    struct FileHeader
+    {
+        char fMagic[8];
+        uint32_t fVersion;
+        uint32_t fFlags;
+        uint32_t fNColumns;
+        uint32_t fNScalars;
+        uint64_t fNEvents;
+        double fDx;
+        double fZenith;
+        uint64_t fEventTable;   // offset of the EventEntry array
+        uint64_t fScalars;      // offset of the scalar columns, eNScalars arrays of fNEvents doubles
+    };
+    // the profiles of each event follow the header, all columns with
+    // particle bins and then the energy deposit ones
+
+    const char* kScalarNames[] =
+    {
+        "xmax", "nmax", "x0", "a", "b", "c", "chi2", "ndof", "calorimetric_energy"
+    };
+
+    void write(FILE* f, const void* data, size_t size, const std::string& filename)
+    {
+        if (size && fwrite(data, 1, size, f) != size)
+            throw IOException("Error writing long profile cache '" + filename + "'.\n");
+    }
+}
+
+struct LongCache::EventEntry
+{
+    uint64_t fNBins;            // particle profiles
+    uint64_t fNBinsEnergyDeposit;
+    uint64_t fOffset;           // first column
+};
+
+std::string LongCache::ScalarName(Scalar s)
+{
+    if (s < 0 || s >= eNScalars)
+        return "";
+    return kScalarNames[s];
+}
+
+LongCache::Scalar LongCache::ScalarFromName(const std::string& name)
+{
+    for (int i = 0; i != eNScalars; ++i)
+    {
+        if (name == kScalarNames[i])
+            return Scalar(i);
+    }
+    return eNScalars;
+}
+
+size_t LongCache::Convert(const std::string& longFile, const std::string& cacheFile, double zenith)
+{
+    LongFile file(longFile, zenith);
+    const size_t n = file.size();
+
+    FILE* f = fopen(cacheFile.c_str(), "wb");
+    if (!f)
+        throw IOException("Error opening long profile cache '" + cacheFile + "' for writing.\n");
+    boost::shared_ptr<FILE> closer(f, fclose);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    write(f, &header, sizeof(header), cacheFile);
+
+    std::vector<EventEntry> entries(n);
+    std::vector<double> scalars(eNScalars*n);
+    for (size_t e = 0; e != n; ++e)
+    {
+        const LongProfile p = file.GetProfile(e);
+        EventEntry& entry = entries[e];
+        entry.fNBins = p.fProfiles.GetNBins();
+        entry.fNBinsEnergyDeposit = p.fProfiles.GetNBinsEnergyDeposit();
+        entry.fOffset = ftell(f);
+        // the table has the layout of the file
+        write(f, p.fProfiles.data(), p.fProfiles.size()*sizeof(double), cacheFile);
+
+        const GaisserHillasParameter& gh = p.fGaisserHillas;
+        scalars[eXMax*n + e] = gh.GetXMax();
+        scalars[eNMax*n + e] = gh.GetNMax();
+        scalars[eXZero*n + e] = gh.GetXZero();
+        scalars[eA*n + e] = gh.GetA();
+        scalars[eB*n + e] = gh.GetB();
+        scalars[eC*n + e] = gh.GetC();
+        scalars[eChiSquare*n + e] = gh.GetChiSquare();
+        scalars[eNdof*n + e] = gh.GetNdof();
+        scalars[eCalorimetricEnergy*n + e] = p.fCalorimetricEnergy;
+    }
+
+    header.fScalars = ftell(f);
+    write(f, scalars.data(), scalars.size()*sizeof(double), cacheFile);
+    header.fEventTable = ftell(f);
+    write(f, entries.data(), entries.size()*sizeof(EventEntry), cacheFile);
+
+    std::memcpy(header.fMagic, kMagic, sizeof(kMagic));
+    header.fVersion = kVersion;
+    header.fFlags = (file.IsSlantDepth() ? eSlant : 0) |
+        (file.HasParticleProfile() ? eParticles : 0) |
+        (file.HasEnergyDeposit() ? eEnergyDeposit : 0);
+    header.fNColumns = eNColumns;
+    header.fNScalars = eNScalars;
+    header.fNEvents = n;
+    header.fDx = file.Dx();
+    header.fZenith = zenith;
+    rewind(f);
+    write(f, &header, sizeof(header), cacheFile);
+    if (fflush(f))
+        throw IOException("Error writing long profile cache '" + cacheFile + "'.\n");
+    return n;
+}
+
+LongCache::LongCache(const std::string& filename):
+    fFilename(filename), fData(0), fSize(0), fNEvents(0)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw IOException("Error opening long profile cache '" + filename + "'.\n");
+    struct stat s;
+    if (fstat(fd, &s) || size_t(s.st_size) < sizeof(FileHeader))
+    {
+        close(fd);
+        throw IOException("Not a long profile cache: '" + filename + "'.\n");
+    }
+    void* data = mmap(0, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw IOException("Error mapping long profile cache '" + filename + "'.\n");
+    fData = static_cast<const char*>(data);
+    fSize = s.st_size;
+
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(fData);
+    std::string error;
+    if (std::memcmp(header.fMagic, kMagic, sizeof(kMagic)))
+        error = "Not a long profile cache: '";
+    else if (header.fVersion != kVersion || header.fNColumns != eNColumns || header.fNScalars != eNScalars)
+        error = "Unsupported long profile cache version in '";
+    else if (header.fEventTable > fSize || header.fNEvents > (fSize - header.fEventTable)/sizeof(EventEntry) ||
+             header.fScalars > fSize || header.fNEvents > (fSize - header.fScalars)/(eNScalars*sizeof(double)))
+        error = "Truncated long profile cache '";
+    if (error.empty())
+    {
+        fNEvents = header.fNEvents;
+        for (size_t e = 0; e != fNEvents && error.empty(); ++e)
+        {
+            const EventEntry& entry = GetEntry(e);
+            const uint64_t values = eDepth_dE*entry.fNBins + (eNColumns - eDepth_dE)*entry.fNBinsEnergyDeposit;
+            if (entry.fOffset > fSize || values > (fSize - entry.fOffset)/sizeof(double))
+                error = "Truncated long profile cache '";
+        }
+    }
+    if (!error.empty())
+    {
+        munmap(const_cast<char*>(fData), fSize);
+        throw IOException(error + filename + "'.\n");
+    }
+}
+
+LongCache::~LongCache()
+{
+    munmap(const_cast<char*>(fData), fSize);
+}
+
+float LongCache::Dx() const
+{
+    return reinterpret_cast<const FileHeader*>(fData)->fDx;
+}
+
+bool LongCache::HasParticleProfile() const
+{
+    return reinterpret_cast<const FileHeader*>(fData)->fFlags & eParticles;
+}
+
+bool LongCache::HasEnergyDeposit() const
+{
+    return reinterpret_cast<const FileHeader*>(fData)->fFlags & eEnergyDeposit;
+}
+
+bool LongCache::IsSlantDepth() const
+{
+    return reinterpret_cast<const FileHeader*>(fData)->fFlags & eSlant;
+}
+
+double LongCache::GetZenith() const
+{
+    return reinterpret_cast<const FileHeader*>(fData)->fZenith;
+}
+
+const LongCache::EventEntry& LongCache::GetEntry(size_t event) const
+{
+    if (event >= fNEvents)
+        throw std::out_of_range("LongCache: event out of range");
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(fData);
+    return reinterpret_cast<const EventEntry*>(fData + header.fEventTable)[event];
+}
+
+size_t LongCache::GetNBins(size_t event, Column c) const
+{
+    if (c < 0 || c >= eNColumns)
+        throw std::out_of_range("LongCache: column out of range");
+    const EventEntry& entry = GetEntry(event);
+    return (c < eDepth_dE ? entry.fNBins : entry.fNBinsEnergyDeposit);
+}
+
+ColumnSpan<double> LongCache::GetColumn(size_t event, Column c) const
+{
+    const size_t n = GetNBins(event, c);
+    const EventEntry& entry = GetEntry(event);
+    const size_t first = (c < eDepth_dE ?
+                          c*entry.fNBins :
+                          eDepth_dE*entry.fNBins + (c - eDepth_dE)*entry.fNBinsEnergyDeposit);
+    return ColumnSpan<double>(reinterpret_cast<const double*>(fData + entry.fOffset) + first, n);
+}
+
+ColumnSpan<double> LongCache::GetScalars(Scalar s) const
+{
+    if (s < 0 || s >= eNScalars)
+        throw std::out_of_range("LongCache: scalar out of range");
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(fData);
+    return ColumnSpan<double>(reinterpret_cast<const double*>(fData + header.fScalars) + s*fNEvents, fNEvents);
+}
+
+GaisserHillasParameter LongCache::GetGaisserHillas(size_t event) const
+{
+    GetEntry(event); // check the range
+    GaisserHillasParameter gh;
+    gh.SetXMax(GetScalars(eXMax)[event], 0);
+    gh.SetNMax(GetScalars(eNMax)[event], 0);
+    gh.SetXZero(GetScalars(eXZero)[event], 0);
+    gh.SetChiSquare(GetScalars(eChiSquare)[event], size_t(GetScalars(eNdof)[event]));
+    gh.SetA(GetScalars(eA)[event], 0);
+    gh.SetB(GetScalars(eB)[event], 0);
+    gh.SetC(GetScalars(eC)[event], 0);
+    return gh;
+}
+
+LongProfile LongCache::GetProfile(size_t event) const
+{
+    const EventEntry& entry = GetEntry(event);
+    LongProfile p;
+    p.fProfiles.Resize(entry.fNBins, entry.fNBinsEnergyDeposit);
+    if (!p.fProfiles.empty())
+        std::memcpy(p.fProfiles.Get(eDepth), fData + entry.fOffset, p.fProfiles.size()*sizeof(double));
+    p.fCalorimetricEnergy = GetScalars(eCalorimetricEnergy)[event];
+    p.fGaisserHillas = GetGaisserHillas(event);
+    return p;
+}
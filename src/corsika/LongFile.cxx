@@ -10,22 +10,27 @@
 #include <corsika/Constants.h>
 #include <corsika/LongFile.h>
 #include <corsika/IOException.h>
+#include <corsika/Instrumentation.h>
+#include <corsika/Trace.h>
 
-#include <fstream>
 #include <sstream>
 #include <string>
+#include <algorithm>
 #include <cmath>
-#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <utility>
 
-#include <boost/tokenizer.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace corsika;
 
 
-typedef boost::tokenizer<boost::char_separator<char> > mytok;
-
 static void log(const std::string& mess)
 {
     std::cout << mess << std::endl;
@@ -41,21 +46,190 @@ static void log(const std::ostringstream& mess)
 
 namespace
 {
-    bool SplitLine(string l, vector<string>& vec, string s = " ")
+    const char particleProfileStr[] = " LONGITUDINAL DISTRIBUTION IN";
+    const char dEdX_ProfileStr[] = " LONGITUDINAL ENERGY DEPOSIT";
+    const char GHFit_Str[] = " FIT OF THE HILLAS CURVE";
+    const char sectionStr[] = " LONGITUDINAL ";
+    const char parametersStr[] = " PARAMETERS         = ";
+    const char chiSquareStr[] = " CHI**2/DOF         = ";
+    
+    /// A line of the mapped file, without the newline
+    struct Line
+    {
+        Line(): fBegin(0), fEnd(0) {}
+        
+        template <size_t N> bool Contains(const char (&str)[N]) const
+        { return memmem(fBegin, fEnd - fBegin, str, N - 1); }
+        
+        std::string String() const { return std::string(fBegin, fEnd); }
+        
+        const char* fBegin;
+        const char* fEnd;
+    };
+    
+    /// Lines of a piece of the mapped file. memchr does the (vectorized) newline scan.
+    struct LineReader
+    {
+        LineReader(const char* begin, const char* end): fPos(begin), fEnd(end) {}
+        
+        bool Next(Line& line)
+        {
+            if (fPos == fEnd)
+                return false;
+            const char* nl = static_cast<const char*>(memchr(fPos, '\n', fEnd - fPos));
+            line.fBegin = fPos;
+            line.fEnd = (nl ? nl : fEnd);
+            fPos = (nl ? nl + 1 : fEnd);
+            return true;
+        }
+        
+        const char* fPos;
+        const char* fEnd;
+    };
+    
+    inline bool is_space(char c)
+    { return c == ' ' || c == '\t' || c == '\r'; }
+    
+    inline bool is_digit(char c)
+    { return c >= '0' && c <= '9'; }
+    
+    /// Split a line in words, up to n of them. Returns the number of words.
+    size_t split(const Line& line, Line* words, size_t n)
     {
-        boost::char_separator<char> sep(s.c_str());
-        mytok tok(l,sep);
-        vec.clear();
-        for (mytok::const_iterator titer=tok.begin();titer!=tok.end();++titer) {
-            vec.push_back(*titer);
+        size_t count = 0;
+        const char* p = line.fBegin;
+        while (count != n)
+        {
+            while (p != line.fEnd && is_space(*p))
+                ++p;
+            if (p == line.fEnd)
+                break;
+            words[count].fBegin = p;
+            while (p != line.fEnd && !is_space(*p))
+                ++p;
+            words[count++].fEnd = p;
         }
+        return count;
+    }
+    
+    template <size_t N> bool equals(const Line& word, const char (&str)[N])
+    { return size_t(word.fEnd - word.fBegin) == N - 1 && !memcmp(word.fBegin, str, N - 1); }
+    
+    /**
+     Parse a number like 12.5, -1.2345E+05 or 3.D-2 without locale
+     and without copying. Leading blanks are skipped. On failure p is
+     not moved and false is returned.
+     */
+    bool parse_number(const char*& p, const char* end, double& value)
+    {
+        static const double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        
+        const char* c = p;
+        while (c != end && is_space(*c))
+            ++c;
+        bool negative = false;
+        if (c != end && (*c == '-' || *c == '+'))
+            negative = (*c++ == '-');
+        
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; c != end && is_digit(*c); ++c, ++digits)
+        {
+            if (mantissa < 100000000000000000ull)
+                mantissa = 10*mantissa + (*c - '0');
+            else
+                ++exponent;
+        }
+        if (c != end && *c == '.')
+        {
+            for (++c; c != end && is_digit(*c); ++c, ++digits)
+            {
+                if (mantissa < 100000000000000000ull)
+                {
+                    mantissa = 10*mantissa + (*c - '0');
+                    --exponent;
+                }
+            }
+        }
+        if (!digits)
+            return false;
+        
+        if (c != end && (*c == 'E' || *c == 'e' || *c == 'D' || *c == 'd'))
+        {
+            const char* e = c + 1;
+            bool negativeExponent = false;
+            if (e != end && (*e == '-' || *e == '+'))
+                negativeExponent = (*e++ == '-');
+            if (e != end && is_digit(*e))
+            {
+                int n = 0;
+                for (; e != end && is_digit(*e); ++e)
+                {
+                    if (n < 10000)
+                        n = 10*n + (*e - '0');
+                }
+                exponent += (negativeExponent ? -n : n);
+                c = e;
+            }
+        }
+        
+        // exact for the mantissa and powers in the table, more than enough for floats otherwise
+        double v = double(mantissa);
+        if (exponent >= 0)
+            v *= (exponent <= 22 ? powers[exponent] : pow(10., exponent));
+        else
+            v /= (exponent >= -22 ? powers[-exponent] : pow(10., -exponent));
+        value = (negative ? -v : v);
+        p = c;
         return true;
     }
     
-    string particleProfileStr = " LONGITUDINAL DISTRIBUTION IN";
-    string dEdX_ProfileStr = " LONGITUDINAL ENERGY DEPOSIT";
-    string GHFit_Str = " FIT OF THE HILLAS CURVE";
+    /// Parse up to n numbers. Those that are missing are left as they are (like sscanf).
+    size_t parse_numbers(const char* p, const char* end, float* values, size_t n)
+    {
+        size_t count = 0;
+        double v;
+        while (count != n && parse_number(p, end, v))
+            values[count++] = v;
+        return count;
+    }
+    
+    size_t parse_numbers(const Line& line, float* values, size_t n)
+    { return parse_numbers(line.fBegin, line.fEnd, values, n); }
+    
+    /// Parse the numbers after a prefix
+    template <size_t N> size_t parse_after(const Line& line, const char (&prefix)[N], float* values, size_t n)
+    {
+        const char* p = static_cast<const char*>(memmem(line.fBegin, line.fEnd - line.fBegin, prefix, N - 1));
+        if (!p)
+            return 0;
+        return parse_numbers(p + N - 1, line.fEnd, values, n);
+    }
     
+    /// VERTICAL or SLANT in a section header, throws otherwise
+    bool is_slant(const Line& word, const Line& line, const std::string& filename)
+    {
+        if (equals(word, "VERTICAL"))
+            return false;
+        if (equals(word, "SLANT"))
+            return true;
+        ostringstream err;
+        err << "Corsika longitunal file \"" << filename << "\" is invalid:\n"
+        "line: \"" << line.String() << "\" "
+        "contains invalid string at                ^^^^^^^\n"
+        "which is neither VERTICAL nor SLANT !";
+        ERROR(err);
+        throw IOException(err.str());
+    }
+    
+    void unmap(const char* data, size_t size)
+    {
+        munmap(const_cast<char*>(data), size);
+    }
 }
 
 LongFile::LongFile(string filename, double zenith):
@@ -63,17 +237,45 @@ LongFile::LongFile(string filename, double zenith):
     fCosZenith(cos(zenith)),
     fIsSlantDepthProfile(false),
     event_count(0),
-    fDx(0.),
+    fVerticalDx(0.),
     fNBinsParticles(0),
     fNBinsEnergyDeposit(0),
-    fLongDataFile(new std::ifstream(fFilename.c_str()))
+    fSize(0)
 {
-    // check if file exists and is readable here
+    CORSIKA_TRACE("LongFile", "open");
+    // a missing or empty file has no profiles
+    const int fd = open(fFilename.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (!fstat(fd, &st) && st.st_size > 0)
+        {
+            void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, st.st_size, MADV_SEQUENTIAL);
+                const size_t size = st.st_size;
+                fSize = size;
+                fData.reset(static_cast<const char*>(data), [size](const char* d) { unmap(d, size); });
+            }
+        }
+        close(fd);
+    }
     Scan();
 }
 
 
-LongProfile LongFile::GetProfile(size_t event)
+LongProfile LongFile::GetProfile(size_t event) const
+{
+    return ToProfile(GetRawProfile(event), fCosZenith);
+}
+
+LongProfile LongFile::GetProfile(size_t event, double zenith) const
+{
+    return ToProfile(GetRawProfile(event), zenith);
+}
+
+LongFile::RawProfile LongFile::GetRawProfile(size_t event) const
 {
     if (event >= event_count)
     {
@@ -84,167 +286,202 @@ LongProfile LongFile::GetProfile(size_t event)
     return FetchProfile(event);
 }
 
-void LongFile::Scan()
+LongProfile LongFile::ToProfile(const RawProfile& raw, double zenith) const
 {
-    // scan for number of bins and dX,
-    // also check if there are energy deposit profiles
-    
-    //static const double g = 1;
-    //static const double cm = 1;
-    //static const double cm2 = cm*cm;
-    //static const double deg = 3.14159/180;
+    return ToProfile(raw, float(cos(zenith)));
+}
+
+LongProfile LongFile::ToProfile(const RawProfile& raw, float cosZenith) const
+{
+    // the arithmetic (and the float rounding) of the depths and of the
+    // fit are the ones of the file with this zenith angle
+    LongProfile profile;
+    profile.fProfiles = ProfileTable(raw.fProfiles);
+    ProfileTable& table = profile.fProfiles;
+    if (!fIsSlantDepthProfile)
+    {
+        //BRD 17/2/05 CORSIKA depths are vertical assuming a flat
+        //Earth.  So apply cosTheta correction here.
+        // RU Wed Jun 13 14:46:44 CEST 2007
+        // if SLANT was used in CORSIKA, don't do the cosZenith correction
+        const float* depth = raw.fProfiles.Get(FloatProfileTable::eDepth);
+        double* out = table.Get(ProfileTable::eDepth);
+        for (size_t i = 0; i != table.GetNBins(); ++i)
+            out[i] = depth[i]/cosZenith;
+        depth = raw.fProfiles.Get(FloatProfileTable::eDepth_dE);
+        out = table.Get(ProfileTable::eDepth_dE);
+        for (size_t i = 0; i != table.GetNBinsEnergyDeposit(); ++i)
+            out[i] = depth[i]/cosZenith;
+    }
+    const double dx = DxAt(cosZenith);
+    double* const dEdX = table.Get(ProfileTable::edEdX);
+    for (size_t i = 0; i != table.GetNBinsEnergyDeposit(); ++i)
+        dEdX[i] /= dx;
     
-    // Read CORSIKA profile if available
-    if (!fLongDataFile->is_open()) return;
+    const float* const par = raw.fGaisserHillas;   // nmax, x0, xmax, a, b, c
+    const float achi = raw.fChiSquare;
+    const bool hasValidGHfit = (achi>0) && (achi*fNBinsParticles<1e15);
+    if (hasValidGHfit)
+    {
+        float axmax = par[2];
+        double A = par[3] * (g/cm2);
+        double B = par[4];
+        double C = par[5] / (g/cm2);
+        if (!fIsSlantDepthProfile)
+        {
+            A /= cosZenith;
+            B /= cosZenith;
+            C /= cosZenith;
+            axmax /= cosZenith;
+        }
+        
+        GaisserHillasParameter& gh = profile.fGaisserHillas;
+        gh.SetXMax(axmax*(g/cm2), 0);
+        gh.SetNMax(par[0], 0);
+        gh.SetXZero(par[1]*(g/cm2), 0);
+        gh.SetChiSquare(fNBinsParticles*achi, fNBinsParticles);
+        gh.SetA(A, 0.);
+        gh.SetB(B, 0.);
+        gh.SetC(C, 0.);
+    }
+    profile.fCalorimetricEnergy = raw.fCalorimetricEnergy;
+    return profile;
+}
+
+void LongFile::Scan()
+{
+    // find the section headers, and read the number of bins and dX from
+    // the first ones (also check if there are energy deposit profiles)
+    if (!fData) return;
     
-    string line;
-    while (getline(*fLongDataFile.get(), line) && (fPartProfiles.size()==0 || fdEdXProfiles.size()==0))
+    const char* begin = fData.get();
+    const char* end = begin + fSize;
+    const char* p = begin;
+    while (const char* found = static_cast<const char*>(memmem(p, end - p, sectionStr, sizeof(sectionStr) - 1)))
     {
+        // the whole line around the match
+        Line line;
+        line.fBegin = found;
+        while (line.fBegin != begin && line.fBegin[-1] != '\n')
+            --line.fBegin;
+        const char* nl = static_cast<const char*>(memchr(found, '\n', end - found));
+        line.fEnd = (nl ? nl : end);
+        p = (nl ? nl + 1 : end);
+        const size_t next = p - begin;
         
-        if (line.find(particleProfileStr) != string::npos)
+        Line words[9];
+        if (line.Contains(particleProfileStr))
         {
-            fPartProfiles.push_back(fLongDataFile->tellg());
-            char s1[50], s2[50], s3[50], isVertOrSlant[50];
-            sscanf(line.c_str(), "%s %s %s %zu %s", s1, s2, s3, &fNBinsParticles, isVertOrSlant);
-            string testStr(isVertOrSlant);
-            if (testStr == "VERTICAL")
-                fIsSlantDepthProfile = false;
-            else if (testStr == "SLANT")
-                fIsSlantDepthProfile = true;
-            else {
-                ostringstream err;
-                err << "Corsika longitunal file \"" << fFilename << "\" is invalid:\n"
-                "line: \"" << line << "\" "
-                "contains invalid string at                ^^^^^^^\n"
-                "which is neither VERTICAL nor SLANT !";
-                ERROR(err);
-                throw IOException(err.str());
+            if (fPartProfiles.empty())
+            {
+                // LONGITUDINAL DISTRIBUTION IN <n> VERTICAL|SLANT ...
+                const size_t n = split(line, words, 5);
+                float bins = 0;
+                if (n == 5 && parse_numbers(words[3], &bins, 1))
+                    fNBinsParticles = size_t(bins);
+                fIsSlantDepthProfile = is_slant(words[n == 5 ? 4 : 0], line, fFilename);
             }
+            fPartProfiles.push_back(next);
         }
         
-        if (line.find(dEdX_ProfileStr) != string::npos)
+        if (line.Contains(dEdX_ProfileStr))
         {
-            fdEdXProfiles.push_back(fLongDataFile->tellg());
-            char s1[50], s2[50], s3[50], s4[50], isVertOrSlant[50], s5 [50], s6 [50];
-            sscanf(line.c_str(),
-                   "%s %s %s %s %zu %s %s %s %f",
-                   s1, s2, s3, s4, &fNBinsEnergyDeposit, isVertOrSlant, s5, s6, &fDx);
-            string testStr(isVertOrSlant);
-            if (testStr == "VERTICAL")
-            {
-                fIsSlantDepthProfile = false;
-                fDx /= fCosZenith;
-            }
-            else if (testStr == "SLANT")
+            if (fdEdXProfiles.empty())
             {
-                fIsSlantDepthProfile = true;
-            }
-            else
-            {
-                ostringstream err;
-                err << "Corsika longitunal file \"" << fFilename << "\" is invalid:\n"
-                "line: \"" << line << "\" "
-                "contains invalid string at                ^^^^^^^\n"
-                " which is neither VERTICAL nor SLANT !";
-                ERROR(err);
-                throw IOException(err.str());
+                // LONGITUDINAL ENERGY DEPOSIT IN <n> VERTICAL|SLANT STEPS OF <dx> ...
+                const size_t n = split(line, words, 9);
+                float bins = 0;
+                if (n > 4 && parse_numbers(words[4], &bins, 1))
+                    fNBinsEnergyDeposit = size_t(bins);
+                if (n == 9)
+                    parse_numbers(words[8], &fVerticalDx, 1);
+                fIsSlantDepthProfile = is_slant(words[n > 5 ? 5 : 0], line, fFilename);
             }
+            fdEdXProfiles.push_back(next);
         }
-    } // --  end scan file  ---
-    while (getline(*fLongDataFile.get(), line))
-    {
-        if (line.find(particleProfileStr) != string::npos)
-            fPartProfiles.push_back(fLongDataFile->tellg());
-
-        if (line.find(dEdX_ProfileStr) != string::npos)
-            fdEdXProfiles.push_back(fLongDataFile->tellg());
     }
     event_count = (fPartProfiles.size()?fPartProfiles.size():fdEdXProfiles.size());
 }
 
 
-LongProfile LongFile::FetchProfile(size_t findShower)
+LongFile::RawProfile LongFile::FetchProfile(size_t findShower) const
 {
+    CORSIKA_TIME(eLongParseTime);
+    CORSIKA_TRACE("LongFile::GetProfile", "decode");
+    CORSIKA_COUNT(eLongProfiles, 1);
     bool aux_flag = false;
     size_t i = 0;
     size_t j = 0;
-    string line;
-    
-    vector<double> auxDepth(fNBinsParticles);
-    vector<double> auxCharge(fNBinsParticles);
-    vector<double> auxMuons(fNBinsParticles);
-    vector<double> auxAntiMuons(fNBinsParticles);
-    vector<double> auxGammas(fNBinsParticles);
-    vector<double> auxElectrons(fNBinsParticles);
-    vector<double> auxPositrons(fNBinsParticles);
-    vector<double> auxHadrons(fNBinsParticles);
-    vector<double> auxNuclei(fNBinsParticles);
-    vector<double> auxCherenkov(fNBinsParticles);
-    
-    vector<double> auxDepth_dE (fNBinsEnergyDeposit);
-    vector<double> auxDeltaEn (fNBinsEnergyDeposit);
-    
-    GaisserHillasParameter gh;
-    double energyDepositSum = 0.;
+    
+    RawProfile profile;
+    std::fill(profile.fGaisserHillas, profile.fGaisserHillas + 6, 0.f);
+    profile.fChiSquare = 0;
+    profile.fCalorimetricEnergy = 0;
     
     // Read CORSIKA profile if available
-    if (!fLongDataFile->is_open())
+    if (!fData)
     {
         ERROR("Reading failed for some reason.");
-        return LongProfile();
+        return profile;
     }
-    fLongDataFile->clear();
-    fLongDataFile->seekg(fPartProfiles[findShower]);
     
-    vector<string> tokens;
-    while (getline(*fLongDataFile.get(), line))
+    // every column is written in place
+    FloatProfileTable& table = profile.fProfiles;
+    table.Resize(fNBinsParticles, fNBinsEnergyDeposit);
+    float* const auxDepth = table.Get(FloatProfileTable::eDepth);
+    float* const auxGammas = table.Get(FloatProfileTable::eGamma);
+    float* const auxPositrons = table.Get(FloatProfileTable::ePositron);
+    float* const auxElectrons = table.Get(FloatProfileTable::eElectron);
+    float* const auxAntiMuons = table.Get(FloatProfileTable::eAntiMuon);
+    float* const auxMuons = table.Get(FloatProfileTable::eMuon);
+    float* const auxHadrons = table.Get(FloatProfileTable::eHadron);
+    float* const auxCharge = table.Get(FloatProfileTable::eCharge);
+    float* const auxNuclei = table.Get(FloatProfileTable::eNuclei);
+    float* const auxCherenkov = table.Get(FloatProfileTable::eCherenkov);
+    
+    float* const auxDepth_dE = table.Get(FloatProfileTable::eDepth_dE);
+    float* const auxDeltaEn = table.Get(FloatProfileTable::edEdX);
+    
+    double energyDepositSum = 0.;
+    
+    LineReader reader(fData.get() + fPartProfiles[findShower], fData.get() + fSize);
+    
+    Line line;
+    Line tokens[2];
+    while (reader.Next(line))
     {
-        SplitLine(line, tokens);
-        if (line.find(particleProfileStr) != string::npos)
+        if (line.Contains(particleProfileStr))
+            reader.Next(line);
+        if (line.Contains(dEdX_ProfileStr) || aux_flag)
         {
-            getline(*fLongDataFile.get(), line);
-            SplitLine(line, tokens);
-        }
-        if (line.find(dEdX_ProfileStr) != string::npos || aux_flag)
-        {
-            if (line.find(dEdX_ProfileStr) != string::npos)
-            {
-                getline(*fLongDataFile.get(), line);
-                SplitLine(line, tokens);
-            }
-            if (tokens.size() > 1 && tokens[0] == string("DEPTH") && tokens[1] == string("GAMMA"))
+            if (line.Contains(dEdX_ProfileStr))
+                reader.Next(line);
+            if (split(line, tokens, 2) == 2 && equals(tokens[0], "DEPTH") && equals(tokens[1], "GAMMA"))
             {
                 aux_flag = true;
-                getline(*fLongDataFile.get(), line);
-                SplitLine(line, tokens);
+                reader.Next(line);
             }
-            if (line.find(GHFit_Str) != string::npos) break;
+            if (line.Contains(GHFit_Str)) break;
             
-            if (aux_flag && j < fNBinsParticles)
+            if (aux_flag && j < fNBinsEnergyDeposit)
             {
-                
-                float xdepth = 0.0;
-                float gamma = 0.0;
-                float emIoniz = 0.0;
-                float emCut = 0.0;
-                float muonIoniz = 0.0;
-                float muonCut = 0.0;
-                float hadronIoniz = 0.0;
-                float hadronCut = 0.0;
-                float neutrino = 0.0;
-                float sumEnergy = 0.0;
-                
-                sscanf(line.c_str(), "%f %f %f %f %f %f %f %f %f %f",
-                       &xdepth, &gamma, &emIoniz, &emCut, &muonIoniz, &muonCut,
-                       &hadronIoniz, &hadronCut, &neutrino, &sumEnergy);
-                
-                if (!fIsSlantDepthProfile)
-                    xdepth /= fCosZenith;
+                // depth, gamma, em ioniz, em cut, muon ioniz, muon cut,
+                // hadron ioniz, hadron cut, neutrino, sum
+                float v[10] = {0};
+                parse_numbers(line, v, 10);
+                const float xdepth = v[0];
+                const float gamma = v[1];
+                const float emIoniz = v[2];
+                const float emCut = v[3];
+                const float muonIoniz = v[4];
+                const float muonCut = v[5];
+                const float hadronIoniz = v[6];
+                const float hadronCut = v[7];
+                const float neutrino = v[8];
+                const float sumEnergy = v[9];
                 
                 // dEdX profile has slightly different depth-bins
                 auxDepth_dE[j] = xdepth;
-                //cout << j << " " << hadroncut  << " " << muoncut
-                //   << " " << neutrino << " " << sumenergy << endl;
                 // Subtracting neutrino energy
                 // and take fraction for muons and hadrons from
                 //     Barbosa et al Astro. Part. Phys. 22, (2004) p. 159
@@ -262,109 +499,51 @@ LongProfile LongFile::FetchProfile(size_t findShower)
                     double groundEnergy = (1.-hadronGroundFraction)*hadronCut + hadronIoniz + muonIoniz + emIoniz+emCut + gamma;
                     energyDepositSum += groundEnergy;
                 }
-                
-                auxDeltaEn[j] /= fDx;
+                // divided by dX in ToProfile
                 
                 ++j;
             }
         }
         
-        if (line.find(dEdX_ProfileStr) == string::npos || (tokens[0] == "DEPTH" && tokens[1] == "GAMMAS" && i < fNBinsParticles))
+        if (aux_flag) continue;
+        if (!line.Contains(dEdX_ProfileStr) && i < fNBinsParticles)
         {
-            if (aux_flag) continue;
-            
-            float xdepth = 0.0;
-            float chargedparticles = 0.0;
-            float gammas, positrons, electrons, muplus, muminus, hadrons;
-            float nuclei, cerenkov;
-            sscanf(line.c_str(), "%f %f %f %f %f %f %f %f %f %f",
-                   &xdepth, &gammas, &positrons, &electrons, &muplus, &muminus,
-                   &hadrons, &chargedparticles, &nuclei, &cerenkov);
+            // depth, gammas, positrons, electrons, mu+, mu-, hadrons, charged, nuclei, cherenkov
+            float v[10] = {0};
+            parse_numbers(line, v, 10);
+            const float xdepth = v[0];
             
             if (xdepth > 0)
             {
-                //BRD 17/2/05 CORSIKA depths are vertical assuming a flat
-                //Earth.  So apply cosTheta correction here.
-                // RU Wed Jun 13 14:46:44 CEST 2007
-                // if SLANT was used in CORSIKA, don't do the fCosZenith correction
-                if (!fIsSlantDepthProfile)
-                    xdepth /= fCosZenith;
+                // the zenith angle correction is done in ToProfile
                 auxDepth[i] = xdepth;
-                auxCharge[i] = chargedparticles;
-                auxMuons[i] =  muminus;
-                auxAntiMuons[i] =  muminus;
-                auxGammas[i] = gammas;
-                auxElectrons[i] = electrons;
-                auxPositrons[i] = positrons;
-                auxHadrons[i] = hadrons;
-                auxNuclei[i] = nuclei;
-                auxCherenkov[i] = cerenkov;
+                auxGammas[i] = v[1];
+                auxPositrons[i] = v[2];
+                auxElectrons[i] = v[3];
+                auxAntiMuons[i] = v[4];
+                auxMuons[i] = v[5];
+                auxHadrons[i] = v[6];
+                auxCharge[i] = v[7];
+                auxNuclei[i] = v[8];
+                auxCherenkov[i] = v[9];
                 ++i;
             }
         }
     }
     
-    float anmax;
-    float ax0;
-    float axmax;
-    float achi;
-    while (getline(*fLongDataFile.get(), line))
+    while (reader.Next(line))
     {
-        if (line.find(" PARAMETERS         = ") != string::npos)
+        if (line.Contains(parametersStr))
         {
-            
-            float aapar, abpar, acpar;
-            sscanf(line.c_str(), " PARAMETERS         =   %f %f %f %f %f %f", &anmax,
-                   &ax0, &axmax, &aapar, &abpar, &acpar);
-            getline(*fLongDataFile.get(), line);
-            sscanf(line.c_str(), " CHI**2/DOF         = %f", &achi);
-            
-            const bool hasValidGHfit = (achi>0) && (achi*fNBinsParticles<1e15);
-            
-            double A = aapar * (g/cm2);
-            double B = abpar;
-            double C = acpar / (g/cm2);
-            
-            if (!fIsSlantDepthProfile)
-            {
-                A /= fCosZenith;
-                B /= fCosZenith;
-                C /= fCosZenith;
-                axmax /= fCosZenith;
-            }
-            
-            // GaisserHillas6Parameter gh;
-            if (hasValidGHfit)
-            {
-                gh.SetXMax(axmax*(g/cm2), 0);
-                gh.SetNMax(anmax, 0);
-                gh.SetXZero(ax0*(g/cm2), 0);
-                gh.SetChiSquare(fNBinsParticles*achi, fNBinsParticles);
-                gh.SetA(A, 0.);
-                gh.SetB(B, 0.);
-                gh.SetC(C, 0.);
-            }
-            
+            // nmax, x0, xmax, a, b, c
+            parse_after(line, parametersStr, profile.fGaisserHillas, 6);
+            if (reader.Next(line))
+                parse_after(line, chiSquareStr, &profile.fChiSquare, 1);
             break;
         }
     }
     
-    LongProfile profile;
-    profile.fChargeProfile = auxCharge;
-    profile.fGammaProfile = auxGammas;
-    profile.fElectronProfile = auxElectrons;
-    profile.fPositronProfile = auxPositrons;
-    profile.fMuonProfile = auxMuons;
-    profile.fAntiMuonProfile = auxAntiMuons;
-    profile.fDepth = auxDepth;
-    profile.fHadronProfile = auxHadrons;
-    profile.fNucleiProfile = auxNuclei;
-    profile.fCherenkovProfile = auxCherenkov;
-    //profile.fdEdX = auxDeltaEn;
-    //profile.fDepth_dE = auxDepth_dE;
-    
     profile.fCalorimetricEnergy = energyDepositSum;
-    profile.fGaisserHillas = gh;
     return profile;
 }
 
@@ -388,19 +567,15 @@ void CorrectProfile(LongProfile& profile, double dX)
     //   somewhere in the middle of the atmosphere !
     
     
-    vector<double> auxDepth = profile.fDepth;
-    vector<double> auxCharge = profile.fChargeProfile;
-    vector<double> auxMuons = profile.fMuonProfile;
-    vector<double> auxAntiMuons = profile.fAntiMuonProfile;
-    vector<double> auxGammas = profile.fGammaProfile;
-    vector<double> auxElectrons = profile.fElectronProfile;
-    vector<double> auxPositrons = profile.fPositronProfile;
-    vector<double> auxHadrons = profile.fHadronProfile;
-    vector<double> auxNuclei = profile.fNucleiProfile;
-    vector<double> auxCherenkov = profile.fCherenkovProfile;
+    const ProfileTable& table = profile.fProfiles;
+    vector<double> auxDepth = table.GetVector(ProfileTable::eDepth);
+    vector<double> auxCharge = table.GetVector(ProfileTable::eCharge);
+    vector<double> auxMuons = table.GetVector(ProfileTable::eMuon);
+    vector<double> auxGammas = table.GetVector(ProfileTable::eGamma);
+    vector<double> auxElectrons = table.GetVector(ProfileTable::eElectron);
     
-    vector<double> auxDepth_dE = profile.fDepth_dE;
-    vector<double> auxDeltaEn = profile.fdEdX;
+    vector<double> auxDepth_dE = table.GetVector(ProfileTable::eDepth_dE);
+    vector<double> auxDeltaEn = table.GetVector(ProfileTable::edEdX);
     size_t i = auxDepth.size();
     
     size_t nBinsEnergyDeposit = auxDepth_dE.size();
@@ -424,8 +599,8 @@ void CorrectProfile(LongProfile& profile, double dX)
     const double normGammas = auxGammas[i-1];
     const double normElectrons = auxElectrons[i-1];
     
-    const double lastBinDepth_dEdX = auxDepth_dE[profile.fDepth_dE.size()-1];
-    const double lastBinDepth_part = auxDepth[profile.fDepth.size()-1];
+    const double lastBinDepth_dEdX = auxDepth_dE[nBinsEnergyDeposit-1];
+    const double lastBinDepth_part = auxDepth[i-1];
     
     // recalculate last dedx bins
     for (size_t iCorrect = 0; iCorrect < 2; ++iCorrect)
@@ -470,16 +645,15 @@ void CorrectProfile(LongProfile& profile, double dX)
         
     }
     
-    profile.fChargeProfile = auxCharge;
-    profile.fGammaProfile = auxGammas;
-    profile.fElectronProfile = auxElectrons;
-    profile.fPositronProfile = auxPositrons;
-    profile.fMuonProfile = auxMuons;
-    profile.fAntiMuonProfile = auxAntiMuons;
-    profile.fDepth = auxDepth;
-    profile.fHadronProfile = auxHadrons;
-    profile.fNucleiProfile = auxNuclei;
-    profile.fCherenkovProfile = auxCherenkov;
-    //profile.fdEdX = auxDeltaEn;
-    //profile.fDepth_dE = auxDepth_dE;
+    // the other particle profiles are zero in the added bins
+    ProfileTable corrected(table);
+    corrected.Resize(auxDepth.size(), nBinsEnergyDeposit);
+    std::copy(auxDepth.begin(), auxDepth.end(), corrected.Get(ProfileTable::eDepth));
+    std::copy(auxCharge.begin(), auxCharge.end(), corrected.Get(ProfileTable::eCharge));
+    std::copy(auxMuons.begin(), auxMuons.end(), corrected.Get(ProfileTable::eMuon));
+    std::copy(auxGammas.begin(), auxGammas.end(), corrected.Get(ProfileTable::eGamma));
+    std::copy(auxElectrons.begin(), auxElectrons.end(), corrected.Get(ProfileTable::eElectron));
+    //std::copy(auxDeltaEn.begin(), auxDeltaEn.end(), corrected.Get(ProfileTable::edEdX));
+    //std::copy(auxDepth_dE.begin(), auxDepth_dE.end(), corrected.Get(ProfileTable::eDepth_dE));
+    profile.fProfiles = std::move(corrected);
 }
@@ -0,0 +1,62 @@
+/**
+ \file
+ Implementation of the cached loader of longitudinal profiles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/LongLoader.h>
+#include <cmath>
+
+using namespace corsika;
+
+LongLoader::LongLoader(const std::string& filename):
+    fFilename(filename),
+    fFile(filename, 0.),
+    fCache(fFile.size())
+{
+}
+
+float LongLoader::Dx(double zenith) const
+{
+    // same arithmetic as LongFile
+    return (IsSlantDepth() ? fFile.Dx() : fFile.Dx()/float(std::cos(zenith)));
+}
+
+LongProfile LongLoader::GetProfile(size_t event, double zenith) const
+{
+    const boost::shared_ptr<const LongFile::RawProfile> raw = GetRawProfile(event);
+    return fFile.ToProfile(*raw, zenith);
+}
+
+boost::shared_ptr<const LongFile::RawProfile> LongLoader::GetRawProfile(size_t event) const
+{
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (event < fCache.size() && fCache[event])
+            return fCache[event];
+    }
+    // parsed without the lock (LongFile is thread-safe), the first one to finish is kept
+    boost::shared_ptr<const LongFile::RawProfile> raw(new LongFile::RawProfile(fFile.GetRawProfile(event)));
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fCache[event])
+        fCache[event] = raw;
+    return fCache[event];
+}
+
+size_t LongLoader::GetNCached() const
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    size_t n = 0;
+    for (size_t i = 0; i != fCache.size(); ++i)
+        n += bool(fCache[i]);
+    return n;
+}
+
+void LongLoader::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (size_t i = 0; i != fCache.size(); ++i)
+        fCache[i].reset();
+}
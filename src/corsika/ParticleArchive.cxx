@@ -0,0 +1,611 @@
+/**
+ \file
+ Implementation of the particle archive
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ParticleArchive.h>
+#include <corsika/RawParticleStream.h>
+#include <corsika/RawStream.h>
+#include <corsika/ShowerFrame.h>
+#include <corsika/ShowerParticleStream.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+using namespace corsika;
+
+namespace
+{
+    const char kMagic[8] = {'C', 'O', 'R', 'S', 'A', 'R', 'C', 'H'};
+    const uint32_t kVersion = 1;
+    const size_t kHeaderSize = sizeof(GenericBlock<NotThinned>);
+    const size_t kRecordWords = sizeof(ParticleData<Thinned>)/sizeof(float);
+
+    struct FileHeader
+    {
+        char fMagic[8];
+        uint32_t fVersion;
+        uint32_t fThinned;
+        double fPosition;
+        double fTime;
+        double fLogMomentum;
+        double fDirection;
+        uint32_t fChunkSize;
+        uint32_t fReserved;
+    };
+
+    struct ChunkHeader
+    {
+        uint32_t fNRecords;     // zero marks the end of an event
+        uint32_t fNRaw;         // records stored without quantization
+        double fTimeOffset;
+        uint32_t fSize;         // uncompressed
+        uint32_t fCompressedSize;
+    };
+
+    /// Append n values of the given size, byte-shuffled
+    void shuffle(const void* in, size_t n, size_t size, std::vector<unsigned char>& out)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(in);
+        const size_t first = out.size();
+        out.resize(first + n*size);
+        unsigned char* o = &out[first];
+        for (size_t b = 0; b != size; ++b)
+        {
+            for (size_t i = 0; i != n; ++i)
+                o[b*n + i] = bytes[i*size + b];
+        }
+    }
+
+    /// Read n byte-shuffled values of the given size and advance the input
+    void unshuffle(const unsigned char*& in, size_t n, size_t size, void* out)
+    {
+        unsigned char* bytes = static_cast<unsigned char*>(out);
+        for (size_t b = 0; b != size; ++b)
+        {
+            for (size_t i = 0; i != n; ++i)
+                bytes[i*size + b] = in[b*n + i];
+        }
+        in += n*size;
+    }
+
+    bool quantize(double value, double step, int32_t& q)
+    {
+        const double r = std::floor(value/step + 0.5);
+        if (!(std::fabs(r) < 2147483647.))
+            return false;
+        q = int32_t(r);
+        return true;
+    }
+
+    /// Columns of one chunk
+    struct Chunk
+    {
+        void resize(size_t n, size_t nRaw, bool thinned)
+        {
+            const size_t q = n - nRaw;
+            fRaw.resize(n);
+            fCode.resize(q);
+            fRest.resize(q);
+            fX.resize(q);
+            fY.resize(q);
+            fT.resize(q);
+            fLogP.resize(q);
+            fU1.resize(q);
+            fU2.resize(q);
+            fWeight.resize(thinned ? q : 0);
+            fRecords.resize(nRaw*kRecordWords);
+        }
+
+        std::vector<unsigned char> fRaw;
+        std::vector<uint16_t> fCode;
+        std::vector<uint16_t> fRest;    // description % 1000, the largest direction cosine (bits 13-14) and its sign (bit 15)
+        std::vector<int32_t> fX, fY, fT;
+        std::vector<int32_t> fLogP, fU1, fU2;   // the other two direction cosines
+        std::vector<float> fWeight;
+        std::vector<float> fRecords;    // raw records, field by field
+    };
+
+    /// Payload layout, shared by the writer and the reader
+    template <class Buffer, class Op>
+    void columns(Chunk& c, size_t n, size_t nRaw, bool thinned, Buffer& buffer, Op op)
+    {
+        const size_t q = n - nRaw;
+        op(c.fRaw.data(), n, 1, buffer);
+        op(c.fCode.data(), q, 2, buffer);
+        op(c.fRest.data(), q, 2, buffer);
+        op(c.fX.data(), q, 4, buffer);
+        op(c.fY.data(), q, 4, buffer);
+        op(c.fT.data(), q, 4, buffer);
+        op(c.fLogP.data(), q, 4, buffer);
+        op(c.fU1.data(), q, 4, buffer);
+        op(c.fU2.data(), q, 4, buffer);
+        if (thinned)
+            op(c.fWeight.data(), q, 4, buffer);
+        for (size_t f = 0; f != kRecordWords; ++f)
+            op(c.fRecords.data() + f*nRaw, nRaw, 4, buffer);
+    }
+
+    bool is_particle(const ParticleData<Thinned>& r)
+    {
+        if (!(r.fDescription > 0 && r.fDescription < 9900000) || r.fDescription != std::floor(r.fDescription))
+            return false;
+        const int id = int(r.fDescription/1000);
+        return id != 75 && id != 76 && id != 85 && id != 86 && id < 65536;
+    }
+
+    /**
+     Particle records of one event in an archive. A block, for
+     AtBlockStart and SkipBlock, is a chunk.
+     */
+    struct ArchiveParticleStream: VRawParticleStream
+    {
+        ArchiveParticleStream(boost::shared_ptr<FILE> file, long start, bool thinned, const ArchiveOptions& options):
+            fFile(file), fStart(start), fThinned(thinned), fOptions(options)
+        {
+            Rewind();
+        }
+
+        boost::optional<Particle> NextParticle()
+        {
+            if (fCurrent == fNRecords && !ReadChunk())
+                return boost::optional<Particle>();
+
+            ParticleData<Thinned> r;
+            if (fChunk.fRaw[fCurrent++])
+            {
+                for (size_t f = 0; f != kRecordWords; ++f)
+                    reinterpret_cast<float*>(&r)[f] = fChunk.fRecords[f*fNRaw + fCurrentRaw];
+                ++fCurrentRaw;
+                if (!fThinned)
+                    r.fWeight = 1;
+                return Particle(r);
+            }
+            const size_t i = fCurrentQuantized++;
+            const double p = std::exp(fChunk.fLogP[i]*fOptions.fLogMomentum);
+            const double u1 = fChunk.fU1[i]*fOptions.fDirection;
+            const double u2 = fChunk.fU2[i]*fOptions.fDirection;
+            const uint16_t rest = fChunk.fRest[i];
+            double u[3];
+            const int k = (rest >> 13) & 3;
+            u[k] = std::sqrt(std::max(0., 1 - u1*u1 - u2*u2));
+            if (rest & 0x8000)
+                u[k] = -u[k];
+            u[(k + 1) % 3] = u1;
+            u[(k + 2) % 3] = u2;
+            r.fDescription = fChunk.fCode[i]*1000. + (rest & 0x3ff);
+            r.fPx = p*u[0];
+            r.fPy = p*u[1];
+            r.fPz = p*u[2];
+            r.fX = fChunk.fX[i]*fOptions.fPosition;
+            r.fY = fChunk.fY[i]*fOptions.fPosition;
+            r.fTorZ = fTimeOffset + fChunk.fT[i]*fOptions.fTime;
+            r.fWeight = (fThinned ? fChunk.fWeight[i] : 1);
+            return Particle(r);
+        }
+
+        void Rewind()
+        {
+            fNext = fStart;
+            fNRecords = fCurrent = 0;
+            fAtEnd = false;
+        }
+
+        bool IsValid() const { return bool(fFile); }
+        bool AtBlockStart() const { return !fAtEnd && fCurrent == fNRecords; }
+
+        bool SkipBlock()
+        {
+            ChunkHeader header;
+            if (!ReadHeader(header))
+                return false;
+            fNext += sizeof(ChunkHeader) + header.fCompressedSize;
+            fNRecords = fCurrent = 0;
+            return true;
+        }
+
+        /// Chunks are skipped by seeking in any case
+        void SetEnd(size_t) {}
+
+    private:
+        bool ReadHeader(ChunkHeader& header)
+        {
+            if (fAtEnd)
+                return false;
+            if (fseek(fFile.get(), fNext, SEEK_SET) || fread(&header, sizeof(header), 1, fFile.get()) != 1)
+                throw IOException("ParticleArchive: error reading a chunk header");
+            if (!header.fNRecords)
+            {
+                fAtEnd = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool ReadChunk()
+        {
+            ChunkHeader header;
+            if (!ReadHeader(header))
+                return false;
+            fCompressed.resize(header.fCompressedSize);
+            fPayload.resize(header.fSize);
+            uLongf size = header.fSize;
+            if (fread(fCompressed.data(), 1, fCompressed.size(), fFile.get()) != fCompressed.size() ||
+                uncompress(fPayload.data(), &size, fCompressed.data(), fCompressed.size()) != Z_OK ||
+                size != header.fSize)
+                throw IOException("ParticleArchive: corrupt chunk");
+            fNext += sizeof(ChunkHeader) + header.fCompressedSize;
+
+            fNRecords = header.fNRecords;
+            fNRaw = header.fNRaw;
+            fTimeOffset = header.fTimeOffset;
+            fChunk.resize(fNRecords, fNRaw, fThinned);
+            const unsigned char* in = fPayload.data();
+            columns(fChunk, fNRecords, fNRaw, fThinned, in,
+                    [](void* column, size_t n, size_t s, const unsigned char*& in) { unshuffle(in, n, s, column); });
+            fCurrent = fCurrentQuantized = fCurrentRaw = 0;
+            return true;
+        }
+
+        boost::shared_ptr<FILE> fFile;
+        long fStart;
+        bool fThinned;
+        ArchiveOptions fOptions;
+
+        long fNext;     // offset of the next chunk
+        bool fAtEnd;
+        std::vector<unsigned char> fCompressed;
+        std::vector<unsigned char> fPayload;
+        Chunk fChunk;
+        size_t fNRecords;
+        size_t fNRaw;
+        double fTimeOffset;
+        size_t fCurrent;
+        size_t fCurrentQuantized;
+        size_t fCurrentRaw;
+    };
+}
+
+ArchiveOptions::ArchiveOptions():
+    fPosition(0.1), fTime(0.1), fLogMomentum(1e-4), fDirection(1e-5),
+    fChunkSize(16384), fCompressionLevel(6)
+{
+}
+
+ParticleArchiveWriter::ParticleArchiveWriter(const std::string& filename, bool thinned, const ArchiveOptions& options):
+    fFilename(filename), fFile(0), fThinned(thinned), fOptions(options), fInEvent(false),
+    fNRecords(0), fNRawRecords(0)
+{
+    if (!(options.fPosition > 0 && options.fTime > 0 && options.fLogMomentum > 0 && options.fDirection > 0 && options.fChunkSize > 0))
+        throw std::invalid_argument("ParticleArchiveWriter: the precisions and the chunk size must be positive");
+    fFile = fopen(filename.c_str(), "wb");
+    if (!fFile)
+        throw IOException("Error opening archive '" + filename + "' for writing.\n");
+    setvbuf(fFile, 0, _IOFBF, 1 << 20);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.fMagic, kMagic, sizeof(kMagic));
+    header.fVersion = kVersion;
+    header.fThinned = thinned;
+    header.fPosition = options.fPosition;
+    header.fTime = options.fTime;
+    header.fLogMomentum = options.fLogMomentum;
+    header.fDirection = options.fDirection;
+    header.fChunkSize = options.fChunkSize;
+    WriteBytes(&header, sizeof(header));
+}
+
+ParticleArchiveWriter::~ParticleArchiveWriter()
+{
+    try
+    {
+        Close();
+    }
+    catch (IOException&)
+    {
+    }
+}
+
+void ParticleArchiveWriter::Write(const Block<Thinned>& block)
+{
+    if (!fThinned)
+        throw IOException("Block type does not match the archive '" + fFilename + "'.\n");
+    WriteBlock(block);
+}
+
+void ParticleArchiveWriter::Write(const Block<NotThinned>& block)
+{
+    if (fThinned)
+        throw IOException("Block type does not match the archive '" + fFilename + "'.\n");
+    WriteBlock(block);
+}
+
+template <class Thinning>
+void ParticleArchiveWriter::WriteBlock(const Block<Thinning>& block)
+{
+    if (!fFile)
+        throw IOException("Writing to closed archive '" + fFilename + "'.\n");
+    if (block.IsRunHeader() || block.IsRunTrailer())
+    {
+        WriteBytes(&block, kHeaderSize);
+    }
+    else if (block.IsEventHeader())
+    {
+        if (fInEvent)
+            throw IOException("Event header inside an event writing '" + fFilename + "'.\n");
+        WriteBytes(&block, kHeaderSize);
+        fInEvent = true;
+    }
+    else if (block.IsEventTrailer())
+    {
+        if (!fInEvent)
+            throw IOException("Event trailer outside an event writing '" + fFilename + "'.\n");
+        WriteChunk();
+        ChunkHeader end;
+        std::memset(&end, 0, sizeof(end));
+        WriteBytes(&end, sizeof(end));
+        WriteBytes(&block, kHeaderSize);
+        fInEvent = false;
+    }
+    else if (block.IsLongitudinal())
+    {
+    }
+    else if (fInEvent)
+    {
+        for (size_t i = 0; i != kParticlesInBlock; ++i)
+        {
+            const ParticleData<Thinning>& p = block.AsParticleBlock.fParticle[i];
+            if (p.fDescription == 0) // empty
+                continue;
+            ParticleData<Thinned> r;
+            std::memcpy(&r, &p, sizeof(p));
+            if (!fThinned)
+                r.fWeight = 1;
+            Add(r);
+        }
+    }
+}
+
+void ParticleArchiveWriter::Add(const ParticleData<Thinned>& record)
+{
+    fChunk.push_back(record);
+    if (fChunk.size() == fOptions.fChunkSize)
+        WriteChunk();
+}
+
+void ParticleArchiveWriter::WriteChunk()
+{
+    if (fChunk.empty())
+        return;
+
+    // times are relative to the earliest particle, so they stay small
+    double tmin = HUGE_VAL;
+    for (size_t i = 0; i != fChunk.size(); ++i)
+    {
+        if (is_particle(fChunk[i]) && std::isfinite(fChunk[i].fTorZ))
+            tmin = std::min(tmin, double(fChunk[i].fTorZ));
+    }
+    if (tmin == HUGE_VAL)
+        tmin = 0;
+
+    const size_t n = fChunk.size();
+    Chunk c;
+    c.fRaw.resize(n);
+    std::vector<size_t> raw;
+    for (size_t i = 0; i != n; ++i)
+    {
+        const ParticleData<Thinned>& r = fChunk[i];
+        const double p = std::sqrt(double(r.fPx)*r.fPx + double(r.fPy)*r.fPy + double(r.fPz)*r.fPz);
+        // the largest direction cosine is computed from the other two, so it is always precise
+        const double u[3] = { r.fPx/p, r.fPy/p, r.fPz/p };
+        int k = (std::fabs(u[0]) > std::fabs(u[1]) ? 0 : 1);
+        if (std::fabs(u[2]) >= std::fabs(u[k]))
+            k = 2;
+        int32_t x, y, t, logp, u1, u2;
+        const bool quantized = is_particle(r) && p > 0 && std::isfinite(p) &&
+            quantize(r.fX, fOptions.fPosition, x) && quantize(r.fY, fOptions.fPosition, y) &&
+            quantize(r.fTorZ - tmin, fOptions.fTime, t) && quantize(std::log(p), fOptions.fLogMomentum, logp) &&
+            quantize(u[(k + 1) % 3], fOptions.fDirection, u1) && quantize(u[(k + 2) % 3], fOptions.fDirection, u2);
+        if (!quantized)
+        {
+            c.fRaw[i] = 1;
+            raw.push_back(i);
+            continue;
+        }
+        const int description = int(r.fDescription);
+        c.fCode.push_back(description/1000);
+        c.fRest.push_back((description % 1000) | (k << 13) | (u[k] < 0 ? 0x8000 : 0));
+        c.fX.push_back(x);
+        c.fY.push_back(y);
+        c.fT.push_back(t);
+        c.fLogP.push_back(logp);
+        c.fU1.push_back(u1);
+        c.fU2.push_back(u2);
+        if (fThinned)
+            c.fWeight.push_back(r.fWeight);
+    }
+    c.fRecords.resize(raw.size()*kRecordWords);
+    for (size_t k = 0; k != raw.size(); ++k)
+    {
+        for (size_t f = 0; f != kRecordWords; ++f)
+            c.fRecords[f*raw.size() + k] = reinterpret_cast<const float*>(&fChunk[raw[k]])[f];
+    }
+
+    std::vector<unsigned char> payload;
+    columns(c, n, raw.size(), fThinned, payload,
+            [](void* column, size_t n, size_t s, std::vector<unsigned char>& out) { shuffle(column, n, s, out); });
+    uLongf size = compressBound(payload.size());
+    std::vector<unsigned char> compressed(size);
+    if (compress2(compressed.data(), &size, payload.data(), payload.size(), fOptions.fCompressionLevel) != Z_OK)
+        throw IOException("Error compressing a chunk of '" + fFilename + "'.\n");
+
+    ChunkHeader header;
+    header.fNRecords = n;
+    header.fNRaw = raw.size();
+    header.fTimeOffset = tmin;
+    header.fSize = payload.size();
+    header.fCompressedSize = size;
+    WriteBytes(&header, sizeof(header));
+    WriteBytes(compressed.data(), size);
+
+    fNRecords += n;
+    fNRawRecords += raw.size();
+    fChunk.clear();
+}
+
+void ParticleArchiveWriter::WriteBytes(const void* data, size_t size)
+{
+    if (fwrite(data, 1, size, fFile) != size)
+        throw IOException("Error writing archive '" + fFilename + "'.\n");
+}
+
+void ParticleArchiveWriter::Close()
+{
+    if (!fFile)
+        return;
+    if (fInEvent)
+    {
+        // an event without trailer, the reader ignores it
+        fInEvent = false;
+        WriteChunk();
+    }
+    FILE* f = fFile;
+    fFile = 0;
+    if (fclose(f))
+        throw IOException("Error closing archive '" + fFilename + "'.\n");
+}
+
+namespace
+{
+    template <class Thinning>
+    void convert(RawStream& in, ParticleArchiveWriter& out)
+    {
+        Block<Thinning> block;
+        while (in.GetNextBlock(block))
+        {
+            out.Write(block);
+            if (block.IsRunTrailer())
+                break;
+        }
+    }
+}
+
+size_t ParticleArchiveWriter::Convert(const std::string& corsikaFile, const std::string& archive,
+                                      const ArchiveOptions& options)
+{
+    RawStreamPtr in = RawStream::Create(corsikaFile);
+    ParticleArchiveWriter out(archive, in->IsThinned(), options);
+    if (in->IsThinned())
+        convert<Thinned>(*in, out);
+    else
+        convert<NotThinned>(*in, out);
+    out.Close();
+    return out.GetNRecords();
+}
+
+ParticleArchive::ParticleArchive():
+    fThinned(false)
+{
+}
+
+ParticleArchive::ParticleArchive(const std::string& filename):
+    fThinned(false)
+{
+    Open(filename);
+}
+
+void ParticleArchive::Open(const std::string& filename)
+{
+    Close();
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f)
+        throw IOException("Error opening archive '" + filename + "'.\n");
+    boost::shared_ptr<FILE> file(f, fclose);
+
+    FileHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || std::memcmp(header.fMagic, kMagic, sizeof(kMagic)))
+        throw IOException("Not a particle archive: '" + filename + "'.\n");
+    if (header.fVersion != kVersion)
+        throw IOException("Unsupported particle archive version in '" + filename + "'.\n");
+    fThinned = header.fThinned;
+    fOptions.fPosition = header.fPosition;
+    fOptions.fTime = header.fTime;
+    fOptions.fLogMomentum = header.fLogMomentum;
+    fOptions.fDirection = header.fDirection;
+    fOptions.fChunkSize = header.fChunkSize;
+
+    Block<NotThinned> block;
+    if (fread(&block, kHeaderSize, 1, f) != 1 || !block.IsRunHeader())
+        throw IOException("Missing run header in archive '" + filename + "'.\n");
+    fRunHeader = block.AsRunHeader;
+
+    // index the events, skipping over the chunks
+    while (fread(&block, kHeaderSize, 1, f) == 1 && block.IsEventHeader())
+    {
+        Event event;
+        event.fHeader = block.AsEventHeader;
+        event.fFirstChunk = ftell(f);
+        ChunkHeader chunk;
+        bool complete = false;
+        while (fread(&chunk, sizeof(chunk), 1, f) == 1)
+        {
+            if (!chunk.fNRecords)
+            {
+                complete = true;
+                break;
+            }
+            if (fseek(f, chunk.fCompressedSize, SEEK_CUR))
+                break;
+        }
+        if (!complete || fread(&block, kHeaderSize, 1, f) != 1 || !block.IsEventTrailer())
+            break; // truncated
+        event.fTrailer = block.AsEventTrailer;
+        fEvents.push_back(event);
+    }
+    fFile = file;
+    fFilename = filename;
+}
+
+void ParticleArchive::Close()
+{
+    fCurrentShower = Shower();
+    fParticleStream.reset();
+    fEvents.clear();
+    fFile.reset();
+    fRunHeader = RunHeader();
+}
+
+Status ParticleArchive::FindEvent(unsigned int eventId)
+{
+    if (!IsOpen())
+        return eEOF;
+    for (size_t i = 0; i != fEvents.size(); ++i)
+    {
+        const Event& event = fEvents[i];
+        if (unsigned(event.fHeader.fEventNumber) != eventId)
+            continue;
+        RawParticleStreamPtr records(new ArchiveParticleStream(fFile, event.fFirstChunk, fThinned, fOptions));
+        // the same settings as ShowerFile
+        fParticleStream.reset(new ShowerParticleStream(records, ShowerFrame::CoreTimeShift(event.fHeader), 1, true));
+        fCurrentShower = Shower(event.fHeader, event.fTrailer, fParticleStream.get());
+        return eSuccess;
+    }
+    return eFail;
+}
+
+bool ParticleArchive::IsValid(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[sizeof(kMagic)];
+    const bool valid = fread(magic, sizeof(magic), 1, f) == 1 && !std::memcmp(magic, kMagic, sizeof(kMagic));
+    fclose(f);
+    return valid;
+}
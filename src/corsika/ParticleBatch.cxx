@@ -0,0 +1,267 @@
+/**
+ \file
+ Implementation of the columnar particle batch
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ParticleBatch.h>
+#include <corsika/particle/ParticleList.h>
+#include <corsika/particle/NucleusProperties.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace corsika;
+
+namespace
+{
+    const char* kColumnNames[] =
+    {
+        "x", "y", "r", "t", "px", "py", "pz", "p", "ekin",
+        "pdg", "corsika_code", "level", "generation", "weight"
+    };
+
+    // PDG code and mass for every CORSIKA code. Filling a batch
+    // happens once per particle, so we avoid the map lookups in
+    // ParticleList. The table is built once and only read afterwards,
+    // so it can be shared between threads.
+    struct CodeTable
+    {
+        static const int kSize = 10000;
+        int pdg[kSize];
+        float mass[kSize];
+
+        CodeTable()
+        {
+            for (int code = 0; code != kSize; ++code)
+            {
+                pdg[code] = ParticleList::CorsikaToPDG(code);
+                mass[code] = 0;
+                if (pdg[code] == Particle::eUndefined)
+                    continue;
+                if (NucleusProperties::IsNucleus(pdg[code]))
+                {
+                    mass[code] = NucleusProperties(pdg[code]).GetMass();
+                    continue;
+                }
+                try
+                {
+                    mass[code] = ParticleList::Get(pdg[code]).GetMass();
+                }
+                catch (std::exception&)
+                {
+                }
+            }
+        }
+    };
+
+    const CodeTable& GetCodeTable()
+    {
+        static const CodeTable table;
+        return table;
+    }
+}
+
+
+ParticleBatch::Column ParticleBatch::ColumnFromName(const std::string& name)
+{
+    for (int i = 0; i != eNColumns; ++i)
+    {
+        if (name == kColumnNames[i])
+            return Column(i);
+    }
+    return eNColumns;
+}
+
+std::string ParticleBatch::ColumnName(Column c)
+{
+    if (c < 0 || c >= eNColumns)
+        return "";
+    return kColumnNames[c];
+}
+
+void ParticleBatch::clear()
+{
+    fX.clear();
+    fY.clear();
+    fT.clear();
+    fPx.clear();
+    fPy.clear();
+    fPz.clear();
+    fKineticEnergy.clear();
+    fWeight.clear();
+    fPDG.clear();
+    fCorsikaCode.clear();
+    fLevel.clear();
+    fGeneration.clear();
+}
+
+void ParticleBatch::reserve(size_t n)
+{
+    fX.reserve(n);
+    fY.reserve(n);
+    fT.reserve(n);
+    fPx.reserve(n);
+    fPy.reserve(n);
+    fPz.reserve(n);
+    fKineticEnergy.reserve(n);
+    fWeight.reserve(n);
+    fPDG.reserve(n);
+    fCorsikaCode.reserve(n);
+    fLevel.reserve(n);
+    fGeneration.reserve(n);
+}
+
+void ParticleBatch::push_back(const Particle& p)
+{
+    const CodeTable& table = GetCodeTable();
+    const int code = std::abs(int(p.fDescription/1000));
+    const bool known = code < CodeTable::kSize;
+    const double mass = (known ? table.mass[code] : 0.);
+    const double p2 = double(p.fPx)*p.fPx + double(p.fPy)*p.fPy + double(p.fPz)*p.fPz;
+
+    fX.push_back(p.fX);
+    fY.push_back(p.fY);
+    fT.push_back(p.fTorZ);
+    fPx.push_back(p.fPx);
+    fPy.push_back(p.fPy);
+    fPz.push_back(p.fPz);
+    fKineticEnergy.push_back(std::sqrt(p2 + mass*mass) - mass);
+    fWeight.push_back(p.fWeight);
+    fPDG.push_back(known ? table.pdg[code] : int(Particle::eUndefined));
+    fCorsikaCode.push_back(code);
+    fLevel.push_back(p.ObservingLevel());
+    fGeneration.push_back(p.HadronicGeneration());
+}
+
+namespace
+{
+    template <class T> void append(std::vector<T>& v, const std::vector<T>& other)
+    {
+        v.insert(v.end(), other.begin(), other.end());
+    }
+
+    template <class T> void compact(std::vector<T>& v, const std::vector<char>& mask)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i != v.size(); ++i)
+        {
+            if (mask[i])
+                v[j++] = v[i];
+        }
+        v.resize(j);
+    }
+}
+
+void ParticleBatch::push_back(const ParticleBatch& other, size_t i)
+{
+    fX.push_back(other.fX[i]);
+    fY.push_back(other.fY[i]);
+    fT.push_back(other.fT[i]);
+    fPx.push_back(other.fPx[i]);
+    fPy.push_back(other.fPy[i]);
+    fPz.push_back(other.fPz[i]);
+    fKineticEnergy.push_back(other.fKineticEnergy[i]);
+    fWeight.push_back(other.fWeight[i]);
+    fPDG.push_back(other.fPDG[i]);
+    fCorsikaCode.push_back(other.fCorsikaCode[i]);
+    fLevel.push_back(other.fLevel[i]);
+    fGeneration.push_back(other.fGeneration[i]);
+}
+
+void ParticleBatch::Append(const ParticleBatch& other)
+{
+    append(fX, other.fX);
+    append(fY, other.fY);
+    append(fT, other.fT);
+    append(fPx, other.fPx);
+    append(fPy, other.fPy);
+    append(fPz, other.fPz);
+    append(fKineticEnergy, other.fKineticEnergy);
+    append(fWeight, other.fWeight);
+    append(fPDG, other.fPDG);
+    append(fCorsikaCode, other.fCorsikaCode);
+    append(fLevel, other.fLevel);
+    append(fGeneration, other.fGeneration);
+}
+
+size_t ParticleBatch::Compact(const std::vector<char>& mask)
+{
+    compact(fX, mask);
+    compact(fY, mask);
+    compact(fT, mask);
+    compact(fPx, mask);
+    compact(fPy, mask);
+    compact(fPz, mask);
+    compact(fKineticEnergy, mask);
+    compact(fWeight, mask);
+    compact(fPDG, mask);
+    compact(fCorsikaCode, mask);
+    compact(fLevel, mask);
+    compact(fGeneration, mask);
+    return size();
+}
+
+double ParticleBatch::Get(Column c, size_t i) const
+{
+    switch (c)
+    {
+        case eX: return fX[i];
+        case eY: return fY[i];
+        case eR: return std::sqrt(double(fX[i])*fX[i] + double(fY[i])*fY[i]);
+        case eT: return fT[i];
+        case ePx: return fPx[i];
+        case ePy: return fPy[i];
+        case ePz: return fPz[i];
+        case eMomentum: return std::sqrt(double(fPx[i])*fPx[i] + double(fPy[i])*fPy[i] + double(fPz[i])*fPz[i]);
+        case eKineticEnergy: return fKineticEnergy[i];
+        case ePDG: return fPDG[i];
+        case eCorsikaCode: return fCorsikaCode[i];
+        case eLevel: return fLevel[i];
+        case eGeneration: return fGeneration[i];
+        case eWeight: return fWeight[i];
+        default: return 0;
+    }
+}
+
+namespace
+{
+    template <class T> void copy_column(const std::vector<T>& v, double* out)
+    {
+        const size_t n = v.size();
+        for (size_t i = 0; i != n; ++i)
+            out[i] = v[i];
+    }
+}
+
+void ParticleBatch::GetColumn(Column c, double* out) const
+{
+    const size_t n = size();
+    switch (c)
+    {
+        case eX: copy_column(fX, out); break;
+        case eY: copy_column(fY, out); break;
+        case eR:
+            for (size_t i = 0; i != n; ++i)
+                out[i] = std::sqrt(double(fX[i])*fX[i] + double(fY[i])*fY[i]);
+            break;
+        case eT: copy_column(fT, out); break;
+        case ePx: copy_column(fPx, out); break;
+        case ePy: copy_column(fPy, out); break;
+        case ePz: copy_column(fPz, out); break;
+        case eMomentum:
+            for (size_t i = 0; i != n; ++i)
+                out[i] = std::sqrt(double(fPx[i])*fPx[i] + double(fPy[i])*fPy[i] + double(fPz[i])*fPz[i]);
+            break;
+        case eKineticEnergy: copy_column(fKineticEnergy, out); break;
+        case ePDG: copy_column(fPDG, out); break;
+        case eCorsikaCode: copy_column(fCorsikaCode, out); break;
+        case eLevel: copy_column(fLevel, out); break;
+        case eGeneration: copy_column(fGeneration, out); break;
+        case eWeight: copy_column(fWeight, out); break;
+        default:
+            for (size_t i = 0; i != n; ++i)
+                out[i] = 0;
+    }
+}
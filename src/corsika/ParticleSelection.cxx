@@ -0,0 +1,599 @@
+/**
+ \file
+ Parser and batch evaluation of particle selection expressions
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ParticleSelection.h>
+#include <corsika/Particle.h>
+#include <corsika/Units.h>
+#include <corsika/Trace.h>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+using namespace corsika;
+
+struct ParticleSelection::Node
+{
+    virtual ~Node() {}
+    /**
+     Write the value for every particle in the batch into out[0..n),
+     n = batch.size(). scratch holds Temporaries() arrays of n values
+     that the node may overwrite.
+     */
+    virtual void Eval(const ParticleBatch& batch, double* out, double* scratch) const = 0;
+    /// Number of scratch arrays Eval needs
+    virtual size_t Temporaries() const { return 0; }
+    /// True (and the value) if the node does not depend on the particles
+    virtual bool Fold(double&) const { return false; }
+};
+
+/// Scratch buffers shared by the copies of a selection, so each batch does not allocate
+struct ParticleSelection::ScratchPool
+{
+    std::mutex fMutex;
+    std::vector<std::vector<double> > fFree;
+
+    std::vector<double> Acquire()
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        std::vector<double> buffer;
+        if (!fFree.empty())
+        {
+            buffer.swap(fFree.back());
+            fFree.pop_back();
+        }
+        return buffer;
+    }
+
+    void Release(std::vector<double>& buffer)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fFree.push_back(std::vector<double>());
+        fFree.back().swap(buffer);
+    }
+};
+
+namespace
+{
+    typedef ParticleSelection::Node Node;
+    typedef boost::shared_ptr<const Node> NodePtr;
+
+    enum Operator
+    {
+        eAdd, eSub, eMul, eDiv,
+        eLess, eLessEqual, eGreater, eGreaterEqual, eEqual, eNotEqual,
+        eAnd, eOr
+    };
+
+    enum Function
+    {
+        eNeg, eNot, eAbs, eSqrt, eExp, eLog, eLog10
+    };
+
+    inline double apply(Operator op, double a, double b)
+    {
+        switch (op)
+        {
+            case eAdd: return a + b;
+            case eSub: return a - b;
+            case eMul: return a * b;
+            case eDiv: return a / b;
+            case eLess: return a < b;
+            case eLessEqual: return a <= b;
+            case eGreater: return a > b;
+            case eGreaterEqual: return a >= b;
+            case eEqual: return a == b;
+            case eNotEqual: return a != b;
+            case eAnd: return (a != 0) && (b != 0);
+            case eOr: return (a != 0) || (b != 0);
+        }
+        return 0;
+    }
+
+    inline double apply(Function f, double a)
+    {
+        switch (f)
+        {
+            case eNeg: return -a;
+            case eNot: return a == 0;
+            case eAbs: return std::fabs(a);
+            case eSqrt: return std::sqrt(a);
+            case eExp: return std::exp(a);
+            case eLog: return std::log(a);
+            case eLog10: return std::log10(a);
+        }
+        return 0;
+    }
+
+    struct ConstNode: Node
+    {
+        double value;
+        ConstNode(double v): value(v) {}
+        void Eval(const ParticleBatch& batch, double* out, double*) const
+        {
+            std::fill(out, out + batch.size(), value);
+        }
+        bool Fold(double& v) const { v = value; return true; }
+    };
+
+    struct ColumnNode: Node
+    {
+        ParticleBatch::Column column;
+        ColumnNode(ParticleBatch::Column c): column(c) {}
+        void Eval(const ParticleBatch& batch, double* out, double*) const
+        {
+            batch.GetColumn(column, out);
+        }
+    };
+
+    struct FunctionNode: Node
+    {
+        Function function;
+        NodePtr arg;
+        FunctionNode(Function f, NodePtr a): function(f), arg(a) {}
+        void Eval(const ParticleBatch& batch, double* out, double* scratch) const
+        {
+            const size_t n = batch.size();
+            arg->Eval(batch, out, scratch);
+            switch (function)
+            {
+                // one loop per function so the compiler can vectorize them
+                case eNeg: for (size_t i = 0; i != n; ++i) out[i] = -out[i]; break;
+                case eNot: for (size_t i = 0; i != n; ++i) out[i] = (out[i] == 0); break;
+                case eAbs: for (size_t i = 0; i != n; ++i) out[i] = std::fabs(out[i]); break;
+                case eSqrt: for (size_t i = 0; i != n; ++i) out[i] = std::sqrt(out[i]); break;
+                default: for (size_t i = 0; i != n; ++i) out[i] = apply(function, out[i]);
+            }
+        }
+        size_t Temporaries() const { return arg->Temporaries(); }
+        bool Fold(double& v) const
+        {
+            double a;
+            if (!arg->Fold(a)) return false;
+            v = apply(function, a);
+            return true;
+        }
+    };
+
+    template <class Op> void binary_loop(double* out, const double* rhs, size_t n, Op op)
+    {
+        for (size_t i = 0; i != n; ++i)
+            out[i] = op(out[i], rhs[i]);
+    }
+
+    struct BinaryNode: Node
+    {
+        Operator op;
+        NodePtr lhs, rhs;
+        BinaryNode(Operator o, NodePtr l, NodePtr r): op(o), lhs(l), rhs(r) {}
+        void Eval(const ParticleBatch& batch, double* out, double* scratch) const
+        {
+            // the right hand side goes to the first scratch array, its own temporaries after it
+            const size_t n = batch.size();
+            lhs->Eval(batch, out, scratch);
+            rhs->Eval(batch, scratch, scratch + n);
+            const double* r = scratch;
+            switch (op)
+            {
+                case eAdd: binary_loop(out, r, n, [](double a, double b) { return a + b; }); break;
+                case eSub: binary_loop(out, r, n, [](double a, double b) { return a - b; }); break;
+                case eMul: binary_loop(out, r, n, [](double a, double b) { return a * b; }); break;
+                case eDiv: binary_loop(out, r, n, [](double a, double b) { return a / b; }); break;
+                case eLess: binary_loop(out, r, n, [](double a, double b) { return double(a < b); }); break;
+                case eLessEqual: binary_loop(out, r, n, [](double a, double b) { return double(a <= b); }); break;
+                case eGreater: binary_loop(out, r, n, [](double a, double b) { return double(a > b); }); break;
+                case eGreaterEqual: binary_loop(out, r, n, [](double a, double b) { return double(a >= b); }); break;
+                case eEqual: binary_loop(out, r, n, [](double a, double b) { return double(a == b); }); break;
+                case eNotEqual: binary_loop(out, r, n, [](double a, double b) { return double(a != b); }); break;
+                case eAnd: binary_loop(out, r, n, [](double a, double b) { return double(a != 0 && b != 0); }); break;
+                case eOr: binary_loop(out, r, n, [](double a, double b) { return double(a != 0 || b != 0); }); break;
+            }
+        }
+        size_t Temporaries() const { return std::max(lhs->Temporaries(), 1 + rhs->Temporaries()); }
+        bool Fold(double& v) const
+        {
+            double a, b;
+            if (!lhs->Fold(a) || !rhs->Fold(b)) return false;
+            v = apply(op, a, b);
+            return true;
+        }
+    };
+
+    struct InNode: Node
+    {
+        NodePtr arg;
+        std::vector<double> values;
+        bool negate;
+        InNode(NodePtr a, const std::vector<double>& v, bool n): arg(a), values(v), negate(n) {}
+        void Eval(const ParticleBatch& batch, double* out, double* scratch) const
+        {
+            const size_t n = batch.size();
+            arg->Eval(batch, out, scratch);
+            for (size_t i = 0; i != n; ++i)
+            {
+                bool found = false;
+                for (size_t j = 0; j != values.size(); ++j)
+                    found |= (out[i] == values[j]);
+                out[i] = (found != negate);
+            }
+        }
+        size_t Temporaries() const { return arg->Temporaries(); }
+        bool Fold(double& v) const
+        {
+            double a;
+            if (!arg->Fold(a)) return false;
+            const bool found = std::find(values.begin(), values.end(), a) != values.end();
+            v = (found != negate);
+            return true;
+        }
+    };
+
+    struct NamedConstant
+    {
+        const char* name;
+        double value;
+    };
+
+    const NamedConstant kConstants[] =
+    {
+        {"mm", mm}, {"cm", cm}, {"m", m}, {"km", km},
+        {"ns", ns}, {"us", microsecond}, {"ms", ms}, {"s", s},
+        {"eV", eV}, {"keV", keV}, {"MeV", MeV}, {"GeV", GeV}, {"TeV", TeV}, {"PeV", PeV}, {"EeV", EeV},
+        {"rad", rad}, {"deg", deg}
+    };
+
+    struct Token
+    {
+        enum Type { eNumber, eName, eSymbol, eEnd };
+        Type type;
+        std::string text;
+        double number;
+        size_t position;
+    };
+
+    /*
+      Recursive descent parser. The grammar is
+
+      or         := and ( ("or" | "||") and )*
+      and        := not ( ("and" | "&&") not )*
+      not        := ("not" | "!") not | comparison
+      comparison := sum [ ("<" | "<=" | ">" | ">=" | "==" | "=" | "!=") sum ]
+                  | sum ["not"] "in" "(" sum ("," sum)* ")"
+      sum        := product ( ("+" | "-") product )*
+      product    := unary ( ("*" | "/") unary )*
+      unary      := "-" unary | primary
+      primary    := number | column | unit | function "(" or ")" | "(" or ")"
+     */
+    struct Parser
+    {
+        Parser(const std::string& e): expression(e), current(0)
+        {
+            Tokenize();
+        }
+
+        NodePtr Parse()
+        {
+            NodePtr root = ParseOr();
+            if (Peek().type != Token::eEnd)
+                Error("unexpected '" + Peek().text + "'");
+            return root;
+        }
+
+    private:
+        std::string expression;
+        std::vector<Token> tokens;
+        size_t current;
+
+        void Error(const std::string& message) const
+        {
+            std::ostringstream msg;
+            msg << "Invalid particle selection \"" << expression << "\": " << message
+                << " at position " << Peek().position;
+            throw std::invalid_argument(msg.str());
+        }
+
+        void Tokenize()
+        {
+            const std::string& e = expression;
+            size_t i = 0;
+            while (i < e.size())
+            {
+                if (std::isspace((unsigned char)e[i]))
+                {
+                    ++i;
+                    continue;
+                }
+                Token t;
+                t.position = i;
+                t.number = 0;
+                if (std::isdigit((unsigned char)e[i]) || (e[i] == '.' && i+1 < e.size() && std::isdigit((unsigned char)e[i+1])))
+                {
+                    const char* begin = e.c_str() + i;
+                    char* end;
+                    t.type = Token::eNumber;
+                    t.number = std::strtod(begin, &end);
+                    t.text = std::string(begin, (const char*)end);
+                    i += end - begin;
+                }
+                else if (std::isalpha((unsigned char)e[i]) || e[i] == '_')
+                {
+                    size_t j = i;
+                    while (j < e.size() && (std::isalnum((unsigned char)e[j]) || e[j] == '_'))
+                        ++j;
+                    t.type = Token::eName;
+                    t.text = e.substr(i, j - i);
+                    i = j;
+                }
+                else
+                {
+                    static const char* symbols[] = {"<=", ">=", "==", "!=", "&&", "||", "<", ">", "=", "!", "+", "-", "*", "/", "(", ")", ","};
+                    t.type = Token::eSymbol;
+                    for (size_t s = 0; s != sizeof(symbols)/sizeof(symbols[0]); ++s)
+                    {
+                        if (e.compare(i, strlen(symbols[s]), symbols[s]) == 0)
+                        {
+                            t.text = symbols[s];
+                            break;
+                        }
+                    }
+                    if (t.text.empty())
+                    {
+                        std::ostringstream msg;
+                        msg << "Invalid particle selection \"" << expression << "\": unexpected character '"
+                            << e[i] << "' at position " << i;
+                        throw std::invalid_argument(msg.str());
+                    }
+                    i += t.text.size();
+                }
+                tokens.push_back(t);
+            }
+            Token end;
+            end.type = Token::eEnd;
+            end.number = 0;
+            end.position = e.size();
+            tokens.push_back(end);
+        }
+
+        const Token& Peek() const { return tokens[current]; }
+
+        bool Accept(const char* text)
+        {
+            const Token& t = Peek();
+            if (t.type != Token::eEnd && t.type != Token::eNumber && t.text == text)
+            {
+                ++current;
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(const char* text)
+        {
+            if (!Accept(text))
+                Error(std::string("expected '") + text + "'");
+        }
+
+        static NodePtr Binary(Operator op, NodePtr lhs, NodePtr rhs)
+        {
+            NodePtr node(new BinaryNode(op, lhs, rhs));
+            double v;
+            if (node->Fold(v))
+                return NodePtr(new ConstNode(v));
+            return node;
+        }
+
+        static NodePtr Unary(Function f, NodePtr arg)
+        {
+            NodePtr node(new FunctionNode(f, arg));
+            double v;
+            if (node->Fold(v))
+                return NodePtr(new ConstNode(v));
+            return node;
+        }
+
+        NodePtr ParseOr()
+        {
+            NodePtr lhs = ParseAnd();
+            while (Accept("or") || Accept("||"))
+                lhs = Binary(eOr, lhs, ParseAnd());
+            return lhs;
+        }
+
+        NodePtr ParseAnd()
+        {
+            NodePtr lhs = ParseNot();
+            while (Accept("and") || Accept("&&"))
+                lhs = Binary(eAnd, lhs, ParseNot());
+            return lhs;
+        }
+
+        NodePtr ParseNot()
+        {
+            if (Accept("not") || Accept("!"))
+                return Unary(eNot, ParseNot());
+            return ParseComparison();
+        }
+
+        NodePtr ParseComparison()
+        {
+            NodePtr lhs = ParseSum();
+            static const struct { const char* text; Operator op; } comparisons[] =
+            {
+                {"<=", eLessEqual}, {">=", eGreaterEqual}, {"<", eLess}, {">", eGreater},
+                {"==", eEqual}, {"=", eEqual}, {"!=", eNotEqual}
+            };
+            for (size_t i = 0; i != sizeof(comparisons)/sizeof(comparisons[0]); ++i)
+            {
+                if (Accept(comparisons[i].text))
+                    return Binary(comparisons[i].op, lhs, ParseSum());
+            }
+            bool negate = false;
+            if (Peek().text == "not" && tokens[current+1].text == "in")
+            {
+                ++current;
+                negate = true;
+            }
+            if (Accept("in"))
+            {
+                std::vector<double> values;
+                Expect("(");
+                do
+                {
+                    double v;
+                    if (!ParseSum()->Fold(v))
+                        Error("the elements of a set must be constants");
+                    values.push_back(v);
+                }
+                while (Accept(","));
+                Expect(")");
+                NodePtr node(new InNode(lhs, values, negate));
+                double v;
+                if (node->Fold(v))
+                    return NodePtr(new ConstNode(v));
+                return node;
+            }
+            return lhs;
+        }
+
+        NodePtr ParseSum()
+        {
+            NodePtr lhs = ParseProduct();
+            while (true)
+            {
+                if (Accept("+"))
+                    lhs = Binary(eAdd, lhs, ParseProduct());
+                else if (Accept("-"))
+                    lhs = Binary(eSub, lhs, ParseProduct());
+                else
+                    return lhs;
+            }
+        }
+
+        NodePtr ParseProduct()
+        {
+            NodePtr lhs = ParseUnary();
+            while (true)
+            {
+                if (Accept("*"))
+                    lhs = Binary(eMul, lhs, ParseUnary());
+                else if (Accept("/"))
+                    lhs = Binary(eDiv, lhs, ParseUnary());
+                else
+                    return lhs;
+            }
+        }
+
+        NodePtr ParseUnary()
+        {
+            if (Accept("-"))
+                return Unary(eNeg, ParseUnary());
+            if (Accept("+"))
+                return ParseUnary();
+            return ParsePrimary();
+        }
+
+        NodePtr ParsePrimary()
+        {
+            const Token t = Peek();
+            if (t.type == Token::eNumber)
+            {
+                ++current;
+                return NodePtr(new ConstNode(t.number));
+            }
+            if (Accept("("))
+            {
+                NodePtr node = ParseOr();
+                Expect(")");
+                return node;
+            }
+            if (t.type != Token::eName)
+            {
+                Error(t.type == Token::eEnd ? "unexpected end of expression" : "unexpected '" + t.text + "'");
+            }
+            ++current;
+
+            static const struct { const char* name; Function f; } functions[] =
+            {
+                {"abs", eAbs}, {"sqrt", eSqrt}, {"exp", eExp}, {"log", eLog}, {"log10", eLog10}
+            };
+            for (size_t i = 0; i != sizeof(functions)/sizeof(functions[0]); ++i)
+            {
+                if (t.text == functions[i].name)
+                {
+                    Expect("(");
+                    NodePtr arg = ParseOr();
+                    Expect(")");
+                    return Unary(functions[i].f, arg);
+                }
+            }
+
+            const ParticleBatch::Column column = ParticleBatch::ColumnFromName(t.text);
+            if (column != ParticleBatch::eNColumns)
+                return NodePtr(new ColumnNode(column));
+
+            for (size_t i = 0; i != sizeof(kConstants)/sizeof(kConstants[0]); ++i)
+            {
+                if (t.text == kConstants[i].name)
+                    return NodePtr(new ConstNode(kConstants[i].value));
+            }
+            --current;
+            Error("unknown name '" + t.text + "'");
+            return NodePtr();
+        }
+    };
+}
+
+
+ParticleSelection::ParticleSelection(const std::string& expression):
+    fExpression(expression),
+    fScratch(new ScratchPool)
+{
+    fRoot = Parser(expression).Parse();
+    fNTemporaries = fRoot->Temporaries();
+}
+
+void ParticleSelection::Evaluate(const ParticleBatch& batch, std::vector<char>& mask) const
+{
+    CORSIKA_TRACE("ParticleSelection", "filter");
+    const size_t n = batch.size();
+    // values first, then the temporaries of the nodes
+    std::vector<double> buffer = fScratch->Acquire();
+    buffer.resize((1 + fNTemporaries)*n);
+    fRoot->Eval(batch, buffer.data(), buffer.data() + n);
+    mask.resize(n);
+    for (size_t i = 0; i != n; ++i)
+        mask[i] = (buffer[i] != 0);
+    fScratch->Release(buffer);
+}
+
+size_t ParticleSelection::Count(const ParticleBatch& batch) const
+{
+    std::vector<char> mask;
+    Evaluate(batch, mask);
+    return std::count(mask.begin(), mask.end(), 1);
+}
+
+size_t ParticleSelection::Select(ParticleBatch& batch) const
+{
+    std::vector<char> mask;
+    Evaluate(batch, mask);
+    return batch.Compact(mask);
+}
+
+bool ParticleSelection::operator()(const Particle& p) const
+{
+    ParticleBatch batch;
+    batch.push_back(p);
+    std::vector<double> values(1 + fNTemporaries);
+    fRoot->Eval(batch, values.data(), values.data() + 1);
+    return values[0] != 0;
+}
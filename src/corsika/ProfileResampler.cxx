@@ -0,0 +1,203 @@
+/**
+ \file
+ Implementation of the resampling of longitudinal profiles
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ProfileResampler.h>
+#include <corsika/Parallel.h>
+#include "fast_math.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace corsika;
+
+/**
+ Positions of the grid in the bins of the last profile, and the
+ values of the profile padded with two zeros. Grid points outside the
+ profile point to the zeros. fLower and fUpper are the values around
+ each grid point.
+ */
+struct ProfileResampler::Workspace
+{
+    Workspace(): fNLocated(0) {}
+
+    std::vector<double> fDepth;         // depths the positions were computed for
+    size_t fNLocated;
+    std::vector<uint32_t> fIndex;
+    std::vector<double> fFraction;
+    std::vector<double> fValues;
+    std::vector<double> fLower;
+    std::vector<double> fUpper;
+
+    void Locate(const std::vector<double>& grid, const double* depth, size_t n)
+    {
+        if (fNLocated == n && !fIndex.empty() && (!n || !std::memcmp(fDepth.data(), depth, n*sizeof(double))))
+            return;
+        fDepth.assign(depth, depth + n);
+        fNLocated = n;
+        fIndex.resize(grid.size());
+        fFraction.resize(grid.size());
+        size_t j = 0;
+        for (size_t k = 0; k != grid.size(); ++k)
+        {
+            const double g = grid[k];
+            if (!n || g < depth[0] || g > depth[n-1])
+            {
+                fIndex[k] = n;
+                fFraction[k] = 0;
+                continue;
+            }
+            while (j + 2 < n && depth[j+1] <= g)
+                ++j;
+            fIndex[k] = j;
+            fFraction[k] = (n > 1 ? (g - depth[j])/(depth[j+1] - depth[j]) : 0.);
+        }
+    }
+};
+
+namespace
+{
+    /// Number of bins before the first depth that does not increase
+    size_t used_bins(const double* depth, size_t n)
+    {
+        size_t used = (n ? 1 : 0);
+        while (used < n && depth[used] > depth[used-1])
+            ++used;
+        return used;
+    }
+
+    void interpolate(ProfileResampler::Workspace& w, ProfileResampler::Interpolation mode,
+                     const double* values, size_t n, double* out)
+    {
+        w.fValues.resize(n + 2);
+        std::copy(values, values + n, w.fValues.begin());
+        w.fValues[n] = w.fValues[n+1] = 0;
+
+        // the gather is on its own, so that the loops below run over contiguous arrays
+        const size_t m = w.fIndex.size();
+        w.fLower.resize(m);
+        w.fUpper.resize(m);
+        const double* v = w.fValues.data();
+        const uint32_t* index = w.fIndex.data();
+        double* lower = w.fLower.data();
+        double* upper = w.fUpper.data();
+        for (size_t k = 0; k < m; ++k)
+        {
+            lower[k] = v[index[k]];
+            upper[k] = v[index[k] + 1];
+        }
+
+        const double* fraction = w.fFraction.data();
+        if (mode == ProfileResampler::eLinear)
+        {
+            for (size_t k = 0; k < m; ++k)
+                out[k] = lower[k] + fraction[k]*(upper[k] - lower[k]);
+            return;
+        }
+
+        // both interpolations everywhere, then the logarithmic one is
+        // selected where both values are positive and finite (and the
+        // exponent is in the range of fast_exp)
+        const double smallest = std::numeric_limits<double>::min();
+        const double infinity = std::numeric_limits<double>::infinity();
+        for (size_t k = 0; k < m; ++k)
+        {
+            const double a = lower[k];
+            const double b = upper[k];
+            const double linear = a + fraction[k]*(b - a);
+            const double exponent = fraction[k]*(detail::fast_log(b) - detail::fast_log(a));
+            const double logarithmic = a*detail::fast_exp(exponent);
+            const uint64_t mask = detail::below_mask(a, infinity) & ~detail::below_mask(a, smallest) &
+                                  detail::below_mask(b, infinity) & ~detail::below_mask(b, smallest) &
+                                  detail::below_mask(std::fabs(exponent), 708.);
+            out[k] = detail::from_bits((detail::to_bits(logarithmic) & mask) | (detail::to_bits(linear) & ~mask));
+        }
+    }
+}
+
+ProfileResampler::ProfileResampler(const std::vector<double>& grid, Interpolation mode):
+    fGrid(grid), fMode(mode)
+{
+    for (size_t k = 1; k < fGrid.size(); ++k)
+    {
+        if (!(fGrid[k] > fGrid[k-1]))
+            throw std::invalid_argument("ProfileResampler: the depths of the grid must increase");
+    }
+}
+
+void ProfileResampler::Resample(const double* depth, const double* values, size_t n, double* out) const
+{
+    Workspace w;
+    n = used_bins(depth, n);
+    w.Locate(fGrid, depth, n);
+    interpolate(w, fMode, values, n, out);
+}
+
+std::vector<double> ProfileResampler::Resample(const std::vector<double>& depth, const std::vector<double>& values) const
+{
+    if (depth.size() != values.size())
+        throw std::invalid_argument("ProfileResampler: depths and values of different size");
+    std::vector<double> out(fGrid.size());
+    Resample(depth.data(), values.data(), depth.size(), out.data());
+    return out;
+}
+
+template <class Get>
+std::vector<double> ProfileResampler::ResampleAll(size_t n, Get get, size_t nThreads) const
+{
+    const size_t m = fGrid.size();
+    std::vector<double> out(n*m);
+    if (!nThreads)
+        nThreads = DefaultThreadCount();
+    std::vector<Workspace> workspaces(std::max<size_t>(1, std::min(nThreads, n)));
+    ParallelFor(n, nThreads,
+                [&](size_t i, size_t thread)
+                {
+                    const double* depth;
+                    const double* values;
+                    size_t bins;
+                    get(i, depth, values, bins);
+                    bins = used_bins(depth, bins);
+                    Workspace& w = workspaces[thread];
+                    w.Locate(fGrid, depth, bins);
+                    interpolate(w, fMode, values, bins, out.data() + i*m);
+                });
+    return out;
+}
+
+std::vector<double> ProfileResampler::Resample(const std::vector<LongProfile>& profiles, LongCache::Column c, size_t nThreads) const
+{
+    if (c < 0 || c >= LongCache::eNColumns)
+        throw std::out_of_range("ProfileResampler: column out of range");
+    return ResampleAll(profiles.size(),
+                       [&](size_t i, const double*& depth, const double*& values, size_t& n)
+                       {
+                           const ProfileTable& table = profiles[i].fProfiles;
+                           depth = table.Get(LongCache::DepthColumn(c));
+                           values = table.Get(c);
+                           n = table.GetNBins(c);
+                       },
+                       nThreads);
+}
+
+std::vector<double> ProfileResampler::Resample(const LongCache& cache, LongCache::Column c, size_t nThreads) const
+{
+    if (c < 0 || c >= LongCache::eNColumns)
+        throw std::out_of_range("ProfileResampler: column out of range");
+    return ResampleAll(cache.size(),
+                       [&](size_t i, const double*& depth, const double*& values, size_t& n)
+                       {
+                           const ColumnSpan<double> v = cache.GetColumn(i, c);
+                           depth = cache.GetColumn(i, LongCache::DepthColumn(c)).data();
+                           values = v.data();
+                           n = v.size();
+                       },
+                       nThreads);
+}
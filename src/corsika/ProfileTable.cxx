@@ -0,0 +1,37 @@
+/**
+ \file
+ Names of the profile columns
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ProfileTable.h>
+
+using namespace corsika;
+
+namespace
+{
+    const char* kColumnNames[] =
+    {
+        "depth", "gamma", "positron", "electron", "anti_muon", "muon",
+        "hadron", "charge", "nuclei", "cherenkov", "depth_dE", "dEdX"
+    };
+}
+
+std::string ProfileColumns::ColumnName(Column c)
+{
+    if (c < 0 || c >= eNColumns)
+        return "";
+    return kColumnNames[c];
+}
+
+ProfileColumns::Column ProfileColumns::ColumnFromName(const std::string& name)
+{
+    for (int i = 0; i != eNColumns; ++i)
+    {
+        if (name == kColumnNames[i])
+            return Column(i);
+    }
+    return eNColumns;
+}
@@ -0,0 +1,178 @@
+/**
+ \file
+ Implementation of the streaming quantile estimator
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/QuantileSketch.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace corsika;
+
+namespace
+{
+    // values closer to zero than this go into the zero bucket
+    const double kMinIndexable = 1e-9;
+}
+
+QuantileSketch::QuantileSketch(double relativeAccuracy, size_t maxBuckets):
+    fAccuracy(relativeAccuracy),
+    fGamma((1 + relativeAccuracy)/(1 - relativeAccuracy)),
+    fLogGamma(std::log(fGamma)),
+    fMaxBuckets(std::max(maxBuckets, size_t(1)))
+{
+    if (!(relativeAccuracy > 0 && relativeAccuracy < 1))
+        throw std::invalid_argument("QuantileSketch: relative accuracy must be between 0 and 1");
+    Clear();
+}
+
+void QuantileSketch::Clear()
+{
+    fPositive = Store();
+    fNegative = Store();
+    fZero = 0;
+    fCount = 0;
+    fTotal = 0;
+    fMin = std::numeric_limits<double>::infinity();
+    fMax = -std::numeric_limits<double>::infinity();
+}
+
+int QuantileSketch::Index(double absValue) const
+{
+    return int(std::ceil(std::log(absValue)/fLogGamma));
+}
+
+double QuantileSketch::Value(int index) const
+{
+    // the point with the same relative distance to both bucket boundaries
+    return 2*std::pow(fGamma, index)/(fGamma + 1);
+}
+
+void QuantileSketch::Store::Add(int index, double weight, size_t maxBuckets)
+{
+    if (fWeights.empty())
+    {
+        fOffset = index;
+        fWeights.push_back(weight);
+        return;
+    }
+
+    const int max = int(maxBuckets);
+    int low = fOffset;
+    int high = fOffset + int(fWeights.size()) - 1;
+    if (index > high)
+    {
+        // make room above, merging the lowest buckets if needed
+        const int newLow = std::max(low, index - max + 1);
+        if (newLow > low)
+        {
+            const int n = std::min(newLow - low, int(fWeights.size()));
+            double collapsed = 0;
+            for (int i = 0; i != n; ++i)
+                collapsed += fWeights[i];
+            fWeights.erase(fWeights.begin(), fWeights.begin() + n);
+            fOffset = newLow;
+            if (fWeights.empty() || newLow > high)
+                fWeights.insert(fWeights.begin(), 0.);
+            fWeights[0] += collapsed;
+        }
+        fWeights.resize(index - fOffset + 1, 0.);
+    }
+    else if (index < low)
+    {
+        // below the range: either extend it or count in the lowest bucket
+        index = std::max(index, high - max + 1);
+        if (index < low)
+        {
+            fWeights.insert(fWeights.begin(), low - index, 0.);
+            fOffset = index;
+        }
+    }
+    fWeights[index - fOffset] += weight;
+}
+
+void QuantileSketch::Add(double value, double weight)
+{
+    if (std::isnan(value) || !(weight > 0))
+        return;
+    if (value > kMinIndexable)
+        fPositive.Add(Index(value), weight, fMaxBuckets);
+    else if (value < -kMinIndexable)
+        fNegative.Add(Index(-value), weight, fMaxBuckets);
+    else
+        fZero += weight;
+    ++fCount;
+    fTotal += weight;
+    fMin = std::min(fMin, value);
+    fMax = std::max(fMax, value);
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other)
+{
+    if (other.fAccuracy != fAccuracy)
+        throw std::invalid_argument("QuantileSketch::Merge: sketches have different accuracy");
+    for (size_t i = 0; i != other.fPositive.fWeights.size(); ++i)
+    {
+        if (other.fPositive.fWeights[i] > 0)
+            fPositive.Add(other.fPositive.fOffset + int(i), other.fPositive.fWeights[i], fMaxBuckets);
+    }
+    for (size_t i = 0; i != other.fNegative.fWeights.size(); ++i)
+    {
+        if (other.fNegative.fWeights[i] > 0)
+            fNegative.Add(other.fNegative.fOffset + int(i), other.fNegative.fWeights[i], fMaxBuckets);
+    }
+    fZero += other.fZero;
+    fCount += other.fCount;
+    fTotal += other.fTotal;
+    fMin = std::min(fMin, other.fMin);
+    fMax = std::max(fMax, other.fMax);
+}
+
+double QuantileSketch::GetQuantile(double q) const
+{
+    if (!fCount)
+        return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0)
+        return fMin;
+    if (q >= 1)
+        return fMax;
+
+    const double rank = q*fTotal;
+    double sum = 0;
+    double value = fMax;
+    bool found = false;
+    // from the most negative value up
+    for (size_t i = fNegative.fWeights.size(); i-- != 0 && !found;)
+    {
+        sum += fNegative.fWeights[i];
+        if (sum > rank)
+        {
+            value = -Value(fNegative.fOffset + int(i));
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        sum += fZero;
+        if (sum > rank)
+        {
+            value = 0;
+            found = true;
+        }
+    }
+    for (size_t i = 0; i != fPositive.fWeights.size() && !found; ++i)
+    {
+        sum += fPositive.fWeights[i];
+        if (sum > rank)
+        {
+            value = Value(fPositive.fOffset + int(i));
+            found = true;
+        }
+    }
+    return std::min(std::max(value, fMin), fMax);
+}
@@ -8,11 +8,12 @@
 
 #include <corsika/RawParticleStream.h>
 #include <corsika/IOException.h>
+#include <corsika/Instrumentation.h>
 
 namespace corsika
 {
     template <class Thinning> RawParticleStream<Thinning>::RawParticleStream(RawStreamPtr stream, size_t start):
-    stream(stream), start(start)
+    stream(stream), start(start), end(0)
     {
         // if there is something we KNOW, it is that particles are not in block zero.
         if (this->start == 0) this->start = stream->GetNextPosition();
@@ -45,10 +46,41 @@ namespace corsika
                 return 0;
             }
             current_particle = 0;
+            CORSIKA_COUNT(eParticleBlocks, 1);
+            CORSIKA_COUNT(eParticleRecords, kParticlesInBlock);
         }
         return block.AsParticleBlock.fParticle + current_particle++;
     }
     
+    template <class Thinning> bool RawParticleStream<Thinning>::SkipBlock()
+    {
+        if (!AtBlockStart())
+            throw IOException("RawParticleIterator can only skip whole blocks.");
+        const size_t position = stream->GetNextPosition();
+        if (end)
+        {
+            // end is the first block after the particle blocks, nothing
+            // before it needs to be read
+            if (position >= end)
+            {
+                valid = false;
+                return false;
+            }
+            stream->SeekTo(position + 1);
+            CORSIKA_COUNT(eSkippedBlocks, 1);
+            return true;
+        }
+        if (!stream->GetNextBlock(block))
+            throw IOException("Error reading block in CORSIKA file.");
+        if (block.IsControl() || block.IsLongitudinal())
+        {
+            valid = false;
+            return false;
+        }
+        CORSIKA_COUNT(eSkippedBlocks, 1);
+        return true;
+    }
+
     RawParticleStreamPtr VRawParticleStream::Create(RawStreamPtr stream, size_t start)
     {
         if (stream->IsThinned()) return RawParticleStreamPtr(new RawParticleStream<Thinned>(stream, start));
@@ -10,6 +10,8 @@
 #include <sstream>
 #include <corsika/RawStream.h>
 #include <corsika/FileStream.h>
+#include <corsika/Instrumentation.h>
+#include <corsika/Trace.h>
 
 namespace corsika
 {
@@ -82,8 +84,12 @@ namespace corsika
         {
             size_t newBlockNumber = thePosition / kSubBlocksPerBlock;
             size_t newIndexInBlock = thePosition % kSubBlocksPerBlock;
-            //if (newBlockNumber == fCurrentBlockNumber && newIndexInBlock == fIndexInDiskBlock) return
-            if (file->seekable)
+            if (buffer_valid && newBlockNumber == current_block)
+            {
+                // same disk block, no need to read it again
+                current_disk_block = newIndexInBlock;
+            }
+            else if (file->seekable)
             {
                 current_block = newBlockNumber;
                 buffer_valid   = false;
@@ -94,6 +100,8 @@ namespace corsika
             {
                 if (GetNextPosition() > thePosition)
                 {
+                    CORSIKA_TRACE("RawStream::SeekTo (reopen)", "seek");
+                    CORSIKA_COUNT(eSeeks, 1);
                     file.reset(FileStream::open(filename.c_str()));
                     if (!file) throw IOException("Failed in dumb seek");
                     current_block = 0;
@@ -109,11 +117,16 @@ namespace corsika
         {
             return Thinning::kWordsPerSubBlock == Thinned::kWordsPerSubBlock;
         }
+        bool Is64Bit() const
+        {
+            return sizeof(Padding) == 8;
+        }
         bool ReadDiskBlock()
         {
             if (file->read(sizeof(DiskBlock), &buffer) <= 0) return false;
             if (buffer.padding_start != buffer.padding_end) throw IOException("Padding mismatch\n");
             buffer_valid = true;
+            CORSIKA_COUNT(eDiskBlocks, 1);
             return true;
         }
     };
@@ -128,6 +141,7 @@ namespace corsika
     
     RawStreamPtr RawStream::Create(const std::string& filename)
     {
+        CORSIKA_TRACE("RawStream::Create", "open");
         boost::shared_ptr<FileStream> file(FileStream::open(filename.c_str()));
         if (!file) throw IOException("Error opening Corsika file '" + filename + "'.\n");
         
@@ -0,0 +1,119 @@
+/**
+ \file
+ Implement writing raw CORSIKA files
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+#include <string>
+#include <cstring>
+#include <corsika/RawStreamWriter.h>
+#include <corsika/FileStream.h>
+
+namespace corsika
+{
+    template <typename Thinning, typename Padding> struct RawStreamWriterT: RawStreamWriter
+    {
+        struct DiskBlock
+        {
+            Padding padding_start;
+            Block<Thinning>  fBlock[kSubBlocksPerBlock];
+            Padding padding_end;
+        } __attribute__((packed));
+
+        boost::shared_ptr<OutputFileStream> file;
+        std::string filename;
+        size_t current_block;
+        size_t current_disk_block;
+        DiskBlock buffer;
+
+        RawStreamWriterT(boost::shared_ptr<OutputFileStream> file, std::string filename): file(file), filename(filename), current_block(0), current_disk_block(0)
+        {
+            buffer.padding_start = buffer.padding_end = sizeof(Block<Thinning>) * kSubBlocksPerBlock;
+        }
+        ~RawStreamWriterT()
+        {
+            try
+            {
+                Close();
+            }
+            catch (IOException&)
+            {
+            }
+        }
+
+        template<typename T> void write_block(const T&)
+        {
+            throw IOException("Block type does not match the corsika file '" + filename + "'.\n");
+        }
+        void write_block(const Block<Thinning>& block)
+        {
+            if (!file)
+                throw IOException("Writing to closed corsika file '" + filename + "'.\n");
+            buffer.fBlock[current_disk_block] = block;
+            if (++current_disk_block >= kSubBlocksPerBlock)
+                WriteDiskBlock();
+        }
+        void Write(const Block<Thinned>& theBlock)
+        {
+            write_block(theBlock);
+        }
+        void Write(const Block<NotThinned>& theBlock)
+        {
+            write_block(theBlock);
+        }
+
+        size_t GetNextPosition() const
+        {
+            return current_disk_block + kSubBlocksPerBlock * current_block;
+        }
+
+        bool IsThinned() const
+        {
+            return Thinning::kWordsPerSubBlock == Thinned::kWordsPerSubBlock;
+        }
+        bool Is64Bit() const
+        {
+            return sizeof(Padding) == 8;
+        }
+
+        void Close()
+        {
+            if (!file)
+                return;
+            if (current_disk_block)
+            {
+                memset(buffer.fBlock + current_disk_block, 0, (kSubBlocksPerBlock - current_disk_block) * sizeof(Block<Thinning>));
+                WriteDiskBlock();
+            }
+            boost::shared_ptr<OutputFileStream> f;
+            f.swap(file);
+            if (!f->close())
+                throw IOException("Error closing corsika file '" + filename + "'.\n");
+        }
+
+        void WriteDiskBlock()
+        {
+            if (!file->write(sizeof(DiskBlock), &buffer))
+                throw IOException("Error writing corsika file '" + filename + "'.\n");
+            current_block++;
+            current_disk_block = 0;
+        }
+    };
+
+    template <typename Thinning, typename Padding>
+    RawStreamWriterPtr create_writer(boost::shared_ptr<OutputFileStream> file, std::string filename)
+    {
+        return RawStreamWriterPtr(new RawStreamWriterT<Thinning, Padding>(file, filename));
+    }
+
+    RawStreamWriterPtr RawStreamWriter::Create(const std::string& filename, bool thinned, bool is64Bit)
+    {
+        boost::shared_ptr<OutputFileStream> file(OutputFileStream::open(filename.c_str()));
+        if (!file) throw IOException("Error opening Corsika file '" + filename + "' for writing.\n");
+
+        if (thinned)
+            return is64Bit ? create_writer<Thinned, int64_t>(file, filename) : create_writer<Thinned, int32_t>(file, filename);
+        return is64Bit ? create_writer<NotThinned, int64_t>(file, filename) : create_writer<NotThinned, int32_t>(file, filename);
+    }
+}
@@ -10,17 +10,23 @@
 #include <corsika/Constants.h>
 #include <corsika/ShowerFile.h>
 #include <corsika/ShowerParticleStream.h>
+#include <corsika/ShowerFrame.h>
 #include <corsika/IOException.h>
 #include <corsika/Block.h>
 #include <corsika/Shower.h>
-#include <corsika/LongFile.h>
+#include <corsika/LongLoader.h>
 #include <corsika/LongProfile.h>
 #include <corsika/particle/ParticleList.h>
+#include <corsika/Parallel.h>
+#include <corsika/Trace.h>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <utility>
 
 #include <boost/tokenizer.hpp>
 #include <boost/filesystem.hpp>
@@ -46,12 +52,195 @@ static void log(const std::ostringstream& mess)
 #define FATAL(mess) log(mess);
 
 
+namespace
+{
+    template <class Thinning>
+    Status read_event_header(RawStream& stream, size_t headerPosition, unsigned int position, EventHeader& header)
+    {
+        stream.SeekTo(headerPosition);
+        
+        Block<Thinning> headerBlock;
+        if (!stream.GetNextBlock(headerBlock))
+        {
+            ostringstream err;
+            err << "Cannot read CORSIKA shower header for position "
+            << position;
+            FATAL(err);
+            return eFail;
+        }
+        
+        if (!headerBlock.IsEventHeader())
+        {
+            ostringstream err;
+            err << "First block at position " << position
+            << " is not event header";
+            FATAL(err);
+            return eFail;
+        }
+        header = headerBlock.AsEventHeader;
+        return eSuccess;
+    }
+    
+    template <class Thinning>
+    Status read_event_trailer(RawStream& stream, size_t trailerPosition, unsigned int position, EventTrailer& trailer)
+    {
+        stream.SeekTo(trailerPosition);
+        
+        Block<Thinning> trailerBlock;
+        if (!stream.GetNextBlock(trailerBlock))
+        {
+            ostringstream err;
+            err << "Cannot read CORSIKA shower trailer for position "
+            << position;
+            FATAL(err);
+            return eFail;
+        }
+        if (!trailerBlock.IsEventTrailer())
+        {
+            ostringstream err;
+            err << "Block at position " << position
+            << " is not event trailer";
+            FATAL(err);
+            return eFail;
+        }
+        trailer = trailerBlock.AsEventTrailer;
+        return eSuccess;
+    }
+    
+    template <class Thinning>
+    Status read_event(RawStream& stream, size_t headerPosition, size_t trailerPosition, unsigned int position,
+                      EventHeader& header, EventTrailer& trailer)
+    {
+        if (read_event_header<Thinning>(stream, headerPosition, position, header) != eSuccess)
+            return eFail;
+        return read_event_trailer<Thinning>(stream, trailerPosition, position, trailer);
+    }
+    
+    // the profiles of the .long file, with the depths of the zenith angle of the shower
+    void set_long_profile(Shower& shower, const LongLoader& file, unsigned int position)
+    {
+        if (position < file.size())
+        {
+            LongProfile p = file.GetProfile(position, shower.GetZenith());
+            shower.fProfiles = std::move(p.fProfiles);
+            shower.SetGaisserHillasParams(p.fGaisserHillas);
+            shower.SetCalorimetricEnergy(p.fCalorimetricEnergy);
+        }
+        else
+        {
+            shower.fProfiles.clear();
+            shower.SetCalorimetricEnergy(0);
+            
+            GaisserHillasParameter gh;
+            shower.SetGaisserHillasParams(gh);
+        }
+    }
+    
+    // the energy deposit of the .long file, for showers with longitudinal blocks
+    void set_energy_deposit(Shower& shower, const LongLoader& file, unsigned int position)
+    {
+        if (position >= file.size())
+            return;
+        const LongProfile p = file.GetProfile(position, shower.GetZenith());
+        ProfileTable& table = shower.fProfiles;
+        const size_t n = p.fProfiles.GetNBinsEnergyDeposit();
+        table.Resize(table.GetNBins(), n);
+        std::copy(p.fProfiles.Get(ProfileTable::eDepth_dE), p.fProfiles.Get(ProfileTable::eDepth_dE) + n,
+                  table.Get(ProfileTable::eDepth_dE));
+        std::copy(p.fProfiles.Get(ProfileTable::edEdX), p.fProfiles.Get(ProfileTable::edEdX) + n,
+                  table.Get(ProfileTable::edEdX));
+        shower.SetCalorimetricEnergy(p.fCalorimetricEnergy);
+    }
+    
+    /// Copy the entries of a block into row i onwards, returns the number of rows
+    int read_long_entries(const LongitudinalBlock& longBlock, ProfileTable& table, int i)
+    {
+        int j = 0;
+        for (; j != kLongEntriesPerBlock; ++j, ++i)
+        {
+            const LongitudinalEntry& entry = longBlock.fEntries[j];
+            if (j && !entry.fDepth)
+                break;
+            table.Get(ProfileTable::eDepth)[i] = entry.fDepth;
+            table.Get(ProfileTable::eGamma)[i] = entry.fGamma;
+            table.Get(ProfileTable::ePositron)[i] = entry.fEplus;
+            table.Get(ProfileTable::eElectron)[i] = entry.fEminus;
+            table.Get(ProfileTable::eAntiMuon)[i] = entry.fMuPlus;
+            table.Get(ProfileTable::eMuon)[i] = entry.fMuMinus;
+            table.Get(ProfileTable::eHadron)[i] = entry.fHadron;
+            table.Get(ProfileTable::eCharge)[i] = entry.fCharged;
+            table.Get(ProfileTable::eNuclei)[i] = entry.fNuclei;
+            table.Get(ProfileTable::eCherenkov)[i] = entry.fCherenkov;
+        }
+        return j;
+    }
+    
+    template <class Thinning>
+    Status read_long_blocks(RawStream& stream, size_t blockPosition, unsigned int position, Shower& shower)
+    {
+        stream.SeekTo(blockPosition);
+        
+        Block<Thinning> block;
+        if (!stream.GetNextBlock(block) || !block.IsLongitudinal())
+        {
+            ostringstream err;
+            err << "Cannot read CORSIKA long block at position "
+                << position;
+            FATAL(err);
+            return eFail;
+        }
+        
+        if (!block.IsLongitudinal())
+        {
+            ostringstream err;
+            err << "Block at position " << position
+            << " is not longitudinal";
+            FATAL(err);
+            return eFail;
+        }
+        const LongitudinalBlock& longBlock = block.AsLongitudinalBlock;
+        
+        
+        const int nBlocks = int(longBlock.fStepsAndBlocks)%100;
+        //cout << int(longBlock.fStepsAndBlocks/100)<< " steps in " << nBlocks << " blocks" << endl;
+        
+        // room for full blocks, trimmed to the entries read at the end
+        // (the blocks have no energy deposit, it is only in the .long file)
+        ProfileTable& table = shower.fProfiles;
+        table.clear();
+        table.Resize(std::max(nBlocks, 1)*kLongEntriesPerBlock, 0);
+        int i = read_long_entries(longBlock, table, 0);
+        
+        for (int b = 1; b < nBlocks; ++b)
+        {
+            if (!stream.GetNextBlock(block) || !block.IsLongitudinal())
+            {
+                ostringstream err;
+                err << "Cannot read CORSIKA long block #" << b << "at position "
+                << position;
+                FATAL(err);
+                return eFail;
+            }
+            i += read_long_entries(block.AsLongitudinalBlock, table, i);
+        }
+        //cout << i << " entries read" << endl;
+        table.Resize(i, 0);
+        
+        // shower.SetGaisserHillasParams(gh);
+        // shower.SetCalorimetricEnergy(energyDepositSum);
+        
+        return eSuccess;
+    }
+}
+
+
 ShowerFile::ShowerFile() :
     fRawStream(),
     fCurrentPosition(0),
     fObservationLevel(1),
     fIsThinned(true),
-    fFileScanned(false)
+    fFileScanned(false),
+    fNIOThreads(4)
 {}
 
 
@@ -60,7 +249,8 @@ fRawStream(),
 fCurrentPosition(0),
 fObservationLevel(1),
 fIsThinned(true),
-fFileScanned(false)
+fFileScanned(false),
+fNIOThreads(4)
 {
     // only call Open() if the particle file is required (default behaviour)
     if (requireParticleFile) Open(theFileName);
@@ -69,6 +259,7 @@ fFileScanned(false)
 
 void ShowerFile::Open(const std::string& theFileName, bool scan)
 {
+    CORSIKA_TRACE("ShowerFile::Open", "open");
     Close();
     
     // Compute the name for the long file
@@ -84,6 +275,7 @@ void ShowerFile::Open(const std::string& theFileName, bool scan)
 
     
     fRawStream = RawStream::Create(theFileName);
+    fFilename = theFileName;
     fIsThinned = fRawStream->IsThinned();
     if (scan && fRawStream->IsSeekable())
     {
@@ -100,8 +292,32 @@ void ShowerFile::Open(const std::string& theFileName, bool scan)
     else ReadRunHeader<NotThinned>();
 }
 
+void ShowerFile::OpenCopy(ShowerFile& other)
+{
+    if (!other.IsOpen())
+        throw IOException("Cannot copy a closed file");
+    other.GetNEvents(); // make sure the file was scanned
+    
+    CORSIKA_TRACE("ShowerFile::Open", "open");
+    Close();
+    fFilename = other.fFilename;
+    fLongFile = other.fLongFile;
+    fRawStream = RawStream::Create(fFilename);
+    fIsThinned = other.fIsThinned;
+    fIndex = other.fIndex;
+    fFileScanned = true;
+    fObservationLevel = other.fObservationLevel;
+    fRunHeader = other.fRunHeader;
+    fLongLoader = other.GetLongLoader();
+}
+
 void ShowerFile::Close()
 {
+    // let pending loads finish
+    fIOThreads.reset();
+    fAsyncState.reset();
+    fLongLoader.reset();
+    
     fRunHeader = corsika::RunHeader();
     fRawStream.reset();
     
@@ -117,49 +333,12 @@ template <class Thinning> Status ShowerFile::Read()
     if (!fRawStream || fCurrentPosition >= fIndex.eventHeaders.size())
         return eEOF;
     
-    fRawStream->SeekTo(fIndex.eventHeaders[fCurrentPosition]);
-    
-    Block<Thinning> headerBlock;
-    if (!fRawStream->GetNextBlock(headerBlock))
-    {
-        ostringstream err;
-        err << "Cannot read CORSIKA shower header for position "
-        << fCurrentPosition;
-        FATAL(err);
+    EventHeader header;
+    EventTrailer trailer;
+    if (read_event<Thinning>(*fRawStream, fIndex.eventHeaders[fCurrentPosition],
+                             fIndex.eventTrailers[fCurrentPosition], fCurrentPosition,
+                             header, trailer) != eSuccess)
         return eFail;
-    }
-    
-    if (!headerBlock.IsEventHeader())
-    {
-        ostringstream err;
-        err << "First block at position " << fCurrentPosition
-        << " is not event header";
-        FATAL(err);
-        return eFail;
-    }
-    const EventHeader& header = headerBlock.AsEventHeader;
-    
-    fRawStream->SeekTo(fIndex.eventTrailers[fCurrentPosition]);
-    
-    Block<Thinning> trailerBlock;
-    if (!fRawStream->GetNextBlock(trailerBlock))
-    {
-        ostringstream err;
-        err << "Cannot read CORSIKA shower trailer for position "
-        << fCurrentPosition;
-        FATAL(err);
-        return eFail;
-    }
-    if (!trailerBlock.IsEventTrailer())
-    {
-        ostringstream err;
-        err << "Block at position " << fCurrentPosition
-        << " is not event trailer";
-        FATAL(err);
-        return eFail;
-    }
-    
-    const EventTrailer& trailer = trailerBlock.AsEventTrailer;
     
     if (fObservationLevel > header.fObservationLevels)
     {
@@ -172,59 +351,31 @@ template <class Thinning> Status ShowerFile::Read()
         INFO(info);
     }
     
-    // Corsika starts at the top of the atmosphere, not
-    const float heightObsLevel =
-    header.fObservationHeight[int(header.fObservationLevels) - 1]; // in cm
-    const float heightFirstInt = abs(header.fZFirst); // in cm
-    
-    double hReference;
-    const double hAtmBoundary = (header.fStartingHeight>0? header.fStartingHeight: 112.8292*1e5); // in cm
-    
-    // for the SLANT and CURVED options, clock starts at the margin of
-    // the atmosphere. This is indicated by fZFirst < 0
-    if (header.fZFirst < 0.) hReference = hAtmBoundary;
-    else hReference = heightFirstInt;
-    
-    
-    double timeShift = 0;
-    
-    const double Zenith = header.fTheta;
-    const double cosZenith = cos(Zenith);
-    
+    const double timeShift = ShowerFrame::CoreTimeShift(header);
     if (header.fFlagCurved)
     {
-        
         INFO("CURVED version");
-        
-        if (ParticleList::CorsikaToPDG(int(header.fParticleId)) == Particle::ePhoton)
-            hReference = heightFirstInt;
-        
-        timeShift = (pow((kEarthRadius + heightObsLevel)*cosZenith, 2) +
-                     pow(hReference - heightObsLevel, 2) +
-                     2*(kEarthRadius + heightObsLevel)*(hReference - heightObsLevel));
-        timeShift = sqrt(timeShift);
-        timeShift -= (kEarthRadius + heightObsLevel)*cosZenith;
-        timeShift /= kSpeedOfLight;
-        
         ostringstream info;
         info << "TimeShift to core: " << timeShift/1e9; // output in ns
         INFO(info);
-        
     }
-    else
-        timeShift = (hReference - heightObsLevel) / (cosZenith * kSpeedOfLight);
-    
     
     ShowerParticleStream* particleIterator =
     new ShowerParticleStream(fRawStream,
                              fIndex.eventHeaders[fCurrentPosition] + 1,
                              timeShift,
                              fObservationLevel,
-                             true); // last one is keepMuProd
+                             true, // keepMuProd
+                             fCurrentPosition < fIndex.longBlocks.size() ?
+                             fIndex.longBlocks[fCurrentPosition] : fIndex.eventTrailers[fCurrentPosition]);
     fCurrentShower = Shower(header, trailer, particleIterator);
     
     if (fIndex.longBlocks.size() > 0)
+    {
         ReadLongBlocks<Thinning>();
+        if ( fLongFile != "" )
+            ReadLongFile(true);
+    }
     else if ( fLongFile != "" )
         ReadLongFile();
     
@@ -280,161 +431,204 @@ size_t ShowerFile::GetNEvents()
 }
 
 
-Status ShowerFile::ReadLongFile()
+std::vector<unsigned int> ShowerFile::GetEventIds()
 {
-    //cout << "reading long file " << fLongFile << endl;
-    if (!fCorsikaLongFile)
-        fCorsikaLongFile.reset(new LongFile(fLongFile, GetCurrentShower().GetZenith()));
-    
-    if (fCorsikaLongFile->size() >= fCurrentPosition)
+    std::vector<unsigned int> ids(GetNEvents());
+    for (IdToPositionMap::const_iterator it = fIndex.IDToPosition.begin(); it != fIndex.IDToPosition.end(); ++it)
     {
-        LongProfile p = fCorsikaLongFile->GetProfile(fCurrentPosition);
-        fCurrentShower.fdEdX = p.fdEdX;
-        fCurrentShower.fChargeProfile = p.fChargeProfile;
-        fCurrentShower.fGammaProfile = p.fGammaProfile;
-        fCurrentShower.fElectronProfile = p.fElectronProfile;
-        fCurrentShower.fPositronProfile = p.fPositronProfile;
-        fCurrentShower.fMuonProfile = p.fMuonProfile;
-        fCurrentShower.fAntiMuonProfile = p.fAntiMuonProfile;
-        fCurrentShower.fHadronProfile = p.fHadronProfile;
-        fCurrentShower.fNucleiProfile = p.fNucleiProfile;
-        fCurrentShower.fCherenkovProfile = p.fCherenkovProfile;
-        fCurrentShower.fDepth_dE = p.fDepth_dE;
-        fCurrentShower.fDepth = p.fDepth;
-        
-        fCurrentShower.SetGaisserHillasParams(p.fGaisserHillas);
-        fCurrentShower.SetCalorimetricEnergy(p.fCalorimetricEnergy);
+        if (it->second < ids.size())
+            ids[it->second] = it->first;
     }
+    return ids;
+}
+
+
+boost::shared_ptr<LongLoader> ShowerFile::GetLongLoader()
+{
+    if (!fLongLoader && !fLongFile.empty())
+        fLongLoader.reset(new LongLoader(fLongFile));
+    return fLongLoader;
+}
+
+
+Status ShowerFile::ReadLongFile(bool energyDepositOnly)
+{
+    const boost::shared_ptr<LongLoader> loader = GetLongLoader();
+    if (!loader)
+        return eFail;
+    if (energyDepositOnly)
+        set_energy_deposit(fCurrentShower, *loader, fCurrentPosition);
     else
-    {
-        fCurrentShower.fdEdX.clear();
-        fCurrentShower.fChargeProfile.clear();
-        fCurrentShower.fGammaProfile.clear();
-        fCurrentShower.fElectronProfile.clear();
-        fCurrentShower.fPositronProfile.clear();
-        fCurrentShower.fMuonProfile.clear();
-        fCurrentShower.fAntiMuonProfile.clear();
-        fCurrentShower.fHadronProfile.clear();
-        fCurrentShower.fNucleiProfile.clear();
-        fCurrentShower.fCherenkovProfile.clear();
-        fCurrentShower.fDepth_dE.clear();
-        fCurrentShower.fDepth.clear();
-        
-        fCurrentShower.SetCalorimetricEnergy(0);
-        
-        GaisserHillasParameter gh;
-        fCurrentShower.SetGaisserHillasParams(gh);
-    }
+        set_long_profile(fCurrentShower, *loader, fCurrentPosition);
     return eSuccess;
 }
 
 
 template <class Thinning> Status ShowerFile::ReadLongBlocks()
 {
-    fRawStream->SeekTo(fIndex.longBlocks[fCurrentPosition]);
-    
-    Block<Thinning> block;
-    if (!fRawStream->GetNextBlock(block) || !block.IsLongitudinal())
-    {
-        ostringstream err;
-        err << "Cannot read CORSIKA long block at position "
-            << fCurrentPosition;
-        FATAL(err);
-        return eFail;
-    }
-    
-    if (!block.IsLongitudinal())
+    return read_long_blocks<Thinning>(*fRawStream, fIndex.longBlocks[fCurrentPosition], fCurrentPosition, fCurrentShower);
+}
+
+
+std::vector<ShowerPtr> ShowerFile::LoadLongitudinal(bool energyDeposit)
+{
+    if (!IsOpen())
+        throw IOException("Cannot load events from a closed file");
+    GetNEvents(); // make sure the file was scanned
+    if (fIsThinned)
+        return LoadLongitudinal<Thinned>(energyDeposit);
+    return LoadLongitudinal<NotThinned>(energyDeposit);
+}
+
+
+template <class Thinning> std::vector<ShowerPtr> ShowerFile::LoadLongitudinal(bool energyDeposit)
+{
+    const bool hasLongBlocks = !fIndex.longBlocks.empty();
+    // the .long file is not even opened when the blocks have all that is needed
+    const boost::shared_ptr<LongLoader> loader = (hasLongBlocks && !energyDeposit ?
+                                                  boost::shared_ptr<LongLoader>() : GetLongLoader());
+    
+    // header, long blocks and trailer of each event, in file order
+    std::vector<ShowerPtr> showers;
+    showers.reserve(fIndex.eventHeaders.size());
+    for (unsigned int position = 0; position != fIndex.eventHeaders.size(); ++position)
     {
-        ostringstream err;
-        err << "Block at position " << fCurrentPosition
-        << " is not longitudinal";
-        FATAL(err);
-        return eFail;
+        EventHeader header;
+        EventTrailer trailer;
+        Shower blocks;  // only for the profiles of the long blocks
+        const bool read =
+            read_event_header<Thinning>(*fRawStream, fIndex.eventHeaders[position], position, header) == eSuccess &&
+            (position >= fIndex.longBlocks.size() ||
+             read_long_blocks<Thinning>(*fRawStream, fIndex.longBlocks[position], position, blocks) == eSuccess) &&
+            read_event_trailer<Thinning>(*fRawStream, fIndex.eventTrailers[position], position, trailer) == eSuccess;
+        if (!read)
+        {
+            ostringstream err;
+            err << "Cannot read event at position " << position << " from " << fFilename;
+            throw IOException(err.str());
+        }
+        
+        ShowerPtr shower(new Shower(header, trailer, 0));
+        shower->fProfiles = std::move(blocks.fProfiles);
+        if (loader && hasLongBlocks)
+            set_energy_deposit(*shower, *loader, position);
+        else if (loader)
+            set_long_profile(*shower, *loader, position);
+        showers.push_back(shower);
     }
-    const LongitudinalBlock& longBlock = block.AsLongitudinalBlock;
-    
-    
-    vector<double> auxDeltaEn;
-    vector<double> auxCharge;
-    vector<double> auxGammas;
-    vector<double> auxElectrons;
-    vector<double> auxPositrons;
-    vector<double> auxMuons;
-    vector<double> auxAntiMuons;
-    vector<double> auxHadrons;
-    vector<double> auxNuclei;
-    vector<double> auxCherenkov;
-    vector<double> auxDepth_dE;
-    vector<double> auxDepth;
-    
-    const int nBlocks = int(longBlock.fStepsAndBlocks)%100;
-    //cout << int(longBlock.fStepsAndBlocks/100)<< " steps in " << nBlocks << " blocks" << endl;
-    int i = 0;
-    
-    for (; i != kLongEntriesPerBlock; ++i)
+    return showers;
+}
+
+
+namespace
+{
+    // a shower that owns its particle stream and the stream of the file
+    struct LoadedShower: Shower
     {
-        if (i && !longBlock.fEntries[i].fDepth)
-            break;
-        auxDeltaEn.push_back(0);
-        auxCharge.push_back(longBlock.fEntries[i].fCharged);
-        auxGammas.push_back(longBlock.fEntries[i].fGamma);
-        auxElectrons.push_back(longBlock.fEntries[i].fEminus);
-        auxPositrons.push_back(longBlock.fEntries[i].fEplus);
-        auxMuons.push_back(longBlock.fEntries[i].fMuMinus);
-        auxAntiMuons.push_back(longBlock.fEntries[i].fMuPlus);
-        auxHadrons.push_back(longBlock.fEntries[i].fHadron);
-        auxNuclei.push_back(longBlock.fEntries[i].fNuclei);
-        auxCherenkov.push_back(longBlock.fEntries[i].fCherenkov);
-        auxDepth.push_back(longBlock.fEntries[i].fDepth);
-        auxDepth_dE.push_back(longBlock.fEntries[i].fDepth);
-    }
+        RawStreamPtr fRawStream;
+        boost::shared_ptr<ShowerParticleStream> fParticleStream;
+    };
+}
+
+
+struct ShowerFile::AsyncState
+{
+    std::string fFilename;
+    unsigned int fObservationLevel;
+    boost::shared_ptr<LongLoader> fLongLoader;
     
-    for (int b = 1; b < nBlocks; ++b)
+    template <class Thinning>
+    ShowerPtr Load(unsigned int eventId, unsigned int position, size_t headerPosition, size_t trailerPosition,
+                   const size_t* longBlockPosition)
     {
-        if (!fRawStream->GetNextBlock(block) || !block.IsLongitudinal())
+        if (Trace::IsRecording())
+            Trace::SetThreadName("ShowerFile::LoadAsync");
+        CORSIKA_TRACE("ShowerFile::LoadAsync", "decode");
+        boost::shared_ptr<LoadedShower> shower(new LoadedShower);
+        shower->fRawStream = RawStream::Create(fFilename);
+        
+        EventHeader header;
+        EventTrailer trailer;
+        if (read_event<Thinning>(*shower->fRawStream, headerPosition, trailerPosition, position, header, trailer) != eSuccess)
         {
             ostringstream err;
-            err << "Cannot read CORSIKA long block #" << b << "at position "
-            << fCurrentPosition;
-            FATAL(err);
-            return eFail;
+            err << "Cannot read event " << eventId << " from " << fFilename;
+            throw IOException(err.str());
         }
-        const LongitudinalBlock& longBlock = block.AsLongitudinalBlock;
-        for (int j = 0; j != kLongEntriesPerBlock; ++j,++i)
+        
+        const unsigned int level = (fObservationLevel > header.fObservationLevels ? 1 : fObservationLevel);
+        shower->fParticleStream.reset(new ShowerParticleStream(shower->fRawStream, headerPosition + 1,
+                                                               ShowerFrame::CoreTimeShift(header), level,
+                                                               true, // keepMuProd
+                                                               longBlockPosition ? *longBlockPosition : trailerPosition));
+        static_cast<Shower&>(*shower) = Shower(header, trailer, shower->fParticleStream.get());
+        
+        if (longBlockPosition &&
+            read_long_blocks<Thinning>(*shower->fRawStream, *longBlockPosition, position, *shower) != eSuccess)
         {
-            if (j && !longBlock.fEntries[j].fDepth)
-                break;
-            auxDeltaEn.push_back(0);
-            auxCharge.push_back(longBlock.fEntries[j].fCharged);
-            auxGammas.push_back(longBlock.fEntries[j].fGamma);
-            auxElectrons.push_back(longBlock.fEntries[j].fEminus);
-            auxPositrons.push_back(longBlock.fEntries[j].fEplus);
-            auxMuons.push_back(longBlock.fEntries[j].fMuMinus);
-            auxAntiMuons.push_back(longBlock.fEntries[j].fMuPlus);
-            auxHadrons.push_back(longBlock.fEntries[j].fHadron);
-            auxNuclei.push_back(longBlock.fEntries[j].fNuclei);
-            auxCherenkov.push_back(longBlock.fEntries[j].fCherenkov);
-            auxDepth.push_back(longBlock.fEntries[j].fDepth);
-            auxDepth_dE.push_back(longBlock.fEntries[j].fDepth);
+            ostringstream err;
+            err << "Cannot read the longitudinal blocks of event " << eventId << " from " << fFilename;
+            throw IOException(err.str());
         }
+        if (fLongLoader)
+        {
+            if (longBlockPosition)
+                set_energy_deposit(*shower, *fLongLoader, position);
+            else
+                set_long_profile(*shower, *fLongLoader, position);
+        }
+        return shower;
     }
-    //cout << i << " entries read" << endl;
-    
-    fCurrentShower.fdEdX = auxDeltaEn;
-    fCurrentShower.fChargeProfile = auxCharge;
-    fCurrentShower.fGammaProfile = auxGammas;
-    fCurrentShower.fElectronProfile = auxElectrons;
-    fCurrentShower.fPositronProfile = auxPositrons;
-    fCurrentShower.fMuonProfile = auxMuons;
-    fCurrentShower.fAntiMuonProfile = auxAntiMuons;
-    fCurrentShower.fHadronProfile = auxHadrons;
-    fCurrentShower.fNucleiProfile = auxNuclei;
-    fCurrentShower.fCherenkovProfile = auxCherenkov;
-    fCurrentShower.fDepth_dE = auxDepth_dE;
-    fCurrentShower.fDepth = auxDepth;
+};
+
+
+std::shared_future<ShowerPtr> ShowerFile::LoadAsync(const unsigned int eventId)
+{
+    if (!IsOpen())
+        throw IOException("Cannot load events from a closed file");
+    GetNEvents(); // make sure the file was scanned
     
-    // fCurrentShower.SetGaisserHillasParams(gh);
-    // fCurrentShower.SetCalorimetricEnergy(energyDepositSum);
+    if (!fAsyncState)
+    {
+        fAsyncState.reset(new AsyncState);
+        fAsyncState->fFilename = fFilename;
+        fAsyncState->fLongLoader = GetLongLoader();
+        fAsyncState->fObservationLevel = fObservationLevel;
+    }
+    if (!fIOThreads)
+        fIOThreads.reset(new ThreadPool(fNIOThreads));
     
-    return eSuccess;
+    // everything the task needs is copied, so the file can move on to other events
+    boost::shared_ptr<AsyncState> state = fAsyncState;
+    const IdToPositionMap::const_iterator iter = fIndex.IDToPosition.find(eventId);
+    std::shared_ptr<std::packaged_task<ShowerPtr()> > task;
+    if (iter == fIndex.IDToPosition.end() || iter->second >= fIndex.eventHeaders.size())
+    {
+        const std::string filename = fFilename;
+        task.reset(new std::packaged_task<ShowerPtr()>([eventId, filename]() -> ShowerPtr
+            {
+                ostringstream err;
+                err << "No event " << eventId << " in " << filename;
+                throw IOException(err.str());
+            }));
+    }
+    else
+    {
+        const unsigned int position = iter->second;
+        const size_t header = fIndex.eventHeaders[position];
+        const size_t trailer = fIndex.eventTrailers[position];
+        const bool hasLongBlocks = position < fIndex.longBlocks.size();
+        const size_t longBlock = (hasLongBlocks ? fIndex.longBlocks[position] : 0);
+        const bool thinned = fIsThinned;
+        task.reset(new std::packaged_task<ShowerPtr()>([=]()
+            {
+                const size_t* longBlocks = (hasLongBlocks ? &longBlock : 0);
+                if (thinned)
+                    return state->Load<Thinned>(eventId, position, header, trailer, longBlocks);
+                return state->Load<NotThinned>(eventId, position, header, trailer, longBlocks);
+            }));
+    }
+    std::shared_future<ShowerPtr> result = task->get_future().share();
+    fIOThreads->Submit([task]() { (*task)(); });
+    return result;
 }
@@ -0,0 +1,114 @@
+/**
+ \file
+ Implementation of the shower frame transformation
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ShowerFrame.h>
+#include <corsika/Block.h>
+#include <corsika/Constants.h>
+#include <corsika/Shower.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/particle/ParticleList.h>
+#include <cmath>
+
+using namespace corsika;
+
+ShowerFrame::ShowerFrame(double zenith, double azimuth, double coreX, double coreY, double timeOffset):
+    fZenith(zenith), fAzimuth(azimuth), fCoreX(coreX), fCoreY(coreY), fTimeOffset(timeOffset)
+{
+    Init();
+}
+
+ShowerFrame::ShowerFrame(const Shower& shower):
+    fZenith(shower.GetZenith()),
+    fAzimuth(shower.GetAzimuth() - shower.GetEventHeader().fArrayRotation),
+    fCoreX(0), fCoreY(0), fTimeOffset(0)
+{
+    Init();
+}
+
+ShowerFrame::ShowerFrame(const EventHeader& header, bool rawTimes):
+    fZenith(header.fTheta),
+    fAzimuth(header.fPhi - header.fArrayRotation),
+    fCoreX(0), fCoreY(0),
+    fTimeOffset(rawTimes ? CoreTimeShift(header) : 0)
+{
+    Init();
+}
+
+void ShowerFrame::Init()
+{
+    fCosZenith = std::cos(fZenith);
+    fSinZenith = std::sin(fZenith);
+    fCosAzimuth = std::cos(fAzimuth);
+    fSinAzimuth = std::sin(fAzimuth);
+}
+
+double ShowerFrame::CoreTimeShift(const EventHeader& header)
+{
+    // Corsika starts at the top of the atmosphere, not
+    const float heightObsLevel =
+    header.fObservationHeight[int(header.fObservationLevels) - 1]; // in cm
+    const float heightFirstInt = std::abs(header.fZFirst); // in cm
+
+    double hReference;
+    const double hAtmBoundary = (header.fStartingHeight>0? header.fStartingHeight: 112.8292*1e5); // in cm
+
+    // for the SLANT and CURVED options, clock starts at the margin of
+    // the atmosphere. This is indicated by fZFirst < 0
+    if (header.fZFirst < 0.) hReference = hAtmBoundary;
+    else hReference = heightFirstInt;
+
+    const double zenith = header.fTheta;
+    const double cosZenith = std::cos(zenith);
+
+    if (!header.fFlagCurved)
+        return (hReference - heightObsLevel) / (cosZenith * kSpeedOfLight);
+
+    if (ParticleList::CorsikaToPDG(int(header.fParticleId)) == Particle::ePhoton)
+        hReference = heightFirstInt;
+
+    double timeShift = (std::pow((kEarthRadius + heightObsLevel)*cosZenith, 2) +
+                        std::pow(hReference - heightObsLevel, 2) +
+                        2*(kEarthRadius + heightObsLevel)*(hReference - heightObsLevel));
+    timeShift = std::sqrt(timeShift);
+    timeShift -= (kEarthRadius + heightObsLevel)*cosZenith;
+    return timeShift/kSpeedOfLight;
+}
+
+void ShowerFrame::Transform(const float* x, const float* y, const float* t, size_t n,
+                            double* xOut, double* yOut, double* r, double* residual) const
+{
+    const double cx = fCosAzimuth;
+    const double sx = fSinAzimuth;
+    const double cz = fCosZenith;
+    const double along = fSinZenith/kSpeedOfLight;
+    for (size_t i = 0; i != n; ++i)
+    {
+        const double dx = x[i] - fCoreX;
+        const double dy = y[i] - fCoreY;
+        const double u = dx*cx + dy*sx;   // horizontal, along the direction of motion
+        const double v = -dx*sx + dy*cx;  // horizontal, perpendicular
+        const double xs = cz*u;
+        if (xOut) xOut[i] = xs;
+        if (yOut) yOut[i] = v;
+        if (r) r[i] = std::sqrt(xs*xs + v*v);
+        if (residual) residual[i] = t[i] - fTimeOffset - along*u;
+    }
+}
+
+void ShowerFrame::Transform(const ParticleBatch& batch,
+                            std::vector<double>& x, std::vector<double>& y,
+                            std::vector<double>& r, std::vector<double>& residual) const
+{
+    const size_t n = batch.size();
+    x.resize(n);
+    y.resize(n);
+    r.resize(n);
+    residual.resize(n);
+    Transform(batch.fX.data(), batch.fY.data(), batch.fT.data(), n,
+              x.data(), y.data(), r.data(), residual.data());
+}
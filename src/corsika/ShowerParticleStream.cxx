@@ -1,23 +1,98 @@
 #include <corsika/ShowerParticleStream.h>
 #include <corsika/particle/ParticleList.h>
+#include <corsika/CounterRandom.h>
+#include <corsika/Instrumentation.h>
+#include <corsika/Trace.h>
+#include <stdexcept>
 
 using namespace corsika;
 
 ShowerParticleStream::
-ShowerParticleStream(RawStreamPtr stream, size_t start, double timeOffset, int observationLevel, bool keepMuProd):
+ShowerParticleStream(RawStreamPtr stream, size_t start, double timeOffset, int observationLevel, bool keepMuProd,
+                     size_t end):
     stream(VRawParticleStream::Create(stream, start)), fTimeOffset(timeOffset),
-    fObservationLevel(observationLevel), fKeepMuProd(keepMuProd)
+    fObservationLevel(observationLevel), fKeepMuProd(keepMuProd),
+    fSubsampling(eAllParticles), fFraction(1), fSeed(0), fNEmitted(0), fNFiltered(0)
 {
+    this->stream->SetEnd(end);
     Rewind();
 }
 
+ShowerParticleStream::
+ShowerParticleStream(RawParticleStreamPtr stream, double timeOffset, int observationLevel, bool keepMuProd):
+    stream(stream), fTimeOffset(timeOffset),
+    fObservationLevel(observationLevel), fKeepMuProd(keepMuProd),
+    fSubsampling(eAllParticles), fFraction(1), fSeed(0), fNEmitted(0), fNFiltered(0)
+{
+    Rewind();
+}
+
+ShowerParticleStream::~ShowerParticleStream()
+{
+    FlushCounts();
+}
+
+void ShowerParticleStream::FlushCounts()
+{
+    CORSIKA_COUNT(eParticlesEmitted, fNEmitted);
+    CORSIKA_COUNT(eParticlesFiltered, fNFiltered);
+    fNEmitted = 0;
+    fNFiltered = 0;
+}
+
+void ShowerParticleStream::Rewind()
+{
+    FlushCounts();
+    stream->Rewind();
+    fAtEnd = false;
+    fNParticles = 0;
+    fNBlocks = 0;
+    fSkippedBlocks = 0;
+    fBlockSkipped = false;
+}
+
+void ShowerParticleStream::SetSubsampling(Subsampling mode, double fraction, uint64_t seed)
+{
+    if (!(fraction > 0 && fraction <= 1))
+        throw std::invalid_argument("ShowerParticleStream::SetSubsampling: the fraction must be in (0, 1]");
+    fSubsampling = mode;
+    fFraction = (mode == eAllParticles ? 1 : fraction);
+    fSeed = seed;
+}
+
+boost::optional<Particle> ShowerParticleStream::NextRecord()
+{
+    if (!stream->AtBlockStart())
+        return stream->NextParticle();
+    FlushCounts();
+    if (fSubsampling == eBlockSubsampling)
+    {
+        while (stream->AtBlockStart() && !(CounterRandom(fSeed, fNBlocks++).Uniform() < fFraction))
+        {
+            if (!stream->SkipBlock())
+                return boost::optional<Particle>();
+            fBlockSkipped = true;
+            ++fSkippedBlocks;
+        }
+    }
+    return stream->NextParticle();
+}
+
 boost::optional<Particle> ShowerParticleStream::NextParticle()
 {
     boost::optional<Particle> parent;
     boost::optional<Particle> grandparent;
     boost::optional<Particle> muaddi;
-    while((value_ = stream->NextParticle()))
+    while((value_ = NextRecord()))
     {
+        if (fBlockSkipped)
+        {
+            // the history records before this one are not from the same particle
+            parent = boost::none;
+            grandparent = boost::none;
+            muaddi = boost::none;
+            fBlockSkipped = false;
+        }
         int corsika_particle_id = int(value_->fDescription/1000);
         int particleId = ParticleList::CorsikaToPDG(corsika_particle_id);
         int obsLevel = (unsigned)value_->fDescription % 10;
@@ -37,12 +112,24 @@ boost::optional<Particle> ShowerParticleStream::NextParticle()
         if (particleId == Particle::eUndefined || (!fKeepMuProd && (particleId == Particle::eDecayedMuon || particleId == Particle::eDecayedAntiMuon)) || obsLevel != fObservationLevel)
         {
             // reset and continue
+            ++fNFiltered;
             parent = boost::none;
             grandparent = boost::none;
             muaddi = boost::none;
             continue;
         }
         
+        if (fSubsampling == eParticleSubsampling && !(CounterRandom(fSeed, fNParticles++).Uniform() < fFraction))
+        {
+            ++fNFiltered;
+            parent = boost::none;
+            grandparent = boost::none;
+            muaddi = boost::none;
+            continue;
+        }
+        if (fSubsampling != eAllParticles)
+            value_->fWeight /= fFraction;
+        
         if (grandparent && parent)
         {
             value_->SetParent(parent.get());
@@ -53,7 +140,73 @@ boost::optional<Particle> ShowerParticleStream::NextParticle()
         // deal with corsika's idiosyncrasies here
         value_->fTorZ -= fTimeOffset;
         
+        ++fNEmitted;
         break;
     }
+    if (!value_)
+        FlushCounts();
     return value_;
 }
+
+size_t ShowerParticleStream::NextBatch(ParticleBatch& batch, size_t maxParticles)
+{
+    CORSIKA_TRACE("ShowerParticleStream::NextBatch", "decode");
+    batch.clear();
+    while (!fAtEnd && batch.size() < maxParticles)
+    {
+        if (!NextParticle())
+            fAtEnd = true;
+        else
+            batch.push_back(*value_);
+    }
+    return batch.size();
+}
+
+namespace
+{
+    // batch[j] = other[i]
+    void assign(ParticleBatch& batch, size_t j, const ParticleBatch& other, size_t i)
+    {
+        batch.fX[j] = other.fX[i];
+        batch.fY[j] = other.fY[i];
+        batch.fT[j] = other.fT[i];
+        batch.fPx[j] = other.fPx[i];
+        batch.fPy[j] = other.fPy[i];
+        batch.fPz[j] = other.fPz[i];
+        batch.fKineticEnergy[j] = other.fKineticEnergy[i];
+        batch.fWeight[j] = other.fWeight[i];
+        batch.fPDG[j] = other.fPDG[i];
+        batch.fCorsikaCode[j] = other.fCorsikaCode[i];
+        batch.fLevel[j] = other.fLevel[i];
+        batch.fGeneration[j] = other.fGeneration[i];
+    }
+}
+
+size_t ShowerParticleStream::NextReservoir(ParticleBatch& batch, size_t size, uint64_t seed)
+{
+    batch.clear();
+    if (!size)
+        throw std::invalid_argument("ShowerParticleStream::NextReservoir: the size must be positive");
+    
+    // Algorithm R: particle n replaces a random one with probability size/(n + 1)
+    size_t n = 0;
+    ParticleBatch read;
+    while (NextBatch(read))
+    {
+        for (size_t i = 0; i != read.size(); ++i, ++n)
+        {
+            if (n < size)
+            {
+                batch.push_back(read, i);
+                continue;
+            }
+            const size_t j = size_t(CounterRandom(seed, n).Uniform()*(n + 1));
+            if (j < size)
+                assign(batch, j, read, i);
+        }
+    }
+    const double correction = batch.empty() ? 1 : double(n)/batch.size();
+    for (size_t i = 0; i != batch.size(); ++i)
+        batch.fWeight[i] *= correction;
+    return n;
+}
@@ -0,0 +1,61 @@
+/**
+ \file
+ Implementation of the shower reuse engine
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ShowerReuse.h>
+#include <stdexcept>
+
+using namespace corsika;
+
+ShowerReuse::ShowerReuse(const std::vector<Detector>& detectors, const std::vector<std::pair<double,double> >& cores,
+                         double cellSize):
+    fCores(cores), fDetectors(detectors), fNDetectors(detectors.size()), fSampler(Shift(detectors, cores), cellSize)
+{
+}
+
+std::vector<Detector> ShowerReuse::Shift(const std::vector<Detector>& detectors,
+                                         const std::vector<std::pair<double,double> >& cores)
+{
+    if (cores.empty())
+        throw std::invalid_argument("ShowerReuse: no core positions");
+    std::vector<Detector> shifted;
+    shifted.reserve(cores.size()*detectors.size());
+    for (size_t k = 0; k != cores.size(); ++k)
+    {
+        for (size_t d = 0; d != detectors.size(); ++d)
+        {
+            Detector det = detectors[d];
+            det.fX -= cores[k].first;
+            det.fY -= cores[k].second;
+            shifted.push_back(det);
+        }
+    }
+    return shifted;
+}
+
+size_t ShowerReuse::Id(size_t k, size_t d) const
+{
+    if (k >= fCores.size() || d >= fNDetectors)
+        throw std::out_of_range("ShowerReuse: core or detector out of range");
+    return k*fNDetectors + d;
+}
+
+void ShowerReuse::SetCallback(const HitCallback& callback)
+{
+    const size_t nDetectors = fNDetectors;
+    fSampler.SetCallback(
+        [callback, nDetectors](const ParticleBatch& batch, size_t particle, size_t id, size_t thread)
+        { callback(batch, particle, id/nDetectors, id%nDetectors, thread); });
+}
+
+size_t ShowerReuse::GetNHits(size_t k) const
+{
+    size_t n = 0;
+    for (size_t d = 0; d != fNDetectors; ++d)
+        n += GetHits(k, d).fEntries;
+    return n;
+}
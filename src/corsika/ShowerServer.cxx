@@ -0,0 +1,515 @@
+/**
+ \file
+ Implementation of the shared-memory shower server
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/ShowerServer.h>
+#include <corsika/IOException.h>
+#include <corsika/Parallel.h>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace corsika;
+
+namespace
+{
+    /// Segments created by this process, to name them (there may be several servers)
+    std::atomic<size_t> gNSegments(0);
+
+    sockaddr_un address(const std::string& path)
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            throw IOException("Socket path too long: '" + path + "'.\n");
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+
+    bool send_line(int fd, const std::string& line)
+    {
+        const std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    /// Take a complete line out of a buffer
+    bool take_line(std::string& buffer, std::string& line)
+    {
+        const size_t end = buffer.find('\n');
+        if (end == std::string::npos)
+            return false;
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 1);
+        return true;
+    }
+
+    std::string canonical(const std::string& filename)
+    {
+        char path[PATH_MAX];
+        if (!realpath(filename.c_str(), path))
+            throw IOException("File not found: '" + filename + "'.\n");
+        return path;
+    }
+
+    /// Path of a file requested by a client, which does not share the working directory of the server
+    std::string requested_path(const std::string& filename)
+    {
+        if (filename.empty() || filename[0] != '/')
+            throw IOException("Not an absolute path: '" + filename + "'.\n");
+        return canonical(filename);
+    }
+
+    /// Decode an event into a new shared memory segment. Returns its name.
+    std::string write_segment(ShowerFile& file, const std::string& path, unsigned int eventId, size_t& size)
+    {
+        if (file.FindEvent(eventId) != eSuccess)
+            throw IOException("No event " + boost::lexical_cast<std::string>(eventId) +
+                              " in '" + path + "'.");
+
+        std::ostringstream name;
+        name << "/corsika-" << getpid() << "-" << gNSegments++;
+        const int fd = shm_open(name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0444);
+        if (fd < 0)
+            throw IOException("Error creating shared memory '" + name.str() + "'.");
+        FILE* f = fdopen(fd, "w+b");
+        if (!f) {
+            close(fd);
+            shm_unlink(name.str().c_str());
+            throw IOException("Error creating shared memory '" + name.str() + "'.");
+        }
+        struct stat st;
+        try {
+            ColumnCache::Write(file, std::vector<unsigned int>(1, eventId), f, name.str());
+            if (fstat(fd, &st))
+                throw IOException("Error writing shared memory '" + name.str() + "'.");
+        }
+        catch (...) {
+            fclose(f);
+            shm_unlink(name.str().c_str());
+            throw;
+        }
+        fclose(f);
+        size = st.st_size;
+        return name.str();
+    }
+
+    /// Split "WORD rest of line"
+    std::string split(const std::string& line, std::string& rest)
+    {
+        const size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            rest.clear();
+            return line;
+        }
+        rest = line.substr(space + 1);
+        return line.substr(0, space);
+    }
+}
+
+const size_t ShowerServer::kDefaultMemoryLimit;
+
+ShowerServer::ShowerServer(const std::string& socketPath, size_t memoryLimit):
+    fSocketPath(socketPath), fSocket(-1), fStop(false),
+    fMemoryLimit(memoryLimit), fSegmentBytes(0), fNRequests(0)
+{
+    RemoveStaleSegments();
+    const sockaddr_un addr = address(socketPath);
+    fSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fSocket < 0)
+        throw IOException("Error creating socket.\n");
+    unlink(socketPath.c_str());
+    if (bind(fSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ||
+        listen(fSocket, 64)) {
+        close(fSocket);
+        throw IOException("Error listening on socket '" + socketPath + "': " + strerror(errno) + ".\n");
+    }
+}
+
+ShowerServer::~ShowerServer()
+{
+    for (std::map<SegmentKey, Segment>::const_iterator it = fSegments.begin(); it != fSegments.end(); ++it)
+        shm_unlink(it->second.fName.c_str());
+    close(fSocket);
+    unlink(fSocketPath.c_str());
+}
+
+size_t ShowerServer::RemoveStaleSegments()
+{
+    // POSIX has no way to list shared memory objects; Linux keeps them in /dev/shm
+    DIR* dir = opendir("/dev/shm");
+    if (!dir)
+        return 0;
+    size_t n = 0;
+    while (const dirent* entry = readdir(dir)) {
+        int pid;
+        size_t id;
+        char end;
+        if (sscanf(entry->d_name, "corsika-%d-%zu%c", &pid, &id, &end) != 2 || pid <= 0 || pid == getpid())
+            continue;
+        if (kill(pid, 0) == 0 || errno != ESRCH)
+            continue;
+        if (!shm_unlink(("/" + std::string(entry->d_name)).c_str()))
+            ++n;
+    }
+    closedir(dir);
+    return n;
+}
+
+/// A client, owned by the worker answering it while busy and by Serve otherwise
+struct ShowerServer::Connection
+{
+    explicit Connection(int socket): fSocket(socket), fOpen(true), fBusy(false) {}
+
+    int fSocket;
+    std::string fBuffer;
+    bool fOpen;
+    std::atomic<bool> fBusy;
+};
+
+size_t ShowerServer::GetNSegments() const
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fSegments.size();
+}
+
+size_t ShowerServer::GetSegmentBytes() const
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fSegmentBytes;
+}
+
+void ShowerServer::Serve(size_t nThreads)
+{
+    fStop = false;
+    if (pipe(fWake))
+        throw IOException("Error creating pipe.\n");
+    std::vector<boost::shared_ptr<Connection> > connections;
+    {
+        ThreadPool workers(nThreads);
+        while (!fStop) {
+            // busy connections are not read until their requests are answered
+            std::vector<pollfd> fds(2);
+            fds[0].fd = fSocket;
+            fds[1].fd = fWake[0];
+            std::vector<boost::shared_ptr<Connection> > polled;
+            for (size_t i = 0; i != connections.size(); ++i) {
+                if (connections[i]->fBusy)
+                    continue;
+                pollfd p;
+                p.fd = connections[i]->fSocket;
+                fds.push_back(p);
+                polled.push_back(connections[i]);
+            }
+            for (size_t i = 0; i != fds.size(); ++i) {
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+
+            // wake up now and then to see if Stop was called
+            const int ready = poll(&fds[0], fds.size(), 200);
+            if (ready < 0 && errno != EINTR)
+                throw IOException("Error waiting for clients.\n");
+            if (ready <= 0)
+                continue;
+
+            if (fds[1].revents & POLLIN) {
+                char data[64];
+                if (read(fWake[0], data, sizeof(data)) < 0 && errno != EINTR)
+                    throw IOException("Error waiting for clients.\n");
+            }
+
+            for (size_t i = 0; i != polled.size(); ++i) {
+                if (!fds[i + 2].revents)
+                    continue;
+                const boost::shared_ptr<Connection> connection = polled[i];
+                char data[4096];
+                const ssize_t n = read(connection->fSocket, data, sizeof(data));
+                if (n <= 0) {
+                    connection->fOpen = false;
+                    continue;
+                }
+                connection->fBuffer.append(data, n);
+                if (connection->fBuffer.find('\n') == std::string::npos)
+                    continue;
+                connection->fBusy = true;
+                workers.Submit([this, connection]() { Answer(*connection); });
+            }
+
+            for (size_t i = connections.size(); i-- > 0; ) {
+                if (connections[i]->fBusy || connections[i]->fOpen)
+                    continue;
+                close(connections[i]->fSocket);
+                connections.erase(connections.begin() + i);
+            }
+
+            if (fds[0].revents & POLLIN) {
+                const int client = accept(fSocket, 0, 0);
+                if (client >= 0)
+                    connections.push_back(boost::shared_ptr<Connection>(new Connection(client)));
+            }
+        }
+    } // the workers answer the requests they already have
+
+    for (size_t i = 0; i != connections.size(); ++i)
+        close(connections[i]->fSocket);
+    close(fWake[0]);
+    close(fWake[1]);
+}
+
+void ShowerServer::Answer(Connection& connection)
+{
+    std::string line;
+    while (connection.fOpen && !fStop && take_line(connection.fBuffer, line))
+        connection.fOpen = send_line(connection.fSocket, Handle(line));
+    connection.fBusy = false;
+    const char wake = 0;
+    while (write(fWake[1], &wake, 1) < 0 && errno == EINTR)
+        ;
+}
+
+std::string ShowerServer::Handle(const std::string& request)
+{
+    try {
+        std::string rest;
+        const std::string command = split(request, rest);
+        if (command == "EVENTS") {
+            const std::string path = requested_path(rest);
+            std::vector<unsigned int> ids;
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                ids = GetFile(path, lock)->GetEventIds();
+            }
+            std::ostringstream reply;
+            reply << "OK";
+            for (size_t i = 0; i != ids.size(); ++i)
+                reply << " " << ids[i];
+            return reply.str();
+        }
+        if (command == "LOAD") {
+            std::string filename;
+            const unsigned int id = boost::lexical_cast<unsigned int>(split(rest, filename));
+            return "OK " + Load(filename, id);
+        }
+        if (command == "STOP") {
+            fStop = true;
+            return "OK";
+        }
+        return "ERROR unknown request '" + command + "'";
+    }
+    catch (std::exception& e) {
+        std::string message = e.what();
+        while (!message.empty() && message[message.size() - 1] == '\n')
+            message.erase(message.size() - 1);
+        return "ERROR " + message;
+    }
+}
+
+boost::shared_ptr<ShowerFile> ShowerServer::GetFile(const std::string& path, std::unique_lock<std::mutex>& lock)
+{
+    // another worker may be scanning this file
+    fOpened.wait(lock, [this, &path]() { return !fOpening.count(path); });
+    std::map<std::string, boost::shared_ptr<ShowerFile> >::const_iterator it = fFiles.find(path);
+    if (it != fFiles.end())
+        return it->second;
+
+    // scan it without the lock, so that other clients are served meanwhile
+    fOpening.insert(path);
+    lock.unlock();
+    boost::shared_ptr<ShowerFile> file;
+    try {
+        file.reset(new ShowerFile(path));
+        file->GetNEvents();
+    }
+    catch (...) {
+        lock.lock();
+        fOpening.erase(path);
+        fOpened.notify_all();
+        throw;
+    }
+    lock.lock();
+    fFiles[path] = file;
+    fOpening.erase(path);
+    fOpened.notify_all();
+    return file;
+}
+
+std::string ShowerServer::Load(const std::string& filename, unsigned int eventId)
+{
+    const std::string path = requested_path(filename);
+    const SegmentKey key(path, eventId);
+    ShowerFile file;
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+        const boost::shared_ptr<ShowerFile> indexed = GetFile(path, lock);
+        // another worker may be decoding this event
+        fDecoded.wait(lock, [this, &key]() { return !fDecoding.count(key); });
+        std::map<SegmentKey, Segment>::iterator it = fSegments.find(key);
+        if (it != fSegments.end()) {
+            it->second.fLastUse = ++fNRequests;
+            return it->second.fName;
+        }
+        file.OpenCopy(*indexed);
+        fDecoding.insert(key);
+    }
+
+    std::string name;
+    size_t size = 0;
+    try {
+        name = write_segment(file, path, eventId, size);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fDecoding.erase(key);
+        fDecoded.notify_all();
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    Segment& segment = fSegments[key];
+    segment.fName = name;
+    segment.fSize = size;
+    segment.fLastUse = ++fNRequests;
+    fSegmentBytes += size;
+    Evict(key);
+    fDecoding.erase(key);
+    fDecoded.notify_all();
+    return name;
+}
+
+void ShowerServer::Evict(const SegmentKey& keep)
+{
+    while (fSegmentBytes > fMemoryLimit && fSegments.size() > 1) {
+        std::map<SegmentKey, Segment>::iterator oldest = fSegments.end();
+        for (std::map<SegmentKey, Segment>::iterator it = fSegments.begin(); it != fSegments.end(); ++it)
+            if (it->first != keep && (oldest == fSegments.end() || it->second.fLastUse < oldest->second.fLastUse))
+                oldest = it;
+        shm_unlink(oldest->second.fName.c_str());
+        fSegmentBytes -= oldest->second.fSize;
+        fSegments.erase(oldest);
+    }
+}
+
+
+ShowerClient::ShowerClient(const std::string& socketPath):
+    fSocketPath(socketPath), fSocket(-1)
+{
+    const sockaddr_un addr = address(socketPath);
+    fSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fSocket < 0)
+        throw IOException("Error creating socket.\n");
+    if (connect(fSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr))) {
+        close(fSocket);
+        throw IOException("Error connecting to shower server at '" + socketPath + "'.\n");
+    }
+}
+
+ShowerClient::~ShowerClient()
+{
+    close(fSocket);
+}
+
+std::string ShowerClient::Request(const std::string& request)
+{
+    if (!send_line(fSocket, request))
+        throw IOException("Error sending request to shower server at '" + fSocketPath + "'.\n");
+    std::string line;
+    while (!take_line(fBuffer, line)) {
+        char data[4096];
+        const ssize_t n = read(fSocket, data, sizeof(data));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw IOException("Shower server at '" + fSocketPath + "' closed the connection.\n");
+        fBuffer.append(data, n);
+    }
+    std::string rest;
+    if (split(line, rest) != "OK")
+        throw IOException("Shower server: " + rest + "\n");
+    return rest;
+}
+
+std::vector<unsigned int> ShowerClient::GetEventIds(const std::string& filename)
+{
+    std::istringstream reply(Request("EVENTS " + canonical(filename)));
+    std::vector<unsigned int> ids;
+    unsigned int id;
+    while (reply >> id)
+        ids.push_back(id);
+    return ids;
+}
+
+boost::shared_ptr<ColumnCache> ShowerClient::Load(const std::string& filename, unsigned int eventId)
+{
+    const std::string request = "LOAD " + boost::lexical_cast<std::string>(eventId) + " " + canonical(filename);
+    const std::string name = Request(request);
+    try {
+        return boost::shared_ptr<ColumnCache>(new ColumnCache(name, ColumnCache::eSharedMemory));
+    }
+    catch (IOException&) {
+        // the server may have evicted the segment before we mapped it: it decodes it again
+        return boost::shared_ptr<ColumnCache>(new ColumnCache(Request(request), ColumnCache::eSharedMemory));
+    }
+}
+
+void ShowerClient::StopServer()
+{
+    Request("STOP");
+}
+
+
+SharedShowerFile::SharedShowerFile(const std::string& socketPath, const std::string& filename):
+    fClient(new ShowerClient(socketPath)),
+    fFilename(filename)
+{
+    fEventIds = fClient->GetEventIds(filename);
+}
+
+Status SharedShowerFile::FindEvent(unsigned int eventId)
+{
+    fCurrentShower = Shower();
+    fParticleStream.reset();
+    fColumns.reset();
+    if (std::find(fEventIds.begin(), fEventIds.end(), eventId) == fEventIds.end())
+        return eFail;
+
+    fColumns = fClient->Load(fFilename, eventId);
+    fParticleStream.reset(new ShowerParticleStream(ColumnCache::CreateParticleStream(fColumns, 0), 0,
+                                                   fColumns->GetObservationLevel(0), true));
+    fCurrentShower = Shower(fColumns->GetEventHeader(0), fColumns->GetEventTrailer(0), fParticleStream.get());
+    return eSuccess;
+}
+
+const RunHeader& SharedShowerFile::GetRunHeader() const
+{
+    if (!fColumns)
+        throw IOException("No event read from '" + fFilename + "'.\n");
+    return fColumns->GetRunHeader();
+}
@@ -0,0 +1,199 @@
+/**
+ \file
+ Implementation of particle skims
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/Skim.h>
+#include <corsika/CounterRandom.h>
+#include <corsika/Particle.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/ShowerFrame.h>
+#include <corsika/particle/ParticleList.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace corsika;
+
+namespace
+{
+    void scale_weight(ParticleData<Thinned>& p, double factor) { p.fWeight *= factor; }
+    void scale_weight(ParticleData<NotThinned>&, double) {}
+
+    template <typename Thinning>
+    struct Skimmer
+    {
+        Skimmer(RawStreamWriter& output, const ParticleSelection& selection, double fraction, uint64_t seed,
+                unsigned int observationLevel):
+            fOutput(output), fSelection(selection), fFraction(fraction), fSeed(seed),
+            fObservationLevel(observationLevel), fTimeShift(0),
+            fNOut(0), fNRead(0), fNKept(0)
+        {
+            std::memset(&fBlock, 0, sizeof(fBlock));
+        }
+
+        void Add(const Block<Thinning>& block)
+        {
+            if (block.IsControl() || block.IsLongitudinal())
+            {
+                Flush();
+                fAuxiliary.clear();
+                WriteBlock();
+                fOutput.Write(block);
+                if (block.IsEventHeader())
+                    fTimeShift = ShowerFrame::CoreTimeShift(block.AsEventHeader);
+                return;
+            }
+            for (size_t i = 0; i != kParticlesInBlock; ++i)
+                Add(block.AsParticleBlock.fParticle[i]);
+        }
+
+        void Add(const ParticleData<Thinning>& record)
+        {
+            if (record.fDescription == 0) // empty
+                return;
+            const int id = int(record.fDescription/1000);
+            if (record.fDescription < 0 || id == 75 || id == 76 || id == 85 || id == 86)
+            {
+                // history and muon-production records go with the next particle
+                fAuxiliary.push_back(record);
+                return;
+            }
+
+            // the particles of ShowerParticleStream: known type, at the observation level
+            const bool particle = (ParticleList::CorsikaToPDG(id) != Particle::eUndefined);
+            const unsigned int level = (unsigned int)record.fDescription % 10;
+            if (particle && level != fObservationLevel)
+            {
+                fAuxiliary.clear();
+                return;
+            }
+
+            fRecords.insert(fRecords.end(), fAuxiliary.begin(), fAuxiliary.end());
+            fAuxiliary.clear();
+            fRecords.push_back(record);
+            fGroupEnd.push_back(fRecords.size());
+            if (!particle)
+            {
+                // Cherenkov bunches and the like are copied, not selected
+                fGroupParticle.push_back(-1);
+                return;
+            }
+            Particle p(record);
+            p.fTorZ -= fTimeShift;
+            fGroupParticle.push_back(int(fBatch.size()));
+            fBatch.push_back(p);
+            if (fBatch.size() == ParticleBatch::kDefaultSize)
+                Flush();
+        }
+
+        /// Select the particles read so far and write the ones that pass
+        void Flush()
+        {
+            if (fGroupEnd.empty())
+                return;
+            if (!fBatch.empty())
+                fSelection.Evaluate(fBatch, fMask);
+            size_t begin = 0;
+            for (size_t g = 0; g != fGroupEnd.size(); ++g)
+            {
+                const size_t end = fGroupEnd[g];
+                const int i = fGroupParticle[g];
+                bool keep = true;
+                if (i >= 0)
+                {
+                    const uint64_t id = fNRead++;
+                    keep = fMask[i] && (fFraction >= 1 || CounterRandom(fSeed, id).Uniform() < fFraction);
+                }
+                if (keep)
+                {
+                    for (size_t r = begin; r != end; ++r)
+                        Write(fRecords[r]);
+                    if (i >= 0 && fFraction < 1)
+                        scale_weight(fBlock.AsParticleBlock.fParticle[fNOut - 1], 1/fFraction);
+                    if (i >= 0)
+                        ++fNKept;
+                }
+                begin = end;
+            }
+            fBatch.clear();
+            fRecords.clear();
+            fGroupEnd.clear();
+            fGroupParticle.clear();
+        }
+
+        void Write(const ParticleData<Thinning>& record)
+        {
+            if (fNOut == kParticlesInBlock)
+                WriteBlock();
+            fBlock.AsParticleBlock.fParticle[fNOut++] = record;
+        }
+
+        /// Write the particle block, completed with empty records
+        void WriteBlock()
+        {
+            if (!fNOut)
+                return;
+            std::memset(fBlock.AsParticleBlock.fParticle + fNOut, 0, (kParticlesInBlock - fNOut)*sizeof(ParticleData<Thinning>));
+            fOutput.Write(fBlock);
+            fNOut = 0;
+        }
+
+        size_t Run(RawStream& input)
+        {
+            Block<Thinning> block;
+            while (input.GetNextBlock(block))
+                Add(block);
+            Flush();
+            WriteBlock();
+            return fNKept;
+        }
+
+        RawStreamWriter& fOutput;
+        const ParticleSelection& fSelection;
+        double fFraction;
+        uint64_t fSeed;
+        unsigned int fObservationLevel;
+        double fTimeShift;  // of the current event
+
+        Block<Thinning> fBlock;
+        size_t fNOut;   // records in fBlock
+
+        std::vector<ParticleData<Thinning> > fAuxiliary;
+        std::vector<ParticleData<Thinning> > fRecords;
+        std::vector<size_t> fGroupEnd;      // records of each group: a particle and what precedes it
+        std::vector<int> fGroupParticle;    // its place in fBatch, -1 if it is copied without selection
+        ParticleBatch fBatch;
+        std::vector<char> fMask;
+        size_t fNRead;
+        size_t fNKept;
+    };
+}
+
+size_t corsika::Skim(RawStream& input, RawStreamWriter& output, const ParticleSelection& selection,
+                     double fraction, uint64_t seed, unsigned int observationLevel)
+{
+    if (!(fraction > 0 && fraction <= 1))
+        throw std::invalid_argument("Skim: the fraction must be in (0, 1]");
+    if (fraction < 1 && !input.IsThinned())
+        throw std::invalid_argument("Skim: subsampling needs a thinned file to carry the weights");
+    if (input.IsThinned() != output.IsThinned())
+        throw std::invalid_argument("Skim: input and output must be both thinned or both not thinned");
+
+    if (input.IsThinned())
+        return Skimmer<Thinned>(output, selection, fraction, seed, observationLevel).Run(input);
+    return Skimmer<NotThinned>(output, selection, fraction, seed, observationLevel).Run(input);
+}
+
+size_t corsika::Skim(const std::string& input, const std::string& output, const ParticleSelection& selection,
+                     double fraction, uint64_t seed, unsigned int observationLevel)
+{
+    RawStreamPtr in = RawStream::Create(input);
+    RawStreamWriterPtr out = RawStreamWriter::Create(output, in->IsThinned(), in->Is64Bit());
+    const size_t n = Skim(*in, *out, selection, fraction, seed, observationLevel);
+    out->Close();
+    return n;
+}
@@ -0,0 +1,227 @@
+/**
+ \file
+ Implementation of the timeline of the reader stages
+
+ \version $Id$
+ \date 19 Oct 2026
+ */
+
+#include <corsika/Trace.h>
+#include <corsika/IOException.h>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+
+using namespace corsika;
+
+namespace
+{
+    struct SpanRecord
+    {
+        const char* fName;
+        const char* fStage;
+        uint64_t fStart;
+        uint64_t fEnd;
+    };
+
+    /// The spans of a thread. Only the thread adds to them, the lock is for Write and Clear.
+    struct ThreadSpans
+    {
+        std::mutex fMutex;
+        std::vector<SpanRecord> fSpans;
+        std::string fName;
+        unsigned int fId;
+    };
+
+    struct Registry
+    {
+        Registry(): fNSpans(0), fNDropped(0), fMaxSpans(0), fStart(0) {}
+
+        std::mutex fMutex;
+        std::vector<boost::shared_ptr<ThreadSpans> > fThreads;  // kept after the threads exit
+        std::set<std::string> fStrings;
+        std::atomic<size_t> fNSpans;
+        std::atomic<size_t> fNDropped;
+        std::atomic<size_t> fMaxSpans;
+        uint64_t fStart;
+    };
+
+    Registry& registry()
+    {
+        static Registry* r = new Registry;  // never destroyed, threads can exit after main
+        return *r;
+    }
+
+    std::atomic<bool> gRecording(false);
+    thread_local ThreadSpans* tSpans = 0;
+
+    ThreadSpans& thread_spans()
+    {
+        if (!tSpans)
+        {
+            boost::shared_ptr<ThreadSpans> spans(new ThreadSpans);
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.fMutex);
+            spans->fId = r.fThreads.size() + 1;
+            r.fThreads.push_back(spans);
+            tSpans = spans.get();
+        }
+        return *tSpans;
+    }
+
+    std::string json_string(const std::string& s)
+    {
+        std::string out = "\"";
+        for (size_t i = 0; i != s.size(); ++i)
+        {
+            const unsigned char c = s[i];
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else
+                out += c;
+        }
+        return out + "\"";
+    }
+}
+
+void Trace::Start(size_t maxSpans)
+{
+    Clear();
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.fMutex);
+        r.fMaxSpans = maxSpans;
+        r.fStart = Now();
+    }
+    gRecording = true;
+}
+
+size_t Trace::Stop()
+{
+    gRecording = false;
+    return GetNSpans();
+}
+
+bool Trace::IsRecording()
+{
+    return gRecording.load(std::memory_order_relaxed);
+}
+
+size_t Trace::GetNSpans()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.fMutex);
+    return std::min(r.fNSpans.load(), r.fMaxSpans.load());
+}
+
+size_t Trace::GetNDropped()
+{
+    return registry().fNDropped;
+}
+
+void Trace::Clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.fMutex);
+    for (size_t t = 0; t != r.fThreads.size(); ++t)
+    {
+        std::lock_guard<std::mutex> threadLock(r.fThreads[t]->fMutex);
+        r.fThreads[t]->fSpans.clear();
+    }
+    r.fNSpans = 0;
+    r.fNDropped = 0;
+}
+
+void Trace::SetThreadName(const std::string& name)
+{
+    ThreadSpans& spans = thread_spans();
+    std::lock_guard<std::mutex> lock(spans.fMutex);
+    spans.fName = name;
+}
+
+uint64_t Trace::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::Record(const char* name, const char* stage, uint64_t start, uint64_t end)
+{
+    Registry& r = registry();
+    if (r.fNSpans++ >= r.fMaxSpans)
+    {
+        ++r.fNDropped;
+        return;
+    }
+    ThreadSpans& spans = thread_spans();
+    const SpanRecord span = {name, stage, start, end};
+    std::lock_guard<std::mutex> lock(spans.fMutex);
+    spans.fSpans.push_back(span);
+}
+
+const char* Trace::Intern(const std::string& s)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.fMutex);
+    return r.fStrings.insert(s).first->c_str();
+}
+
+void Trace::Write(const std::string& filename)
+{
+    std::ofstream out(filename.c_str());
+    if (!out)
+        throw IOException("Error opening trace '" + filename + "' for writing.\n");
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.fMutex);
+    const int pid = getpid();
+    out << "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped_spans\": " << r.fNDropped << "},\n"
+        << "\"traceEvents\": [\n"
+        << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": 0, \"args\": {\"name\": \"corsika\"}}";
+    char buffer[64];
+    for (size_t t = 0; t != r.fThreads.size(); ++t)
+    {
+        ThreadSpans& thread = *r.fThreads[t];
+        std::lock_guard<std::mutex> threadLock(thread.fMutex);
+        if (thread.fSpans.empty() && thread.fName.empty())
+            continue;
+        std::ostringstream name;
+        if (thread.fName.empty())
+            name << "thread " << thread.fId;
+        else
+            name << thread.fName;
+        out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << thread.fId
+            << ", \"args\": {\"name\": " << json_string(name.str()) << "}}"
+            << ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << thread.fId
+            << ", \"args\": {\"sort_index\": " << thread.fId << "}}";
+        for (size_t i = 0; i != thread.fSpans.size(); ++i)
+        {
+            const SpanRecord& span = thread.fSpans[i];
+            // microseconds since Start, with ns precision
+            snprintf(buffer, sizeof(buffer), "\"ts\": %.3f, \"dur\": %.3f",
+                     int64_t(span.fStart - r.fStart)*1e-3, (span.fEnd - span.fStart)*1e-3);
+            out << ",\n{\"name\": " << json_string(span.fName) << ", \"cat\": " << json_string(span.fStage)
+                << ", \"ph\": \"X\", " << buffer << ", \"pid\": " << pid << ", \"tid\": " << thread.fId << "}";
+        }
+    }
+    out << "\n]}\n";
+    if (!out)
+        throw IOException("Error writing trace '" + filename + "'.\n");
+}
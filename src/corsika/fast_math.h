@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/*
+  Branch-free exp, log and selection masks shared by the batch
+  evaluation of Gaisser-Hillas functions and the profile resampler.
+ */
+namespace corsika
+{
+namespace detail
+{
+    // exp and log for the batch loops over profiles, written without
+    // branches or calls so that they vectorize. Both are accurate to a
+    // few units in the last place in the range of a profile.
+    
+    inline double from_bits(uint64_t i)
+    {
+        double d;
+        memcpy(&d, &i, sizeof(d));
+        return d;
+    }
+    
+    inline uint64_t to_bits(double d)
+    {
+        uint64_t i;
+        memcpy(&i, &d, sizeof(i));
+        return i;
+    }
+    
+    const double kLn2Hi = 6.93147180369123816490e-01;
+    const double kLn2Lo = 1.90821492927058770002e-10;
+    
+    /// exp(x) for |x| < 708, the caller checks the range
+    inline double fast_exp(const double x)
+    {
+        // round x/ln2 to the nearest integer k, which ends up in the low bits of t
+        const double shift = 6755399441055744.0; // 1.5*2^52
+        const double t = x*1.4426950408889634 + shift;
+        const double k = t - shift;
+        const double r = (x - k*kLn2Hi) - k*kLn2Lo;  // |r| <= ln2/2
+        // Taylor series to r^12/12!
+        double p = 1./479001600;
+        p = p*r + 1./39916800;
+        p = p*r + 1./3628800;
+        p = p*r + 1./362880;
+        p = p*r + 1./40320;
+        p = p*r + 1./5040;
+        p = p*r + 1./720;
+        p = p*r + 1./120;
+        p = p*r + 1./24;
+        p = p*r + 1./6;
+        p = p*r + 0.5;
+        p = p*r + 1;
+        p = p*r + 1;
+        // times 2^k: the low bits of t are k + 2^51, the shift drops the ones above
+        return p*from_bits((to_bits(t) + (1023 - (uint64_t(1) << 51))) << 52);
+    }
+    
+    // The selection of the results is done with integer masks: gcc
+    // turns selects into branches and does not vectorize 64-bit
+    // comparisons before SSE4.2. Only subtractions and shifts are used,
+    // the sign bit of a - b is set when a < b (both below 2^63).
+    
+    /// All bits set if 0 < x <= inf, zero if not
+    inline uint64_t positive_mask(double x)
+    {
+        // x > 0 when bits - 1 is below the bits of infinity, and below 2^63
+        const uint64_t a = to_bits(x) - 1;
+        return 0 - ((~a & (a - 0x7ff0000000000000ULL)) >> 63);
+    }
+    
+    /// All bits set if 0 <= x < limit, zero if not (or if x is NaN)
+    inline uint64_t below_mask(double x, double limit)
+    {
+        return 0 - ((to_bits(x) - to_bits(limit)) >> 63);
+    }
+    
+    /// log(x) for positive normal x
+    inline double fast_log(double x)
+    {
+        // x = m 2^e with m in [sqrt(1/2), sqrt(2))
+        const uint64_t sqrtHalf = 0x3fe6a09e667f3bcdULL;
+        const uint64_t bits = to_bits(x) + (0x3ff0000000000000ULL - sqrtHalf);
+        // the exponent as a double, without an integer conversion
+        const double e = from_bits((bits >> 52) | 0x4330000000000000ULL) - (4503599627370496.0 + 0x3ff);
+        const double m = from_bits((bits & 0x000fffffffffffffULL) + sqrtHalf);
+        // log(m) = 2 atanh(f), |f| < 0.172
+        const double f = (m - 1)/(m + 1);
+        const double f2 = f*f;
+        double s = 1./19;
+        s = s*f2 + 1./17;
+        s = s*f2 + 1./15;
+        s = s*f2 + 1./13;
+        s = s*f2 + 1./11;
+        s = s*f2 + 1./9;
+        s = s*f2 + 1./7;
+        s = s*f2 + 1./5;
+        s = s*f2 + 1./3;
+        s = s*f2 + 1;
+        return 2*f*s + e*kLn2Lo + e*kLn2Hi;
+    }
+}
+}
@@ -12,6 +12,7 @@
 #include <corsika/IOException.h>
 #include <vector>
 #include <sstream>
+#include <mutex>
 using namespace corsika;
 
 namespace
@@ -68,6 +69,13 @@ std::map<int, int> ParticleList::corsikaToPDGMap_;
 std::map<int, ParticleProperties> ParticleList::particles_;
 std::map<int, NucleusProperties> ParticleList::nuclei_;
 
+namespace
+{
+    // the maps are filled on first use, possibly from several threads at once
+    std::once_flag gListFlag;
+    std::once_flag gCorsikaToPDGFlag;
+}
+
 const VParticleProperties& ParticleList::Get(int code)
 {
     SetList();
@@ -89,8 +97,11 @@ const VParticleProperties& ParticleList::Get(int code)
 
 void ParticleList::SetList()
 {
-    if (particles_.size()>0) return;
-    
+    std::call_once(gListFlag, FillList);
+}
+
+void ParticleList::FillList()
+{
     std::vector<ParticleProperties> prop =
     {
         ParticleProperties(Particle::eUndefined,       "Undefined",       0.),
@@ -230,7 +241,7 @@ int ParticleList::CorsikaToPDG(int theCorsikaCode)
 {
     if (theCorsikaCode < 100)
     {
-        if (!corsikaToPDGMap_.size()) InitCorsikaToPDGMap();
+        std::call_once(gCorsikaToPDGFlag, InitCorsikaToPDGMap);
         
         auto index = corsikaToPDGMap_.find(theCorsikaCode);
         
@@ -0,0 +1,120 @@
+#include <boost/python.hpp>
+#include <corsika/ColumnCache.h>
+#include "numpy_helpers.h"
+#include <string>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  typedef boost::shared_ptr<ColumnCache> ColumnCachePtr;
+
+  /*
+    A column exposed through __array_interface__. numpy keeps this
+    object as the base of the array, and this object keeps the mapped
+    file alive, so the array is a view of the file with no copy.
+   */
+  struct ColumnBuffer
+  {
+    ColumnCachePtr cache;
+    size_t event;
+    ColumnCache::Column column;
+
+    dict array_interface() const
+    {
+      dict d;
+      d["version"] = 3;
+      d["shape"] = make_tuple(cache->GetNParticles(event));
+      d["typestr"] = ColumnCache::ColumnType(column);
+      d["data"] = make_tuple(size_t(cache->GetData(event, column)), true); // read-only
+      return d;
+    }
+  };
+
+  ColumnCache::Column column_from_name(const std::string& name)
+  {
+    ColumnCache::Column c = ColumnCache::ColumnFromName(name);
+    if (c == ColumnCache::eNColumns) {
+      PyErr_SetString(PyExc_KeyError, ("Unknown column: " + name).c_str());
+      throw_error_already_set();
+    }
+    return c;
+  }
+
+  size_t check_event(const ColumnCache& cache, size_t event)
+  {
+    if (event >= cache.GetNEvents()) {
+      PyErr_SetString(PyExc_IndexError, "Event out of range.");
+      throw_error_already_set();
+    }
+    return event;
+  }
+
+  object column(ColumnCachePtr cache, size_t event, const std::string& name)
+  {
+    ColumnBuffer buffer = { cache, check_event(*cache, event), column_from_name(name) };
+    return numpy_helpers::numpy().attr("asarray")(buffer);
+  }
+
+  dict columns(ColumnCachePtr cache, size_t event)
+  {
+    dict d;
+    for (int c = 0; c != ColumnCache::eNColumns; ++c)
+      d[ColumnCache::ColumnName(ColumnCache::Column(c))] =
+        column(cache, event, ColumnCache::ColumnName(ColumnCache::Column(c)));
+    return d;
+  }
+
+  object find_event(const ColumnCache& cache, unsigned int id)
+  {
+    size_t e = cache.FindEvent(id);
+    if (e == cache.GetNEvents())
+      return object();
+    return object(e);
+  }
+
+  object column_names()
+  {
+    list names;
+    for (int c = 0; c != ColumnCache::eNColumns; ++c)
+      names.append(ColumnCache::ColumnName(ColumnCache::Column(c)));
+    return names;
+  }
+
+  const EventHeader& event_header(const ColumnCache& cache, size_t event)
+  {
+    return cache.GetEventHeader(check_event(cache, event));
+  }
+
+  size_t n_particles(const ColumnCache& cache, size_t event)
+  {
+    return cache.GetNParticles(check_event(cache, event));
+  }
+}
+
+void register_ColumnCache()
+{
+  class_<ColumnBuffer>("_ColumnBuffer", no_init)
+    .add_property("__array_interface__", &ColumnBuffer::array_interface)
+    ;
+
+  class_<ColumnCache, ColumnCachePtr, boost::noncopyable>("ColumnCache",
+    "Decoded particle columns of every event, memory-mapped from a cache file written by ColumnCache.convert.\n"
+    "Columns are read-only numpy views of the file.",
+    init<std::string>())
+    .add_property("filename", make_function(&ColumnCache::GetFilename, return_value_policy<copy_const_reference>()))
+    .add_property("run_header", make_function(&ColumnCache::GetRunHeader, return_internal_reference<>()))
+    .add_property("n_events", &ColumnCache::GetNEvents)
+    .def("find_event", find_event, "Position of the event with this event number, None if there is none")
+    .def("event_header", event_header, return_internal_reference<>())
+    .def("n_particles", n_particles)
+    .def("column", column, (arg("event"), arg("name")), "Column of an event as a read-only numpy array (no copy)")
+    .def("columns", columns, "All columns of an event in a dict")
+    .def("convert", &ColumnCache::Convert, (arg("corsika_file"), arg("cache_file")),
+         "Decode all events of a CORSIKA file into a cache file. Returns the number of particles.")
+    .staticmethod("convert")
+    .def("column_names", column_names)
+    .staticmethod("column_names")
+    ;
+}
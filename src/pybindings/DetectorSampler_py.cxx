@@ -0,0 +1,232 @@
+#include <boost/python.hpp>
+#include <corsika/DetectorSampler.h>
+#include <corsika/ShowerReuse.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerParticleStream.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <stdexcept>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  template <class F>
+  object per_detector(const DetectorSampler& s, F f)
+  {
+    std::vector<double> values(s.GetNDetectors());
+    for (size_t d = 0; d != values.size(); ++d)
+      values[d] = f(s.GetHits(d));
+    return numpy_helpers::from_vector(values);
+  }
+}
+
+boost::shared_ptr<DetectorSampler> make_sampler(object detectors, double cellSize)
+{
+  std::vector<Detector> layout;
+  for (long i = 0; i != len(detectors); ++i)
+    layout.push_back(extract<Detector>(detectors[i]));
+  return boost::shared_ptr<DetectorSampler>(new DetectorSampler(layout, cellSize));
+}
+
+boost::shared_ptr<DetectorSampler> make_sampler_default(object detectors)
+{ return make_sampler(detectors, 0); }
+
+// circular detectors of the same radius from arrays of positions
+boost::shared_ptr<DetectorSampler> sampler_circles(object x, object y, double radius)
+{
+  std::vector<double> xs = numpy_helpers::to_vector<double>(x);
+  std::vector<double> ys = numpy_helpers::to_vector<double>(y);
+  if (xs.size() != ys.size())
+    throw std::invalid_argument("x and y have different lengths");
+  std::vector<Detector> layout;
+  for (size_t i = 0; i != xs.size(); ++i)
+    layout.push_back(Detector::Circle(xs[i], ys[i], radius));
+  return boost::shared_ptr<DetectorSampler>(new DetectorSampler(layout));
+}
+
+void sampler_sample_batch(DetectorSampler& s, const ParticleBatch& batch)
+{
+  ReleaseGIL nogil;
+  s.Sample(batch);
+}
+
+void sampler_sample_shower(DetectorSampler& s, Shower& shower, size_t threads)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ReleaseGIL nogil;
+  s.Sample(stream, threads);
+}
+
+void sampler_sample_shower_default(DetectorSampler& s, Shower& shower)
+{ sampler_sample_shower(s, shower, 1); }
+
+void sampler_set_selection(DetectorSampler& s, const std::string& expression)
+{ s.SetSelection(ParticleSelection(expression)); }
+
+void sampler_set_core(DetectorSampler& s, double x, double y)
+{ s.SetCore(x, y); }
+
+object sampler_weight(const DetectorSampler& s)
+{ return per_detector(s, [](const DetectorHits& h) { return h.fWeight; }); }
+
+object sampler_sumw2(const DetectorSampler& s)
+{ return per_detector(s, [](const DetectorHits& h) { return h.fSumW2; }); }
+
+object sampler_entries(const DetectorSampler& s)
+{ return per_detector(s, [](const DetectorHits& h) { return double(h.fEntries); }); }
+
+object sampler_energy(const DetectorSampler& s)
+{ return per_detector(s, [](const DetectorHits& h) { return h.fEnergy; }); }
+
+object sampler_first_time(const DetectorSampler& s)
+{ return per_detector(s, [](const DetectorHits& h) { return h.fFirstTime; }); }
+
+boost::shared_ptr<ShowerReuse> make_reuse(object detectors, object x, object y)
+{
+  std::vector<Detector> layout;
+  for (long i = 0; i != len(detectors); ++i)
+    layout.push_back(extract<Detector>(detectors[i]));
+  std::vector<double> xs = numpy_helpers::to_vector<double>(x);
+  std::vector<double> ys = numpy_helpers::to_vector<double>(y);
+  if (xs.size() != ys.size())
+    throw std::invalid_argument("x and y have different lengths");
+  std::vector<std::pair<double,double> > cores(xs.size());
+  for (size_t k = 0; k != xs.size(); ++k)
+    cores[k] = std::make_pair(xs[k], ys[k]);
+  return boost::shared_ptr<ShowerReuse>(new ShowerReuse(layout, cores));
+}
+
+void reuse_sample_batch(ShowerReuse& r, const ParticleBatch& batch)
+{
+  ReleaseGIL nogil;
+  r.Sample(batch);
+}
+
+void reuse_sample_shower(ShowerReuse& r, Shower& shower, size_t threads)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ReleaseGIL nogil;
+  r.Sample(stream, threads);
+}
+
+void reuse_sample_shower_default(ShowerReuse& r, Shower& shower)
+{ reuse_sample_shower(r, shower, 1); }
+
+void reuse_set_selection(ShowerReuse& r, const std::string& expression)
+{ r.SetSelection(ParticleSelection(expression)); }
+
+// (n_cores, n_detectors) array of one DetectorHits field
+template <class F>
+object reuse_table(const ShowerReuse& r, F f)
+{
+  std::vector<double> values(r.GetNCores()*r.GetNDetectors());
+  for (size_t k = 0; k != r.GetNCores(); ++k)
+    for (size_t d = 0; d != r.GetNDetectors(); ++d)
+      values[k*r.GetNDetectors() + d] = f(r.GetHits(k, d));
+  return numpy_helpers::from_vector(values).attr("reshape")(r.GetNCores(), r.GetNDetectors());
+}
+
+object reuse_weight(const ShowerReuse& r)
+{ return reuse_table(r, [](const DetectorHits& h) { return h.fWeight; }); }
+
+object reuse_sumw2(const ShowerReuse& r)
+{ return reuse_table(r, [](const DetectorHits& h) { return h.fSumW2; }); }
+
+object reuse_entries(const ShowerReuse& r)
+{ return reuse_table(r, [](const DetectorHits& h) { return double(h.fEntries); }); }
+
+object reuse_energy(const ShowerReuse& r)
+{ return reuse_table(r, [](const DetectorHits& h) { return h.fEnergy; }); }
+
+object reuse_first_time(const ShowerReuse& r)
+{ return reuse_table(r, [](const DetectorHits& h) { return h.fFirstTime; }); }
+
+size_t reuse_n_hits(const ShowerReuse& r)
+{ return r.GetNHits(); }
+
+size_t reuse_n_hits_core(const ShowerReuse& r, size_t k)
+{ return r.GetNHits(k); }
+
+void register_DetectorSampler()
+{
+  {
+    scope in_detector =
+      class_<Detector>("Detector", no_init)
+      .def("circle", &Detector::Circle)
+      .staticmethod("circle")
+      .def("rectangle", &Detector::Rectangle, (arg("x"), arg("y"), arg("dx"), arg("dy"), arg("angle")=0.))
+      .staticmethod("rectangle")
+      .add_property("area", &Detector::GetArea)
+      .def_readonly("shape", &Detector::fShape)
+      .def_readonly("x", &Detector::fX)
+      .def_readonly("y", &Detector::fY)
+      .def_readonly("radius", &Detector::fRadius)
+      .def_readonly("dx", &Detector::fDx)
+      .def_readonly("dy", &Detector::fDy)
+      .def_readonly("angle", &Detector::fAngle)
+      ;
+
+    enum_<Detector::Shape>("Shape")
+      .value("eCircle", Detector::eCircle)
+      .value("eRectangle", Detector::eRectangle)
+      ;
+  }
+
+  class_<DetectorHits>("DetectorHits")
+    .def_readonly("entries", &DetectorHits::fEntries)
+    .def_readonly("weight", &DetectorHits::fWeight)
+    .def_readonly("sumw2", &DetectorHits::fSumW2)
+    .def_readonly("energy", &DetectorHits::fEnergy)
+    .def_readonly("first_time", &DetectorHits::fFirstTime)
+    ;
+
+  class_<DetectorSampler, boost::shared_ptr<DetectorSampler> >("DetectorSampler", no_init)
+    .def("__init__", make_constructor(make_sampler_default), "Sampler for a list of Detector")
+    .def("__init__", make_constructor(make_sampler))
+    .def("circles", sampler_circles, "Sampler for circular detectors of one radius at arrays of positions")
+    .staticmethod("circles")
+    .def("__len__", &DetectorSampler::GetNDetectors)
+    .def("detector", &DetectorSampler::GetDetector, return_internal_reference<>())
+    .def("set_core", sampler_set_core, "Position of the shower core in the layout")
+    .add_property("core_x", &DetectorSampler::GetCoreX)
+    .add_property("core_y", &DetectorSampler::GetCoreY)
+    .def("set_selection", sampler_set_selection, "Only sample particles passing a selection expression")
+    .def("clear_selection", &DetectorSampler::ClearSelection)
+    .add_property("use_weights", &DetectorSampler::GetUseWeights, &DetectorSampler::SetUseWeights)
+    .def("sample", sampler_sample_batch)
+    .def("sample", sampler_sample_shower_default)
+    .def("sample", sampler_sample_shower, "Sample the particles of a shower, optionally on several threads")
+    .def("hits", &DetectorSampler::GetHits, return_internal_reference<>())
+    .add_property("n_hits", &DetectorSampler::GetNHits)
+    .add_property("weight", sampler_weight, "Sum of weights in each detector")
+    .add_property("sumw2", sampler_sumw2)
+    .add_property("entries", sampler_entries)
+    .add_property("energy", sampler_energy, "Weighted sum of kinetic energies in each detector")
+    .add_property("first_time", sampler_first_time)
+    .def("reset", &DetectorSampler::Reset)
+    ;
+
+  class_<ShowerReuse, boost::shared_ptr<ShowerReuse> >("ShowerReuse", no_init)
+    .def("__init__", make_constructor(make_reuse), "Sampler for a list of Detector and arrays of core positions x and y")
+    .add_property("n_cores", &ShowerReuse::GetNCores)
+    .add_property("n_detectors", &ShowerReuse::GetNDetectors)
+    .def("detector", &ShowerReuse::GetDetector, return_internal_reference<>())
+    .def("set_selection", reuse_set_selection)
+    .def("clear_selection", &ShowerReuse::ClearSelection)
+    .add_property("use_weights", &ShowerReuse::GetUseWeights, &ShowerReuse::SetUseWeights)
+    .def("sample", reuse_sample_batch)
+    .def("sample", reuse_sample_shower_default)
+    .def("sample", reuse_sample_shower, "Sample the particles of a shower for all cores, optionally on several threads")
+    .def("hits", &ShowerReuse::GetHits, return_internal_reference<>(), "Hits for core k in detector d")
+    .def("n_hits", reuse_n_hits)
+    .def("n_hits", reuse_n_hits_core)
+    .add_property("weight", reuse_weight, "Sum of weights, an array of shape (n_cores, n_detectors)")
+    .add_property("sumw2", reuse_sumw2)
+    .add_property("entries", reuse_entries)
+    .add_property("energy", reuse_energy)
+    .add_property("first_time", reuse_first_time)
+    .def("reset", &ShowerReuse::Reset)
+    ;
+}
@@ -0,0 +1,75 @@
+#include <boost/python.hpp>
+#include <corsika/Dethinning.h>
+#include <corsika/Shower.h>
+#include <corsika/ShowerParticleStream.h>
+#include "gil_helpers.h"
+
+using namespace boost::python;
+using namespace corsika;
+
+boost::shared_ptr<Dethinner> make_dethinner(object detectors, const DethinningKernel& kernel, uint64_t seed)
+{
+  std::vector<Detector> layout;
+  for (long i = 0; i != len(detectors); ++i)
+    layout.push_back(extract<Detector>(detectors[i]));
+  return boost::shared_ptr<Dethinner>(new Dethinner(layout, kernel, seed));
+}
+
+boost::shared_ptr<Dethinner> make_dethinner_kernel(object detectors, const DethinningKernel& kernel)
+{ return make_dethinner(detectors, kernel, 0); }
+
+boost::shared_ptr<Dethinner> make_dethinner_default(object detectors)
+{ return make_dethinner(detectors, DethinningKernel(), 0); }
+
+void dethinner_sample_batch(Dethinner& d, const ParticleBatch& batch)
+{
+  ReleaseGIL nogil;
+  d.Sample(batch);
+}
+
+void dethinner_sample_shower(Dethinner& d, Shower& shower, size_t threads)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ReleaseGIL nogil;
+  d.Sample(stream, threads);
+}
+
+void dethinner_sample_shower_default(Dethinner& d, Shower& shower)
+{ dethinner_sample_shower(d, shower, 1); }
+
+void dethinner_set_selection(Dethinner& d, const std::string& expression)
+{ d.SetSelection(ParticleSelection(expression)); }
+
+void dethinner_set_core(Dethinner& d, double x, double y)
+{ d.SetCore(x, y); }
+
+void register_Dethinning()
+{
+  class_<DethinningKernel>("DethinningKernel")
+    .def_readwrite("vertex_distance", &DethinningKernel::fVertexDistance)
+    .def_readwrite("vertex_spread", &DethinningKernel::fVertexSpread, "Relative width of the vertex distance")
+    .def_readwrite("cone_angle", &DethinningKernel::fConeAngle)
+    .def_readwrite("max_zenith", &DethinningKernel::fMaxZenith, "More inclined particles are not resampled")
+    .def("reach", &DethinningKernel::GetReach, "Largest horizontal displacement for a particle with this zenith angle")
+    ;
+
+  class_<Dethinner, boost::shared_ptr<Dethinner> >("Dethinner", no_init)
+    .def("__init__", make_constructor(make_dethinner_default), "De-thinning for a list of Detector")
+    .def("__init__", make_constructor(make_dethinner_kernel))
+    .def("__init__", make_constructor(make_dethinner))
+    .def("__len__", &Dethinner::GetNDetectors)
+    .def("detector", &Dethinner::GetDetector, return_internal_reference<>())
+    .add_property("kernel", make_function(&Dethinner::GetKernel, return_internal_reference<>()))
+    .add_property("seed", &Dethinner::GetSeed)
+    .def("set_core", dethinner_set_core)
+    .def("set_selection", dethinner_set_selection)
+    .def("clear_selection", &Dethinner::ClearSelection)
+    .def("sample", dethinner_sample_batch)
+    .def("sample", dethinner_sample_shower_default)
+    .def("sample", dethinner_sample_shower, "Resample the particles of a shower, optionally on several threads")
+    .def("particles", &Dethinner::GetParticles, return_internal_reference<>(), "ParticleBatch of the particles in a detector")
+    .add_property("n_read", &Dethinner::GetNRead)
+    .add_property("n_generated", &Dethinner::GetNGenerated)
+    .def("reset", &Dethinner::Reset)
+    ;
+}
@@ -0,0 +1,106 @@
+#include <boost/python.hpp>
+#include <corsika/GaisserHillasFitter.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <string>
+#include <vector>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  ProfileTable::Column column_from_name(const std::string& name)
+  {
+    ProfileTable::Column c = ProfileTable::ColumnFromName(name);
+    if (c == ProfileTable::eNColumns) {
+      PyErr_SetString(PyExc_KeyError, ("Unknown column: " + name).c_str());
+      throw_error_already_set();
+    }
+    return c;
+  }
+
+  list to_list(const std::vector<GaisserHillasParameter>& v)
+  {
+    list out;
+    for (size_t i = 0; i != v.size(); ++i)
+      out.append(v[i]);
+    return out;
+  }
+
+  GaisserHillasParameter fit(const GaisserHillasFitter& f, object depth, object values)
+  {
+    const std::vector<double> d = numpy_helpers::to_vector<double>(depth);
+    const std::vector<double> v = numpy_helpers::to_vector<double>(values);
+    ReleaseGIL nogil;
+    return f.Fit(d, v);
+  }
+
+  GaisserHillasParameter fit_profile(const GaisserHillasFitter& f, const LongProfile& profile, const std::string& name)
+  {
+    return f.Fit(profile, column_from_name(name));
+  }
+
+  list fit_profiles(const GaisserHillasFitter& f, object profiles, const std::string& name, size_t nThreads)
+  {
+    const ProfileTable::Column c = column_from_name(name);
+    std::vector<LongProfile> v;
+    for (long i = 0; i != len(profiles); ++i)
+      v.push_back(extract<const LongProfile&>(profiles[i]));
+    std::vector<GaisserHillasParameter> out;
+    {
+      ReleaseGIL nogil;
+      out = f.Fit(v, c, nThreads);
+    }
+    return to_list(out);
+  }
+
+  list fit_cache(const GaisserHillasFitter& f, const LongCache& cache, const std::string& name, size_t nThreads)
+  {
+    const ProfileTable::Column c = column_from_name(name);
+    std::vector<GaisserHillasParameter> out;
+    {
+      ReleaseGIL nogil;
+      out = f.Fit(cache, c, nThreads);
+    }
+    return to_list(out);
+  }
+
+  void set_min_depth(GaisserHillasFitter& f, double depth) { f.SetDepthRange(depth, f.GetMaxDepth()); }
+  void set_max_depth(GaisserHillasFitter& f, double depth) { f.SetDepthRange(f.GetMinDepth(), depth); }
+}
+
+void register_GaisserHillasFitter()
+{
+  class_<GaisserHillasFitter> fitter("GaisserHillasFitter",
+    "Levenberg-Marquardt fits of Gaisser-Hillas functions to profiles (depths in g/cm2, results in corsika units).\n"
+    "Columns are named as in LongCache (charge, muon, dEdX...).",
+    no_init);
+  {
+    scope in_fitter = fitter;
+    enum_<GaisserHillasFitter::Form>("Form")
+      .value("four_parameters", GaisserHillasFitter::eFourParameters)
+      .value("six_parameters", GaisserHillasFitter::eSixParameters)
+      ;
+    enum_<GaisserHillasFitter::Errors>("Errors")
+      .value("poisson", GaisserHillasFitter::ePoisson)
+      .value("uniform", GaisserHillasFitter::eUniform)
+      ;
+  }
+  fitter
+    .def(init<GaisserHillasFitter::Form, GaisserHillasFitter::Errors>(
+           (arg("form")=GaisserHillasFitter::eFourParameters, arg("errors")=GaisserHillasFitter::ePoisson)))
+    .add_property("form", &GaisserHillasFitter::GetForm)
+    .add_property("errors", &GaisserHillasFitter::GetErrors)
+    .add_property("min_depth", &GaisserHillasFitter::GetMinDepth, set_min_depth)
+    .add_property("max_depth", &GaisserHillasFitter::GetMaxDepth, set_max_depth)
+    .add_property("min_fraction", &GaisserHillasFitter::GetMinFraction, &GaisserHillasFitter::SetMinFraction)
+    .add_property("max_iterations", &GaisserHillasFitter::GetMaxIterations, &GaisserHillasFitter::SetMaxIterations)
+    .def("fit", fit, (arg("depth"), arg("values")), "Fit one profile")
+    .def("fit_profile", fit_profile, (arg("profile"), arg("column")="charge"), "Fit a column of a LongProfile")
+    .def("fit_profiles", fit_profiles, (arg("profiles"), arg("column")="charge", arg("n_threads")=1),
+         "Fit a column of a list of LongProfile, returns a list of GaisserHillasParameter")
+    .def("fit_cache", fit_cache, (arg("cache"), arg("column")="charge", arg("n_threads")=1),
+         "Fit a column of every profile in a LongCache")
+    ;
+}
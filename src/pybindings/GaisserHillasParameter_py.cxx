@@ -1,9 +1,83 @@
 #include <boost/python.hpp>
 #include <corsika/GaisserHillasParameter.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace boost::python;
 using namespace corsika;
 
+namespace
+{
+  std::string dump(const GaisserHillasParameter& gh)
+  {
+    std::ostringstream out;
+    gh.Dump(out);
+    return out.str();
+  }
+
+  double eval_depth(const GaisserHillasParameter& gh, double depth)
+  {
+    return gh.Eval(depth);
+  }
+
+  object eval_array(const GaisserHillasParameter& gh, object depths)
+  {
+    const std::vector<double> d = numpy_helpers::to_vector<double>(depths);
+    std::vector<double> out(d.size());
+    {
+      ReleaseGIL nogil;
+      gh.Eval(d.data(), out.data(), d.size());
+    }
+    return numpy_helpers::from_vector(out);
+  }
+
+  object eval_many(object showers, object depths, size_t nThreads)
+  {
+    std::vector<GaisserHillasParameter> v;
+    for (long i = 0; i != len(showers); ++i)
+      v.push_back(extract<const GaisserHillasParameter&>(showers[i]));
+    const std::vector<double> d = numpy_helpers::to_vector<double>(depths);
+    std::vector<double> out(v.size()*d.size());
+    {
+      ReleaseGIL nogil;
+      GaisserHillasParameter::Eval(v, d.data(), d.size(), out.data(), nThreads);
+    }
+    return numpy_helpers::from_vector(out).attr("reshape")(make_tuple(v.size(), d.size()));
+  }
+}
+
 void register_GaisserHillasParameter()
 {
+  class_<GaisserHillasParameter>("GaisserHillasParameter",
+    "Gaisser-Hillas function with six parameters, lambda = a + b X + c X^2 (depths in corsika units)")
+    .add_property("xmax", &GaisserHillasParameter::GetXMax)
+    .add_property("xmax_error", &GaisserHillasParameter::GetXMaxError)
+    .add_property("nmax", &GaisserHillasParameter::GetNMax)
+    .add_property("nmax_error", &GaisserHillasParameter::GetNMaxError)
+    .add_property("nmax_xmax_correlation", &GaisserHillasParameter::GetNMaxXMaxCorrelation)
+    .add_property("x0", &GaisserHillasParameter::GetXZero)
+    .add_property("x0_error", &GaisserHillasParameter::GetXZeroError)
+    .add_property("a", &GaisserHillasParameter::GetA)
+    .add_property("a_error", &GaisserHillasParameter::GetAError)
+    .add_property("b", &GaisserHillasParameter::GetB)
+    .add_property("b_error", &GaisserHillasParameter::GetBError)
+    .add_property("c", &GaisserHillasParameter::GetC)
+    .add_property("c_error", &GaisserHillasParameter::GetCError)
+    .add_property("chi2", &GaisserHillasParameter::GetChiSquare)
+    .add_property("ndof", &GaisserHillasParameter::GetNdof)
+    .add_property("is_de_dx", &GaisserHillasParameter::IsdEdXProfile)
+    .def("__call__", eval_depth, arg("depth"))
+    .def("eval", eval_array, arg("depths"),
+         "The function at many depths, as an array")
+    .def("eval_many", eval_many, (arg("showers"), arg("depths"), arg("n_threads")=1),
+         "Many functions at the same depths, as an array with one row per function "
+         "(n_threads=0 uses every hardware thread)")
+    .staticmethod("eval_many")
+    .def("integral", &GaisserHillasParameter::GetIntegral)
+    .def("integral_error", &GaisserHillasParameter::GetIntegralError)
+    .def("__str__", dump)
+    ;
 }
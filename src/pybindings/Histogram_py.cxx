@@ -0,0 +1,167 @@
+#include <boost/python.hpp>
+#include <corsika/Histogram.h>
+#include <corsika/Shower.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <stdexcept>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  ParticleBatch::Column column_from_name(const std::string& name)
+  {
+    ParticleBatch::Column c = ParticleBatch::ColumnFromName(name);
+    if (c == ParticleBatch::eNColumns)
+      throw std::invalid_argument("Unknown particle column '" + name + "'");
+    return c;
+  }
+
+  std::vector<double> to_vector(object values)
+  {
+    std::vector<double> v;
+    for (ssize_t i = 0; i != len(values); ++i)
+      v.push_back(extract<double>(values[i]));
+    return v;
+  }
+}
+
+boost::shared_ptr<HistogramAxis> make_uniform_axis(const std::string& column, size_t n, double min, double max, HistogramAxis::Scale scale)
+{
+  return boost::shared_ptr<HistogramAxis>(new HistogramAxis(column_from_name(column), n, min, max, scale));
+}
+
+boost::shared_ptr<HistogramAxis> make_linear_axis(const std::string& column, size_t n, double min, double max)
+{
+  return make_uniform_axis(column, n, min, max, HistogramAxis::eLinear);
+}
+
+boost::shared_ptr<HistogramAxis> make_edges_axis(const std::string& column, object edges, HistogramAxis::Scale scale)
+{
+  return boost::shared_ptr<HistogramAxis>(new HistogramAxis(column_from_name(column), to_vector(edges), scale));
+}
+
+boost::shared_ptr<HistogramAxis> make_edges_axis_default(const std::string& column, object edges)
+{
+  return make_edges_axis(column, edges, HistogramAxis::eEdges);
+}
+
+std::string axis_column(const HistogramAxis& axis)
+{ return ParticleBatch::ColumnName(axis.GetColumn()); }
+
+object axis_edges(const HistogramAxis& axis)
+{ return numpy_helpers::from_vector(axis.GetEdges()); }
+
+object shaped(const Histogram& h, const std::vector<double>& values)
+{
+  list shape;
+  for (size_t a = 0; a != h.GetNDimensions(); ++a)
+    shape.append(h.GetAxis(a).GetNBins());
+  return numpy_helpers::from_vector(values).attr("reshape")(tuple(shape));
+}
+
+object histogram_contents(const Histogram& h) { return shaped(h, h.GetContents()); }
+object histogram_sumw2(const Histogram& h) { return shaped(h, h.GetSumW2()); }
+
+list histogram_edges(const Histogram& h)
+{
+  list edges;
+  for (size_t a = 0; a != h.GetNDimensions(); ++a)
+    edges.append(axis_edges(h.GetAxis(a)));
+  return edges;
+}
+
+object histogram_selection(const Histogram& h)
+{
+  if (!h.HasSelection())
+    return object();
+  return object(h.GetSelection());
+}
+
+void set_histogram_selection(Histogram& h, object selection)
+{
+  if (selection.is_none())
+    h.ClearSelection();
+  else if (extract<std::string>(selection).check())
+    h.SetSelection(ParticleSelection(extract<std::string>(selection)()));
+  else
+    h.SetSelection(extract<const ParticleSelection&>(selection)());
+}
+
+void fill_batch(Histogram& h, const ParticleBatch& batch)
+{
+  ReleaseGIL nogil;
+  h.Fill(batch);
+}
+
+void fill_shower(Histogram& h, Shower& shower, size_t threads)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ReleaseGIL nogil;
+  h.Fill(stream, threads);
+}
+
+void fill_shower_default(Histogram& h, Shower& shower)
+{
+  fill_shower(h, shower, 1);
+}
+
+void fill_file(Histogram& h, const std::string& filename, size_t threads)
+{
+  ReleaseGIL nogil;
+  h.FillFile(filename, threads);
+}
+
+void fill_file_default(Histogram& h, const std::string& filename)
+{
+  fill_file(h, filename, 0);
+}
+
+void register_Histogram()
+{
+  {
+    scope in_axis =
+      class_<HistogramAxis>("HistogramAxis", no_init)
+      .def("__init__", make_constructor(make_linear_axis))
+      .def("__init__", make_constructor(make_uniform_axis))
+      .def("__init__", make_constructor(make_edges_axis_default))
+      .def("__init__", make_constructor(make_edges_axis))
+      .add_property("column", axis_column)
+      .add_property("scale", &HistogramAxis::GetScale)
+      .add_property("n_bins", &HistogramAxis::GetNBins)
+      .add_property("edges", axis_edges, "Bin edges, or the category values")
+      .def("find_bin", &HistogramAxis::FindBin)
+      ;
+
+    enum_<HistogramAxis::Scale>("Scale")
+      .value("eLinear", HistogramAxis::eLinear)
+      .value("eLog", HistogramAxis::eLog)
+      .value("eEdges", HistogramAxis::eEdges)
+      .value("eCategories", HistogramAxis::eCategories)
+      ;
+  }
+
+  class_<Histogram>("Histogram", init<const HistogramAxis&>())
+    .def(init<const HistogramAxis&, const HistogramAxis&>())
+    .def(init<const HistogramAxis&, const HistogramAxis&, const HistogramAxis&>())
+    .add_property("n_dimensions", &Histogram::GetNDimensions)
+    .def("axis", &Histogram::GetAxis, return_value_policy<copy_const_reference>())
+    .add_property("selection", histogram_selection, set_histogram_selection,
+                  "ParticleSelection (or expression string) applied when filling, None to count all particles")
+    .add_property("use_weights", &Histogram::GetUseWeights, &Histogram::SetUseWeights)
+    .def("fill", fill_batch, "Fill with the particles in a batch")
+    .def("fill", fill_shower_default, "Fill with the particles in a shower")
+    .def("fill", fill_shower, "Fill with the particles in a shower using several threads")
+    .def("fill_file", fill_file_default, "Fill with all showers in a file using one thread per CPU")
+    .def("fill_file", fill_file, "Fill with all showers in a file using the given number of threads")
+    .def("add", &Histogram::Add)
+    .def(self += self)
+    .def("reset", &Histogram::Reset)
+    .add_property("contents", histogram_contents, "Numpy array with the bin contents")
+    .add_property("sumw2", histogram_sumw2, "Numpy array with the sum of squared weights per bin")
+    .add_property("edges", histogram_edges, "List with the bin edges along each axis")
+    .add_property("entries", &Histogram::GetEntries)
+    .add_property("outside", &Histogram::GetOutside, "Sum of weights of the particles outside the axes")
+    ;
+}
@@ -0,0 +1,38 @@
+#include <boost/python.hpp>
+#include <corsika/Instrumentation.h>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  dict counters()
+  {
+    dict d;
+    for (int c = 0; c != Instrumentation::eNCounters; ++c)
+      d[Instrumentation::CounterName(Instrumentation::Counter(c))] = Instrumentation::Get(Instrumentation::Counter(c));
+    return d;
+  }
+
+  dict timers()
+  {
+    dict d;
+    for (int t = 0; t != Instrumentation::eNTimers; ++t)
+      d[Instrumentation::TimerName(Instrumentation::Timer(t))] = Instrumentation::Get(Instrumentation::Timer(t));
+    return d;
+  }
+}
+
+void register_Instrumentation()
+{
+  namespace bp = boost::python;
+  // corsika.instrumentation, like corsika.units
+  bp::object module(bp::handle<>(bp::borrowed(PyImport_AddModule("corsika.instrumentation"))));
+  bp::scope().attr("instrumentation") = module;
+  bp::scope module_scope = module;
+
+  def("counters", counters, "Counters of all threads since the last reset, by name");
+  def("timers", timers, "Seconds spent by all threads since the last reset, by name");
+  def("reset", Instrumentation::Reset, "Start counting from zero");
+  def("enabled", Instrumentation::IsEnabled, "False if the library was built with CORSIKA_INSTRUMENTATION=OFF");
+}
@@ -0,0 +1,145 @@
+#include <boost/python.hpp>
+#include <corsika/LateralDistribution.h>
+#include <corsika/Shower.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <stdexcept>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  // classes can be given by index or by name
+  size_t class_index(const LateralDistribution& ldf, object c)
+  {
+    extract<std::string> name(c);
+    if (name.check()) {
+      size_t i = ldf.FindClass(name());
+      if (i == ldf.GetNClasses())
+        throw std::invalid_argument("No particle class named '" + name() + "'");
+      return i;
+    }
+    size_t i = extract<size_t>(c);
+    if (i >= ldf.GetNClasses())
+      throw std::invalid_argument("Particle class index out of range");
+    return i;
+  }
+
+  template <class F>
+  object per_bin(const LateralDistribution& ldf, object c, F f)
+  {
+    const size_t i = class_index(ldf, c);
+    std::vector<double> values(ldf.GetNBins());
+    for (size_t bin = 0; bin != values.size(); ++bin)
+      values[bin] = f(i, bin);
+    return numpy_helpers::from_vector(values);
+  }
+}
+
+object ldf_density(const LateralDistribution& ldf, object c)
+{ return per_bin(ldf, c, [&](size_t i, size_t bin) { return ldf.GetDensity(i, bin); }); }
+
+object ldf_density_error(const LateralDistribution& ldf, object c)
+{ return per_bin(ldf, c, [&](size_t i, size_t bin) { return ldf.GetDensityError(i, bin); }); }
+
+object ldf_weight(const LateralDistribution& ldf, object c)
+{ return per_bin(ldf, c, [&](size_t i, size_t bin) { return ldf.GetWeight(i, bin); }); }
+
+object ldf_entries(const LateralDistribution& ldf, object c)
+{ return per_bin(ldf, c, [&](size_t i, size_t bin) { return double(ldf.GetEntries(i, bin)); }); }
+
+object ldf_time_quantile(const LateralDistribution& ldf, object c, double q)
+{ return per_bin(ldf, c, [&](size_t i, size_t bin) { return ldf.GetTimeQuantile(i, bin, q); }); }
+
+object ldf_area(const LateralDistribution& ldf)
+{
+  std::vector<double> area(ldf.GetNBins());
+  for (size_t bin = 0; bin != area.size(); ++bin)
+    area[bin] = ldf.GetArea(bin);
+  return numpy_helpers::from_vector(area);
+}
+
+object ldf_edges(const LateralDistribution& ldf)
+{ return numpy_helpers::from_vector(ldf.GetRadiusAxis().GetEdges()); }
+
+list ldf_classes(const LateralDistribution& ldf)
+{
+  list names;
+  for (size_t c = 0; c != ldf.GetNClasses(); ++c)
+    names.append(ldf.GetClassName(c));
+  return names;
+}
+
+size_t ldf_add_class(LateralDistribution& ldf, const std::string& name, const std::string& selection)
+{ return ldf.AddClass(name, ParticleSelection(selection)); }
+
+const QuantileSketch& ldf_times(const LateralDistribution& ldf, object c, size_t bin)
+{ return ldf.GetTimes(class_index(ldf, c), bin); }
+
+void ldf_fill_shower(LateralDistribution& ldf, const Shower& shower)
+{
+  ReleaseGIL nogil;
+  ldf.Fill(shower);
+}
+
+void ldf_fill_batch(LateralDistribution& ldf, const ParticleBatch& batch)
+{
+  ReleaseGIL nogil;
+  ldf.Fill(batch);
+}
+
+void ldf_set_geometry(LateralDistribution& ldf, double zenith, double azimuth)
+{ ldf.SetGeometry(zenith, azimuth); }
+
+list ldf_fill_file(const LateralDistribution& prototype, const std::string& filename, size_t threads)
+{
+  std::vector<LateralDistribution> result;
+  {
+    ReleaseGIL nogil;
+    result = LateralDistribution::FillFile(prototype, filename, threads);
+  }
+  list l;
+  for (size_t i = 0; i != result.size(); ++i)
+    l.append(result[i]);
+  return l;
+}
+
+list ldf_fill_file_default(const LateralDistribution& prototype, const std::string& filename)
+{ return ldf_fill_file(prototype, filename, 0); }
+
+void register_LateralDistribution()
+{
+  scope in_ldf =
+    class_<LateralDistribution>("LateralDistribution", init<const HistogramAxis&, optional<LateralDistribution::Plane, double> >())
+    .def("add_class", ldf_add_class, "Add a particle class given by a selection expression. Returns its index.")
+    .def("add_class", &LateralDistribution::AddClass)
+    .def("add_default_classes", &LateralDistribution::AddDefaultClasses)
+    .add_property("classes", ldf_classes)
+    .add_property("plane", &LateralDistribution::GetPlane)
+    .add_property("zenith", &LateralDistribution::GetZenith)
+    .add_property("azimuth", &LateralDistribution::GetAzimuth)
+    .add_property("shower_number", &LateralDistribution::GetShowerNumber)
+    .def("set_geometry", ldf_set_geometry, "Zenith and azimuth (in the frame of the particle coordinates)")
+    .def("fill", ldf_fill_batch)
+    .def("fill", ldf_fill_shower)
+    .def("fill_file", ldf_fill_file_default, "List of distributions, one per shower in a file, filled in parallel")
+    .def("fill_file", ldf_fill_file)
+    .staticmethod("fill_file")
+    .def("add", &LateralDistribution::Add)
+    .def("reset", &LateralDistribution::Reset)
+    .add_property("edges", ldf_edges, "Radius bin edges")
+    .add_property("area", ldf_area, "Area of each radius bin")
+    .def("density", ldf_density, "Weight per unit area in each radius bin for a class (name or index)")
+    .def("density_error", ldf_density_error)
+    .def("weight", ldf_weight)
+    .def("entries", ldf_entries)
+    .def("time_quantile", ldf_time_quantile, "Arrival-time quantile in each radius bin for a class")
+    .def("times", ldf_times, return_internal_reference<>())
+    ;
+
+  enum_<LateralDistribution::Plane>("Plane")
+    .value("eGround", LateralDistribution::eGround)
+    .value("eShowerPlane", LateralDistribution::eShowerPlane)
+    ;
+}
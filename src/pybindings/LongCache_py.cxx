@@ -0,0 +1,112 @@
+#include <boost/python.hpp>
+#include <corsika/LongCache.h>
+#include "numpy_helpers.h"
+#include <string>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  typedef boost::shared_ptr<LongCache> LongCachePtr;
+
+  /*
+    A column exposed through __array_interface__, keeping the mapped
+    file alive as the base of the numpy array (no copy).
+   */
+  struct LongCacheBuffer
+  {
+    LongCachePtr cache;
+    ColumnSpan<double> span;
+
+    dict array_interface() const
+    {
+      dict d;
+      d["version"] = 3;
+      d["shape"] = make_tuple(span.size());
+      d["typestr"] = "<f8";
+      d["data"] = make_tuple(size_t(span.data()), true); // read-only
+      return d;
+    }
+  };
+
+  size_t check_event(const LongCache& cache, size_t event)
+  {
+    if (event >= cache.size()) {
+      PyErr_SetString(PyExc_IndexError, "Event out of range.");
+      throw_error_already_set();
+    }
+    return event;
+  }
+
+  object column(LongCachePtr cache, size_t event, const std::string& name)
+  {
+    LongCache::Column c = LongCache::ColumnFromName(name);
+    if (c == LongCache::eNColumns) {
+      PyErr_SetString(PyExc_KeyError, ("Unknown column: " + name).c_str());
+      throw_error_already_set();
+    }
+    LongCacheBuffer buffer = { cache, cache->GetColumn(check_event(*cache, event), c) };
+    return numpy_helpers::numpy().attr("asarray")(buffer);
+  }
+
+  object scalars(LongCachePtr cache, const std::string& name)
+  {
+    LongCache::Scalar s = LongCache::ScalarFromName(name);
+    if (s == LongCache::eNScalars) {
+      PyErr_SetString(PyExc_KeyError, ("Unknown quantity: " + name).c_str());
+      throw_error_already_set();
+    }
+    LongCacheBuffer buffer = { cache, cache->GetScalars(s) };
+    return numpy_helpers::numpy().attr("asarray")(buffer);
+  }
+
+  LongProfile get_profile(const LongCache& cache, size_t event)
+  {
+    return cache.GetProfile(check_event(cache, event));
+  }
+
+  list names(int n, std::string (*name)(int))
+  {
+    list l;
+    for (int i = 0; i != n; ++i)
+      l.append(name(i));
+    return l;
+  }
+
+  std::string column_name(int i) { return LongCache::ColumnName(LongCache::Column(i)); }
+  std::string scalar_name(int i) { return LongCache::ScalarName(LongCache::Scalar(i)); }
+  list column_names() { return names(LongCache::eNColumns, column_name); }
+  list scalar_names() { return names(LongCache::eNScalars, scalar_name); }
+}
+
+void register_LongCache()
+{
+  class_<LongCacheBuffer>("_LongCacheBuffer", no_init)
+    .add_property("__array_interface__", &LongCacheBuffer::array_interface)
+    ;
+
+  class_<LongCache, LongCachePtr, boost::noncopyable>("LongCache",
+    "Profiles of a .long file, memory-mapped from a cache written by LongCache.convert.\n"
+    "Columns and scalars are read-only numpy views of the file.",
+    init<std::string>())
+    .add_property("filename", make_function(&LongCache::GetFilename, return_value_policy<copy_const_reference>()))
+    .add_property("size", &LongCache::size)
+    .add_property("dx", &LongCache::Dx)
+    .add_property("has_particle_profile", &LongCache::HasParticleProfile)
+    .add_property("has_energy_deposit", &LongCache::HasEnergyDeposit)
+    .add_property("is_slant_depth", &LongCache::IsSlantDepth)
+    .add_property("zenith", &LongCache::GetZenith)
+    .def("__len__", &LongCache::size)
+    .def("get_profile", get_profile)
+    .def("column", column, (arg("event"), arg("name")), "Profile column of a shower as a read-only numpy array (no copy)")
+    .def("scalars", scalars, (arg("name")), "A quantity (like xmax) of all showers as a read-only numpy array (no copy)")
+    .def("convert", &LongCache::Convert, (arg("long_file"), arg("cache_file"), arg("zenith")=0.),
+         "Write all profiles of a .long file into a cache file. Returns the number of showers.")
+    .staticmethod("convert")
+    .def("column_names", column_names)
+    .staticmethod("column_names")
+    .def("scalar_names", scalar_names)
+    .staticmethod("scalar_names")
+    ;
+}
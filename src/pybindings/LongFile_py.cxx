@@ -7,6 +7,9 @@ using namespace corsika;
 
 void register_LongFile()
 {
+  LongProfile (LongFile::*get_profile)(size_t) const = &LongFile::GetProfile;
+  LongProfile (LongFile::*get_profile_zenith)(size_t, double) const = &LongFile::GetProfile;
+
   class_<LongFile>("LongFile", no_init)
     .def(init<const std::string&>())
     .def(init<const std::string&, float>())
@@ -15,6 +18,8 @@ void register_LongFile()
     .add_property("has_particle_profile", &LongFile::HasParticleProfile)
     .add_property("has_energy_deposit", &LongFile::HasEnergyDeposit)
     .add_property("is_slant_depth", &LongFile::IsSlantDepth)
-    .def("get_profile", &LongFile::GetProfile)
+    .def("get_profile", get_profile)
+    .def("get_profile", get_profile_zenith, (arg("event"), arg("zenith")),
+         "Profile with the depths of another zenith angle than the one of the file")
     ;
 }
@@ -0,0 +1,24 @@
+#include <boost/python.hpp>
+#include <corsika/LongLoader.h>
+#include <string>
+
+using namespace boost::python;
+using namespace corsika;
+
+void register_LongLoader()
+{
+  class_<LongLoader, boost::noncopyable>("LongLoader",
+    "Profiles of a .long file, parsed once and given with the depths of any zenith angle",
+    init<std::string>())
+    .add_property("filename", make_function(&LongLoader::GetFilename, return_value_policy<copy_const_reference>()))
+    .add_property("size", &LongLoader::size)
+    .add_property("has_particle_profile", &LongLoader::HasParticleProfile)
+    .add_property("has_energy_deposit", &LongLoader::HasEnergyDeposit)
+    .add_property("is_slant_depth", &LongLoader::IsSlantDepth)
+    .add_property("n_cached", &LongLoader::GetNCached)
+    .def("__len__", &LongLoader::size)
+    .def("dx", &LongLoader::Dx, (arg("zenith")=0.))
+    .def("get_profile", &LongLoader::GetProfile, (arg("event"), arg("zenith")=0.))
+    .def("clear_cache", &LongLoader::ClearCache)
+    ;
+}
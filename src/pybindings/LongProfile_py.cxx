@@ -1,30 +1,26 @@
 #include <boost/python.hpp>
 #include <corsika/LongProfile.h>
+#include "numpy_helpers.h"
 #include <string>
 
 using namespace boost::python;
 using namespace corsika;
 
-object
-expose_vector_as_array(LongProfile& self, std::vector<double> LongProfile::*member) {
-  object numpy = import("numpy");
-  object asarray = numpy.attr("asarray");
-  return asarray(object(self.*member));
-}
-object
-expose_vector_as_array(LongProfile& self, std::vector<double> member) {
-  object numpy = import("numpy");
-  object asarray = numpy.attr("asarray");
-  return asarray(object(member));
+object column(LongProfile& self, ProfileTable::Column c)
+{
+  const ColumnSpan<double> values = self.fProfiles.GetColumn(c);
+  return numpy_helpers::from_pointer(values.data(), values.size());
 }
 
-//object depth_de(LongProfile& self) { return expose_vector_as_array(self, self.fDepth_dE); }
-//object de_dx(LongProfile& self) { return expose_vector_as_array(self, self.fdEdX); }
-object depth(LongProfile& self) { return expose_vector_as_array(self, self.fDepth); }
-object charge_profile(LongProfile& self) { return expose_vector_as_array(self, self.fChargeProfile); }
-object gamma_profile(LongProfile& self) { return expose_vector_as_array(self, self.fGammaProfile); }
-object electron_profile(LongProfile& self) { return expose_vector_as_array(self, self.fElectronProfile); }
-object muon_profile(LongProfile& self) { return expose_vector_as_array(self, self.fMuonProfile); }
+object depth_de(LongProfile& self) { return column(self, ProfileTable::eDepth_dE); }
+object de_dx(LongProfile& self) { return column(self, ProfileTable::edEdX); }
+object depth(LongProfile& self) { return column(self, ProfileTable::eDepth); }
+object charge_profile(LongProfile& self) { return column(self, ProfileTable::eCharge); }
+object gamma_profile(LongProfile& self) { return column(self, ProfileTable::eGamma); }
+object electron_profile(LongProfile& self) { return column(self, ProfileTable::eElectron); }
+object muon_profile(LongProfile& self) { return column(self, ProfileTable::eMuon); }
+
+GaisserHillasParameter gaisser_hillas(LongProfile& self) { return self.fGaisserHillas; }
 
 void register_LongProfile()
 {
@@ -34,6 +30,9 @@ void register_LongProfile()
     .add_property("electron", electron_profile)
     .add_property("muon", muon_profile)
     .add_property("depth", depth)
+    .add_property("de_dx", de_dx)
+    .add_property("depth_de_dx", depth_de)
     .add_property("calorimetric_energy", &LongProfile::fCalorimetricEnergy)
+    .add_property("gaisser_hillas", gaisser_hillas)
     ;
 }
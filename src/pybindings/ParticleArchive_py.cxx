@@ -0,0 +1,57 @@
+#include <boost/python.hpp>
+#include <corsika/ParticleArchive.h>
+#include <string>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  Shower& get_shower(ParticleArchive& a, int i)
+  {
+    if (a.FindEvent(i) != eSuccess) {
+      PyErr_SetString(PyExc_IndexError, "No such event in the archive.");
+      throw_error_already_set();
+    }
+    return a.GetCurrentShower();
+  }
+
+  size_t convert(const std::string& corsikaFile, const std::string& archive, const ArchiveOptions& options)
+  {
+    return ParticleArchiveWriter::Convert(corsikaFile, archive, options);
+  }
+}
+
+void register_ParticleArchive()
+{
+  class_<ArchiveOptions>("ArchiveOptions",
+                         "Precision of a particle archive: positions (cm), times (ns), log(momentum), direction cosines")
+    .def_readwrite("position", &ArchiveOptions::fPosition)
+    .def_readwrite("time", &ArchiveOptions::fTime)
+    .def_readwrite("log_momentum", &ArchiveOptions::fLogMomentum)
+    .def_readwrite("direction", &ArchiveOptions::fDirection)
+    .def_readwrite("chunk_size", &ArchiveOptions::fChunkSize)
+    .def_readwrite("compression_level", &ArchiveOptions::fCompressionLevel)
+    ;
+
+  Shower& (ParticleArchive::*get_current)() = &ParticleArchive::GetCurrentShower;
+
+  class_<ParticleArchive, boost::noncopyable>("ParticleArchive",
+                                              "Compact quantized archive of a CORSIKA file, read like a ShowerFile")
+    .def(init<const std::string&>())
+    .def("open", &ParticleArchive::Open)
+    .def("close", &ParticleArchive::Close)
+    .def("find_event", &ParticleArchive::FindEvent)
+    .add_property("run_header", make_function(&ParticleArchive::GetRunHeader, return_internal_reference<>()))
+    .add_property("n_events", &ParticleArchive::GetNEvents)
+    .add_property("is_thinned", &ParticleArchive::IsThinned)
+    .add_property("options", make_function(&ParticleArchive::GetOptions, return_internal_reference<>()))
+    .add_property("current_shower", make_function(get_current, return_internal_reference<>()))
+    .def("shower", get_shower, return_internal_reference<>())
+    .def("convert", convert, (arg("corsika_file"), arg("archive"), arg("options")=ArchiveOptions()),
+         "Archive a CORSIKA file. Returns the number of particle records.")
+    .staticmethod("convert")
+    .def("is_valid", &ParticleArchive::IsValid)
+    .staticmethod("is_valid")
+    ;
+}
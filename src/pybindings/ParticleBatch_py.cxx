@@ -0,0 +1,79 @@
+#include <boost/python.hpp>
+#include <corsika/ParticleBatch.h>
+#include "numpy_helpers.h"
+#include <stdint.h>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  struct PackedParticle
+  {
+    float x, y, t, px, py, pz, ekin, weight;
+    int32_t pdg;
+    int16_t corsika_code, level, generation;
+  } __attribute__((packed));
+
+  object particle_dtype()
+  {
+    list fields;
+    fields.append(make_tuple("x", "<f4"));
+    fields.append(make_tuple("y", "<f4"));
+    fields.append(make_tuple("t", "<f4"));
+    fields.append(make_tuple("px", "<f4"));
+    fields.append(make_tuple("py", "<f4"));
+    fields.append(make_tuple("pz", "<f4"));
+    fields.append(make_tuple("ekin", "<f4"));
+    fields.append(make_tuple("weight", "<f4"));
+    fields.append(make_tuple("pdg", "<i4"));
+    fields.append(make_tuple("corsika_code", "<i2"));
+    fields.append(make_tuple("level", "<i2"));
+    fields.append(make_tuple("generation", "<i2"));
+    return numpy_helpers::numpy().attr("dtype")(fields);
+  }
+}
+
+// Structured numpy array with one row per particle. Also used by the selection bindings.
+object batch_to_array(const ParticleBatch& batch)
+{
+  std::vector<PackedParticle> rows(batch.size());
+  for (size_t i = 0; i != rows.size(); ++i) {
+    PackedParticle& r = rows[i];
+    r.x = batch.fX[i];
+    r.y = batch.fY[i];
+    r.t = batch.fT[i];
+    r.px = batch.fPx[i];
+    r.py = batch.fPy[i];
+    r.pz = batch.fPz[i];
+    r.ekin = batch.fKineticEnergy[i];
+    r.weight = batch.fWeight[i];
+    r.pdg = batch.fPDG[i];
+    r.corsika_code = batch.fCorsikaCode[i];
+    r.level = batch.fLevel[i];
+    r.generation = batch.fGeneration[i];
+  }
+  return numpy_helpers::from_buffer(rows.data(), rows.size(), particle_dtype());
+}
+
+object batch_column(const ParticleBatch& batch, const std::string& name)
+{
+  ParticleBatch::Column c = ParticleBatch::ColumnFromName(name);
+  if (c == ParticleBatch::eNColumns) {
+    PyErr_SetString(PyExc_KeyError, name.c_str());
+    throw_error_already_set();
+  }
+  std::vector<double> values(batch.size());
+  batch.GetColumn(c, values.data());
+  return numpy_helpers::from_vector(values);
+}
+
+void register_ParticleBatch()
+{
+  class_<ParticleBatch>("ParticleBatch")
+    .def("__len__", &ParticleBatch::size)
+    .def("__getitem__", batch_column)
+    .def("clear", &ParticleBatch::clear)
+    .add_property("array", batch_to_array, "The batch as a numpy structured array")
+    ;
+}
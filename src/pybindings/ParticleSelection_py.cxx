@@ -0,0 +1,76 @@
+#include <boost/python.hpp>
+#include <corsika/ParticleSelection.h>
+#include <corsika/Shower.h>
+#include "numpy_helpers.h"
+
+using namespace boost::python;
+using namespace corsika;
+
+object batch_to_array(const ParticleBatch& batch);
+
+/*
+  These iterate over all the particles in the shower, one batch at a time.
+  They are also used by the Shower bindings (select, count and mask methods).
+ */
+object select_particles(const ParticleSelection& selection, Shower& shower)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ParticleBatch selected;
+  ParticleBatch batch;
+  while (stream.NextBatch(batch)) {
+    selection.Select(batch);
+    selected.Append(batch);
+  }
+  return batch_to_array(selected);
+}
+
+size_t count_particles(const ParticleSelection& selection, Shower& shower)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ParticleBatch batch;
+  size_t count = 0;
+  while (stream.NextBatch(batch))
+    count += selection.Count(batch);
+  return count;
+}
+
+object mask_particles(const ParticleSelection& selection, Shower& shower)
+{
+  ShowerParticleStream& stream = shower.ParticleStream();
+  ParticleBatch batch;
+  std::vector<char> mask;
+  std::vector<char> all;
+  while (stream.NextBatch(batch)) {
+    selection.Evaluate(batch, mask);
+    all.insert(all.end(), mask.begin(), mask.end());
+  }
+  return numpy_helpers::from_vector(all);
+}
+
+object select_batch(const ParticleSelection& selection, const ParticleBatch& batch)
+{
+  ParticleBatch selected(batch);
+  selection.Select(selected);
+  return batch_to_array(selected);
+}
+
+object mask_batch(const ParticleSelection& selection, const ParticleBatch& batch)
+{
+  std::vector<char> mask;
+  selection.Evaluate(batch, mask);
+  return numpy_helpers::from_vector(mask);
+}
+
+void register_ParticleSelection()
+{
+  class_<ParticleSelection>("ParticleSelection", init<std::string>())
+    .add_property("expression", make_function(&ParticleSelection::GetExpression, return_value_policy<copy_const_reference>()))
+    .def("select", select_particles, "Numpy structured array with the selected particles in the shower")
+    .def("select", select_batch, "Numpy structured array with the selected particles in the batch")
+    .def("count", count_particles, "Number of selected particles in the shower")
+    .def("count", &ParticleSelection::Count, "Number of selected particles in the batch")
+    .def("mask", mask_particles, "Boolean numpy array, true for each selected particle in the shower")
+    .def("mask", mask_batch, "Boolean numpy array, true for each selected particle in the batch")
+    .def("__call__", &ParticleSelection::operator())
+    ;
+}
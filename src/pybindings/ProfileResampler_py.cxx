@@ -0,0 +1,95 @@
+#include <boost/python.hpp>
+#include <corsika/ProfileResampler.h>
+#include "numpy_helpers.h"
+#include "gil_helpers.h"
+#include <string>
+#include <vector>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  ProfileResampler* make_resampler(object grid, ProfileResampler::Interpolation mode)
+  {
+    return new ProfileResampler(numpy_helpers::to_vector<double>(grid), mode);
+  }
+
+  LongCache::Column column_from_name(const std::string& name)
+  {
+    LongCache::Column c = LongCache::ColumnFromName(name);
+    if (c == LongCache::eNColumns) {
+      PyErr_SetString(PyExc_KeyError, ("Unknown column: " + name).c_str());
+      throw_error_already_set();
+    }
+    return c;
+  }
+
+  // rows of a row-major matrix as a 2D array
+  object matrix(const std::vector<double>& values, size_t nRows, size_t nColumns)
+  {
+    return numpy_helpers::from_vector(values).attr("reshape")(make_tuple(nRows, nColumns));
+  }
+
+  object resample(const ProfileResampler& r, object depth, object values)
+  {
+    return numpy_helpers::from_vector(r.Resample(numpy_helpers::to_vector<double>(depth),
+                                                 numpy_helpers::to_vector<double>(values)));
+  }
+
+  object resample_profiles(const ProfileResampler& r, object profiles, const std::string& name, size_t nThreads)
+  {
+    const LongCache::Column c = column_from_name(name);
+    std::vector<LongProfile> v;
+    for (long i = 0; i != len(profiles); ++i)
+      v.push_back(extract<const LongProfile&>(profiles[i]));
+    std::vector<double> out;
+    {
+      ReleaseGIL nogil;
+      out = r.Resample(v, c, nThreads);
+    }
+    return matrix(out, v.size(), r.GetGrid().size());
+  }
+
+  object resample_cache(const ProfileResampler& r, const LongCache& cache, const std::string& name, size_t nThreads)
+  {
+    const LongCache::Column c = column_from_name(name);
+    std::vector<double> out;
+    {
+      ReleaseGIL nogil;
+      out = r.Resample(cache, c, nThreads);
+    }
+    return matrix(out, cache.size(), r.GetGrid().size());
+  }
+
+  object grid(const ProfileResampler& r)
+  {
+    return numpy_helpers::from_vector(r.GetGrid());
+  }
+}
+
+void register_ProfileResampler()
+{
+  class_<ProfileResampler> resampler("ProfileResampler",
+    "Interpolate many longitudinal profiles onto the same depth grid (zero outside each profile).\n"
+    "Columns are named as in LongCache (charge, muon, dEdX...).",
+    no_init);
+  {
+    scope in_resampler = resampler;
+    enum_<ProfileResampler::Interpolation>("Interpolation")
+      .value("linear", ProfileResampler::eLinear)
+      .value("log", ProfileResampler::eLog)
+      ;
+  }
+  resampler
+    .def("__init__", make_constructor(make_resampler, default_call_policies(),
+                                      (arg("grid"), arg("interpolation")=ProfileResampler::eLinear)))
+    .add_property("grid", grid)
+    .add_property("interpolation", &ProfileResampler::GetInterpolation)
+    .def("resample", resample, (arg("depth"), arg("values")), "Resample one profile")
+    .def("resample_profiles", resample_profiles, (arg("profiles"), arg("column"), arg("n_threads")=1),
+         "Resample a column of a list of LongProfile, one row per profile")
+    .def("resample_cache", resample_cache, (arg("cache"), arg("column"), arg("n_threads")=1),
+         "Resample a column of every profile in a LongCache, one row per profile")
+    ;
+}
@@ -0,0 +1,27 @@
+#include <boost/python.hpp>
+#include <corsika/QuantileSketch.h>
+
+using namespace boost::python;
+using namespace corsika;
+
+void add_value(QuantileSketch& sketch, double value)
+{
+  sketch.Add(value);
+}
+
+void register_QuantileSketch()
+{
+  class_<QuantileSketch>("QuantileSketch", init<optional<double, size_t> >())
+    .def("add", &QuantileSketch::Add)
+    .def("add", add_value)
+    .def("merge", &QuantileSketch::Merge)
+    .def("clear", &QuantileSketch::Clear)
+    .def("quantile", &QuantileSketch::GetQuantile)
+    .add_property("relative_accuracy", &QuantileSketch::GetRelativeAccuracy)
+    .add_property("count", &QuantileSketch::GetCount)
+    .add_property("total_weight", &QuantileSketch::GetTotalWeight)
+    .add_property("min", &QuantileSketch::GetMin)
+    .add_property("max", &QuantileSketch::GetMax)
+    .add_property("n_buckets", &QuantileSketch::GetNBuckets)
+    ;
+}
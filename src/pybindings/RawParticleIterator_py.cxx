@@ -24,6 +24,18 @@ public:
   {
     return this->get_override("IsValid")();
   }
+  bool AtBlockStart() const
+  {
+    return this->get_override("AtBlockStart")();
+  }
+  bool SkipBlock()
+  {
+    return this->get_override("SkipBlock")();
+  }
+  void SetEnd(size_t end)
+  {
+    this->get_override("SetEnd")(end);
+  }
 };
 
 inline object identity(object const& o) { return o; }
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <corsika/RawStream.h>
 #include <corsika/RawParticleStream.h>
+#include <corsika/RawStreamWriter.h>
+#include <corsika/Skim.h>
 
 using namespace boost::python;
 
@@ -36,6 +38,14 @@ struct RawStream
     {
         return stream->GetNextPosition();
     }
+    bool is_thinned()
+    {
+        return stream->IsThinned();
+    }
+    bool is_64bit()
+    {
+        return stream->Is64Bit();
+    }
     corsika::RawParticleStreamPtr particles()
     {
         return corsika::VRawParticleStream::Create(stream);
@@ -46,6 +56,40 @@ struct RawStream
     }
 };
 
+struct RawStreamWriter
+{
+    corsika::RawStreamWriterPtr stream;
+    RawStreamWriter(const std::string& filename, bool thinned, bool is64Bit)
+    {
+        stream = corsika::RawStreamWriter::Create(filename, thinned, is64Bit);
+    }
+    void close()
+    {
+        stream->Close();
+    }
+    void write(corsika::Block<corsika::NotThinned>& block)
+    {
+        stream->Write(block);
+    }
+    void write_th(corsika::Block<corsika::Thinned>& block)
+    {
+        stream->Write(block);
+    }
+    size_t get_next_position()
+    {
+        return stream->GetNextPosition();
+    }
+};
+
+size_t skim(const std::string& input, const std::string& output, object selection, double fraction, uint64_t seed,
+            unsigned int observationLevel)
+{
+    extract<std::string> expression(selection);
+    if (expression.check())
+        return corsika::Skim(input, output, corsika::ParticleSelection(expression()), fraction, seed, observationLevel);
+    return corsika::Skim(input, output, extract<const corsika::ParticleSelection&>(selection)(), fraction, seed, observationLevel);
+}
+
 void register_RawStream()
 {
     docstring_options local_docstring_options(true, true, false);
@@ -57,7 +101,24 @@ void register_RawStream()
     .def("seek_to", &RawStream::seek_to)
     .add_property("is_open", &RawStream::is_open)
     .def("get_next_position", &RawStream::get_next_position)
+    .add_property("is_thinned", &RawStream::is_thinned)
+    .add_property("is_64bit", &RawStream::is_64bit)
     .def("particles", &RawStream::particles)
     .def("particles", &RawStream::particles1)
     ;
+
+    class_<RawStreamWriter,boost::noncopyable>("RawStreamWriter",
+        "Block-wise writer of CORSIKA files, compressed if the name ends in .gz or .bz2",
+        init<std::string, bool, bool>((arg("filename"), arg("thinned"), arg("is_64bit")=false)))
+    .def("close", &RawStreamWriter::close)
+    .def("write", &RawStreamWriter::write)
+    .def("write", &RawStreamWriter::write_th)
+    .def("get_next_position", &RawStreamWriter::get_next_position)
+    ;
+
+    def("skim", skim, (arg("input"), arg("output"), arg("selection"), arg("fraction")=1., arg("seed")=0, arg("observation_level")=1),
+        "Copy a CORSIKA file keeping only the particles passing a selection (ParticleSelection or expression). "
+        "With fraction < 1 (thinned files only), selected particles are kept with that probability and reweighted. "
+        "Selects the same particles as Shower.select at the given observation level. "
+        "Returns the number of particles written.");
 }
@@ -25,6 +25,11 @@ Particle& next_particle(ShowerParticleStream& o)
   return *p;
 }
 
+size_t next_batch(ShowerParticleStream& o, ParticleBatch& batch)
+{
+  return o.NextBatch(batch);
+}
+
 
 void register_CorsikaShowerFileParticleIterator()
 {
@@ -33,6 +38,8 @@ void register_CorsikaShowerFileParticleIterator()
     .def("__next__", next_particle, return_internal_reference<>())
     .def("__iter__", identity)
     .def("rewind", &ShowerParticleStream::Rewind)
+    .def("next_batch", next_batch)
+    .def("next_batch", &ShowerParticleStream::NextBatch)
     ;
 
 }
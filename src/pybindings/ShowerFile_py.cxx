@@ -1,6 +1,10 @@
 #include <boost/python.hpp>
 #include <corsika/ShowerFile.h>
+#include "gil_helpers.h"
+#include <chrono>
+#include <future>
 #include <string>
+#include <vector>
 
 using namespace boost::python;
 using namespace corsika;
@@ -46,6 +50,57 @@ get_shower(ShowerFile& f, int i)
   return f.GetCurrentShower();
 }
 
+/*
+  Result of ShowerFile.load_async. Waiting releases the GIL, and
+  awaiting it waits in the default executor of the asyncio loop.
+ */
+class ShowerFuture {
+public:
+  ShowerFuture() {}
+  ShowerFuture(const std::shared_future<ShowerPtr>& f): fFuture(f) {}
+
+  bool done() const
+  {
+    return fFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  ShowerPtr result() const
+  {
+    {
+      ReleaseGIL nogil;
+      fFuture.wait();
+    }
+    return fFuture.get();
+  }
+private:
+  std::shared_future<ShowerPtr> fFuture;
+};
+
+ShowerFuture load_async(ShowerFile& f, unsigned int eventId)
+{
+  return ShowerFuture(f.LoadAsync(eventId));
+}
+
+list load_longitudinal(ShowerFile& f, bool energyDeposit)
+{
+  std::vector<ShowerPtr> showers;
+  {
+    ReleaseGIL nogil;
+    showers = f.LoadLongitudinal(energyDeposit);
+  }
+  list result;
+  for (size_t i = 0; i != showers.size(); ++i)
+    result.append(showers[i]);
+  return result;
+}
+
+object await_future(object future)
+{
+  object loop = import("asyncio").attr("get_event_loop")();
+  object result = future.attr("result");
+  return loop.attr("run_in_executor")(object(), result).attr("__await__")();
+}
+
 void register_ShowerFile()
 {
 
@@ -74,5 +129,18 @@ void register_ShowerFile()
     //.staticmethod("IsValid")
     .add_property("current_shower", make_function(get_current, return_internal_reference<>()))
     .def("shower", get_shower, return_internal_reference<>())
+    .def("load_async", load_async, "Read an event in an I/O thread. Returns a ShowerFuture (awaitable).")
+    .add_property("n_io_threads", &ShowerFile::GetNIOThreads, &ShowerFile::SetNIOThreads)
+    .def("load_longitudinal", load_longitudinal, (arg("energy_deposit")=true),
+         "Headers and profiles of every shower in one pass, without particles. "
+         "With energy_deposit=False and LONG blocks in the file, the .long file is not read.")
+    ;
+
+  register_ptr_to_python<ShowerPtr>();
+
+  class_<ShowerFuture>("ShowerFuture")
+    .def("done", &ShowerFuture::done)
+    .def("result", &ShowerFuture::result, "Wait for the shower (raises if it could not be read)")
+    .def("__await__", await_future)
     ;
 }
@@ -0,0 +1,49 @@
+#include <boost/python.hpp>
+#include <corsika/ShowerFrame.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/Shower.h>
+#include <corsika/Block.h>
+#include "numpy_helpers.h"
+#include <stdexcept>
+
+using namespace boost::python;
+using namespace corsika;
+
+tuple transform_batch(const ShowerFrame& frame, const ParticleBatch& batch)
+{
+  std::vector<double> x, y, r, residual;
+  frame.Transform(batch, x, y, r, residual);
+  return make_tuple(numpy_helpers::from_vector(x), numpy_helpers::from_vector(y),
+                    numpy_helpers::from_vector(r), numpy_helpers::from_vector(residual));
+}
+
+tuple transform_arrays(const ShowerFrame& frame, object x_in, object y_in, object t_in)
+{
+  const std::vector<float> xs = numpy_helpers::to_vector<float>(x_in);
+  const std::vector<float> ys = numpy_helpers::to_vector<float>(y_in);
+  const std::vector<float> ts = numpy_helpers::to_vector<float>(t_in);
+  if (ys.size() != xs.size() || ts.size() != xs.size())
+    throw std::invalid_argument("ShowerFrame.transform: x, y and t must have the same length");
+  const size_t n = xs.size();
+  std::vector<double> x(n), y(n), r(n), residual(n);
+  frame.Transform(xs.data(), ys.data(), ts.data(), n, x.data(), y.data(), r.data(), residual.data());
+  return make_tuple(numpy_helpers::from_vector(x), numpy_helpers::from_vector(y),
+                    numpy_helpers::from_vector(r), numpy_helpers::from_vector(residual));
+}
+
+void register_ShowerFrame()
+{
+  class_<ShowerFrame>("ShowerFrame", init<optional<double, double, double, double, double> >())
+    .def(init<const Shower&>())
+    .def(init<const EventHeader&, optional<bool> >())
+    .def("core_time_shift", &ShowerFrame::CoreTimeShift, "Time of flight of the primary to the core, as subtracted from particle times")
+    .staticmethod("core_time_shift")
+    .add_property("zenith", &ShowerFrame::GetZenith)
+    .add_property("azimuth", &ShowerFrame::GetAzimuth)
+    .add_property("core_x", &ShowerFrame::GetCoreX)
+    .add_property("core_y", &ShowerFrame::GetCoreY)
+    .add_property("time_offset", &ShowerFrame::GetTimeOffset)
+    .def("transform", transform_batch, "Tuple of numpy arrays (x', y', r, time residual) for the particles in a batch")
+    .def("transform", transform_arrays, "Tuple of numpy arrays (x', y', r, time residual) for arrays of x, y and t")
+    ;
+}
@@ -0,0 +1,84 @@
+#include <boost/python.hpp>
+#include <corsika/ShowerServer.h>
+#include "gil_helpers.h"
+#include <string>
+#include <vector>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  void serve(ShowerServer& server, size_t nThreads)
+  {
+    ReleaseGIL nogil;
+    server.Serve(nThreads);
+  }
+
+  list event_ids(const std::vector<unsigned int>& ids)
+  {
+    list l;
+    for (size_t i = 0; i != ids.size(); ++i)
+      l.append(ids[i]);
+    return l;
+  }
+
+  list client_event_ids(ShowerClient& client, const std::string& filename)
+  {
+    return event_ids(client.GetEventIds(filename));
+  }
+
+  list file_event_ids(const SharedShowerFile& file)
+  {
+    return event_ids(file.GetEventIds());
+  }
+
+  Shower& get_shower(SharedShowerFile& f, int i)
+  {
+    if (f.FindEvent(i) != eSuccess) {
+      PyErr_SetString(PyExc_IndexError, "No such event in the file.");
+      throw_error_already_set();
+    }
+    return f.GetCurrentShower();
+  }
+}
+
+void register_ShowerServer()
+{
+  class_<ShowerServer, boost::noncopyable>("ShowerServer",
+    "Decode requested events once into POSIX shared memory and serve them to local processes through a Unix socket.",
+    init<std::string, size_t>((arg("socket_path"), arg("memory_limit")=ShowerServer::kDefaultMemoryLimit)))
+    .def("serve", serve, (arg("self"), arg("n_threads")=0),
+         "Handle requests in n_threads workers (0 for one per core) until a STOP request or a call to stop "
+         "(the GIL is released)")
+    .def("stop", &ShowerServer::Stop)
+    .add_property("socket_path", make_function(&ShowerServer::GetSocketPath, return_value_policy<copy_const_reference>()))
+    .add_property("n_segments", &ShowerServer::GetNSegments)
+    .add_property("segment_bytes", &ShowerServer::GetSegmentBytes)
+    .add_property("memory_limit", &ShowerServer::GetMemoryLimit)
+    .def("remove_stale_segments", &ShowerServer::RemoveStaleSegments,
+         "Remove the shared memory segments of servers that are no longer running")
+    .staticmethod("remove_stale_segments")
+    ;
+
+  class_<ShowerClient, boost::noncopyable>("ShowerClient", "Connection to a ShowerServer", init<std::string>())
+    .def("event_ids", client_event_ids)
+    .def("load", &ShowerClient::Load, (arg("filename"), arg("event_id")),
+         "ColumnCache with the columns of an event, mapped from shared memory")
+    .def("stop_server", &ShowerClient::StopServer)
+    ;
+
+  Shower& (SharedShowerFile::*get_current)() = &SharedShowerFile::GetCurrentShower;
+
+  class_<SharedShowerFile, boost::noncopyable>("SharedShowerFile",
+    "Particles of the showers of a file read through a ShowerServer (no profiles or parent records)",
+    init<std::string, std::string>((arg("socket_path"), arg("filename"))))
+    .def("find_event", &SharedShowerFile::FindEvent)
+    .add_property("n_events", &SharedShowerFile::GetNEvents)
+    .add_property("event_ids", file_event_ids)
+    .add_property("run_header", make_function(&SharedShowerFile::GetRunHeader, return_internal_reference<>()))
+    .add_property("current_shower", make_function(get_current, return_internal_reference<>()))
+    .add_property("columns", &SharedShowerFile::GetColumns)
+    .def("shower", get_shower, return_internal_reference<>())
+    ;
+}
@@ -1,6 +1,8 @@
 #include <boost/python.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 #include <corsika/Shower.h>
+#include <corsika/ParticleSelection.h>
+#include "numpy_helpers.h"
 #include <vector>
 
 using namespace boost::python;
@@ -8,31 +10,24 @@ using namespace corsika;
 
 inline object identity(object const& o) { return o; }
 
-object
-expose_vector_as_array(Shower& self, std::vector<double> Shower::*member) {
-  object numpy = import("numpy");
-  object asarray = numpy.attr("asarray");
-  return asarray(object(self.*member));
-}
-object
-expose_vector_as_array(Shower& self, std::vector<double> member) {
-  object numpy = import("numpy");
-  object asarray = numpy.attr("asarray");
-  return asarray(object(member));
+object column(Shower& self, ProfileTable::Column c)
+{
+  const ColumnSpan<double> values = self.fProfiles.GetColumn(c);
+  return numpy_helpers::from_pointer(values.data(), values.size());
 }
 
-object depth_de(Shower& self) { return expose_vector_as_array(self, self.fDepth_dE); }
-object de_dx(Shower& self) { return expose_vector_as_array(self, self.fdEdX); }
-object depth(Shower& self) { return expose_vector_as_array(self, self.fDepth); }
-object charge_profile(Shower& self) { return expose_vector_as_array(self, self.fChargeProfile); }
-object gamma_profile(Shower& self) { return expose_vector_as_array(self, self.fGammaProfile); }
-object electron_profile(Shower& self) { return expose_vector_as_array(self, self.fElectronProfile); }
-object positron_profile(Shower& self) { return expose_vector_as_array(self, self.fPositronProfile); }
-object muon_profile(Shower& self) { return expose_vector_as_array(self, self.fMuonProfile); }
-object anti_muon_profile(Shower& self) { return expose_vector_as_array(self, self.fAntiMuonProfile); }
-object hadron_profile(Shower& self) { return expose_vector_as_array(self, self.fHadronProfile); }
-object nuclei_profile(Shower& self) { return expose_vector_as_array(self, self.fNucleiProfile); }
-object cherenkov_profile(Shower& self) { return expose_vector_as_array(self, self.fCherenkovProfile); }
+object depth_de(Shower& self) { return column(self, ProfileTable::eDepth_dE); }
+object de_dx(Shower& self) { return column(self, ProfileTable::edEdX); }
+object depth(Shower& self) { return column(self, ProfileTable::eDepth); }
+object charge_profile(Shower& self) { return column(self, ProfileTable::eCharge); }
+object gamma_profile(Shower& self) { return column(self, ProfileTable::eGamma); }
+object electron_profile(Shower& self) { return column(self, ProfileTable::eElectron); }
+object positron_profile(Shower& self) { return column(self, ProfileTable::ePositron); }
+object muon_profile(Shower& self) { return column(self, ProfileTable::eMuon); }
+object anti_muon_profile(Shower& self) { return column(self, ProfileTable::eAntiMuon); }
+object hadron_profile(Shower& self) { return column(self, ProfileTable::eHadron); }
+object nuclei_profile(Shower& self) { return column(self, ProfileTable::eNuclei); }
+object cherenkov_profile(Shower& self) { return column(self, ProfileTable::eCherenkov); }
 
 class ParticleIterator {
 public:
@@ -47,6 +42,26 @@ public:
     fIterator->Rewind();
   }
 
+  size_t next_batch(ParticleBatch& batch)
+  {
+    return fIterator->NextBatch(batch);
+  }
+
+  void set_subsampling(ShowerParticleStream::Subsampling mode, double fraction, uint64_t seed)
+  {
+    fIterator->SetSubsampling(mode, fraction, seed);
+  }
+
+  size_t n_skipped_blocks() const
+  {
+    return fIterator->GetNSkippedBlocks();
+  }
+
+  size_t next_reservoir(ParticleBatch& batch, size_t size, uint64_t seed)
+  {
+    return fIterator->NextReservoir(batch, size, seed);
+  }
+
   Particle next_particle()
   {
     if (!fIterator) {
@@ -71,6 +86,18 @@ ParticleIterator get_particle_iterator(Shower& shower)
   return ParticleIterator(&shower.ParticleStream());
 }
 
+// defined in ParticleSelection_py.cxx
+object select_particles(const ParticleSelection& selection, Shower& shower);
+size_t count_particles(const ParticleSelection& selection, Shower& shower);
+object mask_particles(const ParticleSelection& selection, Shower& shower);
+
+object select_expression(Shower& shower, const std::string& expression)
+{ return select_particles(ParticleSelection(expression), shower); }
+size_t count_expression(Shower& shower, const std::string& expression)
+{ return count_particles(ParticleSelection(expression), shower); }
+object mask_expression(Shower& shower, const std::string& expression)
+{ return mask_particles(ParticleSelection(expression), shower); }
+
 void register_Shower()
 {
   class_<std::vector<double> >("vector_double")
@@ -81,6 +108,19 @@ void register_Shower()
     .def("__iter__", identity)
     .def("__next__", &ParticleIterator::next_particle)
     .def("rewind", &ParticleIterator::Rewind)
+    .def("next_batch", &ParticleIterator::next_batch)
+    .def("set_subsampling", &ParticleIterator::set_subsampling,
+         (arg("mode"), arg("fraction")=1., arg("seed")=0),
+         "Keep a random fraction of the particles (or particle blocks), with the weights corrected. Applies from the next particle read.")
+    .add_property("n_skipped_blocks", &ParticleIterator::n_skipped_blocks)
+    .def("next_reservoir", &ParticleIterator::next_reservoir, (arg("batch"), arg("size"), arg("seed")=0),
+         "Uniform sample of a fixed number of the remaining particles, with the weights corrected. Returns the number read.")
+    ;
+
+  enum_<ShowerParticleStream::Subsampling>("Subsampling")
+    .value("eAllParticles", ShowerParticleStream::eAllParticles)
+    .value("eParticleSubsampling", ShowerParticleStream::eParticleSubsampling)
+    .value("eBlockSubsampling", ShowerParticleStream::eBlockSubsampling)
     ;
 
   class_<Shower>("Shower")
@@ -99,6 +139,7 @@ void register_Shower()
     .add_property("calorimetric_energy", &Shower::GetCalorimetricEnergy, &Shower::SetCalorimetricEnergy)
     //.def("particles", &Shower::GetParticleIt, return_internal_reference<>())
     .add_property("particles", get_particle_iterator) // memory management?
+    .add_property("has_particles", &Shower::HasParticleStream)
     .add_property("header", make_function(&Shower::GetEventHeader, return_internal_reference<>()))
     .add_property("gaisser_hillas", &Shower::GetGaisserHillasParams)
     //evt::GaisserHillas6Parameter GetGaisserHillasParams const
@@ -114,5 +155,8 @@ void register_Shower()
     .add_property("depth", depth)
     .add_property("de_dx", de_dx)
     .add_property("depth_de_dx", depth_de)
+    .def("select", select_expression, "Numpy structured array with the particles passing a selection expression, e.g. 'pdg in (13, -13) and r < 800*m'")
+    .def("count", count_expression, "Number of particles passing a selection expression")
+    .def("mask", mask_expression, "Boolean numpy array, true for each particle passing a selection expression")
     ;
 }
@@ -0,0 +1,58 @@
+#include <boost/python.hpp>
+#include <corsika/Trace.h>
+
+using namespace boost::python;
+using namespace corsika;
+
+namespace
+{
+  // with corsika.trace.Span("name"): ...
+  struct PySpan
+  {
+    PySpan(const std::string& name, const std::string& stage):
+      fName(Trace::Intern(name)), fStage(Trace::Intern(stage)), fStart(0) {}
+
+    const char* fName;
+    const char* fStage;
+    uint64_t fStart;
+  };
+
+  object span_enter(object self)
+  {
+    extract<PySpan&> span(self);
+    span().fStart = Trace::Now();
+    return self;
+  }
+
+  bool span_exit(PySpan& span, object, object, object)
+  {
+    if (Trace::IsRecording())
+      Trace::Record(span.fName, span.fStage, span.fStart, Trace::Now());
+    return false;
+  }
+}
+
+void register_Trace()
+{
+  namespace bp = boost::python;
+  // corsika.trace, like corsika.units
+  bp::object module(bp::handle<>(bp::borrowed(PyImport_AddModule("corsika.trace"))));
+  bp::scope().attr("trace") = module;
+  bp::scope module_scope = module;
+
+  def("start", Trace::Start, (arg("max_spans") = size_t(1) << 22),
+      "Start recording spans, discarding earlier ones");
+  def("stop", Trace::Stop, "Stop recording. Returns the number of spans");
+  def("recording", Trace::IsRecording);
+  def("n_spans", Trace::GetNSpans);
+  def("n_dropped", Trace::GetNDropped, "Spans dropped because there were more than max_spans");
+  def("clear", Trace::Clear);
+  def("set_thread_name", Trace::SetThreadName, "Name of the track of the calling thread");
+  def("write", Trace::Write, "Write the spans as Chrome trace events (JSON), for chrome://tracing or ui.perfetto.dev");
+
+  class_<PySpan>("Span", "A span of the calling thread, to be used in a with statement",
+                 init<std::string, std::string>((arg("name"), arg("stage") = "user")))
+    .def("__enter__", span_enter)
+    .def("__exit__", span_exit)
+    ;
+}
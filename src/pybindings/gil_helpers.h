@@ -0,0 +1,18 @@
+#pragma once
+#include <boost/python.hpp>
+
+/*
+  Release the Python GIL for the lifetime of the object, so other
+  Python threads can run while C++ code that does not touch Python
+  objects is busy (reading, filling, fitting...). The GIL is taken
+  back when the scope ends, also when an exception is thrown.
+ */
+struct ReleaseGIL
+{
+  ReleaseGIL(): fState(PyEval_SaveThread()) {}
+  ~ReleaseGIL() { PyEval_RestoreThread(fState); }
+private:
+  ReleaseGIL(const ReleaseGIL&);
+  ReleaseGIL& operator=(const ReleaseGIL&);
+  PyThreadState* fState;
+};
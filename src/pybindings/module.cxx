@@ -39,7 +39,13 @@ namespace bp = boost::python;
   (CorsikaUnits)(MathConstants)(PhysicalConstants)                      \
   (Particle)(Shower)(ShowerFile)                                        \
   (CorsikaShowerFileParticleIterator)(ParticleList)(ParticleProperties) \
-  (LongProfile) (LongFile)
+  (LongProfile) (LongFile)                                              \
+  (ParticleBatch)(ParticleSelection)(Histogram)                         \
+  (QuantileSketch)(LateralDistribution)(ShowerFrame)                   \
+  (DetectorSampler)(Dethinning)(ParticleArchive)                        \
+  (ColumnCache)(ShowerServer)(LongCache)(ProfileResampler)             \
+  (GaisserHillasParameter)(GaisserHillasFitter)(LongLoader)            \
+  (Instrumentation)(Trace)
 
 
 
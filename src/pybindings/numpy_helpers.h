@@ -0,0 +1,56 @@
+#pragma once
+#include <boost/python.hpp>
+#include <cstring>
+#include <vector>
+
+/*
+  Helpers to copy C++ buffers into new numpy arrays in one go.
+
+  We do not link against the numpy C API, so the array is created with
+  numpy.empty and filled through the address in __array_interface__.
+ */
+namespace numpy_helpers
+{
+  inline boost::python::object numpy()
+  { return boost::python::import("numpy"); }
+
+  inline void* data(boost::python::object array)
+  {
+    boost::python::object address = array.attr("__array_interface__")["data"][0];
+    return reinterpret_cast<void*>(boost::python::extract<size_t>(address)());
+  }
+
+  /// New array of n elements of the given dtype, with the raw contents of bytes
+  inline boost::python::object from_buffer(const void* bytes, size_t n, boost::python::object dtype)
+  {
+    boost::python::object array = numpy().attr("empty")(n, dtype);
+    if (n)
+      std::memcpy(data(array), bytes, n*boost::python::extract<size_t>(array.attr("itemsize"))());
+    return array;
+  }
+
+  template <class T> const char* dtype_of();
+  template <> inline const char* dtype_of<float>() { return "<f4"; }
+  template <> inline const char* dtype_of<double>() { return "<f8"; }
+  template <> inline const char* dtype_of<int>() { return "<i4"; }
+  template <> inline const char* dtype_of<short>() { return "<i2"; }
+  template <> inline const char* dtype_of<unsigned int>() { return "<u4"; }
+  template <> inline const char* dtype_of<char>() { return "?"; }
+
+  template <class T> boost::python::object from_vector(const std::vector<T>& v)
+  { return from_buffer(v.data(), v.size(), boost::python::object(dtype_of<T>())); }
+
+  template <class T> boost::python::object from_pointer(const T* v, size_t n)
+  { return from_buffer(v, n, boost::python::object(dtype_of<T>())); }
+
+  /// Copy any array-like object (numpy array, list...) into a vector, converting the type if needed
+  template <class T> std::vector<T> to_vector(boost::python::object values)
+  {
+    boost::python::object array =
+      numpy().attr("ascontiguousarray")(values, boost::python::object(dtype_of<T>())).attr("ravel")();
+    std::vector<T> v(boost::python::len(array));
+    if (!v.empty())
+      std::memcpy(v.data(), data(array), v.size()*sizeof(T));
+    return v;
+  }
+}
@@ -13,5 +13,22 @@ int main(int argc, const char* argv[])
     test_file(dir);
     test_rawstream(dir);
     test_index();
+    test_selection(dir);
+    test_histogram(dir);
+    test_lateral(dir);
+    test_sampler(dir);
+    test_server(dir);
+    test_subsampling(dir);
+    test_archive(dir);
+    test_column_cache(dir);
+    test_async(dir);
+    test_long();
+    test_long_cache();
+    test_resample();
+    test_profile_table();
+    test_gaisser_hillas();
+    test_long_loader(dir);
+    test_instrumentation(dir);
+    test_trace(dir);
     printf("All Tests Were Successfull!\n");
 }
@@ -0,0 +1,68 @@
+#include "tests.h"
+#include <corsika/ParticleArchive.h>
+#include <cmath>
+#include <cstdio>
+#include <sys/stat.h>
+
+namespace
+{
+    void test_convert(std::string filename)
+    {
+        const std::string archive = "/tmp/corsika_reader_archive_test";
+        ArchiveOptions options;
+        const size_t records = ParticleArchiveWriter::Convert(filename, archive, options);
+        assert(records > 181992u); // particles plus muon-production records
+        struct stat original, compact;
+        stat(filename.c_str(), &original);
+        stat(archive.c_str(), &compact);
+        assert(2*compact.st_size < original.st_size);
+        
+        ShowerFile file(filename);
+        ParticleArchive reader(archive);
+        ENSURE_EQUAL(reader.GetNEvents(), 1u);
+        assert(!reader.IsThinned());
+        assert(reader.GetRunHeader().fRunNumber == 2);
+        ENSURE_EQUAL(file.FindEvent(1), eSuccess);
+        ENSURE_EQUAL(reader.FindEvent(1), eSuccess);
+        ENSURE_EQUAL(reader.FindEvent(2), eFail);
+        assert(reader.GetCurrentShower().GetEnergy() == file.GetCurrentShower().GetEnergy());
+        
+        // the same particles, within the precision of the archive
+        ShowerParticleStream& expected = file.GetCurrentShower().ParticleStream();
+        ShowerParticleStream& stream = reader.GetCurrentShower().ParticleStream();
+        ParticleBatch a, b;
+        size_t n = 0;
+        while (expected.NextBatch(a))
+        {
+            ENSURE_EQUAL(stream.NextBatch(b, a.size()), a.size());
+            for (size_t i = 0; i != a.size(); ++i)
+            {
+                assert(a.fPDG[i] == b.fPDG[i] && a.fLevel[i] == b.fLevel[i] && a.fGeneration[i] == b.fGeneration[i]);
+                assert(fabs(a.fX[i] - b.fX[i]) <= 0.5*options.fPosition + 1e-6*fabs(a.fX[i]));
+                assert(fabs(a.fY[i] - b.fY[i]) <= 0.5*options.fPosition + 1e-6*fabs(a.fY[i]));
+                // plus the rounding of raw times around 1e6 ns to float
+                assert(fabs(a.fT[i] - b.fT[i]) <= 0.5*options.fTime + 0.0625);
+                const double p = std::sqrt(a.fPx[i]*a.fPx[i] + a.fPy[i]*a.fPy[i] + a.fPz[i]*a.fPz[i]);
+                assert(fabs(a.fPx[i] - b.fPx[i]) < 1e-4*p && fabs(a.fPz[i] - b.fPz[i]) < 1e-4*p);
+            }
+            n += a.size();
+        }
+        ENSURE_EQUAL(stream.NextBatch(b), 0u);
+        ENSURE_EQUAL(n, 181992u);
+        
+        // chunks are the blocks for block subsampling
+        stream.SetSubsampling(ShowerParticleStream::eBlockSubsampling, 0.5, 3);
+        stream.Rewind();
+        size_t kept = 0;
+        while (stream.NextBatch(b))
+            kept += b.size();
+        assert(kept < n && stream.GetNSkippedBlocks() > 0);
+        std::remove(archive.c_str());
+    }
+}
+
+void test_archive(const char* directory)
+{
+    test_convert(std::string(directory) + "/DAT000002-32");
+    printf("TestParticleArchive Successfull!\n");
+}
@@ -0,0 +1,58 @@
+#include "tests.h"
+#include <cstdio>
+
+namespace
+{
+    void test_load_async(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        ParticleBatch expected;
+        file.GetCurrentShower().ParticleStream().NextBatch(expected, 1000000);
+        
+        // several loads in flight, each with its own stream
+        std::vector<std::shared_future<ShowerPtr> > loads;
+        for (int i = 0; i != 3; ++i)
+            loads.push_back(file.LoadAsync(1));
+        std::shared_future<ShowerPtr> missing = file.LoadAsync(7);
+        ShowerPtr first = loads[0].get();
+        ShowerPtr second = loads[1].get();
+        assert(first->GetEnergy() == file.GetCurrentShower().GetEnergy());
+        ENSURE_EQUAL(first->GetShowerNumber(), 1);
+        ShowerParticleStream& one = first->ParticleStream();
+        ShowerParticleStream& two = second->ParticleStream();
+        ParticleBatch a, b;
+        while (one.NextBatch(a, 1000) && two.NextBatch(b, 1000))
+            assert(a.fX == b.fX);
+        first->ParticleStream().NextBatch(a, 1000000);
+        assert(a.fX == expected.fX && a.fPDG == expected.fPDG);
+        
+        bool thrown = false;
+        try { missing.get(); }
+        catch (IOException&) { thrown = true; }
+        assert(thrown);
+        
+        // the current shower is not touched, and closing waits for pending loads
+        ParticleBatch current;
+        file.GetCurrentShower().ParticleStream().NextBatch(current, 1000000);
+        ENSURE_EQUAL(current.size(), expected.size());
+        std::shared_future<ShowerPtr> pending = file.LoadAsync(1);
+        file.Close();
+        assert(pending.get()->GetEnergy() == first->GetEnergy());
+        // a LONG block missing is an error, not a shorter profile
+        const std::string broken = "/tmp/corsika_reader_broken_long_test";
+        add_long_blocks(filename, broken, 3);
+        ShowerFile withLong(broken);
+        thrown = false;
+        try { withLong.LoadAsync(1).get(); }
+        catch (IOException&) { thrown = true; }
+        assert(thrown);
+        std::remove(broken.c_str());
+    }
+}
+
+void test_async(const char* directory)
+{
+    test_load_async(std::string(directory) + "/DAT000002-32.gz");
+    printf("TestAsyncLoad Successfull!\n");
+}
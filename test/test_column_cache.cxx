@@ -0,0 +1,51 @@
+#include "tests.h"
+#include <corsika/ColumnCache.h>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    void test_columns(std::string filename)
+    {
+        const std::string name = "/tmp/corsika_reader_cache_test";
+        ENSURE_EQUAL(ColumnCache::Convert(filename, name), 181992u);
+        
+        ColumnCache cache(name);
+        ENSURE_EQUAL(cache.GetNEvents(), 1u);
+        ENSURE_EQUAL(cache.FindEvent(1), 0u);
+        ENSURE_EQUAL(cache.FindEvent(2), 1u);
+        assert(cache.GetRunHeader().fRunNumber == 2);
+        
+        // the columns are views of the file, aligned, with the particles of the shower
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        assert(cache.GetEventHeader(0).fEnergy == file.GetCurrentShower().GetEventHeader().fEnergy);
+        ParticleBatch expected, cached;
+        file.GetCurrentShower().ParticleStream().NextBatch(expected, 1000000);
+        cache.GetBatch(0, cached);
+        ENSURE_EQUAL(cached.size(), expected.size());
+        assert(cached.fX == expected.fX && cached.fT == expected.fT && cached.fPz == expected.fPz);
+        assert(cached.fPDG == expected.fPDG && cached.fLevel == expected.fLevel);
+        for (int c = 0; c != ColumnCache::eNColumns; ++c)
+            ENSURE_EQUAL(size_t(cache.GetData(0, ColumnCache::Column(c))) % ColumnCache::kAlignment, 0u);
+        ColumnSpan<int> pdg = cache.GetInts(0, ColumnCache::ePDG);
+        assert(pdg.data() == cache.GetData(0, ColumnCache::ePDG));
+        ENSURE_EQUAL(pdg.size(), 181992u);
+        // no history records in this file
+        ColumnSpan<int> parents = cache.GetInts(0, ColumnCache::eParentPDG);
+        ENSURE_EQUAL(size_t(std::count(parents.begin(), parents.end(), 0)), parents.size());
+        
+        bool thrown = false;
+        try { cache.GetFloats(0, ColumnCache::ePDG); }
+        catch (std::invalid_argument&) { thrown = true; }
+        assert(thrown);
+        std::remove(name.c_str());
+    }
+}
+
+void test_column_cache(const char* directory)
+{
+    test_columns(std::string(directory) + "/DAT000002-32");
+    printf("TestColumnCache Successfull!\n");
+}
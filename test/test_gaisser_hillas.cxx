@@ -0,0 +1,125 @@
+#include "tests.h"
+#include <corsika/GaisserHillasFitter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    GaisserHillasParameter make_gaisser_hillas(double nMax, double xMax, double x0, double a, double b, double c)
+    {
+        GaisserHillasParameter gh;
+        gh.SetNMax(nMax, 0);
+        gh.SetXMax(xMax*g/cm2, 0);
+        gh.SetXZero(x0*g/cm2, 0);
+        gh.SetA(a*g/cm2, 0);
+        gh.SetB(b, 0);
+        gh.SetC(c/(g/cm2), 0);
+        return gh;
+    }
+    
+    void test_fit()
+    {
+        // closed form and numerical integrals against a sum
+        const GaisserHillasParameter four = make_gaisser_hillas(1e6, 750, -50, 65, 0, 0);
+        const GaisserHillasParameter six = make_gaisser_hillas(1e6, 750, -50, 65, 0.02, -1e-5);
+        double sumFour = 0, sumSix = 0;
+        for (double x = -50; x < 3000; x += 0.1)
+        {
+            sumFour += four(x*g/cm2)*0.1;
+            sumSix += six(x*g/cm2)*0.1;
+        }
+        assert(std::fabs(four.GetIntegral()/(g/cm2) - sumFour) < 1e-5*sumFour);
+        assert(std::fabs(six.GetIntegral()/(g/cm2) - sumSix) < 1e-5*sumSix);
+
+        // batch evaluation, zero before X0 and where lambda is not positive
+        std::vector<double> grid;
+        for (double x = -100; x < 3000; x += 7)
+            grid.push_back(x*g/cm2);
+        std::vector<double> batch(grid.size());
+        six.Eval(grid.data(), batch.data(), grid.size());
+        for (size_t i = 0; i != grid.size(); ++i)
+        {
+            const double scalar = six(grid[i]);
+            assert(std::fabs(batch[i] - scalar) <= 1e-12*scalar);
+        }
+        ENSURE_EQUAL(batch[0], 0.);
+        const std::vector<GaisserHillasParameter> showers = {four, six, make_gaisser_hillas(2e6, 650, 0, 70, 0, 0)};
+        for (size_t nThreads = 1; nThreads != 3; ++nThreads)
+        {
+            std::vector<double> many(showers.size()*grid.size());
+            GaisserHillasParameter::Eval(showers, grid.data(), grid.size(), many.data(), nThreads);
+            for (size_t s = 0; s != showers.size(); ++s)
+            {
+                showers[s].Eval(grid.data(), batch.data(), grid.size());
+                assert(std::equal(batch.begin(), batch.end(), many.begin() + s*grid.size()));
+            }
+        }
+
+        std::vector<double> depth, values;
+        for (double x = 5; x < 1500; x += 10)
+        {
+            depth.push_back(x);
+            values.push_back(six(x*g/cm2));
+        }
+        GaisserHillasFitter fitter(GaisserHillasFitter::eSixParameters, GaisserHillasFitter::eUniform);
+        const GaisserHillasParameter fit = fitter.Fit(depth, values);
+        assert(close_to(fit.GetNMax(), 1e6));
+        assert(close_to(fit.GetXMax(), 750*g/cm2));
+        assert(close_to(fit.GetXZero(), -50*g/cm2));
+        assert(close_to(fit.GetA(), 65*g/cm2));
+        assert(close_to(fit.GetB(), 0.02));
+        assert(close_to(fit.GetC(), -1e-5/(g/cm2)));
+        ENSURE_EQUAL(fit.GetNdof(), depth.size() - 6);
+        assert(fit.GetXMaxError() > 0 && fit.GetChiSquare() < 1e-6);
+        
+        // the four-parameter form, with cuts
+        GaisserHillasFitter cut;
+        cut.SetDepthRange(100, 1400);
+        cut.SetMinFraction(0.1);
+        for (size_t i = 0; i != depth.size(); ++i)
+            values[i] = four(depth[i]*g/cm2);
+        const GaisserHillasParameter fitFour = cut.Fit(depth, values);
+        assert(close_to(fitFour.GetXMax(), 750*g/cm2));
+        assert(close_to(fitFour.GetA(), 65*g/cm2));
+        ENSURE_EQUAL(fitFour.GetB(), 0.);
+        assert(fitFour.GetNdof() < depth.size() - 4);
+        
+        // batches give the fits of each profile, with any number of threads
+        std::vector<LongProfile> profiles(5);
+        for (size_t p = 0; p != profiles.size(); ++p)
+        {
+            const GaisserHillasParameter gh = make_gaisser_hillas(1e5*(p + 1), 600 + 20*p, -20, 60 + p, 0, 0);
+            ProfileTable& table = profiles[p].fProfiles;
+            table.Resize(depth.size(), 0);
+            for (size_t i = 0; i != depth.size(); ++i)
+            {
+                table.Get(ProfileTable::eDepth)[i] = depth[i];
+                table.Get(ProfileTable::eCharge)[i] = gh(depth[i]*g/cm2);
+            }
+        }
+        GaisserHillasFitter poisson;
+        for (size_t nThreads = 1; nThreads != 3; ++nThreads)
+        {
+            const std::vector<GaisserHillasParameter> fits = poisson.Fit(profiles, ProfileTable::eCharge, nThreads);
+            ENSURE_EQUAL(fits.size(), profiles.size());
+            for (size_t p = 0; p != profiles.size(); ++p)
+            {
+                ENSURE_EQUAL(fits[p].GetXMax(), poisson.Fit(profiles[p]).GetXMax());
+                assert(close_to(fits[p].GetXMax(), (600 + 20*p)*g/cm2));
+            }
+        }
+        
+        // not enough points
+        const GaisserHillasParameter failed = poisson.Fit(std::vector<double>(depth.begin(), depth.begin() + 4),
+                                                          std::vector<double>(values.begin(), values.begin() + 4));
+        ENSURE_EQUAL(failed.GetNdof(), 0u);
+        ENSURE_EQUAL(failed.GetNMax(), 0.);
+    }
+}
+
+void test_gaisser_hillas()
+{
+    test_fit();
+    printf("TestGaisserHillas Successfull!\n");
+}
@@ -0,0 +1,163 @@
+#include "tests.h"
+#include <corsika/Histogram.h>
+#include <corsika/Parallel.h>
+#include <corsika/RawStreamWriter.h>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    /// Copy of a file with the events numbered from first on
+    template <class Thinning>
+    void renumber(const std::string& input, const std::string& output, int first)
+    {
+        RawStreamPtr in = RawStream::Create(input);
+        RawStreamWriterPtr out = RawStreamWriter::Create(output, in->IsThinned(), in->Is64Bit());
+        Block<Thinning> block;
+        int event = first - 1;
+        while (in->GetNextBlock(block))
+        {
+            if (block.IsEventHeader())
+                block.AsEventHeader.fEventNumber = ++event;
+            if (block.IsEventTrailer())
+                block.AsEventTrailer.fEventNumber = event;
+            out->Write(block);
+            if (block.IsRunTrailer())
+                break;
+        }
+        out->Close();
+    }
+
+    void test_pipeline()
+    {
+        // item k goes to worker k % 3 and is finished in order
+        const size_t n = 1000;
+        size_t produced = 0;
+        std::vector<std::vector<size_t> > seen(3);
+        std::vector<size_t> finished;
+        ParallelPipeline<size_t>(3,
+            [&](size_t& item) { item = produced; return produced++ != n; },
+            [&](const size_t& item, size_t t) { seen[t].push_back(item); },
+            [&](const size_t& item) { finished.push_back(item); });
+        ENSURE_EQUAL(finished.size(), n);
+        for (size_t k = 0; k != n; ++k)
+        {
+            ENSURE_EQUAL(finished[k], k);
+            ENSURE_EQUAL(seen[k % 3][k / 3], k);
+        }
+
+        // an exception in a worker stops production and is rethrown
+        produced = 0;
+        bool thrown = false;
+        try
+        {
+            ParallelPipeline<size_t>(4,
+                [&](size_t& item) { item = produced; return produced++ != n; },
+                [&](const size_t& item, size_t) { if (item == 10) throw std::runtime_error("item 10"); });
+        }
+        catch (std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        assert(produced < n);
+    }
+
+    void test_axis()
+    {
+        HistogramAxis x(ParticleBatch::eX, 10, -5*m, 5*m);
+        ENSURE_EQUAL(x.GetNBins(), 10u);
+        ENSURE_EQUAL(x.FindBin(-5*m), 0);
+        ENSURE_EQUAL(x.FindBin(0.), 5);
+        ENSURE_EQUAL(x.FindBin(4.99*m), 9);
+        ENSURE_EQUAL(x.FindBin(5*m), -1);
+        ENSURE_EQUAL(x.FindBin(-6*m), -1);
+
+        HistogramAxis e(ParticleBatch::eKineticEnergy, 3, 1*MeV, 1*TeV, HistogramAxis::eLog);
+        ENSURE_EQUAL(e.FindBin(10*MeV), 0);
+        ENSURE_EQUAL(e.FindBin(1*GeV), 1);
+        ENSURE_EQUAL(e.FindBin(100*GeV), 2);
+        ENSURE_EQUAL(e.FindBin(0.), -1);
+        assert(fabs(e.GetEdges()[1] - 100*MeV) < 1e-9);
+
+        std::vector<double> edges = {0, 1, 10, 100};
+        HistogramAxis r(ParticleBatch::eR, edges);
+        ENSURE_EQUAL(r.FindBin(0.5), 0);
+        ENSURE_EQUAL(r.FindBin(10.), 2);
+        ENSURE_EQUAL(r.FindBin(100.), -1);
+
+        std::vector<double> types = {Particle::eMuon, Particle::eAntiMuon};
+        HistogramAxis pdg(ParticleBatch::ePDG, types, HistogramAxis::eCategories);
+        ENSURE_EQUAL(pdg.FindBin(Particle::eAntiMuon), 1);
+        ENSURE_EQUAL(pdg.FindBin(Particle::ePhoton), -1);
+
+        bool failed = false;
+        try { HistogramAxis bad(ParticleBatch::eX, 10, 1, -1); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+    }
+
+    void test_fill(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+
+        HistogramAxis x(ParticleBatch::eX, 100, -6*km, 6*km);
+        HistogramAxis y(ParticleBatch::eY, 100, -6*km, 6*km);
+        Histogram h(x, y);
+        h.SetUseWeights(false);
+        h.Fill(shower.ParticleStream());
+        ENSURE_EQUAL(h.GetContents().size(), 10000u);
+        assert(h.GetEntries() + size_t(h.GetOutside()) == 181992u);
+
+        // same particles, one at a time
+        std::vector<double> expected(10000, 0.);
+        ShowerParticleStream& stream = shower.ParticleStream();
+        while (auto p = stream.NextParticle())
+        {
+            const int i = x.FindBin(p->fX);
+            const int j = y.FindBin(p->fY);
+            if (i >= 0 && j >= 0)
+                expected[i*100 + j] += 1;
+        }
+        assert(h.GetContents() == expected);
+
+        // parallel filling gives the same result
+        Histogram parallel(x, y);
+        parallel.SetUseWeights(false);
+        parallel.Fill(shower.ParticleStream(), 3);
+        assert(parallel.GetContents() == expected);
+        ENSURE_EQUAL(parallel.GetEntries(), h.GetEntries());
+
+        Histogram muons(HistogramAxis(ParticleBatch::eR, 20, 1*m, 10*km, HistogramAxis::eLog));
+        muons.SetSelection(ParticleSelection("pdg in (13, -13)"));
+        muons.Fill(shower.ParticleStream());
+        Histogram all_muons(muons);
+        all_muons.Reset();
+        all_muons.FillFile(filename, 2);
+        assert(all_muons.GetContents() == muons.GetContents());
+
+        // events are found by their numbers, whatever they are
+        const std::string renumbered = "/tmp/corsika_reader_renumbered";
+        if (file.IsThinned())
+            renumber<Thinned>(filename, renumbered, 7);
+        else
+            renumber<NotThinned>(filename, renumbered, 7);
+        ENSURE_EQUAL(ShowerFile(renumbered).GetEventIds()[0], 7u);
+        all_muons.Reset();
+        all_muons.FillFile(renumbered, 2);
+        assert(all_muons.GetContents() == muons.GetContents());
+        std::remove(renumbered.c_str());
+
+        bool failed = false;
+        try { h.Add(muons); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+    }
+}
+
+void test_histogram(const char* directory)
+{
+    test_pipeline();
+    test_axis();
+    test_fill(std::string(directory) + "/DAT000002-32");
+    printf("TestHistogram Successfull!\n");
+}
@@ -17,6 +17,19 @@ namespace
         bool operator==(const pointee& other) const { return x_==other.x_ && dx_==other.dx_ && y_==other.y_ && dy_==other.dy_; }
     };
     
+    struct shape
+    {
+        double x_, y_, r_, dx_, dy_, angle_;
+        std::vector<std::pair<double,double> > v_;
+        double x() const { return x_; }
+        double y() const { return y_; }
+        double radius() const { return r_; }
+        double dx() const { return dx_; }
+        double dy() const { return dy_; }
+        double angle() const { return angle_; }
+        const std::vector<std::pair<double,double> >& vertices() const { return v_; }
+    };
+    
     void test_details()
     {
         double a[11] = {-10., -8., -6., -4., -2., 0., 2., 4., 6., 8., 10.};
@@ -173,6 +186,147 @@ namespace
         v = index.Get(p.x(), p.y());
         ENSURE_EQUAL(v.size(), (unsigned)1, "There should be only one pointee.");
     }
+    
+    void test_flat_index()
+    {
+        // same bins and contents as PositionIndex, including points on the edges
+        corsika::PositionIndex<pointee> reference(4*corsika::km, 45*corsika::m);
+        corsika::FlatPositionIndex<pointee> index(4*corsika::km, 45*corsika::m);
+        ENSURE_EQUAL(index.GetBins(0), reference.GetBins(0));
+        ENSURE_EQUAL(index.GetSpacing(0), reference.GetSpacing(0));
+        
+        std::vector<boost::shared_ptr<pointee> > pointees;
+        for (int i = 0; i != 200; ++i) {
+            pointees.push_back(boost::shared_ptr<pointee>(new pointee((i%20 - 10)*210*m, (i/20 - 5)*370*m, 90*m, 40*m)));
+        }
+        reference.Add(pointees);
+        index.Add(pointees);
+        ENSURE_EQUAL(index.Add(pointees[7]), 7u); // already there
+        ENSURE_EQUAL(index.GetAll().size(), 200u);
+        
+        bool failed = false;
+        try { index.Get(0, 0); }
+        catch (std::logic_error&) { failed = true; }
+        assert(failed);
+        index.Build();
+        
+        std::vector<float> xs;
+        std::vector<float> ys;
+        for (int i = -100; i != 100; ++i) {
+            for (int j = -100; j != 100; ++j) {
+                xs.push_back(i*21.1*m);
+                ys.push_back(j*22.5*m); // every other point on a bin edge
+            }
+        }
+        std::vector<unsigned int> cells(xs.size());
+        index.Query(xs.data(), ys.data(), xs.size(), cells.data());
+        size_t total = 0;
+        for (size_t k = 0; k != xs.size(); ++k) {
+            ENSURE_EQUAL(cells[k], index.GetCell(xs[k], ys[k]));
+            const corsika::PositionIndex<pointee>::pointer_list_type& expected = reference.Get(xs[k], ys[k]);
+            corsika::FlatPositionIndex<pointee>::Range found = index.GetRange(cells[k]);
+            ENSURE_EQUAL(found.size(), expected.size());
+            for (size_t l = 0; l != found.size(); ++l) {
+                assert(std::find(expected.begin(), expected.end(), index.GetPointee(found[l])) != expected.end());
+            }
+            total += found.size();
+        }
+        assert(total > 0);
+        
+        std::vector<unsigned int> particles;
+        std::vector<unsigned int> ids;
+        ENSURE_EQUAL(index.Query(xs.data(), ys.data(), xs.size(), particles, ids), total);
+        
+        // overflow, underflow and NaN
+        ENSURE_EQUAL(index.GetCell(-1e9, -1e9), 0u);
+        ENSURE_EQUAL(index.GetCell(1e9, 1e9), index.GetNCells() - 1);
+        ENSURE_EQUAL(index.GetCell(std::nan(""), 1e9), index.GetNCells() - 1);
+    }
+    
+    /*
+     Every point inside a shape must be in one of the cells from the
+     policy (no false negatives) and every point in a cell flagged as
+     full must be inside the shape.
+     */
+    template <class Policy>
+    void check_policy(const shape& s)
+    {
+        corsika::FlatPositionIndex<shape, Policy> index(-500*m, 500*m, 40, -500*m, 500*m, 40);
+        index.Add(s);
+        index.Build();
+        Policy policy;
+        size_t inside = 0;
+        size_t full = 0;
+        for (int i = -260; i != 260; ++i) {
+            for (int j = -260; j != 260; ++j) {
+                const double x = i*2.1*m;
+                const double y = j*2.5*m; // some points on the cell edges
+                const bool contained = policy.Contains(s, x, y);
+                ENSURE_EQUAL(index.Contains(0, x, y), contained);
+                typename corsika::FlatPositionIndex<shape, Policy>::Range range = index.Get(x, y);
+                if (contained) {
+                    ENSURE_EQUAL(range.size(), 1u);
+                    ++inside;
+                }
+                if (!range.empty() && range.full(0)) {
+                    assert(contained);
+                    ++full;
+                }
+            }
+        }
+        assert(inside > 0);
+        assert(full > 0);
+        
+        // the exact query agrees with Contains
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for (int i = -60; i != 60; ++i) {
+            for (int j = -60; j != 60; ++j) {
+                xs.push_back(i*7.3*m);
+                ys.push_back(j*6.1*m);
+            }
+        }
+        std::vector<unsigned int> particles;
+        std::vector<unsigned int> ids;
+        index.QueryContained(xs.data(), ys.data(), xs.size(), particles, ids);
+        size_t expected = 0;
+        for (size_t k = 0; k != xs.size(); ++k) {
+            expected += policy.Contains(s, xs[k], ys[k]);
+        }
+        ENSURE_EQUAL(particles.size(), expected);
+        for (size_t k = 0; k != particles.size(); ++k) {
+            assert(policy.Contains(s, xs[particles[k]], ys[particles[k]]));
+        }
+    }
+    
+    void test_exact_policies()
+    {
+        shape circle = { 30*m, -45*m, 180*m, 0, 0, 0, std::vector<std::pair<double,double> >() };
+        check_policy<corsika::CircleCollision<shape> >(circle);
+        
+        // clockwise hexagon-ish polygon
+        shape polygon = { 0, 0, 0, 0, 0, 0, std::vector<std::pair<double,double> >() };
+        polygon.v_.push_back(std::make_pair(-200*m, 0.));
+        polygon.v_.push_back(std::make_pair(-100*m, 170*m));
+        polygon.v_.push_back(std::make_pair(150*m, 160*m));
+        polygon.v_.push_back(std::make_pair(230*m, 10*m));
+        polygon.v_.push_back(std::make_pair(90*m, -180*m));
+        polygon.v_.push_back(std::make_pair(-120*m, -150*m));
+        check_policy<corsika::ConvexPolygonCollision<shape> >(polygon);
+        
+        shape rotated = { -20*m, 40*m, 0, 300*m, 120*m, 0.4, std::vector<std::pair<double,double> >() };
+        check_policy<corsika::RotatedSquareCollision<shape> >(rotated);
+        
+        // a rotated square with no rotation is the plain square
+        rotated.angle_ = 0;
+        corsika::RotatedSquareCollision<shape> exact;
+        corsika::SquareCollision<shape> plain;
+        std::vector<double> edges;
+        for (int i = 0; i != 41; ++i) {
+            edges.push_back((i - 20)*25*m);
+        }
+        ENSURE_EQUAL(exact(edges, edges, rotated).size(), plain(edges, edges, rotated).size());
+    }
 }
 void test_index()
 {
@@ -180,5 +334,7 @@ void test_index()
     test_square_policy();
     test_square_index();
     test_rectangular_index();
+    test_flat_index();
+    test_exact_policies();
     printf("TestIndex Successfull!\n");
 }
@@ -0,0 +1,44 @@
+#include "tests.h"
+#include <corsika/Instrumentation.h>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    void test_counters(std::string filename)
+    {
+        typedef Instrumentation I;
+        I::Reset();
+        // counted in another thread, kept after it exits
+        std::thread reader([&filename]()
+        {
+            ShowerFile file(filename);
+            file.FindEvent(1);
+            ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+            while (stream.NextParticle()) {}
+        });
+        reader.join();
+        if (!I::IsEnabled())
+        {
+            ENSURE_EQUAL(I::Get(I::eBytesRead), 0u);
+            return;
+        }
+        ENSURE_EQUAL(I::Get(I::eParticlesEmitted), 181992u);
+        assert(I::Get(I::eBytesRead) > 0);
+        ENSURE_EQUAL(I::Get(I::eBytesDecompressed), I::Get(I::eBytesRead));
+        assert(I::Get(I::eReads) > 0 && I::Get(I::eDiskBlocks) > 0 && I::Get(I::eScannedBlocks) > 0);
+        ENSURE_EQUAL(I::Get(I::eParticleRecords), 39*I::Get(I::eParticleBlocks));
+        assert(I::Get(I::eDecompressTime) > 0);
+        ENSURE_EQUAL(I::CounterName(I::eParticlesFiltered), std::string("particles_filtered"));
+        
+        I::Reset();
+        ENSURE_EQUAL(I::Get(I::eParticlesEmitted), 0u);
+        ENSURE_EQUAL(I::Get(I::eScanTime), 0.);
+    }
+}
+
+void test_instrumentation(const char* directory)
+{
+    test_counters(std::string(directory) + "/DAT000002-32.gz");
+    printf("TestInstrumentation Successfull!\n");
+}
@@ -0,0 +1,157 @@
+#include "tests.h"
+#include <corsika/LateralDistribution.h>
+#include <corsika/QuantileSketch.h>
+#include <corsika/ShowerFrame.h>
+#include <corsika/Constants.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    void test_sketch()
+    {
+        QuantileSketch sketch(0.01);
+        QuantileSketch first(0.01);
+        QuantileSketch second(0.01);
+        for (int i = 1; i <= 10000; ++i)
+        {
+            sketch.Add(i);
+            (i % 2 ? first : second).Add(i);
+        }
+        ENSURE_EQUAL(sketch.GetCount(), 10000u);
+        assert(fabs(sketch.GetQuantile(0.5) - 5000) < 0.01*5000);
+        assert(fabs(sketch.GetQuantile(0.9) - 9000) < 0.01*9000);
+        ENSURE_EQUAL(sketch.GetQuantile(0), 1);
+        ENSURE_EQUAL(sketch.GetQuantile(1), 10000);
+
+        first.Merge(second);
+        ENSURE_EQUAL(first.GetQuantile(0.5), sketch.GetQuantile(0.5));
+
+        // negative values and weights
+        QuantileSketch mixed;
+        mixed.Add(-100, 3);
+        mixed.Add(0);
+        mixed.Add(100, 1);
+        assert(fabs(mixed.GetQuantile(0.5) + 100) < 1);
+        assert(fabs(mixed.GetQuantile(0.8) - 100) < 1);
+
+        // the memory is bounded
+        QuantileSketch small(0.01, 64);
+        for (int i = 0; i != 100; ++i)
+            small.Add(std::pow(10., i/10.));
+        assert(small.GetNBuckets() <= 64);
+        assert(fabs(small.GetQuantile(0.95) - std::pow(10., 9.5)) < 0.01*std::pow(10., 9.5));
+    }
+
+    void test_frame(std::string filename)
+    {
+        const float x[] = { 100*m, 0, -30*m };
+        const float y[] = { 0, 100*m, 40*m };
+        const float t[] = { 10*ns, 20*ns, 30*ns };
+        double xs[3], ys[3], r[3], dt[3];
+
+        ShowerFrame vertical;
+        vertical.Transform(x, y, t, 3, xs, ys, r, dt);
+        for (int i = 0; i != 3; ++i)
+        {
+            assert(fabs(xs[i] - x[i]) < 1e-9 && fabs(ys[i] - y[i]) < 1e-9);
+            assert(fabs(dt[i] - t[i]) < 1e-9);
+        }
+        assert(fabs(r[2] - 50*m) < 1e-6);
+
+        // moving towards +x, 60 degrees from the vertical
+        ShowerFrame inclined(60*deg, 0, 0, 0, 5*ns);
+        inclined.Transform(x, y, t, 3, xs, ys, r, 0);
+        assert(fabs(xs[0] - 50*m) < 1e-6 && fabs(ys[0]) < 1e-6);
+        assert(fabs(r[1] - 100*m) < 1e-6);
+        inclined.Transform(x, y, t, 3, 0, 0, 0, dt);
+        assert(fabs(dt[0] - (10*ns - 5*ns - sin(60*deg)*100*m/kSpeedOfLight)) < 1e-6);
+
+        // the time shift subtracted by ShowerParticleStream
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+        const double shift = ShowerFrame::CoreTimeShift(shower.GetEventHeader());
+        assert(shift > 0);
+        ENSURE_EQUAL(ShowerFrame(shower.GetEventHeader(), true).GetTimeOffset(), shift);
+        ENSURE_EQUAL(ShowerFrame(shower).GetTimeOffset(), 0);
+        ENSURE_EQUAL(ShowerFrame(shower).GetZenith(), shower.GetZenith());
+    }
+
+    void test_ldf(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+
+        HistogramAxis radius(ParticleBatch::eR, 20, 1*m, 10*km, HistogramAxis::eLog);
+        LateralDistribution ground(radius, LateralDistribution::eGround);
+        ground.AddDefaultClasses();
+        ENSURE_EQUAL(ground.GetNClasses(), 4u);
+        ENSURE_EQUAL(ground.FindClass("muon"), 2u);
+        ground.Fill(shower);
+
+        // the muon weights are the same as a histogram of r
+        Histogram muons(radius);
+        muons.SetSelection(ParticleSelection("pdg in (13, -13)"));
+        muons.Fill(shower.ParticleStream());
+        for (size_t bin = 0; bin != ground.GetNBins(); ++bin)
+        {
+            assert(fabs(ground.GetWeight(2, bin) - muons.GetContents()[bin]) < 1e-6*(1 + muons.GetContents()[bin]));
+            if (ground.GetEntries(2, bin))
+            {
+                const QuantileSketch& t = ground.GetTimes(2, bin);
+                const double median = ground.GetTimeQuantile(2, bin, 0.5);
+                assert(median >= t.GetMin() && median <= t.GetMax());
+            }
+            else
+                assert(std::isnan(ground.GetTimeQuantile(2, bin, 0.5)));
+        }
+
+        // every particle ends up in one class
+        double all = 0;
+        for (size_t c = 0; c != ground.GetNClasses(); ++c)
+            for (size_t bin = 0; bin != ground.GetNBins(); ++bin)
+                all += ground.GetEntries(c, bin);
+        assert(all <= 181992);
+        assert(all > 0.9*181992);
+
+        LateralDistribution plane(radius);
+        plane.AddDefaultClasses();
+        plane.Fill(shower);
+        ENSURE_EQUAL(plane.GetZenith(), shower.GetZenith());
+
+        // vertical showers look the same in both planes
+        LateralDistribution vertical(radius);
+        vertical.AddDefaultClasses();
+        vertical.SetGeometry(0, 0);
+        ParticleBatch batch;
+        ShowerParticleStream& stream = shower.ParticleStream();
+        while (stream.NextBatch(batch))
+            vertical.Fill(batch);
+        for (size_t bin = 0; bin != ground.GetNBins(); ++bin)
+            assert(fabs(vertical.GetDensity(0, bin) - ground.GetDensity(0, bin)) <= 1e-9*ground.GetDensity(0, bin));
+
+        std::vector<LateralDistribution> events = LateralDistribution::FillFile(plane, filename, 2);
+        ENSURE_EQUAL(events.size(), 1u);
+        for (size_t bin = 0; bin != plane.GetNBins(); ++bin)
+        {
+            ENSURE_EQUAL(events[0].GetWeight(1, bin), plane.GetWeight(1, bin));
+            ENSURE_EQUAL(events[0].GetEntries(1, bin), plane.GetEntries(1, bin));
+        }
+        ENSURE_EQUAL(events[0].GetShowerNumber(), shower.GetShowerNumber());
+
+        bool failed = false;
+        try { plane.Add(LateralDistribution(HistogramAxis(ParticleBatch::eR, 3, 0, 10))); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+    }
+}
+
+void test_lateral(const char* directory)
+{
+    test_sketch();
+    test_frame(std::string(directory) + "/DAT000002-32");
+    test_ldf(std::string(directory) + "/DAT000002-32");
+    printf("TestLateral Successfull!\n");
+}
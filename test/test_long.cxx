@@ -0,0 +1,87 @@
+#include "tests.h"
+#include <corsika/LongFile.h>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    void test_parse()
+    {
+        const std::string name = "/tmp/corsika_reader_test.long";
+        write_long(name);
+        LongFile file(name);
+        ENSURE_EQUAL(file.size(), 2u);
+        assert(file.HasParticleProfile() && file.HasEnergyDeposit() && !file.IsSlantDepth());
+        assert(close_to(file.Dx(), 100.));
+        for (int shower = 1; shower != 3; ++shower)
+        {
+            const LongProfile p = file.GetProfile(shower - 1);
+            const ProfileTable& t = p.fProfiles;
+            ENSURE_EQUAL(t.GetNBins(), 3u);
+            ENSURE_EQUAL(t.GetNBinsEnergyDeposit(), 3u);
+            for (int b = 0; b != 3; ++b)
+            {
+                assert(close_to(t.Get(ProfileTable::eDepth)[b], 100.*b + 50.));
+                assert(close_to(t.Get(ProfileTable::eGamma)[b], 1e5*shower + b));
+                assert(close_to(t.Get(ProfileTable::eElectron)[b], 3e4 + b));
+                assert(close_to(t.Get(ProfileTable::ePositron)[b], 2e4));
+                assert(close_to(t.Get(ProfileTable::eAntiMuon)[b], 4.5e2*shower));
+                assert(close_to(t.Get(ProfileTable::eMuon)[b], 5.25e2));
+                assert(close_to(t.Get(ProfileTable::eCharge)[b], 7e4));
+                assert(close_to(t.Get(ProfileTable::eCherenkov)[b], 9.87654e7));
+                ENSURE_EQUAL(t.Get(ProfileTable::eNuclei)[b], 0.);
+            }
+            // two bins of sum - neutrino - fractions of muon and hadron cuts, plus the energy reaching ground
+            const double deposit = 100. - 8. - 0.575*5. - 0.261*7.;
+            assert(close_to(p.fCalorimetricEnergy, 2*deposit + (1. - 0.39)*7. + 6. + 4. + 2. + 3. + 1.));
+            assert(close_to(p.fGaisserHillas.GetXMax(), (250. + shower)*g/cm2));
+            assert(close_to(p.fGaisserHillas.GetNMax(), 1.5e5*shower));
+            assert(close_to(p.fGaisserHillas.GetChiSquare(), 3*2.5));
+        }
+        
+        bool thrown = false;
+        try { file.GetProfile(2); }
+        catch (IOException&) { thrown = true; }
+        assert(thrown);
+        std::remove(name.c_str());
+        
+        ENSURE_EQUAL(LongFile("/tmp/corsika_reader_missing.long").size(), 0u);
+    }
+}
+
+// equal within the precision of the numbers written to the files
+bool close_to(double a, double b)
+{
+    return std::fabs(a - b) <= 1e-6*std::fabs(b);
+}
+
+// two showers with three bins, in the layout written by CORSIKA
+void write_long(const std::string& name)
+{
+    FILE* f = fopen(name.c_str(), "w");
+    for (int shower = 1; shower != 3; ++shower)
+    {
+        fprintf(f, " LONGITUDINAL DISTRIBUTION IN     3 VERTICAL STEPS OF   100. G/CM**2 FOR SHOWER %6d\n", shower);
+        fprintf(f, " DEPTH     GAMMAS   POSITRONS   ELECTRONS         MU+         MU-     HADRONS     CHARGED      NUCLEI   CERENKOV\n");
+        for (int b = 0; b != 3; ++b)
+            fprintf(f, "%7.1f %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E\n",
+                    100.*b + 50., 1e5*shower + b, 2e4, 3e4 + b, 4.5e2*shower, 5.25e2, 6., 7e4, 0., 9.87654e7);
+        fprintf(f, " LONGITUDINAL ENERGY DEPOSIT IN     3 VERTICAL STEPS OF   100. G/CM**2 FOR SHOWER %6d\n", shower);
+        fprintf(f, " DEPTH       GAMMA    EM IONIZ     EM CUT    MU IONIZ     MU CUT  HADR IONIZ   HADR CUT   NEUTRINO    SUM\n");
+        for (int b = 0; b != 3; ++b)
+            fprintf(f, "%7.1f %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E %11.5E\n",
+                    100.*b + 50., 1., 2., 3., 4., 5., 6., 7., 8., 100.);
+        fprintf(f, "\n FIT OF THE HILLAS CURVE   N(T) = P1 * ((T-P2)/(P3-P2))**((P3-P2)/(P4+P5*T+P6*T**2)) * EXP((P3-T)/(P4+P5*T+P6*T**2))\n");
+        fprintf(f, " TO LONGITUDINAL DISTRIBUTION OF     ALL CHARGED  PARTICLES\n");
+        fprintf(f, " PARAMETERS         =   %11.4E %11.4E %11.4E %11.4E %11.4E %11.4E\n",
+                1.5e5*shower, -12., 250. + shower, 40., -1.5e-2, 2e-5);
+        fprintf(f, " CHI**2/DOF         =   %11.4E\n AV. DEVIATION IN %% =   1.0000E+00\n\n", 2.5);
+    }
+    fclose(f);
+}
+
+void test_long()
+{
+    test_parse();
+    printf("TestLongFile Successfull!\n");
+}
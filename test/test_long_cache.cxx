@@ -0,0 +1,60 @@
+#include "tests.h"
+#include <corsika/LongCache.h>
+#include <corsika/LongFile.h>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    void test_convert()
+    {
+        const std::string name = "/tmp/corsika_reader_test.long";
+        const std::string cacheName = "/tmp/corsika_reader_test.long.cache";
+        write_long(name);
+        const double zenith = 0.5;
+        ENSURE_EQUAL(LongCache::Convert(name, cacheName, zenith), 2u);
+        
+        LongFile file(name, zenith);
+        LongCache cache(cacheName);
+        ENSURE_EQUAL(cache.size(), file.size());
+        ENSURE_EQUAL(cache.Dx(), file.Dx());
+        assert(cache.HasParticleProfile() && cache.HasEnergyDeposit() && !cache.IsSlantDepth());
+        ENSURE_EQUAL(cache.GetZenith(), zenith);
+        for (size_t e = 0; e != file.size(); ++e)
+        {
+            const LongProfile expected = file.GetProfile(e);
+            const LongProfile cached = cache.GetProfile(e);
+            ENSURE_EQUAL(cached.fProfiles.GetNBins(), expected.fProfiles.GetNBins());
+            ENSURE_EQUAL(cached.fProfiles.GetNBinsEnergyDeposit(), expected.fProfiles.GetNBinsEnergyDeposit());
+            assert(std::equal(cached.fProfiles.data(), cached.fProfiles.data() + cached.fProfiles.size(), expected.fProfiles.data()));
+            ENSURE_EQUAL(cached.fCalorimetricEnergy, expected.fCalorimetricEnergy);
+            ENSURE_EQUAL(cached.fGaisserHillas.GetXMax(), expected.fGaisserHillas.GetXMax());
+            ENSURE_EQUAL(cached.fGaisserHillas.GetNdof(), expected.fGaisserHillas.GetNdof());
+            
+            // views of the mapped file
+            ColumnSpan<double> charge = cache.GetColumn(e, LongCache::eCharge);
+            ENSURE_EQUAL(charge.size(), expected.fProfiles.GetNBins());
+            assert(std::equal(charge.begin(), charge.end(), expected.fProfiles.Get(ProfileTable::eCharge)));
+            ENSURE_EQUAL(cache.GetScalars(LongCache::eXMax)[e], expected.fGaisserHillas.GetXMax());
+        }
+        ENSURE_EQUAL(cache.GetScalars(LongCache::eNMax).size(), 2u);
+        
+        bool thrown = false;
+        try { cache.GetProfile(2); }
+        catch (std::out_of_range&) { thrown = true; }
+        assert(thrown);
+        thrown = false;
+        try { LongCache bad(name); }
+        catch (IOException&) { thrown = true; }
+        assert(thrown);
+        std::remove(name.c_str());
+        std::remove(cacheName.c_str());
+    }
+}
+
+void test_long_cache()
+{
+    test_convert();
+    printf("TestLongCache Successfull!\n");
+}
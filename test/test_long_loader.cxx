@@ -0,0 +1,99 @@
+#include "tests.h"
+#include <corsika/LongLoader.h>
+#include <corsika/LongFile.h>
+#include <algorithm>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    bool same_profile(const LongProfile& a, const LongProfile& b)
+    {
+        const GaisserHillasParameter& ga = a.fGaisserHillas;
+        const GaisserHillasParameter& gb = b.fGaisserHillas;
+        return a.fProfiles.size() == b.fProfiles.size() &&
+            std::equal(a.fProfiles.data(), a.fProfiles.data() + a.fProfiles.size(), b.fProfiles.data()) &&
+            a.fCalorimetricEnergy == b.fCalorimetricEnergy &&
+            ga.GetXMax() == gb.GetXMax() && ga.GetNMax() == gb.GetNMax() && ga.GetXZero() == gb.GetXZero() &&
+            ga.GetA() == gb.GetA() && ga.GetB() == gb.GetB() && ga.GetC() == gb.GetC() &&
+            ga.GetChiSquare() == gb.GetChiSquare();
+    }
+    
+    void test_load(const std::string& particleFile)
+    {
+        const std::string name = "/tmp/corsika_reader_test.long";
+        write_long(name);
+        
+        // one parse for any zenith angle, with the results of a LongFile opened with it
+        LongLoader loader(name);
+        ENSURE_EQUAL(loader.size(), 2u);
+        ENSURE_EQUAL(loader.GetNCached(), 0u);
+        const double zenith[] = {0., 0.5, 1.2};
+        for (int z = 0; z != 3; ++z)
+        {
+            LongFile file(name, zenith[z]);
+            ENSURE_EQUAL(loader.Dx(zenith[z]), file.Dx());
+            for (size_t e = 0; e != file.size(); ++e)
+                assert(same_profile(loader.GetProfile(e, zenith[z]), file.GetProfile(e)));
+        }
+        ENSURE_EQUAL(loader.GetNCached(), 2u);
+        bool thrown = false;
+        try { loader.GetProfile(2); }
+        catch (IOException&) { thrown = true; }
+        assert(thrown);
+        loader.ClearCache();
+        ENSURE_EQUAL(loader.GetNCached(), 0u);
+        
+        // a particle file next to a .long file, the profiles follow the zenith angle of each shower
+        const std::string dir = "/tmp/corsika_reader_loader";
+        mkdir(dir.c_str(), 0755);
+        const std::string linked = dir + "/DAT000002";
+        std::remove(linked.c_str());
+        assert(!symlink(particleFile.c_str(), linked.c_str()));
+        write_long(linked + ".long");
+        
+        ShowerFile file(linked);
+        const std::vector<ShowerPtr> showers = file.LoadLongitudinal();
+        ENSURE_EQUAL(showers.size(), file.GetNEvents());
+        const std::vector<unsigned int> ids = file.GetEventIds();
+        for (size_t i = 0; i != showers.size(); ++i)
+        {
+            const Shower& shower = *showers[i];
+            ENSURE_EQUAL(unsigned(shower.GetShowerNumber()), ids[i]);
+            ENSURE_EQUAL(shower.fProfiles.GetNBins(), 3u);
+            
+            // profiles only, asking for the particles is an error
+            assert(!shower.HasParticleStream());
+            bool thrown = false;
+            try { shower.ParticleStream(); }
+            catch (IOException&) { thrown = true; }
+            assert(thrown);
+            
+            LongProfile expected = LongFile(linked + ".long", shower.GetZenith()).GetProfile(i);
+            LongProfile loaded;
+            loaded.fProfiles = shower.fProfiles;
+            loaded.fGaisserHillas = shower.GetGaisserHillasParams();
+            loaded.fCalorimetricEnergy = expected.fCalorimetricEnergy = float(expected.fCalorimetricEnergy);
+            assert(same_profile(loaded, expected));
+            
+            // the same as reading the whole event
+            assert(file.FindEvent(ids[i]) == eSuccess);
+            const Shower& current = file.GetCurrentShower();
+            ENSURE_EQUAL(current.GetEnergy(), shower.GetEnergy());
+            ENSURE_EQUAL(current.GetEventTrailer().fParticles, shower.GetEventTrailer().fParticles);
+            assert(current.fProfiles.size() == shower.fProfiles.size() &&
+                   std::equal(current.fProfiles.data(), current.fProfiles.data() + current.fProfiles.size(),
+                              shower.fProfiles.data()));
+        }
+        std::remove((linked + ".long").c_str());
+        std::remove(linked.c_str());
+        std::remove(name.c_str());
+    }
+}
+
+void test_long_loader(const char* directory)
+{
+    test_load(std::string(directory) + "/DAT000002-32");
+    printf("TestLongLoader Successfull!\n");
+}
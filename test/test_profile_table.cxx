@@ -0,0 +1,50 @@
+#include "tests.h"
+#include <corsika/LongProfile.h>
+#include <stdexcept>
+
+namespace
+{
+    void test_layout()
+    {
+        ProfileTable table(3, 2);
+        ENSURE_EQUAL(table.size(), 3u*10 + 2u*2);
+        for (int c = 0; c != ProfileTable::eNColumns; ++c)
+        {
+            const ProfileTable::Column column = ProfileTable::Column(c);
+            for (size_t b = 0; b != table.GetNBins(column); ++b)
+                table.Get(column)[b] = 100*c + b;
+        }
+        // columns follow each other in one buffer
+        ENSURE_EQUAL(table.Get(ProfileTable::eGamma) - table.Get(ProfileTable::eDepth), 3);
+        ENSURE_EQUAL(table.Get(ProfileTable::edEdX) - table.Get(ProfileTable::eDepth_dE), 2);
+        ENSURE_EQUAL(table.GetColumn(ProfileTable::eMuon)[2], 502.);
+        
+        // shrinking keeps the remaining bins in place, growing adds zeros
+        ProfileTable resized(table);
+        resized.Resize(2, 1);
+        ENSURE_EQUAL(resized.size(), 2u*10 + 1u*2);
+        ENSURE_EQUAL(resized.Get(ProfileTable::eCherenkov)[1], 901.);
+        ENSURE_EQUAL(resized.Get(ProfileTable::edEdX)[0], 1100.);
+        resized.Resize(4, 1);
+        ENSURE_EQUAL(resized.Get(ProfileTable::eHadron)[1], 601.);
+        ENSURE_EQUAL(resized.Get(ProfileTable::eHadron)[3], 0.);
+        ENSURE_EQUAL(resized.Get(ProfileTable::edEdX)[0], 1100.);
+        
+        const FloatProfileTable single(table);
+        ENSURE_EQUAL(single.GetNBinsEnergyDeposit(), 2u);
+        ENSURE_EQUAL(single.GetColumn(ProfileTable::eCharge)[1], 701.f);
+        ENSURE_EQUAL(ProfileTable::ColumnName(ProfileTable::eAntiMuon), std::string("anti_muon"));
+        ENSURE_EQUAL(ProfileTable::ColumnFromName("dEdX"), ProfileTable::edEdX);
+        
+        bool thrown = false;
+        try { table.Get(ProfileTable::eNColumns); }
+        catch (std::out_of_range&) { thrown = true; }
+        assert(thrown);
+    }
+}
+
+void test_profile_table()
+{
+    test_layout();
+    printf("TestProfileTable Successfull!\n");
+}
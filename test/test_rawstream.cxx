@@ -1,4 +1,9 @@
 #include "tests.h"
+#include <corsika/RawStreamWriter.h>
+#include <corsika/Skim.h>
+#include <corsika/ShowerParticleStream.h>
+#include <cstdio>
+#include <stdexcept>
 
 namespace
 {
@@ -35,6 +40,73 @@ namespace
         ENSURE_EQUAL(all, 183339);
         ENSURE_EQUAL(i, 181992);
     }
+    
+    std::vector<float> read_muons(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        ParticleSelection muons("pdg in (13, -13)");
+        ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+        ParticleBatch batch;
+        std::vector<float> x;
+        while (stream.NextBatch(batch))
+        {
+            muons.Select(batch);
+            x.insert(x.end(), batch.fX.begin(), batch.fX.end());
+        }
+        return x;
+    }
+    
+    void test_skim(std::string filename)
+    {
+        const std::string output = "/tmp/corsika_reader_skim_test";
+        ParticleSelection muons("pdg in (13, -13)");
+        const size_t n = Skim(filename, output, muons);
+        
+        RawStreamPtr in = RawStream::Create(filename);
+        RawStreamPtr out = RawStream::Create(output);
+        assert(out->IsThinned() == in->IsThinned());
+        assert(out->Is64Bit() == in->Is64Bit());
+        
+        // the same muons in the same order, and nothing else
+        std::vector<float> original = read_muons(filename);
+        ENSURE_EQUAL(original.size(), n);
+        assert(read_muons(output) == original);
+        ShowerFile skimmed(output);
+        skimmed.FindEvent(1);
+        ShowerParticleStream& stream = skimmed.GetCurrentShower().ParticleStream();
+        ParticleBatch batch;
+        size_t all = 0;
+        while (stream.NextBatch(batch))
+            all += batch.size();
+        ENSURE_EQUAL(all, n);
+
+        // times are relative to the core, as in the particle stream
+        ParticleSelection early("t < 0");
+        size_t nEarly = 0;
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        ShowerParticleStream& original_stream = file.GetCurrentShower().ParticleStream();
+        while (original_stream.NextBatch(batch))
+        {
+            early.Select(batch);
+            nEarly += batch.size();
+        }
+        ENSURE_EQUAL(Skim(filename, output, early), nEarly);
+
+        // compressed output
+        ENSURE_EQUAL(Skim(filename, output + ".gz", muons), n);
+        assert(read_muons(output + ".gz") == original);
+        
+        // there are no weights to compensate subsampling
+        bool thrown = false;
+        try { Skim(filename, output, muons, 0.5); }
+        catch (std::invalid_argument&) { thrown = true; }
+        assert(thrown);
+        
+        std::remove(output.c_str());
+        std::remove((output + ".gz").c_str());
+    }
 }
 void test_rawstream(const char* directory)
 {
@@ -45,6 +117,7 @@ void test_rawstream(const char* directory)
     {
         std::cout << "testing raw stream " << filenames[i] << std::endl;
         test_basic(dir + filenames[i]);
+        test_skim(dir + filenames[i]);
     }
     //assert(Verify<CloseTo>(p.GetCoordinates(CTrans), Triple(-1,0,0)));
     printf("TestRawStream Successfull!\n");
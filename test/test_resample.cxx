@@ -0,0 +1,89 @@
+#include "tests.h"
+#include <corsika/ProfileResampler.h>
+#include <corsika/LongFile.h>
+#include <corsika/LongCache.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    void test_interpolation()
+    {
+        const std::string name = "/tmp/corsika_reader_test.long";
+        const std::string cacheName = "/tmp/corsika_reader_test.long.cache";
+        write_long(name);
+        LongFile file(name);
+        std::vector<LongProfile> profiles;
+        for (size_t e = 0; e != file.size(); ++e)
+            profiles.push_back(file.GetProfile(e));
+        
+        // energy deposit per depth
+        const double deposit = 100. - 8. - 0.575*5. - 0.261*7.;
+        ENSURE_EQUAL(profiles[0].fProfiles.GetNBins(ProfileTable::edEdX), 3u);
+        assert(close_to(profiles[0].fProfiles.Get(ProfileTable::edEdX)[1], deposit/100.));
+        
+        const double points[] = {0., 50., 100., 150., 250., 300.};
+        const std::vector<double> grid(points, points + 6);
+        ProfileResampler linear(grid);
+        const std::vector<double> gamma = linear.Resample(profiles[0].fProfiles.GetVector(ProfileTable::eDepth),
+                                                            profiles[0].fProfiles.GetVector(ProfileTable::eGamma));
+        ENSURE_EQUAL(gamma.size(), 6u);
+        ENSURE_EQUAL(gamma[0], 0.);
+        assert(close_to(gamma[1], 1e5));
+        assert(close_to(gamma[2], 1e5 + 0.5));
+        assert(close_to(gamma[3], 1e5 + 1));
+        assert(close_to(gamma[4], 1e5 + 2));
+        ENSURE_EQUAL(gamma[5], 0.);
+        
+        // logarithmic where both neighbours are positive, and unused bins at the end are ignored
+        const double depth[] = {0., 10., 20., 0.};
+        const double values[] = {1., 100., 0., 0.};
+        const double logPoints[] = {5., 15., 25.};
+        ProfileResampler log(std::vector<double>(logPoints, logPoints + 3), ProfileResampler::eLog);
+        double out[3];
+        log.Resample(depth, values, 4, out);
+        assert(close_to(out[0], 10.));
+        assert(close_to(out[1], 50.));
+        ENSURE_EQUAL(out[2], 0.);
+        const double depth2[] = {0., 10.};
+        const double values2[] = {3., 7e5};
+        const double point = 2.5;
+        ProfileResampler(std::vector<double>(1, point), ProfileResampler::eLog).Resample(depth2, values2, 2, out);
+        assert(fabs(out[0]/(3*std::exp(0.25*std::log(7e5/3))) - 1) < 1e-14);
+        
+        // batches are rows of single resamplings, with any number of threads
+        LongCache::Convert(name, cacheName);
+        LongCache cache(cacheName);
+        for (size_t nThreads = 1; nThreads != 3; ++nThreads)
+        {
+            const std::vector<double> charge = linear.Resample(profiles, LongCache::eCharge, nThreads);
+            const std::vector<double> dEdX = linear.Resample(profiles, LongCache::edEdX, nThreads);
+            ENSURE_EQUAL(charge.size(), 2*grid.size());
+            for (size_t e = 0; e != profiles.size(); ++e)
+            {
+                const ProfileTable& t = profiles[e].fProfiles;
+                const std::vector<double> c = linear.Resample(t.GetVector(ProfileTable::eDepth), t.GetVector(ProfileTable::eCharge));
+                const std::vector<double> d = linear.Resample(t.GetVector(ProfileTable::eDepth_dE), t.GetVector(ProfileTable::edEdX));
+                assert(std::equal(c.begin(), c.end(), charge.begin() + e*grid.size()));
+                assert(std::equal(d.begin(), d.end(), dEdX.begin() + e*grid.size()));
+            }
+            assert(linear.Resample(cache, LongCache::eCharge, nThreads) == charge);
+            assert(linear.Resample(cache, LongCache::edEdX, nThreads) == dEdX);
+        }
+        
+        bool thrown = false;
+        try { ProfileResampler bad(std::vector<double>(2, 1.)); }
+        catch (std::invalid_argument&) { thrown = true; }
+        assert(thrown);
+        std::remove(name.c_str());
+        std::remove(cacheName.c_str());
+    }
+}
+
+void test_resample()
+{
+    test_interpolation();
+    printf("TestProfileResampler Successfull!\n");
+}
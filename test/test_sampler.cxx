@@ -0,0 +1,250 @@
+#include "tests.h"
+#include <corsika/DetectorSampler.h>
+#include <corsika/ShowerReuse.h>
+#include <corsika/Dethinning.h>
+#include <corsika/ShowerParticleStream.h>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // hits in each detector counted particle by particle
+    std::vector<DetectorHits> brute_force(const Shower& shower, const std::vector<Detector>& layout,
+                                          double coreX, double coreY)
+    {
+        std::vector<DetectorHits> hits(layout.size());
+        DetectorCollision policy;
+        ParticleBatch batch;
+        ShowerParticleStream& stream = shower.ParticleStream();
+        while (stream.NextBatch(batch))
+        {
+            for (size_t i = 0; i != batch.size(); ++i)
+            {
+                for (size_t d = 0; d != layout.size(); ++d)
+                {
+                    if (!policy.Contains(layout[d], batch.fX[i] + coreX, batch.fY[i] + coreY))
+                        continue;
+                    ++hits[d].fEntries;
+                    hits[d].fWeight += batch.fWeight[i];
+                }
+            }
+        }
+        return hits;
+    }
+
+    void test_detector_sampler(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+
+        // a triangular grid of large tanks and a few rotated scintillators
+        std::vector<Detector> layout;
+        for (int i = -6; i <= 6; ++i)
+            for (int j = -6; j <= 6; ++j)
+                layout.push_back(Detector::Circle((i + 0.5*(j%2))*150*m, j*130*m, 20*m));
+        layout.push_back(Detector::Rectangle(10*m, -5*m, 40*m, 10*m, 0.3));
+        layout.push_back(Detector::Rectangle(-60*m, 75*m, 25*m, 25*m, 1.));
+        ENSURE_EQUAL(layout.back().GetArea(), 25*m*25*m);
+
+        DetectorSampler sampler(layout);
+        ENSURE_EQUAL(sampler.GetNDetectors(), layout.size());
+        sampler.Sample(shower);
+        std::vector<DetectorHits> expected = brute_force(shower, layout, 0, 0);
+        size_t total = 0;
+        for (size_t d = 0; d != layout.size(); ++d)
+        {
+            ENSURE_EQUAL(sampler.GetHits(d).fEntries, expected[d].fEntries);
+            assert(fabs(sampler.GetHits(d).fWeight - expected[d].fWeight) < 1e-6*(1 + expected[d].fWeight));
+            total += expected[d].fEntries;
+        }
+        assert(total > 0);
+        ENSURE_EQUAL(sampler.GetNHits(), total);
+
+        // several threads, a callback and a core away from the origin
+        sampler.Reset();
+        ENSURE_EQUAL(sampler.GetNHits(), 0u);
+        sampler.SetCore(100*m, -50*m);
+        std::atomic<size_t> calls(0);
+        sampler.SetCallback([&](const ParticleBatch&, size_t, size_t, size_t) { ++calls; });
+        sampler.Sample(shower.ParticleStream(), 3);
+        std::vector<DetectorHits> shifted = brute_force(shower, layout, 100*m, -50*m);
+        for (size_t d = 0; d != layout.size(); ++d)
+            ENSURE_EQUAL(sampler.GetHits(d).fEntries, shifted[d].fEntries);
+        ENSURE_EQUAL(calls.load(), sampler.GetNHits());
+
+        // unweighted muons only
+        sampler.Reset();
+        sampler.ClearCallback();
+        sampler.SetCore(0, 0);
+        sampler.SetUseWeights(false);
+        sampler.SetSelection(ParticleSelection("pdg in (13, -13)"));
+        sampler.Sample(shower, 2);
+        for (size_t d = 0; d != layout.size(); ++d)
+        {
+            ENSURE_EQUAL(sampler.GetHits(d).fWeight, double(sampler.GetHits(d).fEntries));
+            assert(sampler.GetHits(d).fEntries <= expected[d].fEntries);
+        }
+        assert(sampler.GetNHits() < total);
+
+        bool failed = false;
+        try { DetectorSampler(std::vector<Detector>()); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+    }
+
+    void test_reuse(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+
+        std::vector<Detector> layout;
+        for (int i = -3; i <= 3; ++i)
+            for (int j = -3; j <= 3; ++j)
+                layout.push_back(Detector::Circle(i*125*m, j*125*m, 15*m));
+        std::vector<std::pair<double,double> > cores;
+        for (int k = 0; k != 7; ++k)
+            cores.push_back(std::make_pair((k - 3)*37*m, (k%3 - 1)*51*m));
+
+        // one pass gives the same as one DetectorSampler per core
+        ShowerReuse reuse(layout, cores);
+        ENSURE_EQUAL(reuse.GetNCores(), cores.size());
+        ENSURE_EQUAL(reuse.GetNDetectors(), layout.size());
+        std::vector<size_t> calls(cores.size(), 0);
+        reuse.SetCallback([&](const ParticleBatch&, size_t, size_t core, size_t, size_t) { ++calls[core]; });
+        reuse.Sample(shower);
+        DetectorSampler sampler(layout);
+        for (size_t k = 0; k != cores.size(); ++k)
+        {
+            sampler.Reset();
+            sampler.SetCore(cores[k].first, cores[k].second);
+            sampler.Sample(shower);
+            for (size_t d = 0; d != layout.size(); ++d)
+            {
+                ENSURE_EQUAL(reuse.GetHits(k, d).fEntries, sampler.GetHits(d).fEntries);
+                assert(fabs(reuse.GetHits(k, d).fWeight - sampler.GetHits(d).fWeight) < 1e-6*(1 + sampler.GetHits(d).fWeight));
+            }
+            ENSURE_EQUAL(reuse.GetNHits(k), sampler.GetNHits());
+            ENSURE_EQUAL(calls[k], sampler.GetNHits());
+            assert(sampler.GetNHits() > 0);
+        }
+        ENSURE_EQUAL(reuse.GetDetector(3).fX, layout[3].fX);
+
+        bool failed = false;
+        try { reuse.GetHits(cores.size(), 0); }
+        catch (std::out_of_range&) { failed = true; }
+        assert(failed);
+    }
+
+    // thinned particles: vertical and inclined, around the origin
+    ParticleBatch thinned_batch()
+    {
+        ParticleBatch batch;
+        for (int i = 0; i != 40; ++i)
+        {
+            const double zenith = (i%4)*15*deg;
+            const double azimuth = i*0.7;
+            batch.fX.push_back((i%7 - 3)*5*m);
+            batch.fY.push_back((i%5 - 2)*5*m);
+            batch.fT.push_back(100*ns);
+            batch.fPx.push_back(sin(zenith)*cos(azimuth));
+            batch.fPy.push_back(sin(zenith)*sin(azimuth));
+            batch.fPz.push_back(cos(zenith));
+            batch.fKineticEnergy.push_back(1);
+            batch.fWeight.push_back(i == 0 ? 1 : 50.5 + i);
+            batch.fPDG.push_back(13);
+            batch.fCorsikaCode.push_back(6);
+            batch.fLevel.push_back(0);
+            batch.fGeneration.push_back(1);
+        }
+        return batch;
+    }
+
+    void test_dethinning(std::string filename)
+    {
+        const ParticleBatch batch = thinned_batch();
+        double weight = 0;
+        for (size_t i = 0; i != batch.size(); ++i)
+            weight += batch.fWeight[i];
+
+        std::vector<Detector> layout;
+        layout.push_back(Detector::Circle(0, 0, 10*m));
+        layout.push_back(Detector::Rectangle(30*m, 0, 10*m, 20*m, 0.5));
+        layout.push_back(Detector::Circle(0, 0, 500*m)); // catches everything
+        layout.push_back(Detector::Circle(5*km, 0, 10*m)); // too far
+        DethinningKernel kernel;
+        ENSURE_EQUAL(kernel.GetReach(80*deg), 0);
+        assert(kernel.GetReach(60*deg) > kernel.GetReach(0));
+
+        Dethinner dethinner(layout, kernel, 42);
+        dethinner.Sample(batch);
+        ENSURE_EQUAL(dethinner.GetNRead(), batch.size());
+        assert(fabs(dethinner.GetNGenerated() - (weight - 1)) < 40);
+        // the kernel stays well inside the big detector
+        const ParticleBatch& all = dethinner.GetParticles(2);
+        ENSURE_EQUAL(all.size(), dethinner.GetNGenerated() + 1);
+        ENSURE_EQUAL(dethinner.GetParticles(3).size(), 0u);
+        DetectorCollision policy;
+        for (size_t d = 0; d != 2; ++d)
+        {
+            const ParticleBatch& hits = dethinner.GetParticles(d);
+            assert(hits.size() > 0 && hits.size() < all.size());
+            for (size_t i = 0; i != hits.size(); ++i)
+            {
+                assert(policy.Contains(layout[d], hits.fX[i], hits.fY[i]));
+                ENSURE_EQUAL(hits.fWeight[i], 1);
+                assert(fabs(hits.fT[i] - 100*ns) < 100*ns);
+                const double p = sqrt(double(hits.fPx[i])*hits.fPx[i] + double(hits.fPy[i])*hits.fPy[i] + double(hits.fPz[i])*hits.fPz[i]);
+                assert(fabs(p - 1) < 1e-5);
+            }
+        }
+
+        // the same particles if the batch is given in two pieces
+        ParticleBatch head, tail;
+        for (size_t i = 0; i != batch.size(); ++i)
+            (i < 17 ? head : tail).push_back(batch, i);
+        Dethinner pieces(layout, kernel, 42);
+        pieces.Sample(head);
+        pieces.Sample(tail);
+        for (size_t d = 0; d != layout.size(); ++d)
+        {
+            ENSURE_EQUAL(pieces.GetParticles(d).size(), dethinner.GetParticles(d).size());
+            ENSURE_EQUAL(pieces.GetParticles(d).fX, dethinner.GetParticles(d).fX);
+            ENSURE_EQUAL(pieces.GetParticles(d).fT, dethinner.GetParticles(d).fT);
+        }
+        // and different ones with another seed
+        Dethinner other(layout, kernel, 43);
+        other.Sample(batch);
+        assert(other.GetParticles(0).fX != dethinner.GetParticles(0).fX);
+
+        // the test file is not thinned: particles are kept as they are, for any number of threads
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        const Shower& shower = file.GetCurrentShower();
+        std::vector<Detector> tanks;
+        for (int i = -2; i <= 2; ++i)
+            tanks.push_back(Detector::Circle(i*60*m, 0, 10*m));
+        Dethinner one(tanks);
+        one.Sample(shower);
+        Dethinner three(tanks);
+        three.Sample(shower, 3);
+        DetectorSampler sampler(tanks);
+        sampler.Sample(shower);
+        ENSURE_EQUAL(one.GetNRead(), 181992u);
+        for (size_t d = 0; d != tanks.size(); ++d)
+        {
+            ENSURE_EQUAL(one.GetParticles(d).size(), sampler.GetHits(d).fEntries);
+            ENSURE_EQUAL(one.GetParticles(d).fX, three.GetParticles(d).fX);
+        }
+    }
+}
+
+void test_sampler(const char* directory)
+{
+    test_detector_sampler(std::string(directory) + "/DAT000002-32");
+    test_reuse(std::string(directory) + "/DAT000002-32");
+    test_dethinning(std::string(directory) + "/DAT000002-32");
+    printf("TestSampler Successfull!\n");
+}
@@ -0,0 +1,103 @@
+#include "tests.h"
+#include <corsika/ParticleSelection.h>
+#include <stdexcept>
+
+namespace
+{
+    Particle make_particle(int corsikaCode, float x, float y, float pz)
+    {
+        Particle p;
+        p.fDescription = corsikaCode*1000 + 11; // generation 1, level 1
+        p.fX = x;
+        p.fY = y;
+        p.fPz = pz;
+        p.fTorZ = 10;
+        p.fWeight = 1;
+        return p;
+    }
+
+    void test_parse()
+    {
+        bool failed = false;
+        try { ParticleSelection s("pdg in (13, -13) and"); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+
+        failed = false;
+        try { ParticleSelection s("energy > 1"); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+
+        failed = false;
+        try { ParticleSelection s("pdg in (x, 13)"); }
+        catch (std::invalid_argument&) { failed = true; }
+        assert(failed);
+    }
+
+    void test_batch()
+    {
+        ParticleBatch batch;
+        batch.push_back(make_particle(5, 100*m, 0, 2*GeV));   // mu+
+        batch.push_back(make_particle(6, 0, 900*m, 2*GeV));   // mu-
+        batch.push_back(make_particle(6, 300*m, 400*m, 0.5*GeV));
+        batch.push_back(make_particle(1, 10*m, 10*m, 5*GeV)); // gamma
+        ENSURE_EQUAL(batch.size(), 4u);
+        ENSURE_EQUAL(batch.fPDG[0], Particle::eAntiMuon);
+        ENSURE_EQUAL(batch.fLevel[0], 0);
+        ENSURE_EQUAL(batch.fGeneration[0], 1);
+        assert(fabs(batch.Get(ParticleBatch::eR, 2) - 500*m) < 1e-3);
+
+        ParticleSelection muons("pdg in (13,-13) and r < 800*m and ekin > 1*GeV");
+        std::vector<char> mask;
+        muons.Evaluate(batch, mask);
+        assert(mask[0] && !mask[1] && !mask[2] && !mask[3]);
+        ENSURE_EQUAL(muons.Count(batch), 1u);
+
+        ParticleSelection not_muons("not pdg in (13, -13) || (x > 2*x - 1*km && !(y == 0))");
+        ENSURE_EQUAL(not_muons.Count(batch), 3u);
+
+        ParticleSelection constant("1 + 2*3 == 7");
+        ENSURE_EQUAL(constant.Count(batch), 4u);
+
+        ParticleSelection far("sqrt(x*x + y*y) >= 500*m");
+        ENSURE_EQUAL(far.Select(batch), 2u);
+        ENSURE_EQUAL(batch.fPDG[0], Particle::eMuon);
+        assert(far(make_particle(5, 1*km, 0, 1)));
+        assert(!far(make_particle(5, 1*m, 0, 1)));
+    }
+
+    void test_shower(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+
+        ParticleSelection muons("pdg in (13, -13)");
+        ParticleBatch batch;
+        size_t all = 0;
+        size_t selected = 0;
+        while (stream.NextBatch(batch))
+        {
+            all += batch.size();
+            selected += muons.Count(batch);
+        }
+        ENSURE_EQUAL(all, 181992u);
+
+        size_t count = 0;
+        stream.Rewind();
+        while (auto p = stream.NextParticle())
+        {
+            if (p->PDGCode() == Particle::eMuon || p->PDGCode() == Particle::eAntiMuon)
+                ++count;
+        }
+        ENSURE_EQUAL(selected, count);
+    }
+}
+
+void test_selection(const char* directory)
+{
+    test_parse();
+    test_batch();
+    test_shower(std::string(directory) + "/DAT000002-32");
+    printf("TestSelection Successfull!\n");
+}
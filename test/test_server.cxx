@@ -0,0 +1,127 @@
+#include "tests.h"
+#include <corsika/ShowerServer.h>
+#include <corsika/ShowerFile.h>
+#include <corsika/ParticleBatch.h>
+#include <corsika/IOException.h>
+#include <thread>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    void test_eviction(const std::string& filename)
+    {
+        // a segment of a server that did not exit is removed by the next one
+        const pid_t child = fork();
+        if (!child)
+            _exit(0);
+        waitpid(child, 0, 0);
+        const std::string stale = "/corsika-" + std::to_string(child) + "-0";
+        const int fd = shm_open(stale.c_str(), O_CREAT | O_RDWR, 0600);
+        assert(fd >= 0);
+        close(fd);
+
+        // a limit of one byte keeps only the last segment
+        ShowerServer server("/tmp/corsika_reader_server_eviction_test", 1);
+        assert(shm_open(stale.c_str(), O_RDONLY, 0) < 0);
+        std::thread thread([&server]() { server.Serve(); });
+        ShowerClient client(server.GetSocketPath());
+        boost::shared_ptr<ColumnCache> first = client.Load(filename, 1);
+        const size_t bytes = server.GetSegmentBytes();
+        assert(bytes > 0);
+        boost::shared_ptr<ColumnCache> second = client.Load(filename + ".gz", 1);
+        ENSURE_EQUAL(server.GetNSegments(), 1u);
+        ENSURE_EQUAL(server.GetSegmentBytes(), bytes);
+
+        // the evicted segment stays mapped, and is decoded again when requested
+        ENSURE_EQUAL(first->GetNParticles(0), second->GetNParticles(0));
+        boost::shared_ptr<ColumnCache> again = client.Load(filename, 1);
+        assert(again->GetFilename() != first->GetFilename());
+        ENSURE_EQUAL(again->GetNParticles(0), first->GetNParticles(0));
+
+        client.StopServer();
+        thread.join();
+    }
+
+    void test_concurrent(const std::string& filename)
+    {
+        // clients asking for the same event at once share one decoding
+        ShowerServer server("/tmp/corsika_reader_server_concurrent_test");
+        std::thread thread([&server]() { server.Serve(4); });
+        std::vector<std::string> names(4);
+        std::vector<std::thread> clients;
+        for (size_t i = 0; i != names.size(); ++i)
+            clients.push_back(std::thread([&server, &names, &filename, i]() {
+                ShowerClient client(server.GetSocketPath());
+                names[i] = client.Load(filename, 1)->GetFilename();
+            }));
+        for (size_t i = 0; i != clients.size(); ++i)
+            clients[i].join();
+        ENSURE_EQUAL(server.GetNSegments(), 1u);
+        for (size_t i = 1; i != names.size(); ++i)
+            ENSURE_EQUAL(names[i], names[0]);
+        server.Stop();
+        thread.join();
+    }
+}
+
+void test_server(const char* directory)
+{
+    const std::string filename = std::string(directory) + "/DAT000002-32";
+    ShowerServer server("/tmp/corsika_reader_server_test");
+    std::thread thread([&server]() { server.Serve(); });
+
+    ShowerFile file(filename);
+    file.FindEvent(1);
+    ParticleBatch expected;
+    file.GetCurrentShower().ParticleStream().NextBatch(expected, 1000000);
+
+    // two clients share the segment of the same event
+    ShowerClient client(server.GetSocketPath());
+    ENSURE_EQUAL(client.GetEventIds(filename), std::vector<unsigned int>(1, 1));
+    boost::shared_ptr<ColumnCache> columns = client.Load(filename, 1);
+    SharedShowerFile shared(server.GetSocketPath(), filename);
+    ENSURE_EQUAL(shared.GetNEvents(), 1u);
+    ENSURE_EQUAL(shared.FindEvent(1), eSuccess);
+    ENSURE_EQUAL(server.GetNSegments(), 1u);
+    ENSURE_EQUAL(shared.GetColumns()->GetFilename(), columns->GetFilename());
+    assert(shared.GetRunHeader().fRunNumber == 2);
+    assert(shared.GetCurrentShower().GetEventHeader().fEnergy == file.GetCurrentShower().GetEventHeader().fEnergy);
+
+    ParticleBatch cached;
+    columns->GetBatch(0, cached);
+    assert(cached.fX == expected.fX && cached.fPDG == expected.fPDG);
+
+    // the particle stream of the shared file gives the same particles
+    ParticleBatch streamed;
+    shared.GetCurrentShower().ParticleStream().NextBatch(streamed, 1000000);
+    ENSURE_EQUAL(streamed.size(), expected.size());
+    assert(streamed.fX == expected.fX && streamed.fT == expected.fT && streamed.fPz == expected.fPz);
+    assert(streamed.fPDG == expected.fPDG && streamed.fLevel == expected.fLevel);
+    ENSURE_EQUAL(shared.GetColumns()->GetObservationLevel(0), 1u);
+
+    // relative paths are resolved by the client, in its own directory
+    char cwd[PATH_MAX];
+    const bool moved = getcwd(cwd, sizeof(cwd)) && !chdir(directory);
+    assert(moved);
+    ENSURE_EQUAL(client.GetEventIds("DAT000002-32"), std::vector<unsigned int>(1, 1));
+    ENSURE_EQUAL(client.Load("./DAT000002-32", 1)->GetFilename(), columns->GetFilename());
+    const bool back = !chdir(cwd);
+    assert(back);
+
+    ENSURE_EQUAL(shared.FindEvent(7), eFail);
+    bool thrown = false;
+    try { client.Load(filename, 7); }
+    catch (IOException&) { thrown = true; }
+    assert(thrown);
+
+    client.StopServer();
+    thread.join();
+
+    test_eviction(filename);
+    test_concurrent(filename);
+    printf("TestShowerServer Successfull!\n");
+}
@@ -0,0 +1,128 @@
+#include "tests.h"
+#include <corsika/RawStreamWriter.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // number of particles kept with particle and block subsampling
+    std::pair<size_t, size_t> count_subsampled(std::string filename)
+    {
+        ShowerFile file(filename);
+        file.FindEvent(1);
+        ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+        ParticleBatch batch;
+        
+        stream.SetSubsampling(ShowerParticleStream::eParticleSubsampling, 0.1, 7);
+        size_t particles = 0;
+        double weight = 0;
+        while (stream.NextBatch(batch))
+        {
+            particles += batch.size();
+            for (size_t i = 0; i != batch.size(); ++i)
+                weight += batch.fWeight[i];
+        }
+        assert(fabs(particles - 18199.2) < 5*sqrt(18199.2*0.9));
+        assert(fabs(weight - 10*particles) < 1e-3*weight);
+        ENSURE_EQUAL(stream.GetNSkippedBlocks(), 0u);
+        
+        // the same particles on every pass
+        stream.Rewind();
+        size_t again = 0;
+        while (stream.NextBatch(batch))
+            again += batch.size();
+        ENSURE_EQUAL(again, particles);
+        
+        stream.SetSubsampling(ShowerParticleStream::eBlockSubsampling, 0.05, 7);
+        stream.Rewind();
+        size_t blocks = 0;
+        weight = 0;
+        while (stream.NextBatch(batch))
+        {
+            blocks += batch.size();
+            for (size_t i = 0; i != batch.size(); ++i)
+                weight += batch.fWeight[i];
+        }
+        assert(stream.GetNSkippedBlocks() > 4000);
+        assert(fabs(weight - 181992) < 0.3*181992);
+        
+        // reservoir of a fixed size
+        stream.SetSubsampling(ShowerParticleStream::eAllParticles);
+        stream.Rewind();
+        ENSURE_EQUAL(stream.NextReservoir(batch, 1000, 3), 181992u);
+        ENSURE_EQUAL(batch.size(), 1000u);
+        weight = 0;
+        for (size_t i = 0; i != batch.size(); ++i)
+            weight += batch.fWeight[i];
+        assert(fabs(weight - 181992) < 1);
+        
+        return std::make_pair(particles, blocks);
+    }
+    
+    // blocks skipped by seeking are the particle blocks, not the LONG blocks after them
+    void test_skip_long_blocks(std::string filename)
+    {
+        const std::string copy = "/tmp/corsika_reader_long_blocks_test";
+        add_long_blocks(filename, copy);
+        size_t skipped[2];
+        const std::string files[2] = {filename, copy};
+        for (int f = 0; f != 2; ++f)
+        {
+            ShowerFile file(files[f]);
+            file.FindEvent(1);
+            ShowerParticleStream& stream = file.GetCurrentShower().ParticleStream();
+            stream.SetSubsampling(ShowerParticleStream::eBlockSubsampling, 1e-12, 7);
+            ParticleBatch batch;
+            while (stream.NextBatch(batch))
+                ;
+            skipped[f] = stream.GetNSkippedBlocks();
+        }
+        ENSURE_EQUAL(skipped[1], skipped[0]);
+        std::remove(copy.c_str());
+    }
+}
+
+// copy of an unthinned file with two LONG blocks before each event trailer, announcing \a declared blocks
+void add_long_blocks(const std::string& input, const std::string& output, int declared)
+{
+    RawStreamPtr in = RawStream::Create(input);
+    RawStreamWriterPtr out = RawStreamWriter::Create(output, false, in->Is64Bit());
+    Block<NotThinned> block;
+    while (in->GetNextBlock(block))
+    {
+        if (block.IsEventTrailer())
+        {
+            Block<NotThinned> longBlock;
+            std::memset(&longBlock, 0, sizeof(longBlock));
+            std::memcpy(longBlock.AsLongitudinalBlock.fID.fID, "LONG", 4);
+            longBlock.AsLongitudinalBlock.fStepsAndBlocks = 2*kLongEntriesPerBlock*100 + declared;
+            for (int b = 1; b <= 2; ++b)
+            {
+                longBlock.AsLongitudinalBlock.fCurrentBlock = b;
+                out->Write(longBlock);
+            }
+        }
+        out->Write(block);
+        if (block.IsRunTrailer())
+            break;
+    }
+    out->Close();
+}
+
+void test_subsampling(const char* directory)
+{
+    std::string dir(directory);
+    std::vector<const char*> filenames = {"/DAT000002-32", "/DAT000002-32.bz2", "/DAT000002-32.gz"};
+    
+    std::vector<std::pair<size_t, size_t> > subsampled;
+    for (unsigned int i = 0; i != filenames.size(); ++i)
+    {
+        std::cout << "testing subsampling " << dir << filenames[i] << std::endl;
+        subsampled.push_back(count_subsampled(dir + filenames[i]));
+        // compressed or not, the same particles are chosen
+        assert(subsampled.back() == subsampled.front());
+    }
+    test_skip_long_blocks(dir + filenames[0]);
+    printf("TestSubsampling Successfull!\n");
+}
@@ -0,0 +1,65 @@
+#include "tests.h"
+#include <corsika/Trace.h>
+#include <corsika/Instrumentation.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    void test_spans(std::string filename)
+    {
+        const std::string traceName = "/tmp/corsika_reader_test.trace.json";
+        assert(!Trace::IsRecording());
+        Trace::Start();
+        {
+            Trace::Span span("test", "user");
+            ShowerFile file(filename);
+            std::shared_future<ShowerPtr> loaded = file.LoadAsync(1);
+            ShowerParticleStream& stream = loaded.get()->ParticleStream();
+            ParticleBatch batch;
+            while (stream.NextBatch(batch)) {}
+        }
+        const size_t spans = Trace::Stop();
+        assert(!Trace::IsRecording());
+        assert(spans > 0);
+        ENSURE_EQUAL(Trace::GetNDropped(), 0u);
+        // not recording
+        {
+            Trace::Span span("ignored", "user");
+        }
+        ENSURE_EQUAL(Trace::GetNSpans(), spans);
+        Trace::Write(traceName);
+        
+        std::ifstream in(traceName.c_str());
+        std::stringstream json;
+        json << in.rdbuf();
+        const std::string text = json.str();
+        assert(text.find("\"traceEvents\"") != std::string::npos);
+        assert(text.find("\"name\": \"test\", \"cat\": \"user\"") != std::string::npos);
+        assert(text.find("\"ignored\"") == std::string::npos);
+        if (Instrumentation::IsEnabled())
+        {
+            assert(text.find("\"cat\": \"scan\"") != std::string::npos);
+            assert(text.find("\"cat\": \"decompress\"") != std::string::npos);
+            assert(text.find("\"cat\": \"decode\"") != std::string::npos);
+            assert(text.find("\"ShowerFile::LoadAsync\"") != std::string::npos);
+        }
+        
+        // few spans: the rest are dropped
+        Trace::Start(2);
+        for (int i = 0; i != 5; ++i)
+            Trace::Span span("test", "user");
+        ENSURE_EQUAL(Trace::Stop(), 2u);
+        ENSURE_EQUAL(Trace::GetNDropped(), 3u);
+        Trace::Clear();
+        ENSURE_EQUAL(Trace::GetNSpans(), 0u);
+        remove(traceName.c_str());
+    }
+}
+
+void test_trace(const char* directory)
+{
+    test_spans(std::string(directory) + "/DAT000002-32.gz");
+    printf("TestTrace Successfull!\n");
+}
@@ -14,3 +14,25 @@ void test_low_high(const char* dir);
 void test_file(const char* directory);
 void test_rawstream(const char* directory);
 void test_index();
+void test_selection(const char* directory);
+void test_histogram(const char* directory);
+void test_lateral(const char* directory);
+void test_sampler(const char* directory);
+void test_server(const char* directory);
+void test_subsampling(const char* directory);
+void test_archive(const char* directory);
+void test_column_cache(const char* directory);
+void test_async(const char* directory);
+void test_long();
+void test_long_cache();
+void test_resample();
+void test_profile_table();
+void test_gaisser_hillas();
+void test_long_loader(const char* directory);
+void test_instrumentation(const char* directory);
+void test_trace(const char* directory);
+
+// helpers shared by several tests
+void add_long_blocks(const std::string& input, const std::string& output, int declared = 2);
+void write_long(const std::string& name);
+bool close_to(double a, double b);